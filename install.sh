@@ -16,9 +16,11 @@ mkdir -p $GAWAKE_DB_DIR
 chown gawake:gawake $GAWAKE_DB_DIR
 chmod 770 $GAWAKE_DB_DIR
 
-# [3] Creating database
-echo "Creating database"
-cat ./src/database.sql | sqlite3 $GAWAKE_DB_PATH
+# [3] Creating database; an existing one is migrated by Gawake when it's opened
+if [ ! -f $GAWAKE_DB_PATH ]; then
+  echo "Creating database"
+  cat ./src/database.sql | sqlite3 $GAWAKE_DB_PATH
+fi
 chown gawake:gawake $GAWAKE_DB_PATH
 chmod 660 $GAWAKE_DB_PATH
 
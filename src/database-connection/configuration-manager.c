@@ -24,61 +24,55 @@
 #include "database-connection-utils.h"
 #include "configuration-manager.h"
 
-int
-configuration_set_localtime (bool use_localtime)
+// Configuration changes aren't related to a rule: the receivers reload it
+static int
+run_and_notify (GawakeDb *db, DatabaseStatement statement, int value)
 {
-  sqlite3_snprintf (SQL_SIZE, utils_get_sql (),
-                    "UPDATE config "\
-                    "SET localtime = %d "\
-                    "WHERE id = 1;",
-                    use_localtime);
+  sqlite3_stmt *stmt = utils_get_statement (db, statement);
+
+  if (stmt == NULL)
+    return EXIT_FAILURE;
+
+  sqlite3_bind_int (stmt, 1, value);
+
+  if (utils_run_statement (db, stmt))
+    return EXIT_FAILURE;
+
+  // data_version only changes on commits of other connections
+  db->config_valid = false;
+
+  utils_notify_change (db, CHANGE_OTHER, NULL);
 
-  return utils_run_sql ();
+  return EXIT_SUCCESS;
 }
 
 int
-configuration_set_default_mode (Mode default_mode)
+configuration_set_localtime (GawakeDb *db, bool use_localtime)
+{
+  return run_and_notify (db, STATEMENT_SET_LOCALTIME, use_localtime);
+}
+
+int
+configuration_set_default_mode (GawakeDb *db, Mode default_mode)
 {
   // Validate mode
   if (default_mode >= MODE_MEM && default_mode <= MODE_OFF)
-    {
-      sqlite3_snprintf (SQL_SIZE, utils_get_sql (),
-                        "UPDATE config "\
-                        "SET default_mode = %d "\
-                        "WHERE id = 1;",
-                        default_mode);
-
-      return utils_run_sql ();
-    }
+    return run_and_notify (db, STATEMENT_SET_DEFAULT_MODE, default_mode);
   else
     return EXIT_FAILURE;
 }
 
 int
-configuration_set_notification_time (int notification_time)
+configuration_set_notification_time (GawakeDb *db, int notification_time)
 {
   if (notification_time >= 0 && notification_time <= MAX_NOTIFICATION_TIME)
-    {
-      sqlite3_snprintf (SQL_SIZE, utils_get_sql (),
-                        "UPDATE config "\
-                        "SET notification_time = %d "\
-                        "WHERE id = 1;",
-                        notification_time);
-
-      return utils_run_sql ();
-    }
+    return run_and_notify (db, STATEMENT_SET_NOTIFICATION_TIME, notification_time);
   else
     return EXIT_FAILURE;
 }
 
 int
-configuration_set_shutdown_fail (bool shutdown_fail)
+configuration_set_shutdown_fail (GawakeDb *db, bool shutdown_fail)
 {
-  sqlite3_snprintf (SQL_SIZE, utils_get_sql (),
-                    "UPDATE config "\
-                    "SET shutdown_fail = %d "\
-                    "WHERE id = 1;",
-                    shutdown_fail);
-
-  return utils_run_sql ();
+  return run_and_notify (db, STATEMENT_SET_SHUTDOWN_FAIL, shutdown_fail);
 }
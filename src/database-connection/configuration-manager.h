@@ -21,9 +21,9 @@
 #ifndef CONFIGURATION_MANAGER_H_
 #define CONFIGURATION_MANAGER_H_
 
-int configuration_set_localtime (bool use_localtime);
-int configuration_set_default_mode (Mode default_mode);
-int configuration_set_notification_time (int notification_time);
-int configuration_set_shutdown_fail (bool shutdown_fail);
+int configuration_set_localtime (GawakeDb *db, bool use_localtime);
+int configuration_set_default_mode (GawakeDb *db, Mode default_mode);
+int configuration_set_notification_time (GawakeDb *db, int notification_time);
+int configuration_set_shutdown_fail (GawakeDb *db, bool shutdown_fail);
 
 #endif /* CONFIGURATION_MANAGER_H_ */
@@ -25,15 +25,8 @@
 #include "database-connection-utils.h"
 #include "configuration-reader.h"
 
-typedef struct
-{
-  bool use_localtime;
-  Mode default_mode;
-  int notification_time;
-  bool shutdown_fail;
-} Config;
-
-static Config config =
+// Values used if the configuration can't be read
+static const Config DEFAULT_CONFIG =
 {
   false,
   MODE_OFF,
@@ -41,25 +34,43 @@ static Config config =
   false
 };
 
+// Counter of the commits made by other connections
+static int
+get_data_version (GawakeDb *db, int *version)
+{
+  sqlite3_stmt *stmt = utils_get_statement (db, STATEMENT_DATA_VERSION);
+
+  if (stmt == NULL)
+    return EXIT_FAILURE;
+
+  if (sqlite3_step (stmt) != SQLITE_ROW)
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR (failed getting the data version): %s\n",
+               sqlite3_errmsg (db->connection));
+      sqlite3_reset (stmt);
+      return EXIT_FAILURE;
+    }
+  *version = sqlite3_column_int (stmt, 0);
+  sqlite3_reset (stmt);
+
+  return EXIT_SUCCESS;
+}
+
 static int
-get_config (void)
+get_config (GawakeDb *db, Config *config)
 {
   // Database related variables
   int rc;
-  struct sqlite3_stmt *stmt;
+  sqlite3_stmt *stmt;
 
-  // Generate SQL
-  sqlite3_snprintf (SQL_SIZE, utils_get_sql (),
-                    "SELECT * FROM config "\
-                    "WHERE id = 1;");
+  *config = DEFAULT_CONFIG;
 
-  DEBUG_PRINT (("Generated SQL:\n\t%s", utils_get_sql ()));
-
-  if (sqlite3_prepare_v2 (utils_get_pdb (), utils_get_sql (), -1, &stmt, NULL) != SQLITE_OK)
+  stmt = utils_get_statement (db, STATEMENT_GET_CONFIG);
+  if (stmt == NULL)
     {
       DEBUG_PRINT_CONTEX;
       fprintf (stderr, "ERROR: Failed to query rule\n");
-      sqlite3_finalize (stmt);
       return EXIT_FAILURE;
     }
 
@@ -69,59 +80,59 @@ get_config (void)
       // Note: column 1 is the cli_version
 
       // Use localtime
-      config.use_localtime = (bool) sqlite3_column_int (stmt, 2);
+      config->use_localtime = (bool) sqlite3_column_int (stmt, 2);
 
       // Default mode
-      config.default_mode = (Mode) sqlite3_column_int (stmt, 3);
+      config->default_mode = (Mode) sqlite3_column_int (stmt, 3);
 
       // Notification time
-      config.notification_time = sqlite3_column_int (stmt, 4);
+      config->notification_time = sqlite3_column_int (stmt, 4);
 
       // Shutdown if fails
-      config.shutdown_fail = (bool) sqlite3_column_int (stmt, 5);
+      config->shutdown_fail = (bool) sqlite3_column_int (stmt, 5);
     }
 
+  // Release the read lock; the statement is kept for the next call
+  sqlite3_reset (stmt);
+
   if (rc != SQLITE_DONE)
     {
       DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "ERROR (failed to query rule): %s\n"), sqlite3_errmsg (utils_get_pdb ());
-      sqlite3_finalize (stmt);
+      fprintf (stderr, "ERROR (failed to query rule): %s\n", sqlite3_errmsg (db->connection));
       return EXIT_FAILURE;
     }
 
-  sqlite3_finalize(stmt);
-
   return EXIT_SUCCESS;
 }
 
+/*
+ * Get all the configuration at once. It's read from the database only if it
+ * changed since the last call on this GawakeDb: by this connection (the
+ * configuration manager invalidates it) or by another one (data_version)
+ */
 int
-configuration_get_localtime (bool *use_localtime)
+configuration_get_snapshot (GawakeDb *db, Config *config)
 {
-  int ret = get_config ();
-  *use_localtime = config.use_localtime;
-  return ret;
-}
+  int version;
 
-int
-configuration_get_default_mode (Mode *default_mode)
-{
-  int ret = get_config ();
-  *default_mode = config.default_mode;
-  return ret;
-}
+  if (get_data_version (db, &version))
+    return EXIT_FAILURE;
 
-int
-configuration_get_notification_time (int *notification_time)
-{
-  int ret = get_config ();
-  *notification_time = config.notification_time;
-  return ret;
-}
+  if (!db->config_valid || version != db->config_data_version)
+    {
+      if (get_config (db, &db->config))
+        {
+          db->config_valid = false;
+          *config = DEFAULT_CONFIG;
+          return EXIT_FAILURE;
+        }
+
+      db->config_data_version = version;
+      db->config_valid = true;
+      DEBUG_PRINT (("Configuration read, data version %d", version));
+    }
 
-int
-configuration_get_shutdown_fail (bool *shutdown_fail)
-{
-  int ret = get_config ();
-  *shutdown_fail = config.shutdown_fail;
-  return ret;
+  *config = db->config;
+
+  return EXIT_SUCCESS;
 }
@@ -23,9 +23,14 @@
 
 #include "gawake-types.h"
 
-int configuration_get_localtime (bool *use_localtime);
-int configuration_get_default_mode (Mode *default_mode);
-int configuration_get_notification_time (int *notification_time);
-int configuration_get_shutdown_fail (bool *shutdown_fail);
+typedef struct
+{
+  bool use_localtime;
+  Mode default_mode;
+  int notification_time;
+  bool shutdown_fail;
+} Config;
+
+int configuration_get_snapshot (GawakeDb *db, Config *config);
 
 #endif /* CONFIGURATION_READER_H_ */
@@ -0,0 +1,251 @@
+/* database-backup.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Online backup and restore, with the SQLite backup API: the programs using
+ * the database keep running, and the copy is always a committed state
+ * (copying the file could catch a transaction half written).
+ *
+ * The backup copies BACKUP_STEP_PAGES pages at a time, pausing between the
+ * steps: the live database is only locked during each step. If another
+ * connection commits in the meantime, the copy starts over, so it's never a
+ * mix of two states; after BACKUP_MAX_RESTARTS, the rest is copied in a
+ * single step, so frequent writes can't postpone the backup forever (with
+ * WAL, reading the whole database doesn't block the writers either).
+ *
+ * The restore doesn't write an unverified file on the live database: the
+ * backup is first copied to a temporary database, where it's migrated to
+ * the current schema and checked (integrity_check). Only then it's copied to
+ * the live database, in a single step: the destination of a copy stays
+ * locked for writing until it's complete, so smaller steps would only hold
+ * the lock for longer. The readers aren't blocked (WAL), they see the
+ * previous state until the copy is committed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "database-backup.h"
+#include "database-connection-utils.h"
+#include "database-migration.h"
+#include "../utils/debugger.h"
+
+#define BACKUP_STEP_PAGES 64
+#define BACKUP_STEP_PAUSE 2     // ms
+#define BACKUP_MAX_RESTARTS 3
+
+// Tables every Gawake database has, since the first schema version
+#define COUNT_TABLES \
+  "SELECT count (*) FROM sqlite_schema WHERE type = 'table' AND name IN "\
+  "('rules_turnon', 'rules_turnoff', 'config', 'custom_schedule');"
+
+/*
+ * Copy a database, pages_per_step at a time (-1: all at once). A locked
+ * source is tried again, up to BUSY_TIMEOUT; the busy timeout of the
+ * destination connection is used for the destination
+ */
+static int
+copy_database (sqlite3 *source, sqlite3 *destination, int pages_per_step, int *pages)
+{
+  sqlite3_backup *backup;
+  int rc, busy = 0, restarts = 0, remaining = -1;
+
+  backup = sqlite3_backup_init (destination, "main", source, "main");
+  if (backup == NULL)
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR: Couldn't start copying the database: %s\n",
+               sqlite3_errmsg (destination));
+      return EXIT_FAILURE;
+    }
+
+  for (;;)
+    {
+      rc = sqlite3_backup_step (backup, pages_per_step);
+
+      if (rc == SQLITE_OK)
+        {
+          busy = 0;
+
+          // Started over: another connection changed the source
+          if (remaining >= 0 && sqlite3_backup_remaining (backup) >= remaining
+              && ++restarts == BACKUP_MAX_RESTARTS)
+            pages_per_step = -1;
+          remaining = sqlite3_backup_remaining (backup);
+        }
+      else if ((rc == SQLITE_BUSY || rc == SQLITE_LOCKED) && busy < BUSY_TIMEOUT)
+        busy += BACKUP_STEP_PAUSE;
+      else
+        break;
+
+      // Let the other connections use the database between the steps
+      sqlite3_sleep (BACKUP_STEP_PAUSE);
+    }
+
+  *pages = sqlite3_backup_pagecount (backup);
+  sqlite3_backup_finish (backup);
+
+  if (rc != SQLITE_DONE)
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR: Failed to copy the database: %s\n", sqlite3_errstr (rc));
+      return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
+
+// Run a query that returns a single value
+static int
+query_value (sqlite3 *connection, const char *sql, char *value, size_t size)
+{
+  sqlite3_stmt *stmt;
+  const unsigned char *text;
+  int rc;
+
+  if (sqlite3_prepare_v2 (connection, sql, -1, &stmt, NULL) != SQLITE_OK)
+    return EXIT_FAILURE;
+
+  rc = sqlite3_step (stmt);
+  if (rc == SQLITE_ROW)
+    {
+      text = sqlite3_column_text (stmt, 0);
+      snprintf (value, size, "%s", (text != NULL) ? (const char *) text : "");
+    }
+
+  sqlite3_finalize (stmt);
+
+  return (rc == SQLITE_ROW) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Validate the copy of a backup, bringing it to the current schema
+static int
+check_backup (sqlite3 *connection)
+{
+  char result[64];
+
+  if (query_value (connection, COUNT_TABLES, result, sizeof (result))
+      || strcmp (result, "4") != 0)
+    {
+      fprintf (stderr, "ERROR: The file isn't a Gawake database\n");
+      return EXIT_FAILURE;
+    }
+
+  // Rejects newer schema versions
+  if (migration_run (connection, false))
+    return EXIT_FAILURE;
+
+  if (query_value (connection, "PRAGMA integrity_check;", result, sizeof (result))
+      || strcmp (result, "ok") != 0)
+    {
+      fprintf (stderr, "ERROR: The backup failed the integrity check\n");
+      return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
+
+// Don't copy the live database over itself
+static bool
+is_live_database (const char *path)
+{
+  struct stat live, file;
+
+  return stat (DB_PATH, &live) == 0 && stat (path, &file) == 0
+         && live.st_dev == file.st_dev && live.st_ino == file.st_ino;
+}
+
+int
+database_backup (GawakeDb *db, const char *path, int *pages)
+{
+  sqlite3 *destination = NULL;
+  int ret;
+
+  if (is_live_database (path))
+    {
+      fprintf (stderr, "ERROR: The backup can't replace the database itself\n");
+      return EXIT_FAILURE;
+    }
+
+  if (sqlite3_open_v2 (path, &destination, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL) != SQLITE_OK)
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR: Couldn't open \"%s\": %s\n", path, sqlite3_errmsg (destination));
+      sqlite3_close (destination);
+      return EXIT_FAILURE;
+    }
+
+  sqlite3_busy_timeout (destination, BUSY_TIMEOUT);
+
+  ret = copy_database (db->connection, destination, BACKUP_STEP_PAGES, pages);
+
+  // The copy has the journal mode of the live database; a backup is better
+  // as a single file
+  if (ret == EXIT_SUCCESS
+      && sqlite3_exec (destination, "PRAGMA journal_mode = DELETE;", NULL, NULL, NULL) != SQLITE_OK)
+    fprintf (stderr, "Warning: Couldn't change the journal mode of the backup: %s\n",
+             sqlite3_errmsg (destination));
+
+  sqlite3_close (destination);
+
+  return ret;
+}
+
+int
+database_restore (GawakeDb *db, const char *path, int *pages)
+{
+  sqlite3 *backup = NULL, *staging = NULL;
+  int staged_pages, ret = EXIT_FAILURE;
+
+  if (is_live_database (path))
+    {
+      fprintf (stderr, "ERROR: The backup is the database itself\n");
+      return EXIT_FAILURE;
+    }
+
+  // An empty name is a temporary database, deleted when it's closed
+  if (sqlite3_open_v2 (path, &backup, SQLITE_OPEN_READONLY, NULL) != SQLITE_OK
+      || sqlite3_open_v2 ("", &staging, SQLITE_OPEN_READWRITE, NULL) != SQLITE_OK)
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR: Couldn't open \"%s\": %s\n", path,
+               sqlite3_errmsg ((staging == NULL) ? backup : staging));
+      goto out;
+    }
+
+  if (copy_database (backup, staging, -1, &staged_pages)
+      || check_backup (staging)
+      || copy_database (staging, db->connection, -1, pages))
+    goto out;
+
+  ret = EXIT_SUCCESS;
+
+  // Everything may have changed
+  db->config_valid = false;
+  utils_notify_change (db, CHANGE_OTHER, NULL);
+
+out:
+  sqlite3_close (backup);
+  sqlite3_close (staging);
+
+  return ret;
+}
@@ -26,22 +26,87 @@
 #include "../utils/debugger.h"
 #include "database-connection-utils.h"
 
-static sqlite3 *db = NULL;
-static char sql[SQL_SIZE];
-
-// Get the system time (now) as time_t
-static
-int get_time (time_t *time_now)
-{
-  time (time_now);
-  if (*time_now ==  (time_t) -1)
-    {
-      fprintf (stderr, "ERROR: failed while getting time\n");
-      return EXIT_FAILURE;
-    }
-  else
-    return EXIT_SUCCESS;
-}
+// Index matches DatabaseStatement
+static const char *const SQL[STATEMENT_COUNT] = {
+  // STATEMENT_GET_SINGLE_ON, STATEMENT_GET_SINGLE_OFF; turn on rules have no mode
+  "SELECT id, rule_name, minute, days_mask, active, 0 FROM rules_turnon WHERE id = ?1;",
+  "SELECT id, rule_name, minute, days_mask, active, mode FROM rules_turnoff WHERE id = ?1;",
+  // STATEMENT_GET_ALL_ON, STATEMENT_GET_ALL_OFF
+  "SELECT id, rule_name, minute, days_mask, active, 0 FROM rules_turnon;",
+  "SELECT id, rule_name, minute, days_mask, active, mode FROM rules_turnoff;",
+  // STATEMENT_GET_FIELDS_ON, STATEMENT_GET_FIELDS_OFF: all but the name, in
+  // id order (the rowid), for rule_set_load ()
+  "SELECT id, minute, days_mask, active, 0 FROM rules_turnon ORDER BY id;",
+  "SELECT id, minute, days_mask, active, mode FROM rules_turnoff ORDER BY id;",
+  // STATEMENT_GET_NAMES_ON, STATEMENT_GET_NAMES_OFF
+  "SELECT id, rule_name FROM rules_turnon ORDER BY id;",
+  "SELECT id, rule_name FROM rules_turnoff ORDER BY id;",
+  // STATEMENT_ADD_ON, STATEMENT_ADD_OFF
+  "INSERT INTO rules_turnon (rule_name, minute, days_mask, active) "\
+  "VALUES (?1, ?2, ?3, ?4);",
+  "INSERT INTO rules_turnoff (rule_name, minute, days_mask, active, mode) "\
+  "VALUES (?1, ?2, ?3, ?4, ?5);",
+  // STATEMENT_EDIT_ON, STATEMENT_EDIT_OFF
+  "UPDATE rules_turnon SET "\
+  "rule_name = ?1, minute = ?2, days_mask = ?3, active = ?4 WHERE id = ?6;",
+  "UPDATE rules_turnoff SET "\
+  "rule_name = ?1, minute = ?2, days_mask = ?3, active = ?4, mode = ?5 WHERE id = ?6;",
+  // STATEMENT_DELETE_ON, STATEMENT_DELETE_OFF
+  "DELETE FROM rules_turnon WHERE id = ?1;",
+  "DELETE FROM rules_turnoff WHERE id = ?1;",
+  // STATEMENT_DELETE_ALL_ON, STATEMENT_DELETE_ALL_OFF
+  "DELETE FROM rules_turnon;",
+  "DELETE FROM rules_turnoff;",
+  // STATEMENT_ENABLE_ON, STATEMENT_ENABLE_OFF
+  "UPDATE rules_turnon SET active = ?2 WHERE id = ?1;",
+  "UPDATE rules_turnoff SET active = ?2 WHERE id = ?1;",
+  // STATEMENT_GET_CUSTOM_SCHEDULE
+  "SELECT hour, minutes, day, month, year, mode "\
+  "FROM custom_schedule WHERE id = 1;",
+  // STATEMENT_SET_CUSTOM_SCHEDULE
+  "UPDATE custom_schedule "\
+  "SET hour = ?1, minutes = ?2, day = ?3, month = ?4, year = ?5, mode = ?6 "\
+  "WHERE id = 1;",
+  // STATEMENT_GET_ONE_SHOTS: a range of the (wake_time) index
+  "SELECT id, name, wake_time FROM one_shot_schedule "\
+  "WHERE wake_time > ?1 ORDER BY wake_time;",
+  // STATEMENT_ADD_ONE_SHOT
+  "INSERT INTO one_shot_schedule (name, wake_time) VALUES (?1, ?2);",
+  // STATEMENT_DELETE_ONE_SHOT
+  "DELETE FROM one_shot_schedule WHERE id = ?1;",
+  // STATEMENT_PRUNE_ONE_SHOTS
+  "DELETE FROM one_shot_schedule WHERE wake_time <= ?1;",
+  // STATEMENT_GET_EXCEPTIONS: a range of the (date, rule_table, rule_id) index
+  "SELECT id, date, rule_table, rule_id FROM exception_dates "\
+  "WHERE date >= ?1 ORDER BY date, rule_table, rule_id;",
+  // STATEMENT_ADD_EXCEPTION: a date already set is kept; not OR IGNORE, so an
+  // invalid date still fails the CHECK
+  "INSERT INTO exception_dates (date, rule_table, rule_id) VALUES (?1, ?2, ?3) "\
+  "ON CONFLICT DO NOTHING;",
+  // STATEMENT_DELETE_EXCEPTION
+  "DELETE FROM exception_dates WHERE id = ?1;",
+  // STATEMENT_DELETE_RULE_EXCEPTIONS, STATEMENT_DELETE_TABLE_EXCEPTIONS: the
+  // dates of a deleted rule, and of all the rules of a table (not the ones
+  // of all the rules)
+  "DELETE FROM exception_dates WHERE rule_table = ?1 AND rule_id = ?2;",
+  "DELETE FROM exception_dates WHERE rule_table = ?1 AND rule_id != 0;",
+  // STATEMENT_GET_CONFIG
+  "SELECT * FROM config WHERE id = 1;",
+  // STATEMENT_DATA_VERSION
+  "PRAGMA data_version;",
+  // STATEMENT_SET_LOCALTIME
+  "UPDATE config SET localtime = ?1 WHERE id = 1;",
+  // STATEMENT_SET_DEFAULT_MODE
+  "UPDATE config SET default_mode = ?1 WHERE id = 1;",
+  // STATEMENT_SET_NOTIFICATION_TIME
+  "UPDATE config SET notification_time = ?1 WHERE id = 1;",
+  // STATEMENT_SET_SHUTDOWN_FAIL
+  "UPDATE config SET shutdown_fail = ?1 WHERE id = 1;",
+  // STATEMENT_SAVEPOINT, STATEMENT_RELEASE, STATEMENT_ROLLBACK_TO
+  "SAVEPOINT batch;",
+  "RELEASE batch;",
+  "ROLLBACK TO batch;",
+};
 
 int
 utils_validate_rule (const Rule *rule)
@@ -83,116 +148,194 @@ utils_validate_table (const Table table)
   return EXIT_FAILURE;
 }
 
-int
-utils_run_sql (void)
+/*
+ * Get the statement, ready to be bound and stepped; it's prepared on its
+ * first use and kept until the database is disconnected. Returns NULL on
+ * failure.
+ */
+sqlite3_stmt *
+utils_get_statement (GawakeDb *db, DatabaseStatement statement)
 {
   int rc;
-  char *err_msg = 0;
+  sqlite3_stmt *stmt;
 
-  if (db == NULL)
+  if (db == NULL || db->connection == NULL)
     {
       fprintf (stderr, "Database not connected\n");
-      return EXIT_FAILURE;
+      return NULL;
     }
 
-  DEBUG_PRINT (("Generated SQL:\n\t%s", sql));
+  stmt = db->statements[statement];
+  if (stmt == NULL)
+    {
+      rc = sqlite3_prepare_v3 (db->connection, SQL[statement], -1,
+                               SQLITE_PREPARE_PERSISTENT, &stmt, NULL);
+      if (rc != SQLITE_OK)
+        {
+          DEBUG_PRINT_CONTEX;
+          fprintf (stderr, "ERROR: Failed preparing statement: %s\n"\
+                   "SQL: %s\n", sqlite3_errmsg (db->connection), SQL[statement]);
+          return NULL;
+        }
+
+      db->statements[statement] = stmt;
+      return stmt;
+    }
 
-  rc = sqlite3_exec(db, sql, NULL, 0, &err_msg);
-  if (rc != SQLITE_OK)
-    fprintf (stderr, "Failed to run SQL: %s\n", sqlite3_errmsg(db));
+  // The previous result (or error) was already handled
+  sqlite3_reset (stmt);
+  sqlite3_clear_bindings (stmt);
 
-  sqlite3_free (err_msg);
+  return stmt;
+}
 
-  if (rc == SQLITE_OK)
+// Run a bound statement that doesn't return rows
+int
+utils_run_statement (GawakeDb *db, sqlite3_stmt *stmt)
+{
+  int rc;
+
+  DEBUG_PRINT (("Running SQL:\n\t%s", sqlite3_sql (stmt)));
+
+  rc = sqlite3_step (stmt);
+  // Release the locks now, not on the next use of the statement
+  sqlite3_reset (stmt);
+
+  if (rc != SQLITE_DONE)
     {
-      // TODO
-      /* trigger_update_database (); */
-      return EXIT_SUCCESS;
+      fprintf (stderr, "Failed to run SQL: %s\n", sqlite3_errmsg (db->connection));
+      return EXIT_FAILURE;
     }
-  else
-    return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
 }
 
-char *
-utils_get_sql (void)
+// Must be called before closing the connection
+void
+utils_finalize_statements (GawakeDb *db)
 {
-  return sql;
+  for (int i = 0; i < STATEMENT_COUNT; i++)
+    {
+      sqlite3_finalize (db->statements[i]);
+      db->statements[i] = NULL;
+    }
 }
 
-sqlite3 * utils_get_pdb (void)
+// Report a successful change to the program using the library, if it wants
+// to propagate it (e.g. through the DatabaseUpdated signal)
+void
+utils_notify_change (GawakeDb *db, ChangeOperation operation, const Rule *rule)
 {
-  return db;
+  DatabaseChange change = {
+    .operation = operation,
+  };
+
+  if (rule != NULL)
+    change.rule = *rule;
+
+  utils_notify_changes (db, &change, 1);
 }
 
-sqlite3 ** utils_get_ppdb (void)
+// Send all the changes of a batch at once (a single DatabaseUpdated signal);
+// inside a transaction, they are queued until it ends
+void
+utils_notify_changes (GawakeDb *db, const DatabaseChange *changes, size_t length)
 {
-  return &db;
+  if (db->change_callback == NULL || length == 0)
+    return;
+
+  if (db->transaction_depth == 0)
+    {
+      db->change_callback (changes, length);
+      return;
+    }
+
+  if (db->pending_length + length > db->pending_allocated)
+    {
+      size_t allocated = (db->pending_allocated > 0) ? db->pending_allocated : 16;
+      DatabaseChange *pending;
+
+      while (allocated < db->pending_length + length)
+        allocated *= 2;
+
+      pending = realloc (db->pending_changes, allocated * sizeof (DatabaseChange));
+      if (pending == NULL)
+        {
+          DEBUG_PRINT_CONTEX;
+          fprintf (stderr, "ERROR: Couldn't queue the changes\n");
+          db->pending_lost = true;
+          return;
+        }
+
+      db->pending_changes = pending;
+      db->pending_allocated = allocated;
+    }
+
+  memcpy (db->pending_changes + db->pending_length, changes, length * sizeof (DatabaseChange));
+  db->pending_length += length;
 }
 
-int
-utils_validade_rtcwake_args (RtcwakeArgs *rtcwake_args)
+/*
+ * The outermost transaction ended: notify the queued changes if it was
+ * committed, or drop them. If a change couldn't be queued, a change that
+ * isn't related to a single rule is sent instead, so everything is read again
+ */
+void
+utils_end_pending_changes (GawakeDb *db, bool committed)
 {
-  DEBUG_PRINT (("Validating rtcwake_args..."));
-
-  bool hour, minutes, date, year, mode;
-  hour = minutes = date = year  = mode = false;
-  int ret;
-  struct tm *timeinfo;
-
-  // Hour
-  if (rtcwake_args->hour >= 0 && rtcwake_args->hour <= 23)
-    hour = true;
-
-  // Minutes
-  if (rtcwake_args->minutes >= 0 && rtcwake_args->minutes <= 59)
-    minutes = true;
-
-  // Date
-  struct tm input = {
-    .tm_mday = rtcwake_args->day,
-    .tm_mon = rtcwake_args->month - 1,
-    .tm_year = rtcwake_args->year - 1900,
+  DatabaseChange lost = {
+    .operation = CHANGE_OTHER,
   };
-  time_t generated_time = mktime (&input);
-  timeinfo = localtime (&generated_time);
-  if (generated_time == -1
-      || rtcwake_args->day != timeinfo->tm_mday
-      || rtcwake_args->month != timeinfo->tm_mon + 1
-      || rtcwake_args->year != timeinfo->tm_year + 1900)
-    date = false;
-  else
-    date = true;
 
-  // Year (must be this year or at most the next, only)
-  get_time_tm (&timeinfo);
-  if (rtcwake_args->year > (timeinfo->tm_year + 1900 + 1))
-    year = false;
-  else
-    year = true;
-
-  switch (rtcwake_args->mode)
+  if (committed && db->change_callback != NULL)
     {
-    case MODE_MEM:
-    case MODE_DISK:
-    case MODE_OFF:
-    case MODE_NO:
-      mode = true;
-      break;
-
-    case MODE_LAST:
-    default:
-      mode = false;
+      if (db->pending_lost)
+        db->change_callback (&lost, 1);
+      else if (db->pending_length > 0)
+        db->change_callback (db->pending_changes, db->pending_length);
     }
 
-  if (hour && minutes && date && year && mode)
-    ret = 1;    // valid
-  else
-    ret = -1;   // invalid
+  db->pending_length = 0;
+  db->pending_lost = false;
+}
+
+// Run a statement without parameters
+static int
+run_unbound (GawakeDb *db, DatabaseStatement statement)
+{
+  sqlite3_stmt *stmt = utils_get_statement (db, statement);
+
+  if (stmt == NULL)
+    return EXIT_FAILURE;
+
+  return utils_run_statement (db, stmt);
+}
 
-  DEBUG_PRINT (("RtcwakeArgs validation:\n"\
-                "\tHour: %d\n\tMinutes: %d\n\tDate: %d\n\tYear: %d\n"\
-                "\tMode: %d\n\tthis_year: %d\n\t--> Passed: %d",
-                hour, minutes, date, year, mode, timeinfo->tm_year + 1900, ret));
+/*
+ * Run the following statements as a single transaction (one journal sync),
+ * until utils_batch_end (). A savepoint is used, so a batch can also be part
+ * of a transaction opened by the caller
+ */
+int
+utils_batch_begin (GawakeDb *db)
+{
+  return run_unbound (db, STATEMENT_SAVEPOINT);
+}
 
-  return ret;
+// Commit the batch if ret is EXIT_SUCCESS, otherwise (or if the commit fails)
+// undo all of it; returns whether the batch was committed
+int
+utils_batch_end (GawakeDb *db, int ret)
+{
+  if (ret == EXIT_SUCCESS && run_unbound (db, STATEMENT_RELEASE) == EXIT_SUCCESS)
+    return EXIT_SUCCESS;
+
+  // The savepoint must be released even after rolling back to it
+  if (run_unbound (db, STATEMENT_ROLLBACK_TO) || run_unbound (db, STATEMENT_RELEASE))
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR: Failed to roll back the changes\n");
+    }
+
+  return EXIT_FAILURE;
 }
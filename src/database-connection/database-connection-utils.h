@@ -22,15 +22,101 @@
 #define DATABASE_CONNECTION_UTILS_H_
 
 #include "gawake-types.h"
+#include "configuration-reader.h"
 #include <sqlite3.h>
+#include <sys/stat.h>
 
-#define SQL_SIZE 256
+/*
+ * Statements of the library, prepared once on the connection. The table name
+ * can't be bound, so the operations on rules have a statement per table, in
+ * the order of Table: use TABLE_STATEMENT () to pick one
+ */
+typedef enum {
+  STATEMENT_GET_SINGLE_ON,
+  STATEMENT_GET_SINGLE_OFF,
+  STATEMENT_GET_ALL_ON,
+  STATEMENT_GET_ALL_OFF,
+  STATEMENT_GET_FIELDS_ON,
+  STATEMENT_GET_FIELDS_OFF,
+  STATEMENT_GET_NAMES_ON,
+  STATEMENT_GET_NAMES_OFF,
+  STATEMENT_ADD_ON,
+  STATEMENT_ADD_OFF,
+  STATEMENT_EDIT_ON,
+  STATEMENT_EDIT_OFF,
+  STATEMENT_DELETE_ON,
+  STATEMENT_DELETE_OFF,
+  STATEMENT_DELETE_ALL_ON,
+  STATEMENT_DELETE_ALL_OFF,
+  STATEMENT_ENABLE_ON,
+  STATEMENT_ENABLE_OFF,
+  STATEMENT_GET_CUSTOM_SCHEDULE,
+  STATEMENT_SET_CUSTOM_SCHEDULE,
+  STATEMENT_GET_ONE_SHOTS,
+  STATEMENT_ADD_ONE_SHOT,
+  STATEMENT_DELETE_ONE_SHOT,
+  STATEMENT_PRUNE_ONE_SHOTS,
+  STATEMENT_GET_EXCEPTIONS,
+  STATEMENT_ADD_EXCEPTION,
+  STATEMENT_DELETE_EXCEPTION,
+  STATEMENT_DELETE_RULE_EXCEPTIONS,
+  STATEMENT_DELETE_TABLE_EXCEPTIONS,
+  STATEMENT_GET_CONFIG,
+  STATEMENT_DATA_VERSION,
+  STATEMENT_SET_LOCALTIME,
+  STATEMENT_SET_DEFAULT_MODE,
+  STATEMENT_SET_NOTIFICATION_TIME,
+  STATEMENT_SET_SHUTDOWN_FAIL,
+  STATEMENT_SAVEPOINT,
+  STATEMENT_RELEASE,
+  STATEMENT_ROLLBACK_TO,
+  STATEMENT_COUNT
+} DatabaseStatement;
+
+// Nested gawake_db_transaction_begin () calls
+#define MAX_TRANSACTION_DEPTH 8
+
+// The table must be valid (see utils_validate_table)
+#define TABLE_STATEMENT(statement_on, table) \
+  ((DatabaseStatement) ((statement_on) + (table)))
+
+struct GawakeDb
+{
+  sqlite3 *connection;    // where the queries run: the file, or its image
+  sqlite3_stmt *statements[STATEMENT_COUNT];
+  DatabaseChangeCallback change_callback;
+
+  // Changes made inside gawake_db_transaction_begin () ... _end (): notified
+  // at once after the commit, dropped if rolled back
+  int transaction_depth;
+  size_t transaction_marks[MAX_TRANSACTION_DEPTH];  // length at each begin
+  DatabaseChange *pending_changes;
+  size_t pending_length;
+  size_t pending_allocated;
+  bool pending_lost;    // a change couldn't be queued
+
+  // Last configuration read; valid while the data_version doesn't change
+  Config config;
+  int config_data_version;
+  bool config_valid;
+
+  // Image mode (gawake_db_open_image): the file is only read to load the
+  // image again, when its data_version or status change
+  sqlite3 *file;
+  sqlite3_stmt *file_data_version;
+  int image_data_version;
+  struct stat image_status;
+};
 
 int utils_validate_rule (const Rule *rule);
 int utils_validate_table (const Table table);
-int utils_run_sql (void);
-char* utils_get_sql (void);
-sqlite3* utils_get_pdb (void);
-sqlite3** utils_get_ppdb (void);
+sqlite3_stmt* utils_get_statement (GawakeDb *db, DatabaseStatement statement);
+int utils_run_statement (GawakeDb *db, sqlite3_stmt *stmt);
+void utils_finalize_statements (GawakeDb *db);
+int utils_batch_begin (GawakeDb *db);
+int utils_batch_end (GawakeDb *db, int ret);
+void utils_notify_change (GawakeDb *db, ChangeOperation operation, const Rule *rule);
+void utils_notify_changes (GawakeDb *db, const DatabaseChange *changes, size_t length);
+void utils_end_pending_changes (GawakeDb *db, bool committed);
 
 #endif /* DATABASE_CONNECTION_UTILS_H_ */
@@ -19,54 +19,321 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "database-connection.h"
 #include "database-connection-utils.h"
+#include "database-migration.h"
 #include "../utils/debugger.h"
 
-// This function connect to the database
-// Should be called once
-int
-connect_database (bool read_only)
+// Open a connection with the options of the library; returns NULL on failure
+static sqlite3 *
+open_connection (const char *path, int flags)
 {
-  int rc = 0;
+  sqlite3 *connection;
+
+  // SQLITE_OPEN_NOMUTEX: a connection is only used by a thread at a time
+  if (sqlite3_open_v2 (path, &connection, flags | SQLITE_OPEN_NOMUTEX, NULL) != SQLITE_OK)
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "Can't open database: %s\n", sqlite3_errmsg (connection));
+      sqlite3_close (connection);
+      return NULL;
+    }
+
+  // Wait for the locks held by the other programs (SQLite retries until the
+  // timeout), instead of failing right away with SQLITE_BUSY
+  sqlite3_busy_timeout (connection, BUSY_TIMEOUT);
+
+  // Enable security options
+  sqlite3_db_config (connection, SQLITE_DBCONFIG_DEFENSIVE, 0, 0);
+  sqlite3_db_config (connection, SQLITE_DBCONFIG_ENABLE_TRIGGER, 0, 0);
+  sqlite3_db_config (connection, SQLITE_DBCONFIG_ENABLE_VIEW, 0, 0);
+  sqlite3_db_config (connection, SQLITE_DBCONFIG_TRUSTED_SCHEMA, 0, 0);
+
+  return connection;
+}
+
+// Open a new connection to the database; returns NULL on failure
+GawakeDb *
+gawake_db_open (bool read_only)
+{
+  GawakeDb *db;
+
+  // The connections aren't shared between threads, but the library must
+  // still be able to run on more than one thread
+  if (!sqlite3_threadsafe ())
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR: SQLite was built without thread safety\n");
+      return NULL;
+    }
 
-  if (utils_get_pdb () != NULL)
+  db = calloc (1, sizeof (*db));
+  if (db == NULL)
     {
-      printf ("Warning: Database already connected.\n");
-      return SQLITE_OK;
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR: Failed to allocate memory\n");
+      return NULL;
     }
 
-  // Open the SQLite database
-  if (!read_only)
-    rc = sqlite3_open_v2 (DB_PATH, utils_get_ppdb (), SQLITE_OPEN_READWRITE, NULL);
-  else
-    rc = sqlite3_open_v2 (DB_PATH, utils_get_ppdb (), SQLITE_OPEN_READONLY, NULL);
+  db->connection = open_connection (DB_PATH, read_only ? SQLITE_OPEN_READONLY : SQLITE_OPEN_READWRITE);
+  if (db->connection == NULL)
+    {
+      free (db);
+      return NULL;
+    }
 
+  if (migration_run (db->connection, read_only))
+    {
+      sqlite3_close (db->connection);
+      free (db);
+      return NULL;
+    }
+
+  return db;
+}
+
+// data_version of the file connection and status of the file, which change
+// when the database does
+static int
+get_file_state (GawakeDb *db, int *data_version, struct stat *status)
+{
+  int rc;
+
+  if (db->file_data_version == NULL
+      && sqlite3_prepare_v3 (db->file, "PRAGMA data_version;", -1,
+                             SQLITE_PREPARE_PERSISTENT, &db->file_data_version, NULL) != SQLITE_OK)
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR: Failed preparing statement: %s\n", sqlite3_errmsg (db->file));
+      return EXIT_FAILURE;
+    }
+
+  rc = sqlite3_step (db->file_data_version);
+  if (rc == SQLITE_ROW)
+    *data_version = sqlite3_column_int (db->file_data_version, 0);
+  sqlite3_reset (db->file_data_version);
+
+  if (rc != SQLITE_ROW)
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR: Failed to get the data version: %s\n", sqlite3_errmsg (db->file));
+      return EXIT_FAILURE;
+    }
+
+  if (stat (DB_PATH, status) == -1)
+    {
+      DEBUG_PRINT_CONTEX;
+      perror ("ERROR: Couldn't get the database file status");
+      return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
+
+// Copy the file to the image, replacing the previous one
+static int
+load_image (GawakeDb *db)
+{
+  unsigned char *image;
+  sqlite3_int64 size;
+  int rc;
+
+  // Before the copy: a commit in between only makes the image be loaded again
+  if (get_file_state (db, &db->image_data_version, &db->image_status))
+    return EXIT_FAILURE;
+
+  // A single statement: a consistent copy, including the pages on the WAL
+  image = sqlite3_serialize (db->file, "main", &size, 0);
+  if (image == NULL || size < 100)
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR: Failed to copy the database to memory: %s\n",
+               sqlite3_errmsg (db->file));
+      sqlite3_free (image);
+      return EXIT_FAILURE;
+    }
+
+  // The file format bytes 18 and 19 tell the database is on WAL; the image
+  // has no WAL, it's read as a plain database
+  image[18] = image[19] = 1;
+
+  // The statements of the previous image can't be used anymore
+  utils_finalize_statements (db);
+
+  // The image is freed by SQLite, even on failure
+  rc = sqlite3_deserialize (db->connection, "main", image, size, size,
+                            SQLITE_DESERIALIZE_FREEONCLOSE | SQLITE_DESERIALIZE_READONLY);
   if (rc != SQLITE_OK)
     {
       DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "Can't open database: %s\n", sqlite3_errmsg (utils_get_pdb ()));
-      sqlite3_close (utils_get_pdb ());
-      return rc;
+      fprintf (stderr, "ERROR: Failed to load the database image: %s\n", sqlite3_errstr (rc));
+      return EXIT_FAILURE;
+    }
+
+  // The data_version of the image doesn't change when it's replaced
+  db->config_valid = false;
+
+  DEBUG_PRINT (("Database image loaded, %lld bytes", (long long) size));
+
+  return EXIT_SUCCESS;
+}
+
+/*
+ * Open the database for reading, with the queries running on a private copy
+ * of it in memory (sqlite3_deserialize): they don't take the file locks nor
+ * read the disk. gawake_db_refresh_image () must be called to see the
+ * changes of the file. Returns NULL on failure
+ */
+GawakeDb *
+gawake_db_open_image (void)
+{
+  GawakeDb *db = gawake_db_open (true);
+
+  if (db == NULL)
+    return NULL;
+
+  db->file = db->connection;
+  db->connection = open_connection (":memory:", SQLITE_OPEN_READWRITE);
+
+  if (db->connection == NULL || load_image (db))
+    {
+      gawake_db_close (db);
+      return NULL;
     }
-  else
+
+  return db;
+}
+
+/*
+ * Load the image again if the file changed: cheap otherwise (a data_version
+ * and a stat). reloaded (optional) tells if it was loaded again; the
+ * statements prepared on the image by the caller must then be prepared
+ * again. Does nothing if db isn't on image mode
+ */
+int
+gawake_db_refresh_image (GawakeDb *db, bool *reloaded)
+{
+  struct stat status;
+  sqlite3 *file;
+  int data_version;
+
+  if (reloaded != NULL)
+    *reloaded = false;
+
+  if (db->file == NULL)
+    return EXIT_SUCCESS;
+
+  if (get_file_state (db, &data_version, &status))
+    return EXIT_FAILURE;
+
+  if (data_version == db->image_data_version
+      && status.st_dev == db->image_status.st_dev
+      && status.st_ino == db->image_status.st_ino
+      && status.st_size == db->image_status.st_size
+      && status.st_mtim.tv_sec == db->image_status.st_mtim.tv_sec
+      && status.st_mtim.tv_nsec == db->image_status.st_mtim.tv_nsec)
+    return EXIT_SUCCESS;
+
+  // Replaced file: the connection still reads the previous one
+  if (status.st_dev != db->image_status.st_dev || status.st_ino != db->image_status.st_ino)
     {
-      // Enable security options
-      sqlite3_db_config (utils_get_pdb (), SQLITE_DBCONFIG_DEFENSIVE, 0, 0);
-      sqlite3_db_config (utils_get_pdb (), SQLITE_DBCONFIG_ENABLE_TRIGGER, 0, 0);
-      sqlite3_db_config (utils_get_pdb (), SQLITE_DBCONFIG_ENABLE_VIEW, 0, 0);
-      sqlite3_db_config (utils_get_pdb (), SQLITE_DBCONFIG_TRUSTED_SCHEMA, 0, 0);
+      file = open_connection (DB_PATH, SQLITE_OPEN_READONLY);
+      if (file == NULL || migration_run (file, true))
+        {
+          sqlite3_close (file);
+          return EXIT_FAILURE;
+        }
+
+      sqlite3_finalize (db->file_data_version);
+      db->file_data_version = NULL;
+      sqlite3_close (db->file);
+      db->file = file;
     }
 
-  return rc;
+  if (load_image (db))
+    return EXIT_FAILURE;
+
+  if (reloaded != NULL)
+    *reloaded = true;
+
+  return EXIT_SUCCESS;
 }
 
+void
+gawake_db_close (GawakeDb *db)
+{
+  if (db == NULL)
+    return;
+
+  // Pending statements would keep the connection open
+  utils_finalize_statements (db);
+
+  sqlite3_close (db->connection);
+
+  sqlite3_finalize (db->file_data_version);
+  sqlite3_close (db->file);
+
+  free (db->pending_changes);
+  free (db);
+}
+
+// For queries that aren't part of the library (e.g. the checks of the
+// scheduler); the connection still belongs to the GawakeDb
+sqlite3 *
+gawake_db_get_connection (GawakeDb *db)
+{
+  return db->connection;
+}
+
+// The callback receives the changes made by the rules and configuration
+// managers through this GawakeDb, after they are written
+void
+gawake_db_set_change_callback (GawakeDb *db, DatabaseChangeCallback callback)
+{
+  db->change_callback = callback;
+}
+
+/*
+ * Group the following operations in a single transaction, committed by
+ * gawake_db_transaction_end () if ret is EXIT_SUCCESS, or undone otherwise;
+ * on a read only connection, it gives a consistent view of the database.
+ * The changes are notified only after the commit, all at once; the ones
+ * rolled back aren't notified
+ */
 int
-disconnect_database (void)
+gawake_db_transaction_begin (GawakeDb *db)
 {
-  sqlite3 **db = utils_get_ppdb ();
-  int rc = sqlite3_close (utils_get_pdb ());
-  *db = NULL;
-  return rc;
+  if (db->transaction_depth >= MAX_TRANSACTION_DEPTH)
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR: Too many nested transactions\n");
+      return EXIT_FAILURE;
+    }
+
+  if (utils_batch_begin (db))
+    return EXIT_FAILURE;
+
+  db->transaction_marks[db->transaction_depth++] = db->pending_length;
+  return EXIT_SUCCESS;
+}
+
+int
+gawake_db_transaction_end (GawakeDb *db, int ret)
+{
+  ret = utils_batch_end (db, ret);
+
+  if (db->transaction_depth == 0)
+    return ret;
+
+  // Rolled back: so are the changes made since it began
+  db->transaction_depth--;
+  if (ret != EXIT_SUCCESS)
+    db->pending_length = db->transaction_marks[db->transaction_depth];
+
+  if (db->transaction_depth == 0)
+    utils_end_pending_changes (db, ret == EXIT_SUCCESS);
+
+  return ret;
 }
@@ -27,10 +27,22 @@
 
 #include "gawake-types.h"
 
-int connect_database (bool read_only);
-int disconnect_database (void);
+/*
+ * Each GawakeDb owns its connection and statements, so the programs (and
+ * their threads) don't share any state: a GawakeDb must be used by a single
+ * thread at a time, open one for each thread
+ */
+GawakeDb *gawake_db_open (bool read_only);
+GawakeDb *gawake_db_open_image (void);
+int gawake_db_refresh_image (GawakeDb *db, bool *reloaded);
+void gawake_db_close (GawakeDb *db);
+sqlite3 *gawake_db_get_connection (GawakeDb *db);
+void gawake_db_set_change_callback (GawakeDb *db, DatabaseChangeCallback callback);
+int gawake_db_transaction_begin (GawakeDb *db);
+int gawake_db_transaction_end (GawakeDb *db, int ret);
 
 # include "rules-reader.h"
+# include "rule-set.h"
 
 #ifdef ALLOW_MANAGING_RULES
 # include "rules-manager.h"
@@ -43,4 +55,6 @@ int disconnect_database (void);
 # include "configuration-manager.h"
 #endif
 
+# include "database-backup.h"
+
 #endif /* DATABASE_CONNECTION_H_ */
@@ -0,0 +1,269 @@
+/* database-migration.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * The schema version is kept on PRAGMA user_version. Databases created by
+ * Gawake 3.1.0 (version 0) store the rule time as TEXT 'HH:MM:SS' and a
+ * column for each week day; version 4 stores the minute of the day and a
+ * bitmask of the days (see database.sql), with indexes covering the queries
+ * of the active rules; version 5 adds the queue of one-shot wake ups;
+ * version 6 adds the exception dates (e.g. holidays); version 7 indexes them
+ * by rule, as they are deleted with their rule, and deletes the ones left by
+ * the rules already deleted.
+ *
+ * The migration runs in a single transaction, so the database is either
+ * fully migrated or left untouched; the rule ids (and the AUTOINCREMENT
+ * sequences) are kept.
+ *
+ * Writable connections also switch the database to WAL journaling (it's
+ * persistent): the readers don't block the writers, nor the opposite.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "database-migration.h"
+#include "gawake-types.h"
+#include "../utils/debugger.h"
+
+// 'HH:MM:SS' to minute of the day
+#define MINUTE_OF_DAY \
+  "CAST (substr (rule_time, 1, 2) AS INTEGER) * 60 + CAST (substr (rule_time, 4, 2) AS INTEGER)"
+
+#define DAYS_MASK \
+  "(sun != 0) + (mon != 0) * 2 + (tue != 0) * 4 + (wed != 0) * 8 "\
+  "+ (thu != 0) * 16 + (fri != 0) * 32 + (sat != 0) * 64"
+
+// Rebuild the table with the new columns; the sequence of the ids is moved
+// to the new table before the old one is dropped
+#define MIGRATE_TABLE(table, columns, extra_columns) \
+  "CREATE TABLE " table "_v4 ("\
+  "id INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT, "\
+  "rule_name TEXT NOT NULL, "\
+  "minute INTEGER NOT NULL, "\
+  "days_mask INTEGER NOT NULL, "\
+  "active INTEGER NOT NULL" columns ");"\
+  "INSERT INTO " table "_v4 (id, rule_name, minute, days_mask, active" extra_columns ") "\
+  "SELECT id, rule_name, " MINUTE_OF_DAY ", " DAYS_MASK ", active" extra_columns " "\
+  "FROM " table ";"\
+  "DELETE FROM sqlite_sequence WHERE name = '" table "_v4';"\
+  "UPDATE sqlite_sequence SET name = '" table "_v4' WHERE name = '" table "';"\
+  "DROP TABLE " table ";"\
+  "ALTER TABLE " table "_v4 RENAME TO " table ";"
+
+static const char MIGRATION_V4[] =
+  MIGRATE_TABLE ("rules_turnon", "", "")
+  MIGRATE_TABLE ("rules_turnoff", ", mode INTEGER NOT NULL", ", mode")
+  "CREATE INDEX rules_turnon_schedule ON rules_turnon (active, days_mask, minute);"
+  "CREATE INDEX rules_turnoff_schedule ON rules_turnoff (active, days_mask, minute, mode);"
+  "PRAGMA user_version = 4;";
+
+static const char MIGRATION_V5[] =
+  "CREATE TABLE one_shot_schedule ("\
+  "id INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT, "\
+  "name TEXT NOT NULL, "\
+  "wake_time INTEGER NOT NULL);"
+  "CREATE INDEX one_shot_schedule_time ON one_shot_schedule (wake_time);"
+  "PRAGMA user_version = 5;";
+
+static const char MIGRATION_V6[] =
+  "CREATE TABLE exception_dates ("\
+  "id INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT, "\
+  "date TEXT NOT NULL CHECK (date IS date (date, '+0 days')), "\
+  "rule_table INTEGER NOT NULL DEFAULT 0, "\
+  "rule_id INTEGER NOT NULL DEFAULT 0, "\
+  "UNIQUE (date, rule_table, rule_id));"
+  "PRAGMA user_version = 6;";
+
+// Exception dates of the rules of table that no longer exist
+#define DELETE_ORPHAN_EXCEPTIONS(table, rule_table) \
+  "DELETE FROM exception_dates WHERE rule_table = " rule_table " AND rule_id != 0 "\
+  "AND rule_id NOT IN (SELECT id FROM " table ");"
+
+static const char MIGRATION_V7[] =
+  "CREATE INDEX exception_dates_rule ON exception_dates (rule_table, rule_id);"
+  DELETE_ORPHAN_EXCEPTIONS ("rules_turnon", "0")
+  DELETE_ORPHAN_EXCEPTIONS ("rules_turnoff", "1")
+  "PRAGMA user_version = 7;";
+
+static int
+get_schema_version (sqlite3 *connection, int *version)
+{
+  sqlite3_stmt *stmt;
+  int rc;
+
+  if (sqlite3_prepare_v2 (connection, "PRAGMA user_version;", -1, &stmt, NULL) != SQLITE_OK)
+    return EXIT_FAILURE;
+
+  rc = sqlite3_step (stmt);
+  if (rc == SQLITE_ROW)
+    *version = sqlite3_column_int (stmt, 0);
+  sqlite3_finalize (stmt);
+
+  return (rc == SQLITE_ROW) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*
+ * Switch to WAL, if it isn't yet; it needs a moment with no other connection
+ * using the database, so a failure isn't fatal: the next writable connection
+ * tries again
+ */
+static void
+enable_wal (sqlite3 *connection)
+{
+  sqlite3_stmt *stmt;
+  const unsigned char *mode;
+  const char *file = sqlite3_db_filename (connection, "main");
+
+  // Temporary databases (e.g. a backup being restored) can't use WAL
+  if (file == NULL || file[0] == '\0')
+    return;
+
+  if (sqlite3_prepare_v2 (connection, "PRAGMA journal_mode = WAL;", -1, &stmt, NULL) != SQLITE_OK)
+    return;
+
+  if (sqlite3_step (stmt) == SQLITE_ROW)
+    {
+      mode = sqlite3_column_text (stmt, 0);
+      if (mode == NULL || sqlite3_stricmp ((const char *) mode, "wal") != 0)
+        fprintf (stderr, "Warning: Couldn't enable WAL journaling (mode: %s)\n",
+                 (mode != NULL) ? (const char *) mode : "unknown");
+    }
+  else
+    {
+      fprintf (stderr, "Warning: Couldn't enable WAL journaling: %s\n",
+               sqlite3_errmsg (connection));
+    }
+
+  sqlite3_finalize (stmt);
+}
+
+// Migrate a writable connection to the current version
+static int
+migrate (sqlite3 *connection)
+{
+  int version;
+  char *err_msg = NULL;
+
+#if PREPROCESSOR_DEBUG
+  struct timespec start, end;
+  clock_gettime (CLOCK_MONOTONIC, &start);
+#endif
+
+  sqlite3_busy_timeout (connection, BUSY_TIMEOUT);
+
+  // Take the write lock before checking the version again: another program
+  // may have migrated the database in the meantime
+  if (sqlite3_exec (connection, "BEGIN IMMEDIATE;", NULL, NULL, &err_msg) != SQLITE_OK)
+    goto failed;
+
+  if (get_schema_version (connection, &version))
+    goto failed;
+
+  if (version < 4
+      && sqlite3_exec (connection, MIGRATION_V4, NULL, NULL, &err_msg) != SQLITE_OK)
+    goto failed;
+
+  if (version < 5
+      && sqlite3_exec (connection, MIGRATION_V5, NULL, NULL, &err_msg) != SQLITE_OK)
+    goto failed;
+
+  if (version < 6
+      && sqlite3_exec (connection, MIGRATION_V6, NULL, NULL, &err_msg) != SQLITE_OK)
+    goto failed;
+
+  if (version < 7
+      && sqlite3_exec (connection, MIGRATION_V7, NULL, NULL, &err_msg) != SQLITE_OK)
+    goto failed;
+
+  if (sqlite3_exec (connection, "COMMIT;", NULL, NULL, &err_msg) != SQLITE_OK)
+    goto failed;
+
+  enable_wal (connection);
+
+#if PREPROCESSOR_DEBUG
+  clock_gettime (CLOCK_MONOTONIC, &end);
+  DEBUG_PRINT (("Database migrated from schema version %d to %d in %.3f ms",
+                version, DB_SCHEMA_VERSION,
+                (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6));
+#endif
+
+  return EXIT_SUCCESS;
+
+failed:
+  DEBUG_PRINT_CONTEX;
+  fprintf (stderr, "ERROR: Failed to migrate the database: %s\n",
+           (err_msg != NULL) ? err_msg : sqlite3_errmsg (connection));
+  sqlite3_free (err_msg);
+  sqlite3_exec (connection, "ROLLBACK;", NULL, NULL, NULL);
+  return EXIT_FAILURE;
+}
+
+/*
+ * Bring the database to DB_SCHEMA_VERSION, if it's older. A read-only
+ * connection can't do it, so another one, writable, is opened just for the
+ * migration; the read-only connection sees the new schema on its next query.
+ */
+int
+migration_run (sqlite3 *connection, bool read_only)
+{
+  int version, ret;
+  sqlite3 *writable = NULL;
+
+  if (get_schema_version (connection, &version))
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR: Couldn't get the database schema version: %s\n",
+               sqlite3_errmsg (connection));
+      return EXIT_FAILURE;
+    }
+
+  if (version == DB_SCHEMA_VERSION)
+    {
+      if (!read_only)
+        enable_wal (connection);
+      return EXIT_SUCCESS;
+    }
+
+  if (version > DB_SCHEMA_VERSION)
+    {
+      fprintf (stderr, "ERROR: The database schema (version %d) is newer than "\
+               "this version of Gawake supports (%d)\n", version, DB_SCHEMA_VERSION);
+      return EXIT_FAILURE;
+    }
+
+  if (!read_only)
+    return migrate (connection);
+
+  if (sqlite3_open_v2 (DB_PATH, &writable, SQLITE_OPEN_READWRITE, NULL) != SQLITE_OK)
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR: The database must be migrated, but it can't be "\
+               "opened for writing: %s\n", sqlite3_errmsg (writable));
+      sqlite3_close (writable);
+      return EXIT_FAILURE;
+    }
+
+  ret = migrate (writable);
+  sqlite3_close (writable);
+
+  return ret;
+}
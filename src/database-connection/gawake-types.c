@@ -33,3 +33,22 @@ const char *MODE[] = {
 };
 
 const char *DAYS[] = {"sun", "mon", "tue", "wed", "thu", "fri", "sat"};
+
+uint8_t
+days_to_mask (const bool days[7])
+{
+  uint8_t mask = 0;
+
+  for (int i = 0; i < 7; i++)
+    if (days[i])
+      mask |= (uint8_t) (1 << i);
+
+  return mask;
+}
+
+void
+days_from_mask (uint8_t mask, bool days[7])
+{
+  for (int i = 0; i < 7; i++)
+    days[i] = (mask >> i) & 1;
+}
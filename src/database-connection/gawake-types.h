@@ -7,11 +7,15 @@
 #define VERSION "3.1.0"
 
 #define DB_NAME "gawake.db"
+#ifndef DB_DIR                      // the tests set their own
 #define DB_DIR "/var/lib/gawake/"
+#endif
 #define DB_PATH DB_DIR DB_NAME
+#define DB_SCHEMA_VERSION 7         // PRAGMA user_version of the database
 
 #include <inttypes.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 // ATTENTION: enum and char[] must be synced
 typedef enum
@@ -51,10 +55,14 @@ typedef enum
   NOTIFICATION_TIME_LAST
 } NotificationTime;
 
+// days_mask column: bit 0 is Sunday, ..., bit 6 is Saturday
+uint8_t days_to_mask (const bool days[7]);
+void days_from_mask (uint8_t mask, bool days[7]);
+
 // Same order as database
 typedef struct
 {
-  uint16_t id;                    // q
+  int64_t id;                     // x: rowid, never reused
   char name[RULE_NAME_LENGTH];    // s
   uint8_t hour;                   // y
   uint8_t minutes;                // y
@@ -64,6 +72,31 @@ typedef struct
   Table table;                    // y
 } Rule;
 
+// A one-shot wake up (e.g. a maintenance window), queued ahead; it's used
+// once, when the system is turned off before it
+typedef struct
+{
+  int64_t id;                     // x: rowid, never reused
+  char name[RULE_NAME_LENGTH];    // s
+  int64_t time;                   // x: seconds since the epoch
+} OneShot;
+
+// GVariant type of the one-shot schedules: array of (id, name, time)
+#define ONE_SHOTS_TYPE "a(xsx)"
+
+// 'YYYY-MM-DD' and the null terminator
+#define EXCEPTION_DATE_LENGTH 11
+
+// A date the rules don't run on (e.g. a holiday): all of them, or a single
+// one
+typedef struct
+{
+  int64_t id;                     // rowid, never reused
+  char date[EXCEPTION_DATE_LENGTH];
+  Table table;                    // table of the rule; TABLE_ON if rule_id is 0
+  int64_t rule_id;                // 0: all the rules
+} ExceptionDate;
+
 typedef struct
 {
   bool found;
@@ -79,4 +112,54 @@ typedef struct
 
 #define RtcwakeArgs_s sizeof (RtcwakeArgs)
 
+// ATTENTION: sent through D-Bus (y); don't change the values
+typedef enum
+{
+  CHANGE_ADD,
+  CHANGE_EDIT,
+  CHANGE_DELETE,    // only the rule id and table are set
+  CHANGE_OTHER,     // not related to a single rule (e.g. configuration)
+  CHANGE_LAST
+} ChangeOperation;
+
+// A change made on the database, carried by the DatabaseUpdated signal
+typedef struct
+{
+  ChangeOperation operation;
+  Rule rule;        // new values of the rule
+} DatabaseChange;
+
+// GVariant type of the changes: array of (operation, rule)
+#define DATABASE_CHANGES_TYPE "a(y(xsyyabbyy))"
+
+typedef void (*DatabaseChangeCallback) (const DatabaseChange *changes, size_t length);
+
+// Connection to the database, with its own prepared statements (opaque; see
+// database-connection.h)
+typedef struct GawakeDb GawakeDb;
+
+// ATTENTION: sent through D-Bus (y); don't change the values
+typedef enum
+{
+  EVENT_TURN_ON,
+  EVENT_TURN_OFF,
+  EVENT_CUSTOM_SCHEDULE,
+  EVENT_ONE_SHOT,
+  EVENT_LAST
+} EventKind;
+
+// An upcoming event of the plan, returned by GetUpcomingEvents
+typedef struct
+{
+  int64_t time;     // seconds since the epoch
+  EventKind kind;
+  int64_t id;       // rule or one-shot id; 0 for the custom schedule
+  Mode mode;        // only for turn off events and the custom schedule
+} UpcomingEvent;
+
+// GVariant type of the upcoming events: array of (time, kind, id, mode)
+#define UPCOMING_EVENTS_TYPE "a(xyxy)"
+// Maximum number of events returned at once
+#define MAX_UPCOMING_EVENTS 100000
+
 #endif /* GAWAKE_TYPES_H_ */
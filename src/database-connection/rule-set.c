@@ -0,0 +1,335 @@
+/* rule-set.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * A Rule has room for the longest name and 7 bools for the days, and most of
+ * it is padding: going through many of them reads mostly bytes that aren't
+ * needed. A RuleSet keeps each field in an array of its own, with the
+ * smallest type that holds it (about 12 bytes per rule, against 64), so a pass
+ * over the times or the active flags only reads those. The names are loaded
+ * when they're needed, into a single buffer.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sqlite3.h>
+
+#include "rule-set.h"
+#include "database-connection-utils.h"
+#include "../utils/debugger.h"
+
+#define INITIAL_ALLOC 16
+#define ACTIVE_WORDS(length) (((length) + 63) / 64)
+
+void
+rule_set_init (RuleSet *set)
+{
+  memset (set, 0, sizeof (*set));
+}
+
+// Resize an array of the set; it's kept as it was on failure
+static int
+grow (void *array, size_t count, size_t size)
+{
+  void *p = realloc (*(void **) array, count * size);
+
+  if (p == NULL)
+    return EXIT_FAILURE;
+
+  *(void **) array = p;
+
+  return EXIT_SUCCESS;
+}
+
+// Make room for "needed" rules; the arrays keep their contents
+static int
+reserve (RuleSet *set, size_t needed)
+{
+  size_t allocated = (set->allocated == 0) ? INITIAL_ALLOC : set->allocated;
+
+  if (needed <= set->allocated)
+    return EXIT_SUCCESS;
+
+  while (allocated < needed)
+    allocated *= 2;
+
+  // A failure leaves the set as it was, with some arrays already bigger
+  if (grow (&set->ids, allocated, sizeof (*set->ids))
+      || grow (&set->minutes, allocated, sizeof (*set->minutes))
+      || grow (&set->days_masks, allocated, sizeof (*set->days_masks))
+      || grow (&set->modes, allocated, sizeof (*set->modes))
+      || grow (&set->active, ACTIVE_WORDS (allocated), sizeof (*set->active)))
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR: Failed to allocate memory\n");
+      return EXIT_FAILURE;
+    }
+
+  // Cleared before being set, bit by bit
+  memset (set->active + ACTIVE_WORDS (set->allocated), 0,
+          (ACTIVE_WORDS (allocated) - ACTIVE_WORDS (set->allocated)) * sizeof (*set->active));
+  set->allocated = allocated;
+
+  return EXIT_SUCCESS;
+}
+
+/*
+ * Load all the rules of the table, replacing the previous ones; the
+ * allocated memory is reused. The names aren't loaded.
+ */
+int
+rule_set_load (GawakeDb *db, const Table table, RuleSet *set)
+{
+  sqlite3_stmt *stmt;
+  int rc;
+  size_t i;
+
+  if (utils_validate_table (table))
+    return EXIT_FAILURE;
+
+  set->table = table;
+  set->length = 0;
+  set->names_length = 0;
+  set->names_loaded = false;
+  if (set->active != NULL)
+    memset (set->active, 0, ACTIVE_WORDS (set->allocated) * sizeof (*set->active));
+
+  stmt = utils_get_statement (db, TABLE_STATEMENT (STATEMENT_GET_FIELDS_ON, table));
+  if (stmt == NULL)
+    return EXIT_FAILURE;
+
+  while ((rc = sqlite3_step (stmt)) == SQLITE_ROW)
+    {
+      if (reserve (set, set->length + 1))
+        {
+          sqlite3_reset (stmt);
+          return EXIT_FAILURE;
+        }
+
+      i = set->length++;
+      set->ids[i] = sqlite3_column_int64 (stmt, 0);
+      set->minutes[i] = (uint16_t) sqlite3_column_int (stmt, 1);
+      set->days_masks[i] = (uint8_t) sqlite3_column_int (stmt, 2);
+      if (sqlite3_column_int (stmt, 3))
+        set->active[i / 64] |= UINT64_C (1) << (i % 64);
+      set->modes[i] = (uint8_t) sqlite3_column_int (stmt, 4);
+    }
+
+  // Release the read lock; the statement is kept for the next call
+  sqlite3_reset (stmt);
+
+  if (rc != SQLITE_DONE)
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR (failed to query rules): %s\n", sqlite3_errmsg (db->connection));
+      set->length = 0;
+      return EXIT_FAILURE;
+    }
+
+  DEBUG_PRINT (("Loaded %zu rules from %s", set->length, TABLE[set->table]));
+
+  return EXIT_SUCCESS;
+}
+
+// Append a name to the arena; returns its offset, or RULE_SET_NO_NAME on failure
+static uint32_t
+add_name (RuleSet *set, const char *name, size_t length)
+{
+  size_t allocated = (set->names_allocated == 0) ? INITIAL_ALLOC * RULE_NAME_LENGTH : set->names_allocated;
+  size_t offset = set->names_length;
+  char *names;
+
+  if (length >= RULE_NAME_LENGTH)
+    length = RULE_NAME_LENGTH - 1;
+
+  if (offset + length + 1 >= RULE_SET_NO_NAME)
+    return RULE_SET_NO_NAME;
+
+  if (offset + length + 1 > set->names_allocated)
+    {
+      while (allocated < offset + length + 1)
+        allocated *= 2;
+
+      names = realloc (set->names, allocated);
+      if (names == NULL)
+        return RULE_SET_NO_NAME;
+
+      set->names = names;
+      set->names_allocated = allocated;
+    }
+
+  memcpy (set->names + offset, name, length);
+  set->names[offset + length] = '\0';
+  set->names_length += length + 1;
+
+  return (uint32_t) offset;
+}
+
+/*
+ * Load the names of the rules of the set. Both queries are in id order, so
+ * the names are matched in a single pass; a rule deleted since
+ * rule_set_load () gets no name, one added since is ignored.
+ */
+int
+rule_set_load_names (GawakeDb *db, RuleSet *set)
+{
+  sqlite3_stmt *stmt;
+  uint32_t *offsets;
+  size_t i = 0;
+  int rc;
+
+  if (set->names_loaded)
+    return EXIT_SUCCESS;
+
+  offsets = realloc (set->name_offsets, (set->allocated ? set->allocated : 1) * sizeof (*offsets));
+  if (offsets == NULL)
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR: Failed to allocate memory\n");
+      return EXIT_FAILURE;
+    }
+  set->name_offsets = offsets;
+  set->names_length = 0;
+
+  stmt = utils_get_statement (db, TABLE_STATEMENT (STATEMENT_GET_NAMES_ON, set->table));
+  if (stmt == NULL)
+    return EXIT_FAILURE;
+
+  while (i < set->length && (rc = sqlite3_step (stmt)) == SQLITE_ROW)
+    {
+      int64_t id = sqlite3_column_int64 (stmt, 0);
+
+      while (i < set->length && set->ids[i] < id)
+        offsets[i++] = RULE_SET_NO_NAME;
+
+      if (i == set->length || set->ids[i] != id)
+        continue;
+
+      offsets[i] = add_name (set, (const char *) sqlite3_column_text (stmt, 1),
+                             (size_t) sqlite3_column_bytes (stmt, 1));
+      if (offsets[i++] == RULE_SET_NO_NAME)
+        {
+          DEBUG_PRINT_CONTEX;
+          fprintf (stderr, "ERROR: Failed to allocate memory\n");
+          sqlite3_reset (stmt);
+          return EXIT_FAILURE;
+        }
+    }
+
+  // Stopped after the last rule of the set
+  if (i == set->length)
+    rc = SQLITE_DONE;
+
+  sqlite3_reset (stmt);
+
+  if (rc != SQLITE_DONE)
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR (failed to query rules names): %s\n", sqlite3_errmsg (db->connection));
+      return EXIT_FAILURE;
+    }
+
+  for (; i < set->length; i++)
+    offsets[i] = RULE_SET_NO_NAME;
+
+  set->names_loaded = true;
+
+  return EXIT_SUCCESS;
+}
+
+bool
+rule_set_is_active (const RuleSet *set, size_t i)
+{
+  return (set->active[i / 64] >> (i % 64)) & 1;
+}
+
+/*
+ * Get the index of the first active rule from "i" on; returns the length of
+ * the set if there's none. Goes through the flags a word (64 rules) at a
+ * time:
+ *
+ *  for (i = rule_set_next_active (set, 0); i < set->length;
+ *       i = rule_set_next_active (set, i + 1))
+ */
+size_t
+rule_set_next_active (const RuleSet *set, size_t i)
+{
+  size_t word = i / 64;
+  uint64_t bits;
+
+  if (i >= set->length)
+    return set->length;
+
+  // Ignore the rules before "i" on its word
+  bits = set->active[word] & (~UINT64_C (0) << (i % 64));
+  while (bits == 0)
+    {
+      if (++word >= ACTIVE_WORDS (set->length))
+        return set->length;
+      bits = set->active[word];
+    }
+
+  // The bits after the last rule are always clear
+  return word * 64 + (size_t) __builtin_ctzll (bits);
+}
+
+// Get the name of a rule; NULL if the names weren't loaded, or it has none
+const char *
+rule_set_get_name (const RuleSet *set, size_t i)
+{
+  if (!set->names_loaded || set->name_offsets[i] == RULE_SET_NO_NAME)
+    return NULL;
+
+  return set->names + set->name_offsets[i];
+}
+
+// Get the index of the rule with the id; returns the length of the set if
+// there's none
+size_t
+rule_set_find (const RuleSet *set, int64_t id)
+{
+  size_t low = 0, high = set->length;
+
+  while (low < high)
+    {
+      size_t middle = low + (high - low) / 2;
+
+      if (set->ids[middle] < id)
+        low = middle + 1;
+      else
+        high = middle;
+    }
+
+  return (low < set->length && set->ids[low] == id) ? low : set->length;
+}
+
+void
+rule_set_free (RuleSet *set)
+{
+  free (set->ids);
+  free (set->minutes);
+  free (set->days_masks);
+  free (set->modes);
+  free (set->active);
+  free (set->names);
+  free (set->name_offsets);
+  rule_set_init (set);
+}
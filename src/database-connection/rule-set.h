@@ -0,0 +1,65 @@
+/* rule-set.h
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef RULE_SET_H_
+#define RULE_SET_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "gawake-types.h"
+
+#define RULE_SET_NO_NAME UINT32_MAX
+
+/*
+ * Rules of a table, a field per array (rule i is at index i of each one),
+ * sorted by id; the names are only loaded by rule_set_load_names ()
+ */
+typedef struct
+{
+  Table table;
+  size_t length;
+  size_t allocated;
+
+  int64_t *ids;
+  uint16_t *minutes;      // minute of the day
+  uint8_t *days_masks;    // see days_to_mask ()
+  uint8_t *modes;         // Mode; MODE_MEM for turn on rules
+  uint64_t *active;       // bit (i % 64) of word (i / 64)
+
+  // Names arena: the names, each one null terminated, one after the other
+  char *names;
+  size_t names_length;
+  size_t names_allocated;
+  uint32_t *name_offsets; // RULE_SET_NO_NAME: not loaded
+  bool names_loaded;
+} RuleSet;
+
+void rule_set_init (RuleSet *set);
+int rule_set_load (GawakeDb *db, const Table table, RuleSet *set);
+int rule_set_load_names (GawakeDb *db, RuleSet *set);
+bool rule_set_is_active (const RuleSet *set, size_t i);
+size_t rule_set_next_active (const RuleSet *set, size_t i);
+const char *rule_set_get_name (const RuleSet *set, size_t i);
+size_t rule_set_find (const RuleSet *set, int64_t id);
+void rule_set_free (RuleSet *set);
+
+#endif /* RULE_SET_H_ */
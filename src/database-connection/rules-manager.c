@@ -18,137 +18,359 @@
  * SPDX-License-Identifier: GPL-3.0-or-later
  */
 
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include <sqlite3.h>
 
 #include "database-connection-utils.h"
 #include "rules-manager.h"
+#include "rules-reader.h"
+
+// Bind the values of the rule to the add and edit statements:
+// ?1 name, ?2 minute of the day, ?3 days mask, ?4 active, ?5 mode, ?6 id
+static void
+bind_rule (sqlite3_stmt *stmt, const Rule *rule)
+{
+  sqlite3_bind_text (stmt, 1, rule->name, -1, SQLITE_STATIC);
+  sqlite3_bind_int (stmt, 2, rule->hour * 60 + rule->minutes);
+  sqlite3_bind_int (stmt, 3, days_to_mask (rule->days));
+  sqlite3_bind_int (stmt, 4, rule->active);
+
+  // Turn on rules have no mode
+  if (rule->table == TABLE_OFF)
+    sqlite3_bind_int (stmt, 5, rule->mode);
+
+  // Only used when editing
+  if (sqlite3_bind_parameter_count (stmt) >= 6)
+    sqlite3_bind_int64 (stmt, 6, rule->id);
+}
+
+/*
+ * The operations on many rules run in a single transaction, reusing the
+ * prepared statement: either all the rules are changed, or none. The changes
+ * are reported at once, when the transaction is committed. The single rule
+ * operations are batches of one
+ */
 
 int
-rule_add (const Rule *rule)
+rule_add (GawakeDb *db, const Rule *rule)
 {
-  if (utils_validate_rule (rule))
-    return EXIT_FAILURE;
+  return rule_add_many (db, rule, 1);
+}
+
+int
+rule_add_many (GawakeDb *db, const Rule *rules, size_t length)
+{
+  DatabaseChange *changes;
+  sqlite3_stmt *stmt;
+  int ret = EXIT_SUCCESS;
 
-  switch (rule->table)
-    {
-    case TABLE_ON:
-      sqlite3_snprintf (SQL_SIZE, utils_get_sql (),
-                        "INSERT INTO rules_turnon "\
-                        "(rule_name, rule_time, sun, mon, tue, wed, thu, fri, sat, active) "\
-                        "VALUES ('%s', '%02d:%02u:00', %d, %d, %d, %d, %d, %d, %d, %d);",
-                        rule->name,
-                        rule->hour,
-                        rule->minutes,
-                        rule->days[0], rule->days[1], rule->days[2], rule->days[3],
-                        rule->days[4], rule->days[5], rule->days[6],
-                        rule->active);
-      break;
-
-    case TABLE_OFF:
-      sqlite3_snprintf (SQL_SIZE, utils_get_sql (),
-                        "INSERT INTO rules_turnoff "\
-                        "(rule_name, rule_time, sun, mon, tue, wed, thu, fri, sat, active, mode) "\
-                        "VALUES ('%s', '%02d:%02u:00', %d, %d, %d, %d, %d, %d, %d, %d, %u);",
-                        rule->name,
-                        rule->hour,
-                        rule->minutes,
-                        rule->days[0], rule->days[1], rule->days[2], rule->days[3],
-                        rule->days[4], rule->days[5], rule->days[6],
-                        rule->active,
-                        rule->mode);
-      break;
-
-    case TABLE_LAST:
+  if (length == 0)
+    return EXIT_SUCCESS;
+
+  for (size_t i = 0; i < length; i++)
+    {
+      if (utils_validate_rule (&rules[i]))
+        return EXIT_FAILURE;
+    }
+
+  changes = malloc (length * sizeof (DatabaseChange));
+  if (changes == NULL || utils_batch_begin (db))
+    {
+      free (changes);
       return EXIT_FAILURE;
+    }
+
+  for (size_t i = 0; i < length && ret == EXIT_SUCCESS; i++)
+    {
+      stmt = utils_get_statement (db, TABLE_STATEMENT (STATEMENT_ADD_ON, rules[i].table));
+      if (stmt == NULL)
+        {
+          ret = EXIT_FAILURE;
+          break;
+        }
+
+      bind_rule (stmt, &rules[i]);
+      ret = utils_run_statement (db, stmt);
+
+      changes[i].operation = CHANGE_ADD;
+      changes[i].rule = rules[i];
+      changes[i].rule.id = sqlite3_last_insert_rowid (db->connection);
+    }
 
-    default:
+  ret = utils_batch_end (db, ret);
+  if (ret == EXIT_SUCCESS)
+    utils_notify_changes (db, changes, length);
+
+  free (changes);
+  return ret;
+}
+
+/*
+ * Fail if the last statement changed no row, i.e. the id doesn't exist: the
+ * batch is rolled back, so a change that didn't happen isn't notified
+ */
+static int
+check_changed (GawakeDb *db)
+{
+  if (sqlite3_changes (db->connection) == 0)
+    {
+      fprintf (stderr, "Invalid ID\n\n");
       return EXIT_FAILURE;
     }
 
-  return utils_run_sql ();
+  return EXIT_SUCCESS;
+}
+
+/*
+ * The exception dates of a single rule are deleted with it: the ids aren't
+ * reused, so they'd never apply again. STATEMENT_DELETE_TABLE_EXCEPTIONS
+ * deletes the ones of all the rules of table (rule_id isn't used)
+ */
+static int
+delete_exceptions (GawakeDb *db,
+                   const DatabaseStatement statement,
+                   const Table table,
+                   const int64_t rule_id)
+{
+  sqlite3_stmt *stmt = utils_get_statement (db, statement);
+
+  if (stmt == NULL)
+    return EXIT_FAILURE;
+
+  sqlite3_bind_int (stmt, 1, table);
+  if (statement == STATEMENT_DELETE_RULE_EXCEPTIONS)
+    sqlite3_bind_int64 (stmt, 2, rule_id);
+
+  return utils_run_statement (db, stmt);
 }
 
 int
-rule_delete (const uint16_t id,
+rule_delete (GawakeDb *db,
+             const int64_t id,
              const Table table)
 {
+  return rule_delete_many (db, &id, 1, table);
+}
+
+int
+rule_delete_many (GawakeDb *db,
+                  const int64_t *ids,
+                  size_t length,
+                  const Table table)
+{
+  DatabaseChange *changes;
+  sqlite3_stmt *stmt;
+  int ret = EXIT_SUCCESS;
+
+  if (length == 0)
+    return EXIT_SUCCESS;
+
   if (utils_validate_table (table))
     return EXIT_FAILURE;
 
-  sqlite3_snprintf (SQL_SIZE, utils_get_sql (), "DELETE FROM %s WHERE id = %d;", TABLE[table], id);
+  changes = malloc (length * sizeof (DatabaseChange));
+  if (changes == NULL || utils_batch_begin (db))
+    {
+      free (changes);
+      return EXIT_FAILURE;
+    }
+
+  for (size_t i = 0; i < length && ret == EXIT_SUCCESS; i++)
+    {
+      stmt = utils_get_statement (db, TABLE_STATEMENT (STATEMENT_DELETE_ON, table));
+      if (stmt == NULL)
+        {
+          ret = EXIT_FAILURE;
+          break;
+        }
+
+      sqlite3_bind_int64 (stmt, 1, ids[i]);
+      ret = utils_run_statement (db, stmt);
+      if (ret == EXIT_SUCCESS)
+        ret = check_changed (db);
+      if (ret == EXIT_SUCCESS)
+        ret = delete_exceptions (db, STATEMENT_DELETE_RULE_EXCEPTIONS, table, ids[i]);
+
+      changes[i] = (DatabaseChange) {
+        .operation = CHANGE_DELETE,
+        .rule = { .id = ids[i], .table = table },
+      };
+    }
+
+  ret = utils_batch_end (db, ret);
+  if (ret == EXIT_SUCCESS)
+    utils_notify_changes (db, changes, length);
 
-  return utils_run_sql ();
+  free (changes);
+  return ret;
 }
 
 int
-rule_enable_disable (const uint16_t id,
+rule_enable_disable (GawakeDb *db,
+                     const int64_t id,
                      const Table table,
                      const bool active)
 {
+  return rule_set_active_many (db, &id, 1, table, active);
+}
+
+int
+rule_set_active_many (GawakeDb *db,
+                      const int64_t *ids,
+                      size_t length,
+                      const Table table,
+                      const bool active)
+{
+  DatabaseChange *changes;
+  sqlite3_stmt *stmt;
+  bool read_all = true;
+  int ret = EXIT_SUCCESS;
+
+  if (length == 0)
+    return EXIT_SUCCESS;
+
   if (utils_validate_table (table))
     return EXIT_FAILURE;
 
-  sqlite3_snprintf (SQL_SIZE, utils_get_sql (), "UPDATE %s SET active = %d WHERE id = %d;", TABLE[table], active, id);
+  changes = malloc (length * sizeof (DatabaseChange));
+  if (changes == NULL || utils_batch_begin (db))
+    {
+      free (changes);
+      return EXIT_FAILURE;
+    }
+
+  for (size_t i = 0; i < length && ret == EXIT_SUCCESS; i++)
+    {
+      stmt = utils_get_statement (db, TABLE_STATEMENT (STATEMENT_ENABLE_ON, table));
+      if (stmt == NULL)
+        {
+          ret = EXIT_FAILURE;
+          break;
+        }
+
+      sqlite3_bind_int64 (stmt, 1, ids[i]);
+      sqlite3_bind_int (stmt, 2, active);
+      ret = utils_run_statement (db, stmt);
+      if (ret == EXIT_SUCCESS)
+        ret = check_changed (db);
+
+      // The change carries the whole rule, read in the same transaction
+      changes[i].operation = CHANGE_EDIT;
+      if (ret == EXIT_SUCCESS && read_all)
+        read_all = (rule_get_single (db, ids[i], table, &changes[i].rule) == EXIT_SUCCESS);
+    }
+
+  ret = utils_batch_end (db, ret);
+  if (ret == EXIT_SUCCESS)
+    {
+      // If some rule can't be read, the receiver must reload everything
+      if (read_all)
+        utils_notify_changes (db, changes, length);
+      else
+        utils_notify_change (db, CHANGE_OTHER, NULL);
+    }
 
-  return utils_run_sql ();
+  free (changes);
+  return ret;
 }
 
 int
-rule_edit (const Rule *rule)
+rule_edit (GawakeDb *db, const Rule *rule)
 {
-  if (utils_validate_rule (rule))
-    return EXIT_FAILURE;
+  return rule_edit_many (db, rule, 1);
+}
+
+int
+rule_edit_many (GawakeDb *db, const Rule *rules, size_t length)
+{
+  DatabaseChange *changes;
+  sqlite3_stmt *stmt;
+  int ret = EXIT_SUCCESS;
+
+  if (length == 0)
+    return EXIT_SUCCESS;
+
+  for (size_t i = 0; i < length; i++)
+    {
+      if (utils_validate_rule (&rules[i]))
+        return EXIT_FAILURE;
+    }
 
-  switch (rule->table)
-    {
-    case TABLE_ON:
-      sqlite3_snprintf (SQL_SIZE, utils_get_sql (),
-                        "UPDATE rules_turnon SET "\
-                        "rule_name = '%s', rule_time = '%02d:%02d:00', "\
-                        "sun = %d, mon = %d, tue = %d, wed = %d, thu = %d, fri = %d, sat = %d, "\
-                        "active = %d WHERE id = %d;",
-                        rule->name,
-                        rule->hour,
-                        rule->minutes,
-                        rule->days[0], rule->days[1], rule->days[2], rule->days[3],
-                        rule->days[4], rule->days[5], rule->days[6],
-                        rule->active,
-                        rule->id);
-      break;
-
-    case TABLE_OFF:
-      sqlite3_snprintf (SQL_SIZE, utils_get_sql (),
-                        "UPDATE rules_turnoff SET "\
-                        "rule_name = '%s', rule_time = '%02d:%02d:00', "\
-                        "sun = %d, mon = %d, tue = %d, wed = %d, thu = %d, fri = %d, sat = %d, "\
-                        "active = %d, mode = %d WHERE id = %d;",
-                        rule->name,
-                        rule->hour,
-                        rule->minutes,
-                        rule->days[0], rule->days[1], rule->days[2], rule->days[3],
-                        rule->days[4], rule->days[5], rule->days[6],
-                        rule->active,
-                        rule->mode,
-                        rule->id);
-      break;
-
-    case TABLE_LAST:
-    default:
+  changes = malloc (length * sizeof (DatabaseChange));
+  if (changes == NULL || utils_batch_begin (db))
+    {
+      free (changes);
       return EXIT_FAILURE;
     }
 
-  return utils_run_sql ();
+  for (size_t i = 0; i < length && ret == EXIT_SUCCESS; i++)
+    {
+      stmt = utils_get_statement (db, TABLE_STATEMENT (STATEMENT_EDIT_ON, rules[i].table));
+      if (stmt == NULL)
+        {
+          ret = EXIT_FAILURE;
+          break;
+        }
+
+      bind_rule (stmt, &rules[i]);
+      ret = utils_run_statement (db, stmt);
+      if (ret == EXIT_SUCCESS)
+        ret = check_changed (db);
+
+      changes[i] = (DatabaseChange) { .operation = CHANGE_EDIT, .rule = rules[i] };
+    }
+
+  ret = utils_batch_end (db, ret);
+  if (ret == EXIT_SUCCESS)
+    utils_notify_changes (db, changes, length);
+
+  free (changes);
+  return ret;
 }
 
+// Remove all the rules of the table (e.g. to replace them)
 int
-rule_custom_schedule (const uint8_t hour,
+rule_delete_all (GawakeDb *db, const Table table)
+{
+  sqlite3_stmt *stmt;
+  int ret;
+
+  if (utils_validate_table (table) || utils_batch_begin (db))
+    return EXIT_FAILURE;
+
+  stmt = utils_get_statement (db, TABLE_STATEMENT (STATEMENT_DELETE_ALL_ON, table));
+  ret = (stmt == NULL) ? EXIT_FAILURE : utils_run_statement (db, stmt);
+  if (ret == EXIT_SUCCESS)
+    ret = delete_exceptions (db, STATEMENT_DELETE_TABLE_EXCEPTIONS, table, 0);
+
+  if (utils_batch_end (db, ret))
+    return EXIT_FAILURE;
+
+  utils_notify_change (db, CHANGE_OTHER, NULL);
+
+  return EXIT_SUCCESS;
+}
+
+// Check the values of a rule before adding it, as rule_add () does
+int
+rule_validate (const Rule *rule)
+{
+  return utils_validate_rule (rule);
+}
+
+int
+rule_custom_schedule (GawakeDb *db,
+                      const uint8_t hour,
                       const uint8_t minutes,
                       const uint8_t day,
                       const uint8_t month,
                       const uint16_t year,
                       const uint8_t mode)
 {
+  sqlite3_stmt *stmt;
   RtcwakeArgs rtcwake_args = {
     .hour = hour,
     .minutes = minutes,
@@ -162,17 +384,18 @@ rule_custom_schedule (const uint8_t hour,
   /* if (validade_rtcwake_args (&rtcwake_args) == -1) */
   /*   return EXIT_FAILURE; */
 
-  sqlite3_snprintf (SQL_SIZE, utils_get_sql (),
-                    "UPDATE custom_schedule "\
-                    "SET hour = %d, minutes = %d, "\
-                    "day = %d, month = %d, year = %d, "\
-                    "mode = %d, use_args = %d "\
-                    "WHERE id = 1;",
-                    hour, minutes,
-                    day, month, year,
-                    mode, true);
+  stmt = utils_get_statement (db, STATEMENT_SET_CUSTOM_SCHEDULE);
+  if (stmt == NULL)
+    return EXIT_FAILURE;
+
+  sqlite3_bind_int (stmt, 1, hour);
+  sqlite3_bind_int (stmt, 2, minutes);
+  sqlite3_bind_int (stmt, 3, day);
+  sqlite3_bind_int (stmt, 4, month);
+  sqlite3_bind_int (stmt, 5, year);
+  sqlite3_bind_int (stmt, 6, mode);
 
-  int ret = utils_run_sql ();
+  int ret = utils_run_statement (db, stmt);
 
   // TODO
   /* if (ret == EXIT_SUCCESS) */
@@ -180,3 +403,171 @@ rule_custom_schedule (const uint8_t hour,
 
   return ret;
 }
+
+// Remove the one-shot schedules up to "now": a range of the time index
+static int
+prune_one_shots (GawakeDb *db, const int64_t now)
+{
+  sqlite3_stmt *stmt = utils_get_statement (db, STATEMENT_PRUNE_ONE_SHOTS);
+
+  if (stmt == NULL)
+    return EXIT_FAILURE;
+
+  sqlite3_bind_int64 (stmt, 1, now);
+
+  return utils_run_statement (db, stmt);
+}
+
+/*
+ * Queue a one-shot wake up, at "wake_time" (seconds since the epoch, in the
+ * future); "id" receives its id. The expired ones are removed in the same
+ * transaction, so the table doesn't grow with them
+ */
+int
+one_shot_add (GawakeDb *db, const char *name, const int64_t wake_time, int64_t *id)
+{
+  sqlite3_stmt *stmt;
+  int64_t now = (int64_t) time (NULL);
+  int ret;
+
+  if (name == NULL || strlen (name) >= RULE_NAME_LENGTH || wake_time <= now)
+    {
+      fprintf (stderr, "Invalid one-shot schedule values\n\n");
+      return EXIT_FAILURE;
+    }
+
+  if (utils_batch_begin (db))
+    return EXIT_FAILURE;
+
+  ret = prune_one_shots (db, now);
+  if (ret == EXIT_SUCCESS)
+    {
+      stmt = utils_get_statement (db, STATEMENT_ADD_ONE_SHOT);
+      if (stmt == NULL)
+        ret = EXIT_FAILURE;
+      else
+        {
+          sqlite3_bind_text (stmt, 1, name, -1, SQLITE_STATIC);
+          sqlite3_bind_int64 (stmt, 2, wake_time);
+          ret = utils_run_statement (db, stmt);
+          *id = sqlite3_last_insert_rowid (db->connection);
+        }
+    }
+
+  ret = utils_batch_end (db, ret);
+  // Not related to a rule: the scheduler loads the one-shot schedules again
+  if (ret == EXIT_SUCCESS)
+    utils_notify_change (db, CHANGE_OTHER, NULL);
+
+  return ret;
+}
+
+int
+one_shot_delete (GawakeDb *db, const int64_t id)
+{
+  sqlite3_stmt *stmt = utils_get_statement (db, STATEMENT_DELETE_ONE_SHOT);
+
+  if (stmt == NULL)
+    return EXIT_FAILURE;
+
+  sqlite3_bind_int64 (stmt, 1, id);
+  if (utils_run_statement (db, stmt))
+    return EXIT_FAILURE;
+
+  if (sqlite3_changes (db->connection) == 0)
+    {
+      fprintf (stderr, "Invalid ID\n\n");
+      return EXIT_FAILURE;
+    }
+
+  utils_notify_change (db, CHANGE_OTHER, NULL);
+
+  return EXIT_SUCCESS;
+}
+
+// Remove the expired one-shot schedules; they're never used, so the
+// scheduler isn't notified
+int
+one_shot_prune (GawakeDb *db, const int64_t now)
+{
+  return prune_one_shots (db, now);
+}
+
+/*
+ * Add exception dates ('YYYY-MM-DD'): of all the rules if "rule_id" is 0,
+ * else of that rule of "table". All or nothing, in a single transaction, so
+ * a list of holidays is a single change; the dates already set are kept, and
+ * not counted on "added"
+ */
+int
+exception_add_dates (GawakeDb *db,
+                     const char *const *dates,
+                     size_t length,
+                     const Table table,
+                     const int64_t rule_id,
+                     size_t *added)
+{
+  sqlite3_stmt *stmt;
+  Rule rule;
+  int ret = EXIT_SUCCESS;
+
+  *added = 0;
+
+  if (utils_validate_table (table))
+    return EXIT_FAILURE;
+
+  // The rule must exist; rule_get_single () reports an invalid ID
+  if (rule_id != 0 && rule_get_single (db, rule_id, table, &rule))
+    return EXIT_FAILURE;
+
+  stmt = utils_get_statement (db, STATEMENT_ADD_EXCEPTION);
+  if (stmt == NULL || utils_batch_begin (db))
+    return EXIT_FAILURE;
+
+  for (size_t i = 0; i < length && ret == EXIT_SUCCESS; i++)
+    {
+      sqlite3_bind_text (stmt, 1, dates[i], -1, SQLITE_STATIC);
+      // Only one scope for all the rules
+      sqlite3_bind_int (stmt, 2, (rule_id != 0) ? table : TABLE_ON);
+      sqlite3_bind_int64 (stmt, 3, rule_id);
+
+      ret = utils_run_statement (db, stmt);
+      if (ret == EXIT_SUCCESS)
+        *added += (size_t) sqlite3_changes (db->connection);
+      // Failed the CHECK: not a valid 'YYYY-MM-DD' date
+      else if (sqlite3_errcode (db->connection) == SQLITE_CONSTRAINT)
+        fprintf (stderr, "Invalid date \"%s\": it must be on format \"YYYY-MM-DD\"\n\n", dates[i]);
+    }
+
+  ret = utils_batch_end (db, ret);
+  if (ret != EXIT_SUCCESS)
+    *added = 0;
+  // Not related to a single rule change: the scheduler loads the dates again
+  else if (*added > 0)
+    utils_notify_change (db, CHANGE_OTHER, NULL);
+
+  return ret;
+}
+
+int
+exception_delete (GawakeDb *db, const int64_t id)
+{
+  sqlite3_stmt *stmt = utils_get_statement (db, STATEMENT_DELETE_EXCEPTION);
+
+  if (stmt == NULL)
+    return EXIT_FAILURE;
+
+  sqlite3_bind_int64 (stmt, 1, id);
+  if (utils_run_statement (db, stmt))
+    return EXIT_FAILURE;
+
+  if (sqlite3_changes (db->connection) == 0)
+    {
+      fprintf (stderr, "Invalid ID\n\n");
+      return EXIT_FAILURE;
+    }
+
+  utils_notify_change (db, CHANGE_OTHER, NULL);
+
+  return EXIT_SUCCESS;
+}
@@ -23,15 +23,38 @@
 
 #include "gawake-types.h"
 
-int rule_add (const Rule *rule);
-int rule_delete (const uint16_t id, const Table table);
-int rule_enable_disable (const uint16_t id, const Table table, const bool active);
-int rule_edit (const Rule *rule);
-int rule_custom_schedule (const uint8_t hour,
+int rule_add (GawakeDb *db, const Rule *rule);
+int rule_delete (GawakeDb *db, const int64_t id, const Table table);
+int rule_enable_disable (GawakeDb *db, const int64_t id, const Table table, const bool active);
+int rule_edit (GawakeDb *db, const Rule *rule);
+
+// All or nothing, in a single transaction; the changes are notified at once
+int rule_add_many (GawakeDb *db, const Rule *rules, size_t length);
+int rule_delete_many (GawakeDb *db, const int64_t *ids, size_t length, const Table table);
+int rule_set_active_many (GawakeDb *db,
+                          const int64_t *ids,
+                          size_t length,
+                          const Table table,
+                          const bool active);
+int rule_edit_many (GawakeDb *db, const Rule *rules, size_t length);
+int rule_delete_all (GawakeDb *db, const Table table);
+int rule_validate (const Rule *rule);
+int rule_custom_schedule (GawakeDb *db,
+                          const uint8_t hour,
                           const uint8_t minutes,
                           const uint8_t day,
                           const uint8_t month,
                           const uint16_t year,
                           const uint8_t mode);
+int one_shot_add (GawakeDb *db, const char *name, const int64_t wake_time, int64_t *id);
+int one_shot_delete (GawakeDb *db, const int64_t id);
+int one_shot_prune (GawakeDb *db, const int64_t now);
+int exception_add_dates (GawakeDb *db,
+                         const char *const *dates,
+                         size_t length,
+                         const Table table,
+                         const int64_t rule_id,
+                         size_t *added);
+int exception_delete (GawakeDb *db, const int64_t id);
 
 #endif /* RULES_MANAGER_H_ */
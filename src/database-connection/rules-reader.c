@@ -25,8 +25,42 @@
 #include "../utils/debugger.h"
 #include "rules-reader.h"
 
+/*
+ * Copy the row the statement is on to the rule
+ * ATTENTION columns numbers:
+ *    0     1             2         3           4         5
+ *    id    rule_name     minute    days_mask   active    mode (0 for turn on rules)
+ */
+static void
+read_rule (sqlite3_stmt *stmt, Table table, Rule *rule)
+{
+  int minute = sqlite3_column_int (stmt, 2);    // minute of the day
+
+  // ID
+  rule->id = sqlite3_column_int64 (stmt, 0);
+  // NAME
+  snprintf (rule->name, RULE_NAME_LENGTH, "%s", sqlite3_column_text (stmt, 1));
+
+  // MINUTES AND HOUR
+  rule->hour = (uint8_t) (minute / 60);
+  rule->minutes = (uint8_t) (minute % 60);
+
+  // DAYS
+  days_from_mask ((uint8_t) sqlite3_column_int (stmt, 3), rule->days);
+
+  // ACTIVE
+  rule->active = (bool) sqlite3_column_int (stmt, 4);
+
+  // MODE
+  rule->mode = (Mode) sqlite3_column_int (stmt, 5);
+
+  // TABLE
+  rule->table = table;
+}
+
 int
-rule_get_single (const uint16_t id,
+rule_get_single (GawakeDb *db,
+                 const int64_t id,
                  const Table table,
                  Rule *rule)
 {
@@ -35,196 +69,299 @@ rule_get_single (const uint16_t id,
 
   // Database related variables
   int rc;
-  struct sqlite3_stmt *stmt;
+  sqlite3_stmt *stmt;
 
-  // Generate SQL
-  sqlite3_snprintf (SQL_SIZE, utils_get_sql (), "SELECT * FROM %s WHERE id = %d LIMIT 1;", TABLE[table], id);
+  stmt = utils_get_statement (db, TABLE_STATEMENT (STATEMENT_GET_SINGLE_ON, table));
+  if (stmt == NULL)
+    return EXIT_FAILURE;
 
-  DEBUG_PRINT (("Generated SQL:\n\t%s", utils_get_sql ()));
+  sqlite3_bind_int64 (stmt, 1, id);
 
-  // Verify ID (also prepare statement)
-  if (sqlite3_prepare_v2 (utils_get_pdb (), utils_get_sql (), -1, &stmt, NULL) == SQLITE_OK
-      && sqlite3_step (stmt) != SQLITE_ROW)
+  // Verify ID
+  rc = sqlite3_step (stmt);
+  if (rc == SQLITE_DONE)
     {
       fprintf (stderr, "Invalid ID\n\n");
-      sqlite3_finalize (stmt);
+      sqlite3_reset (stmt);
       return EXIT_FAILURE;
     }
 
-  // Query data
-  /* ATTENTION columns numbers:
-   *    0     1             2       3       (...)       9       10          11
-   *    id    rule_name     time    sun     (...)       sat     active      mode
-   *                                                                        ^~~~
-   *                                                                        |
-   *                                                  only for turn off rules
-   */
-  // Temporary variables to receive the minutes and pass to the structure;
-  int hour, minutes;
-  char timestamp[9]; // HH:MM:SS'\0' = 9 characters
-  while ((rc = sqlite3_step (stmt)) == SQLITE_ROW)
+  if (rc != SQLITE_ROW)
     {
-      // ID
-      rule->id = (uint16_t) sqlite3_column_int (stmt, 0);
-      // NAME
-      snprintf (rule->name, RULE_NAME_LENGTH, "%s", sqlite3_column_text (stmt, 1));
-
-      // MINUTES AND HOUR
-      sqlite3_snprintf (9, timestamp, "%s", sqlite3_column_text (stmt, 2));
-      sscanf (timestamp, "%02d:%02d", &hour, &minutes);
-      rule->hour = (uint8_t) hour;
-      rule->minutes = minutes;
-
-      // DAYS
-      for (int i = 0; i <= 6; i++)
-        {
-          // days range: [0,6]                  column range: [3,9]
-          rule->days[i] = (bool) sqlite3_column_int (stmt, (i+3));
-        }
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR (failed to query rule): %s\n", sqlite3_errmsg (db->connection));
+      sqlite3_reset (stmt);
+      return EXIT_FAILURE;
+    }
 
-      // ACTIVE
-      rule->active = (bool) sqlite3_column_int (stmt, 10); // active
+  read_rule (stmt, table, rule);
 
-      // MODE (for turn on rules it isn't used):
-      rule->mode = (Mode) ((table == TABLE_OFF) ? sqlite3_column_int (stmt, 11) : 0);
+  // Release the read lock; the statement is kept for the next call
+  sqlite3_reset (stmt);
 
-      // TABLE
-      rule->table = (Table) table;
-    }
+  return EXIT_SUCCESS;
+}
 
-  if (rc != SQLITE_DONE)
+/*
+ * Iterate over the rules of the table, reading them one by one from the
+ * query: nothing is allocated, whatever the number of rules.
+ *
+ *  RuleIter iter;
+ *  Rule rule;
+ *
+ *  if (rule_iter_begin (db, table, &iter))
+ *    return EXIT_FAILURE;
+ *  while (rule_iter_next (&iter, &rule))
+ *    (...)
+ *  if (rule_iter_end (&iter))
+ *    return EXIT_FAILURE;
+ *
+ * The statement belongs to the GawakeDb: only one iteration over a table
+ * can be running on it, and rule_iter_end () must always be called, to
+ * release the read transaction.
+ */
+int
+rule_iter_begin (GawakeDb *db, const Table table, RuleIter *iter)
+{
+  if (utils_validate_table (table))
+    return EXIT_FAILURE;
+
+  iter->db = db;
+  iter->table = table;
+  iter->rc = SQLITE_OK;
+  iter->stmt = utils_get_statement (db, TABLE_STATEMENT (STATEMENT_GET_ALL_ON, table));
+  if (iter->stmt == NULL)
     {
       DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "ERROR (failed to query rule): %s\n", sqlite3_errmsg (utils_get_pdb ()));
-      sqlite3_finalize (stmt);
+      fprintf (stderr, "ERROR: Failed to query rules\n");
       return EXIT_FAILURE;
     }
 
-  sqlite3_finalize (stmt);
-
   return EXIT_SUCCESS;
 }
 
-int
-rule_get_all (const Table table,
-              Rule **rules,
-              uint16_t *rowcount)
+// Get the next rule; returns false at the end, or on failure
+bool
+rule_iter_next (RuleIter *iter, Rule *rule)
 {
-  int counter = 0;
-  // Database related variables
-  int rc;
-  struct sqlite3_stmt *stmt;
-  // Temporary variables to receive the hour and minutes, and then pass to the structure
-  int hour, minutes;
-  char timestamp[9]; // HH:MM:SS'\0' = 9 characters
+  if (iter->stmt == NULL || (iter->rc != SQLITE_OK && iter->rc != SQLITE_ROW))
+    return false;
 
+  iter->rc = sqlite3_step (iter->stmt);
+  if (iter->rc != SQLITE_ROW)
+    return false;
 
-  if (utils_validate_table (table))
+  read_rule (iter->stmt, iter->table, rule);
+
+  return true;
+}
+
+// Finish the iteration; returns EXIT_FAILURE if it stopped because of an error
+int
+rule_iter_end (RuleIter *iter)
+{
+  if (iter->stmt == NULL)
     return EXIT_FAILURE;
 
-  // Count the number of rows
-  sqlite3_snprintf (SQL_SIZE, utils_get_sql (), "SELECT COUNT(*) FROM %s;", TABLE[table]);
-  if (sqlite3_prepare_v2 (utils_get_pdb (), utils_get_sql (), -1, &stmt, NULL) == SQLITE_OK
-      && sqlite3_step (stmt) != SQLITE_ROW)
+  // Release the read lock; the statement is kept for the next iteration
+  sqlite3_reset (iter->stmt);
+  iter->stmt = NULL;
+
+  // Stopped before the end (by the caller) isn't a failure
+  if (iter->rc != SQLITE_DONE && iter->rc != SQLITE_ROW && iter->rc != SQLITE_OK)
     {
       DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "ERROR: Failed to query row count\n");
-      sqlite3_finalize (stmt);
+      fprintf (stderr, "ERROR (failed to query rule): %s\n", sqlite3_errmsg (iter->db->connection));
       return EXIT_FAILURE;
     }
-  *rowcount = sqlite3_column_int (stmt, 0);
 
-  DEBUG_PRINT (("Row count: %d", *rowcount));
+  return EXIT_SUCCESS;
+}
+
+// Get the custom schedule (the timestamp set for a custom wake up); "found"
+// of the RtcwakeArgs tells if it was ever set
+int
+rule_get_custom_schedule (GawakeDb *db, RtcwakeArgs *rtcwake_args)
+{
+  // Database related variables
+  int rc;
+  sqlite3_stmt *stmt;
+
+  rtcwake_args->found = false;
 
-  // SQL_SIZEate structure array
-  // https://www.youtube.com/watch?v=lq8tJS3g6tY
-  // TODO should "sizeof (**rules)" be "sizeof (**Rules)"
-  *rules = malloc (*rowcount * sizeof (**rules));
-  if (*rules == NULL)
+  stmt = utils_get_statement (db, STATEMENT_GET_CUSTOM_SCHEDULE);
+  if (stmt == NULL)
     {
       DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "ERROR: Failed to SQL_SIZEate memory\n");
-      sqlite3_finalize (stmt);
+      fprintf (stderr, "ERROR: Failed to query custom schedule\n");
       return EXIT_FAILURE;
     }
 
-  // Generate SQL
-  // SELECT length(<table>.rule_name), * FROM <table>;
-  sqlite3_snprintf (SQL_SIZE, utils_get_sql (),
-                    "SELECT length(%s.rule_name), * FROM %s;",
-                    TABLE[table], TABLE[table]);
-
-  DEBUG_PRINT (("Generated SQL:\n\t%s", utils_get_sql ()));
-
-  // Prepare statement
-  if (sqlite3_prepare_v2 (utils_get_pdb (), utils_get_sql (), -1, &stmt, NULL) != SQLITE_OK)
+  rc = sqlite3_step (stmt);
+  if (rc == SQLITE_ROW)
+    {
+      rtcwake_args->hour = sqlite3_column_int (stmt, 0);
+      rtcwake_args->minutes = sqlite3_column_int (stmt, 1);
+      rtcwake_args->day = sqlite3_column_int (stmt, 2);
+      rtcwake_args->month = sqlite3_column_int (stmt, 3);
+      rtcwake_args->year = sqlite3_column_int (stmt, 4);
+      rtcwake_args->mode = (Mode) sqlite3_column_int (stmt, 5);
+
+      // Default row: never set
+      rtcwake_args->found = (rtcwake_args->year != 0);
+    }
+  else if (rc != SQLITE_DONE)
     {
       DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "ERROR: Failed to query rule\n");
-      free (*rules);
-      sqlite3_finalize (stmt);
+      fprintf (stderr, "ERROR (failed to query custom schedule): %s\n", sqlite3_errmsg (db->connection));
+      sqlite3_reset (stmt);
       return EXIT_FAILURE;
     }
 
-  // Query data
-  /* ATTENTION columns numbers:
-   *    0                     1     2             3       4       (...)       10      11        12
-   *    rule_name length      id    rule_name     time    sun     (...)       sat     active    mode
-   *                                                                                            ^~~~
-   *                                                                                            |
-   *                                                                      only for turn off rules
-   */
+  sqlite3_reset (stmt);
+
+  return EXIT_SUCCESS;
+}
+
+/*
+ * Get the one-shot schedules after "from" (seconds since the epoch), in time
+ * order; "one_shots" must be freed, even if there are none
+ */
+int
+one_shot_get_upcoming (GawakeDb *db,
+                       const int64_t from,
+                       OneShot **one_shots,
+                       size_t *length)
+{
+  int rc;
+  size_t allocated = 16;
+  sqlite3_stmt *stmt;
+  OneShot *list;
+
+  *one_shots = NULL;
+  *length = 0;
+
+  stmt = utils_get_statement (db, STATEMENT_GET_ONE_SHOTS);
+  if (stmt == NULL)
+    return EXIT_FAILURE;
+
+  list = malloc (allocated * sizeof (*list));
+  if (list == NULL)
+    goto no_memory;
+
+  sqlite3_bind_int64 (stmt, 1, from);
+
   while ((rc = sqlite3_step (stmt)) == SQLITE_ROW)
     {
-      // If the loop tries to assign on non SQL_SIZEated space, leave
-      if (counter > *rowcount)
-        break;
-
-      // ID
-      (*rules)[counter].id = (uint16_t) sqlite3_column_int (stmt, 1);
-
-      // NAME
-      snprintf ((*rules)[counter].name,           // string pointer
-                  RULE_NAME_LENGTH,               // size
-                  "%s",                           // format
-                  sqlite3_column_text (stmt, 2)   // arguments
-                  );
-
-      // MINUTES AND HOUR
-      sqlite3_snprintf (9, timestamp, "%s", sqlite3_column_text (stmt, 3));
-      sscanf (timestamp, "%02d:%02d", &hour, &minutes);
-      (*rules)[counter].hour =  (uint8_t) hour;
-      (*rules)[counter].minutes = (uint8_t) minutes;
-
-      // DAYS
-      for (int i = 0; i <= 6; i++)
+      if (*length == allocated)
         {
-          // days range: [0,6]                  column range: [4,10]
-          (*rules)[counter].days[i] = (bool) sqlite3_column_int (stmt, (i+4));
+          OneShot *bigger = realloc (list, allocated * 2 * sizeof (*list));
+          if (bigger == NULL)
+            goto no_memory;
+
+          list = bigger;
+          allocated *= 2;
         }
 
-      // ACTIVE
-      (*rules)[counter].active = (bool) sqlite3_column_int (stmt, 11);
+      list[*length].id = sqlite3_column_int64 (stmt, 0);
+      snprintf (list[*length].name, RULE_NAME_LENGTH, "%s", sqlite3_column_text (stmt, 1));
+      list[*length].time = sqlite3_column_int64 (stmt, 2);
+      (*length)++;
+    }
+
+  // Release the read lock; the statement is kept for the next call
+  sqlite3_reset (stmt);
+
+  if (rc != SQLITE_DONE)
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR (failed to query one-shot schedules): %s\n", sqlite3_errmsg (db->connection));
+      free (list);
+      *length = 0;
+      return EXIT_FAILURE;
+    }
+
+  *one_shots = list;
+
+  return EXIT_SUCCESS;
+
+no_memory:
+  DEBUG_PRINT_CONTEX;
+  fprintf (stderr, "ERROR: Failed to allocate memory\n");
+  sqlite3_reset (stmt);
+  free (list);
+  *length = 0;
+  return EXIT_FAILURE;
+}
+
+/*
+ * Get the exception dates from "from" ('YYYY-MM-DD') on, in date order;
+ * "dates" must be freed, even if there are none
+ */
+int
+exception_get_dates (GawakeDb *db,
+                     const char *from,
+                     ExceptionDate **dates,
+                     size_t *length)
+{
+  int rc;
+  size_t allocated = 16;
+  sqlite3_stmt *stmt;
+  ExceptionDate *list;
+
+  *dates = NULL;
+  *length = 0;
+
+  stmt = utils_get_statement (db, STATEMENT_GET_EXCEPTIONS);
+  if (stmt == NULL)
+    return EXIT_FAILURE;
+
+  list = malloc (allocated * sizeof (*list));
+  if (list == NULL)
+    goto no_memory;
+
+  sqlite3_bind_text (stmt, 1, from, -1, SQLITE_STATIC);
 
-      // MODE (for turn on rules it isn't used, assigning 0):
-      (*rules)[counter].mode = (Mode) ((table == TABLE_OFF) ? sqlite3_column_int (stmt, 12) : 0);
+  while ((rc = sqlite3_step (stmt)) == SQLITE_ROW)
+    {
+      if (*length == allocated)
+        {
+          ExceptionDate *bigger = realloc (list, allocated * 2 * sizeof (*list));
+          if (bigger == NULL)
+            goto no_memory;
 
-      // TABLE
-      (*rules)[counter].table = (Table) table;
+          list = bigger;
+          allocated *= 2;
+        }
 
-      counter++;
+      list[*length].id = sqlite3_column_int64 (stmt, 0);
+      snprintf (list[*length].date, EXCEPTION_DATE_LENGTH, "%s", sqlite3_column_text (stmt, 1));
+      list[*length].table = (sqlite3_column_int (stmt, 2) == TABLE_OFF) ? TABLE_OFF : TABLE_ON;
+      list[*length].rule_id = sqlite3_column_int64 (stmt, 3);
+      (*length)++;
     }
 
+  // Release the read lock; the statement is kept for the next call
+  sqlite3_reset (stmt);
+
   if (rc != SQLITE_DONE)
     {
       DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "ERROR (failed to query rule): %s\n"), sqlite3_errmsg (utils_get_pdb ());
-      free (*rules);
-      sqlite3_finalize (stmt);
+      fprintf (stderr, "ERROR (failed to query exception dates): %s\n", sqlite3_errmsg (db->connection));
+      free (list);
+      *length = 0;
       return EXIT_FAILURE;
     }
 
-  sqlite3_finalize(stmt);
+  *dates = list;
 
   return EXIT_SUCCESS;
+
+no_memory:
+  DEBUG_PRINT_CONTEX;
+  fprintf (stderr, "ERROR: Failed to allocate memory\n");
+  sqlite3_reset (stmt);
+  free (list);
+  *length = 0;
+  return EXIT_FAILURE;
 }
@@ -21,15 +21,37 @@
 #ifndef RULES_READER_H_
 #define RULES_READER_H_
 
+#include <sqlite3.h>
+
 #include "gawake-types.h"
 
 // TODO make const pointers
-int rule_get_single (const uint16_t id,
+int rule_get_single (GawakeDb *db,
+                     const int64_t id,
                      const Table table,
                      Rule *rule);
 
-int rule_get_all (const Table table,
-                  Rule **rules,
-                  uint16_t *rowcount);
+// Position on the rules of a table; see rule_iter_begin ()
+typedef struct
+{
+  GawakeDb *db;
+  sqlite3_stmt *stmt;
+  Table table;
+  int rc;           // result of the last step
+} RuleIter;
+
+int rule_iter_begin (GawakeDb *db, const Table table, RuleIter *iter);
+bool rule_iter_next (RuleIter *iter, Rule *rule);
+int rule_iter_end (RuleIter *iter);
+
+int rule_get_custom_schedule (GawakeDb *db, RtcwakeArgs *rtcwake_args);
+int one_shot_get_upcoming (GawakeDb *db,
+                           const int64_t from,
+                           OneShot **one_shots,
+                           size_t *length);
+int exception_get_dates (GawakeDb *db,
+                         const char *from,
+                         ExceptionDate **dates,
+                         size_t *length);
 
 #endif /* RULES_READER_H_ */
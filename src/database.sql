@@ -1,32 +1,36 @@
+-- Schema version 7; older databases are migrated when they are opened
+-- (see database-connection/database-migration.c)
+PRAGMA user_version = 7;
+
+-- Readers (the scheduler) and writers (gawake-cli) don't block each other
+PRAGMA journal_mode = WAL;
+
+-- minute: minute of the day [0, 1439]
+-- days_mask: bit 0 is Sunday, ..., bit 6 is Saturday
 CREATE TABLE IF NOT EXISTS rules_turnon (
 	id          INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT,
 	rule_name   TEXT NOT NULL,
-	rule_time   TEXT NOT NULL,
-	sun         INTEGER NOT NULL,
-	mon         INTEGER NOT NULL,
-	tue         INTEGER NOT NULL,
-	wed         INTEGER NOT NULL,
-	thu         INTEGER NOT NULL,
-	fri         INTEGER NOT NULL,
-	sat         INTEGER NOT NULL,
+	minute      INTEGER NOT NULL,
+	days_mask   INTEGER NOT NULL,
 	active      INTEGER NOT NULL
 );
 
 CREATE TABLE IF NOT EXISTS rules_turnoff (
 	id          INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT,
 	rule_name   TEXT NOT NULL,
-	rule_time   TEXT NOT NULL,
-	sun         INTEGER NOT NULL,
-	mon         INTEGER NOT NULL,
-	tue         INTEGER NOT NULL,
-	wed         INTEGER NOT NULL,
-	thu         INTEGER NOT NULL,
-	fri         INTEGER NOT NULL,
-	sat         INTEGER NOT NULL,
+	minute      INTEGER NOT NULL,
+	days_mask   INTEGER NOT NULL,
 	active      INTEGER NOT NULL,
 	mode        INTEGER NOT NULL
 );
 
+-- Cover the queries of the active rules: the id is the rowid
+CREATE INDEX IF NOT EXISTS rules_turnon_schedule
+	ON rules_turnon (active, days_mask, minute);
+
+CREATE INDEX IF NOT EXISTS rules_turnoff_schedule
+	ON rules_turnoff (active, days_mask, minute, mode);
+
 CREATE TABLE IF NOT EXISTS config (
 	id                      INTEGER NOT NULL PRIMARY KEY,
 	cli_version             TEXT,
@@ -52,4 +56,31 @@ CREATE TABLE IF NOT EXISTS custom_schedule (
 );
 
 INSERT OR IGNORE INTO custom_schedule (id, hour, minutes, day, month, year, mode)
-VALUES (1, 0, 0, 0, 0, 0, 0);
\ No newline at end of file
+VALUES (1, 0, 0, 0, 0, 0, 0);
+
+-- One-shot wake ups, queued ahead; wake_time: seconds since the epoch
+CREATE TABLE IF NOT EXISTS one_shot_schedule (
+	id          INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT,
+	name        TEXT NOT NULL,
+	wake_time   INTEGER NOT NULL
+);
+
+-- The upcoming ones are a range of it, in time order; so are the expired
+CREATE INDEX IF NOT EXISTS one_shot_schedule_time
+	ON one_shot_schedule (wake_time);
+
+-- Dates the rules don't run on (e.g. holidays); date: 'YYYY-MM-DD'
+-- rule_id 0: all the rules; else, the rule of rule_table
+-- '+0 days' normalizes an overflowing day (e.g. '2026-02-30'), so it fails
+CREATE TABLE IF NOT EXISTS exception_dates (
+	id          INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT,
+	date        TEXT NOT NULL CHECK (date IS date (date, '+0 days')),
+	rule_table  INTEGER NOT NULL DEFAULT 0,
+	rule_id     INTEGER NOT NULL DEFAULT 0,
+	-- Also the index of the dates: the scheduler reads a range of them
+	UNIQUE (date, rule_table, rule_id)
+);
+
+-- The dates of a rule, deleted with it
+CREATE INDEX IF NOT EXISTS exception_dates_rule
+	ON exception_dates (rule_table, rule_id);
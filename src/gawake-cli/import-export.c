@@ -0,0 +1,1058 @@
+/* import-export.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Bulk import and export of the rules, the configuration and the custom
+ * schedule, to provision many machines at once. A file has one record per
+ * line, as JSON Lines (a flat object per line) or, if its name ends with
+ * ".csv", as CSV (the first line names the columns; the ones that don't
+ * apply to a record are left empty):
+ *
+ *   {"record":"rule","table":"off","name":"Night","time":"23:00","days":"0111110","active":true,"mode":"off"}
+ *   {"record":"config","localtime":true,"default_mode":"off","notification_time":5,"shutdown_fail":false}
+ *   {"record":"custom_schedule","date":"2025-01-15","time":"09:45","mode":"disk"}
+ *
+ * "days" has a digit per day, from Sunday. "-" is the standard input/output.
+ *
+ * Both directions stream the file: the export iterates the tables, and the
+ * import adds the rules in chunks, so the memory used doesn't depend on the
+ * number of rules. The import replaces all the rules and runs in a single
+ * transaction: on any invalid record, nothing is changed. The file has no
+ * rule ids, so the exception dates of single rules are deleted with the old
+ * rules (the ones of all the rules are kept).
+ *
+ * Lists of exception dates (e.g. the holidays of a year) are plain text, a
+ * date per line, added the same way: in chunks, in a single transaction.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <limits.h>
+
+#define ALLOW_MANAGING_RULES
+#define ALLOW_MANAGING_CONFIGURATION
+#include "../database-connection/database-connection.h"
+#undef ALLOW_MANAGING_RULES
+#undef ALLOW_MANAGING_CONFIGURATION
+
+#include "../utils/colors.h"
+#include "import-export.h"
+
+#define MAX_FIELDS 16
+#define IMPORT_CHUNK 256    // rules added at once
+
+typedef enum {
+  FORMAT_JSON_LINES,
+  FORMAT_CSV
+} Format;
+
+// Values are always text; quoted tells if it's a JSON string
+typedef struct
+{
+  const char *key;
+  const char *value;
+  bool quoted;
+} Field;
+
+typedef struct
+{
+  Field fields[MAX_FIELDS];
+  size_t length;
+} Record;
+
+// Columns written on CSV files
+static const char *const CSV_COLUMNS[] = {
+  "record", "table", "name", "time", "days", "active", "mode",
+  "localtime", "default_mode", "notification_time", "shutdown_fail", "date",
+};
+#define CSV_COLUMNS_LENGTH (sizeof (CSV_COLUMNS) / sizeof (CSV_COLUMNS[0]))
+
+// Fields allowed on each record, besides "record"
+static const char *const RULE_KEYS[] = {
+  "table", "name", "time", "days", "active", "mode", NULL
+};
+static const char *const CONFIG_KEYS[] = {
+  "localtime", "default_mode", "notification_time", "shutdown_fail", NULL
+};
+static const char *const CUSTOM_SCHEDULE_KEYS[] = {
+  "date", "time", "mode", NULL
+};
+
+static const char *const TABLE_NAME[] = { "on", "off" };
+
+#define BOOL_STRING(value) ((value) ? "true" : "false")
+
+static Format
+format_from_path (const char *path)
+{
+  size_t length = strlen (path);
+
+  if (length > 4 && strcasecmp (path + length - 4, ".csv") == 0)
+    return FORMAT_CSV;
+
+  return FORMAT_JSON_LINES;
+}
+
+static FILE *
+open_file (const char *path, const char *mode)
+{
+  FILE *file;
+
+  if (strcmp (path, "-") == 0)
+    return (mode[0] == 'r') ? stdin : stdout;
+
+  file = fopen (path, mode);
+  if (file == NULL)
+    perror (path);
+
+  return file;
+}
+
+// Returns EXIT_FAILURE if the file had an error, including on writing
+static int
+close_file (FILE *file)
+{
+  int ret = ferror (file) ? EXIT_FAILURE : EXIT_SUCCESS;
+
+  if (file == stdin)
+    return ret;
+
+  if (file == stdout)
+    return (fflush (file) == 0) ? ret : EXIT_FAILURE;
+
+  return (fclose (file) == 0) ? ret : EXIT_FAILURE;
+}
+
+/////////////////////////////////// EXPORT ////////////////////////////////////
+
+static void
+write_json_string (FILE *file, const char *string)
+{
+  putc ('"', file);
+  for (const unsigned char *c = (const unsigned char *) string; *c != '\0'; c++)
+    {
+      if (*c == '"' || *c == '\\')
+        fprintf (file, "\\%c", *c);
+      else if (*c < 0x20)
+        fprintf (file, "\\u%04x", *c);
+      else
+        putc (*c, file);
+    }
+  putc ('"', file);
+}
+
+static void
+write_csv_value (FILE *file, const char *value)
+{
+  // Quote only if needed, doubling the quotes of the value
+  if (strpbrk (value, ",\"\r\n") == NULL && !isspace ((unsigned char) value[0]))
+    {
+      fputs (value, file);
+      return;
+    }
+
+  putc ('"', file);
+  for (const char *c = value; *c != '\0'; c++)
+    {
+      if (*c == '"')
+        putc ('"', file);
+      putc (*c, file);
+    }
+  putc ('"', file);
+}
+
+static void
+write_record (FILE *file, Format format, const Field *fields, size_t length)
+{
+  if (format == FORMAT_JSON_LINES)
+    {
+      putc ('{', file);
+      for (size_t i = 0; i < length; i++)
+        {
+          if (i > 0)
+            putc (',', file);
+
+          write_json_string (file, fields[i].key);
+          putc (':', file);
+          if (fields[i].quoted)
+            write_json_string (file, fields[i].value);
+          else
+            fputs (fields[i].value, file);
+        }
+      fputs ("}\n", file);
+      return;
+    }
+
+  // CSV: the fields on their columns
+  for (size_t column = 0; column < CSV_COLUMNS_LENGTH; column++)
+    {
+      if (column > 0)
+        putc (',', file);
+
+      for (size_t i = 0; i < length; i++)
+        {
+          if (strcmp (fields[i].key, CSV_COLUMNS[column]) == 0)
+            {
+              write_csv_value (file, fields[i].value);
+              break;
+            }
+        }
+    }
+  putc ('\n', file);
+}
+
+static void
+write_rule (FILE *file, Format format, const Rule *rule)
+{
+  char time[8], days[8];
+
+  snprintf (time, sizeof (time), "%02d:%02d", rule->hour, rule->minutes);
+  for (int d = 0; d < 7; d++)
+    days[d] = rule->days[d] ? '1' : '0';
+  days[7] = '\0';
+
+  const Field fields[] = {
+    { "record", "rule", true },
+    { "table", TABLE_NAME[rule->table], true },
+    { "name", rule->name, true },
+    { "time", time, true },
+    { "days", days, true },
+    { "active", BOOL_STRING (rule->active), false },
+    { "mode", MODE[rule->mode], true },
+  };
+
+  // Turn on rules have no mode
+  write_record (file, format, fields, (rule->table == TABLE_OFF) ? 7 : 6);
+}
+
+static void
+write_config (FILE *file, Format format, const Config *config)
+{
+  char notification_time[12];
+
+  snprintf (notification_time, sizeof (notification_time), "%d", config->notification_time);
+
+  const Field fields[] = {
+    { "record", "config", true },
+    { "localtime", BOOL_STRING (config->use_localtime), false },
+    { "default_mode", MODE[config->default_mode], true },
+    { "notification_time", notification_time, false },
+    { "shutdown_fail", BOOL_STRING (config->shutdown_fail), false },
+  };
+
+  write_record (file, format, fields, sizeof (fields) / sizeof (fields[0]));
+}
+
+static void
+write_custom_schedule (FILE *file, Format format, const RtcwakeArgs *custom)
+{
+  char date[32], time[24];
+
+  snprintf (date, sizeof (date), "%04d-%02d-%02d", custom->year, custom->month, custom->day);
+  snprintf (time, sizeof (time), "%02d:%02d", custom->hour, custom->minutes);
+
+  const Field fields[] = {
+    { "record", "custom_schedule", true },
+    { "date", date, true },
+    { "time", time, true },
+    { "mode", MODE[custom->mode], true },
+  };
+
+  write_record (file, format, fields, sizeof (fields) / sizeof (fields[0]));
+}
+
+int
+export_database (GawakeDb *db, const char *path)
+{
+  Format format = format_from_path (path);
+  RtcwakeArgs custom;
+  Config config;
+  RuleIter iter;
+  Rule rule;
+  FILE *file;
+  size_t exported = 0;
+  int ret;
+
+  file = open_file (path, "w");
+  if (file == NULL)
+    return EXIT_FAILURE;
+
+  // A single read transaction: all the tables as they were at the same moment
+  if (gawake_db_transaction_begin (db))
+    {
+      close_file (file);
+      return EXIT_FAILURE;
+    }
+
+  if (format == FORMAT_CSV)
+    {
+      for (size_t column = 0; column < CSV_COLUMNS_LENGTH; column++)
+        fprintf (file, (column > 0) ? ",%s" : "%s", CSV_COLUMNS[column]);
+      putc ('\n', file);
+    }
+
+  ret = configuration_get_snapshot (db, &config);
+  if (ret == EXIT_SUCCESS)
+    {
+      write_config (file, format, &config);
+      ret = rule_get_custom_schedule (db, &custom);
+    }
+
+  if (ret == EXIT_SUCCESS && custom.found)
+    write_custom_schedule (file, format, &custom);
+
+  for (Table table = TABLE_ON; table < TABLE_LAST && ret == EXIT_SUCCESS; table++)
+    {
+      if (rule_iter_begin (db, table, &iter))
+        {
+          ret = EXIT_FAILURE;
+          break;
+        }
+
+      while (rule_iter_next (&iter, &rule))
+        {
+          write_rule (file, format, &rule);
+          exported++;
+        }
+
+      ret = rule_iter_end (&iter);
+    }
+
+  // Nothing was changed: only ends the read
+  gawake_db_transaction_end (db, EXIT_SUCCESS);
+
+  if (close_file (file))
+    {
+      fprintf (stderr, RED ("ERROR: Failed to write \"%s\"\n"), path);
+      return EXIT_FAILURE;
+    }
+
+  if (ret != EXIT_SUCCESS)
+    {
+      fprintf (stderr, RED ("ERROR: Failed to read the database\n"));
+      return EXIT_FAILURE;
+    }
+
+  // Don't mix the summary with the records
+  if (file != stdout)
+    printf ("Exported %zu rules to \"%s\"\n", exported, path);
+
+  return EXIT_SUCCESS;
+}
+
+/////////////////////////////////// IMPORT ////////////////////////////////////
+
+static int
+report (size_t line, const char *format, ...)
+{
+  va_list args;
+
+  fprintf (stderr, RED ("ERROR: ") "line %zu: ", line);
+  va_start (args, format);
+  vfprintf (stderr, format, args);
+  va_end (args);
+  putc ('\n', stderr);
+
+  return EXIT_FAILURE;
+}
+
+static char *
+skip_space (char *c)
+{
+  while (isspace ((unsigned char) *c))
+    c++;
+  return c;
+}
+
+static void
+put_utf8 (char **dst, unsigned long code)
+{
+  char *d = *dst;
+
+  if (code < 0x80)
+    *d++ = (char) code;
+  else if (code < 0x800)
+    {
+      *d++ = (char) (0xC0 | (code >> 6));
+      *d++ = (char) (0x80 | (code & 0x3F));
+    }
+  else if (code < 0x10000)
+    {
+      *d++ = (char) (0xE0 | (code >> 12));
+      *d++ = (char) (0x80 | ((code >> 6) & 0x3F));
+      *d++ = (char) (0x80 | (code & 0x3F));
+    }
+  else
+    {
+      *d++ = (char) (0xF0 | (code >> 18));
+      *d++ = (char) (0x80 | ((code >> 12) & 0x3F));
+      *d++ = (char) (0x80 | ((code >> 6) & 0x3F));
+      *d++ = (char) (0x80 | (code & 0x3F));
+    }
+
+  *dst = d;
+}
+
+static bool
+read_hex4 (const char *c, unsigned long *code)
+{
+  char hex[5];
+
+  for (int i = 0; i < 4; i++)
+    {
+      if (!isxdigit ((unsigned char) c[i]))
+        return false;
+      hex[i] = c[i];
+    }
+  hex[4] = '\0';
+
+  *code = strtoul (hex, NULL, 16);
+  return true;
+}
+
+/*
+ * Unescape the JSON string starting on the quote, in place (it never grows);
+ * returns the character after the closing quote, or NULL if it's invalid
+ */
+static char *
+json_string (char *quote, const char **string)
+{
+  char *src = quote + 1, *dst = quote + 1;
+  unsigned long code, low;
+
+  *string = dst;
+
+  for (;;)
+    {
+      char c = *src++;
+
+      if (c == '\0')
+        return NULL;
+
+      if (c == '"')
+        {
+          *dst = '\0';
+          return src;
+        }
+
+      if (c != '\\')
+        {
+          *dst++ = c;
+          continue;
+        }
+
+      switch (*src++)
+        {
+        case '"':   *dst++ = '"';  break;
+        case '\\':  *dst++ = '\\'; break;
+        case '/':   *dst++ = '/';  break;
+        case 'b':   *dst++ = '\b'; break;
+        case 'f':   *dst++ = '\f'; break;
+        case 'n':   *dst++ = '\n'; break;
+        case 'r':   *dst++ = '\r'; break;
+        case 't':   *dst++ = '\t'; break;
+        case 'u':
+          if (!read_hex4 (src, &code))
+            return NULL;
+          src += 4;
+
+          // Surrogate pair: characters out of the BMP
+          if (code >= 0xD800 && code <= 0xDBFF)
+            {
+              if (src[0] != '\\' || src[1] != 'u' || !read_hex4 (src + 2, &low)
+                  || low < 0xDC00 || low > 0xDFFF)
+                return NULL;
+              src += 6;
+              code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+            }
+
+          put_utf8 (&dst, code);
+          break;
+        default:
+          return NULL;
+        }
+    }
+}
+
+/*
+ * Parse a flat JSON object (string keys; strings, numbers, true, false or
+ * null as values) in place: the fields point to the line. null is the same
+ * as an empty value
+ */
+static int
+parse_json (char *line, Record *record)
+{
+  char *c = skip_space (line);
+  char next;
+
+  record->length = 0;
+
+  if (*c++ != '{')
+    return EXIT_FAILURE;
+
+  c = skip_space (c);
+  if (*c == '}')
+    return (*skip_space (c + 1) == '\0') ? EXIT_SUCCESS : EXIT_FAILURE;
+
+  for (;;)
+    {
+      Field *field;
+
+      if (record->length == MAX_FIELDS)
+        return EXIT_FAILURE;
+      field = &record->fields[record->length++];
+
+      if (*c != '"' || (c = json_string (c, &field->key)) == NULL)
+        return EXIT_FAILURE;
+
+      c = skip_space (c);
+      if (*c++ != ':')
+        return EXIT_FAILURE;
+      c = skip_space (c);
+
+      if (*c == '"')
+        {
+          if ((c = json_string (c, &field->value)) == NULL)
+            return EXIT_FAILURE;
+          field->quoted = true;
+          c = skip_space (c);
+          next = *c++;
+        }
+      else
+        {
+          field->value = c;
+          c += strcspn (c, ",} \t\r\n");
+          if (c == field->value)
+            return EXIT_FAILURE;
+
+          // The value is ended where its delimiter was
+          next = *c;
+          *c++ = '\0';
+          if (isspace ((unsigned char) next))
+            {
+              c = skip_space (c);
+              next = *c++;
+            }
+
+          field->quoted = false;
+          if (strcmp (field->value, "null") == 0)
+            field->value = "";
+        }
+
+      if (next == '}')
+        return (*skip_space (c) == '\0') ? EXIT_SUCCESS : EXIT_FAILURE;
+
+      if (next != ',')
+        return EXIT_FAILURE;
+
+      c = skip_space (c);
+    }
+}
+
+// Split a CSV line in place; quoted values can't have line breaks
+static int
+split_csv (char *line, const char **values, size_t max, size_t *length)
+{
+  char *src = line, *dst;
+  bool last;
+
+  line[strcspn (line, "\r\n")] = '\0';
+  *length = 0;
+
+  for (;;)
+    {
+      if (*length == max)
+        return EXIT_FAILURE;
+      values[(*length)++] = dst = src;
+
+      if (*src == '"')
+        {
+          // "" is a quote inside the value
+          for (src++; *src != '"' || src[1] == '"'; src++)
+            {
+              if (*src == '\0')
+                return EXIT_FAILURE;
+              if (*src == '"')
+                src++;
+              *dst++ = *src;
+            }
+          src++;
+
+          if (*src != ',' && *src != '\0')
+            return EXIT_FAILURE;
+        }
+      else
+        {
+          while (*src != ',' && *src != '\0')
+            src++;
+          dst = src;
+        }
+
+      last = (*src == '\0');
+      *dst = '\0';
+
+      if (last)
+        return EXIT_SUCCESS;
+      src++;
+    }
+}
+
+static int
+parse_record (Format format,
+              char *line,
+              const char *const *columns,
+              size_t columns_length,
+              Record *record)
+{
+  const char *values[MAX_FIELDS];
+  size_t length;
+
+  if (format == FORMAT_JSON_LINES)
+    return parse_json (line, record);
+
+  if (split_csv (line, values, MAX_FIELDS, &length) || length != columns_length)
+    return EXIT_FAILURE;
+
+  for (size_t i = 0; i < length; i++)
+    record->fields[i] = (Field) { columns[i], values[i], false };
+  record->length = length;
+
+  return EXIT_SUCCESS;
+}
+
+// Value of the field; NULL if it's missing or empty
+static const char *
+record_get (const Record *record, const char *key)
+{
+  for (size_t i = 0; i < record->length; i++)
+    {
+      if (strcmp (record->fields[i].key, key) == 0)
+        return (record->fields[i].value[0] == '\0') ? NULL : record->fields[i].value;
+    }
+
+  return NULL;
+}
+
+// Catch misspelled fields, instead of silently ignoring them
+static int
+check_keys (const Record *record, const char *const *keys, size_t line)
+{
+  for (size_t i = 0; i < record->length; i++)
+    {
+      const Field *field = &record->fields[i];
+      bool known = (strcmp (field->key, "record") == 0 || field->value[0] == '\0');
+
+      for (int k = 0; !known && keys[k] != NULL; k++)
+        known = (strcmp (field->key, keys[k]) == 0);
+
+      if (!known)
+        return report (line, "unknown field \"%s\"", field->key);
+    }
+
+  return EXIT_SUCCESS;
+}
+
+static int
+parse_bool (const char *value, bool *result)
+{
+  if (strcmp (value, "true") == 0 || strcmp (value, "1") == 0)
+    *result = true;
+  else if (strcmp (value, "false") == 0 || strcmp (value, "0") == 0)
+    *result = false;
+  else
+    return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
+}
+
+static int
+parse_mode (const char *value, Mode *mode)
+{
+  for (int m = MODE_MEM; m < MODE_LAST; m++)
+    {
+      if (strcmp (value, MODE[m]) == 0)
+        {
+          *mode = (Mode) m;
+          return EXIT_SUCCESS;
+        }
+    }
+
+  return EXIT_FAILURE;
+}
+
+static int
+parse_int (const char *value, int *result)
+{
+  char *end;
+  long number = strtol (value, &end, 10);
+
+  if (end == value || *end != '\0' || number < 0 || number > INT_MAX)
+    return EXIT_FAILURE;
+
+  *result = (int) number;
+  return EXIT_SUCCESS;
+}
+
+// "hh:mm"
+static int
+parse_time (const char *value, int *hour, int *minutes)
+{
+  char end;
+
+  if (sscanf (value, "%2d:%2d%c", hour, minutes, &end) != 2
+      || *hour < 0 || *hour > 23 || *minutes < 0 || *minutes > 59)
+    return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
+}
+
+static int
+read_rule (const Record *record, Rule *rule, size_t line)
+{
+  const char *table, *name, *time, *days, *active, *mode;
+  int hour, minutes;
+
+  if (check_keys (record, RULE_KEYS, line))
+    return EXIT_FAILURE;
+
+  table = record_get (record, "table");
+  name = record_get (record, "name");
+  time = record_get (record, "time");
+  days = record_get (record, "days");
+  active = record_get (record, "active");
+  mode = record_get (record, "mode");
+
+  *rule = (Rule) {
+    .active = true,
+    .mode = MODE_OFF,
+  };
+
+  if (table == NULL || (strcmp (table, "on") != 0 && strcmp (table, "off") != 0))
+    return report (line, "\"table\" must be \"on\" or \"off\"");
+  rule->table = (strcmp (table, "on") == 0) ? TABLE_ON : TABLE_OFF;
+
+  if (name == NULL || strlen (name) >= RULE_NAME_LENGTH)
+    return report (line, "\"name\" must have 1 to %d characters", RULE_NAME_LENGTH - 1);
+  strcpy (rule->name, name);
+
+  if (time == NULL || parse_time (time, &hour, &minutes))
+    return report (line, "\"time\" must be \"hh:mm\"");
+  rule->hour = (uint8_t) hour;
+  rule->minutes = (uint8_t) minutes;
+
+  if (days == NULL || strlen (days) != 7 || strspn (days, "01") != 7)
+    return report (line, "\"days\" must have 7 digits (0 or 1), from Sunday");
+  for (int d = 0; d < 7; d++)
+    rule->days[d] = (days[d] == '1');
+
+  if (active != NULL && parse_bool (active, &rule->active))
+    return report (line, "\"active\" must be true or false");
+
+  if (mode != NULL && parse_mode (mode, &rule->mode))
+    return report (line, "invalid \"mode\"");
+
+  if (rule_validate (rule))
+    return report (line, "invalid rule");
+
+  return EXIT_SUCCESS;
+}
+
+// Only the fields present are changed
+static int
+apply_config (GawakeDb *db, const Record *record, size_t line)
+{
+  const char *value;
+  bool flag;
+  Mode mode;
+  int number;
+
+  if (check_keys (record, CONFIG_KEYS, line))
+    return EXIT_FAILURE;
+
+  if ((value = record_get (record, "localtime")) != NULL
+      && (parse_bool (value, &flag) || configuration_set_localtime (db, flag)))
+    return report (line, "invalid \"localtime\"");
+
+  if ((value = record_get (record, "default_mode")) != NULL
+      && (parse_mode (value, &mode) || configuration_set_default_mode (db, mode)))
+    return report (line, "invalid \"default_mode\"");
+
+  if ((value = record_get (record, "notification_time")) != NULL
+      && (parse_int (value, &number) || configuration_set_notification_time (db, number)))
+    return report (line, "invalid \"notification_time\"");
+
+  if ((value = record_get (record, "shutdown_fail")) != NULL
+      && (parse_bool (value, &flag) || configuration_set_shutdown_fail (db, flag)))
+    return report (line, "invalid \"shutdown_fail\"");
+
+  return EXIT_SUCCESS;
+}
+
+static int
+apply_custom_schedule (GawakeDb *db, const Record *record, size_t line)
+{
+  const char *date, *time, *mode_value;
+  int year, month, day, hour, minutes;
+  Mode mode = MODE_OFF;
+  char end;
+
+  if (check_keys (record, CUSTOM_SCHEDULE_KEYS, line))
+    return EXIT_FAILURE;
+
+  date = record_get (record, "date");
+  time = record_get (record, "time");
+  mode_value = record_get (record, "mode");
+
+  if (date == NULL
+      || sscanf (date, "%4d-%2d-%2d%c", &year, &month, &day, &end) != 3
+      || month < 1 || month > 12 || day < 1 || day > 31)
+    return report (line, "\"date\" must be \"YYYY-MM-DD\"");
+
+  if (time == NULL || parse_time (time, &hour, &minutes))
+    return report (line, "\"time\" must be \"hh:mm\"");
+
+  if (mode_value != NULL && parse_mode (mode_value, &mode))
+    return report (line, "invalid \"mode\"");
+
+  if (rule_custom_schedule (db, hour, minutes, day, month, year, mode))
+    return report (line, "couldn't set the custom schedule");
+
+  return EXIT_SUCCESS;
+}
+
+static bool
+is_blank (const char *line)
+{
+  while (isspace ((unsigned char) *line))
+    line++;
+
+  return *line == '\0';
+}
+
+// Exception dates of a single rule, deleted with it by the import
+static int
+count_rule_exceptions (GawakeDb *db, size_t *count)
+{
+  ExceptionDate *dates;
+  size_t length;
+
+  *count = 0;
+  if (exception_get_dates (db, "", &dates, &length))
+    return EXIT_FAILURE;
+
+  for (size_t i = 0; i < length; i++)
+    {
+      if (dates[i].rule_id != 0)
+        (*count)++;
+    }
+
+  free (dates);
+  return EXIT_SUCCESS;
+}
+
+int
+import_database (GawakeDb *db, const char *path)
+{
+  Format format = format_from_path (path);
+  const char *columns[MAX_FIELDS];
+  Rule chunk[IMPORT_CHUNK];
+  Record record;
+  FILE *file;
+  char *line = NULL, *header = NULL;
+  size_t size = 0, line_number = 0, columns_length = 0, pending = 0, imported = 0;
+  size_t rule_exceptions = 0;
+  int ret = EXIT_SUCCESS;
+
+  file = open_file (path, "r");
+  if (file == NULL)
+    return EXIT_FAILURE;
+
+  if (gawake_db_transaction_begin (db))
+    {
+      close_file (file);
+      return EXIT_FAILURE;
+    }
+
+  // The rules of the file replace the current ones
+  if (count_rule_exceptions (db, &rule_exceptions)
+      || rule_delete_all (db, TABLE_ON) || rule_delete_all (db, TABLE_OFF))
+    ret = EXIT_FAILURE;
+
+  while (ret == EXIT_SUCCESS && getline (&line, &size, file) != -1)
+    {
+      const char *type;
+
+      line_number++;
+      if (is_blank (line))
+        continue;
+
+      // First line of a CSV file: names of the columns, kept for all the lines
+      if (format == FORMAT_CSV && header == NULL)
+        {
+          header = strdup (line);
+          if (header == NULL || split_csv (header, columns, MAX_FIELDS, &columns_length))
+            ret = report (line_number, "invalid header");
+          continue;
+        }
+
+      if (parse_record (format, line, columns, columns_length, &record))
+        {
+          ret = report (line_number, "malformed record");
+          break;
+        }
+
+      type = record_get (&record, "record");
+      if (type == NULL)
+        ret = report (line_number, "missing \"record\"");
+      else if (strcmp (type, "rule") == 0)
+        {
+          ret = read_rule (&record, &chunk[pending], line_number);
+          if (ret == EXIT_SUCCESS && ++pending == IMPORT_CHUNK)
+            {
+              ret = rule_add_many (db, chunk, pending);
+              imported += pending;
+              pending = 0;
+            }
+        }
+      else if (strcmp (type, "config") == 0)
+        ret = apply_config (db, &record, line_number);
+      else if (strcmp (type, "custom_schedule") == 0)
+        ret = apply_custom_schedule (db, &record, line_number);
+      else
+        ret = report (line_number, "unknown record \"%s\"", type);
+    }
+
+  if (ret == EXIT_SUCCESS && pending > 0)
+    {
+      ret = rule_add_many (db, chunk, pending);
+      imported += pending;
+    }
+
+  if (close_file (file))
+    {
+      fprintf (stderr, RED ("ERROR: Failed to read \"%s\"\n"), path);
+      ret = EXIT_FAILURE;
+    }
+
+  free (line);
+  free (header);
+
+  if (gawake_db_transaction_end (db, ret))
+    {
+      fprintf (stderr, RED ("ERROR: Nothing was imported\n"));
+      return EXIT_FAILURE;
+    }
+
+  printf ("Imported %zu rules from \"%s\"\n", imported, path);
+  if (rule_exceptions > 0)
+    fprintf (stderr, YELLOW ("Warning: %zu exception dates of single rules were "\
+                             "deleted with the old rules\n"), rule_exceptions);
+
+  return EXIT_SUCCESS;
+}
+
+/*
+ * Add the exception dates of a list, of all the rules if "rule_id" is 0:
+ * blank lines and the ones starting with '#' are ignored. All or nothing;
+ * "added" gets the number of new dates
+ */
+int
+import_exception_dates (GawakeDb *db,
+                        const char *path,
+                        const Table table,
+                        const int64_t rule_id,
+                        size_t *added)
+{
+  char chunk[IMPORT_CHUNK][EXCEPTION_DATE_LENGTH];
+  const char *dates[IMPORT_CHUNK];
+  FILE *file;
+  char *line = NULL;
+  size_t size = 0, line_number = 0, pending = 0, chunk_added;
+  int ret = EXIT_SUCCESS;
+
+  *added = 0;
+
+  file = open_file (path, "r");
+  if (file == NULL)
+    return EXIT_FAILURE;
+
+  if (gawake_db_transaction_begin (db))
+    {
+      close_file (file);
+      return EXIT_FAILURE;
+    }
+
+  for (size_t i = 0; i < IMPORT_CHUNK; i++)
+    dates[i] = chunk[i];
+
+  while (ret == EXIT_SUCCESS && getline (&line, &size, file) != -1)
+    {
+      char *date = skip_space (line), *end;
+
+      line_number++;
+      if (*date == '\0' || *date == '#')
+        continue;
+
+      end = date + strlen (date);
+      while (end > date && isspace ((unsigned char) end[-1]))
+        *--end = '\0';
+
+      if (end - date != EXCEPTION_DATE_LENGTH - 1)
+        {
+          ret = report (line_number, "invalid date \"%s\", it must be on format \"YYYY-MM-DD\"", date);
+          break;
+        }
+
+      memcpy (chunk[pending], date, EXCEPTION_DATE_LENGTH);
+      if (++pending == IMPORT_CHUNK)
+        {
+          ret = exception_add_dates (db, dates, pending, table, rule_id, &chunk_added);
+          *added += chunk_added;
+          pending = 0;
+        }
+    }
+
+  if (ret == EXIT_SUCCESS && pending > 0)
+    {
+      ret = exception_add_dates (db, dates, pending, table, rule_id, &chunk_added);
+      *added += chunk_added;
+    }
+
+  if (close_file (file))
+    {
+      fprintf (stderr, RED ("ERROR: Failed to read \"%s\"\n"), path);
+      ret = EXIT_FAILURE;
+    }
+
+  free (line);
+
+  if (gawake_db_transaction_end (db, ret))
+    {
+      fprintf (stderr, RED ("ERROR: Nothing was imported\n"));
+      *added = 0;
+      return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
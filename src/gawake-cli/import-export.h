@@ -0,0 +1,17 @@
+#ifndef IMPORT_EXPORT_H_
+#define IMPORT_EXPORT_H_
+
+#include "../database-connection/gawake-types.h"
+
+// JSON Lines, or CSV if the file name ends with ".csv"; "-" is stdin/stdout
+int export_database (GawakeDb *db, const char *path);
+int import_database (GawakeDb *db, const char *path);
+
+// A date ('YYYY-MM-DD') per line; "-" is stdin
+int import_exception_dates (GawakeDb *db,
+                            const char *path,
+                            const Table table,
+                            const int64_t rule_id,
+                            size_t *added);
+
+#endif /* IMPORT_EXPORT_H_ */
@@ -25,17 +25,46 @@
 
 #include "main.h"
 
+// Connection used by the menu and the options
+static GawakeDb *db = NULL;
+
 int
 main (int argc, char **argv)
 {
   // Receiving arguments (reference [4])
-  int cflag = 0, mflag = 0, sflag = 0;
-  char *cvalue = NULL, *mvalue = NULL;
+  int cflag = 0, mflag = 0, sflag = 0, pflag = 0;
+  char *cvalue = NULL, *mvalue = NULL, *evalue = NULL, *ivalue = NULL;
+  char *bvalue = NULL, *rvalue = NULL;
+  char *one_shot_time = NULL, *one_shot_name = NULL;
+  int list_one_shots = 0;
+  int64_t remove_id = -1;
+  char *exceptions_path = NULL, *exceptions_rule = NULL;
+  int list_exceptions = 0;
+  int64_t remove_exception_id = -1;
+  unsigned int pvalue = 0;
   int index;
   int c;
   opterr = 0;
 
-  while ((c = getopt (argc, argv, "hsc:m:")) != -1)
+  static const struct option long_options[] = {
+    { "plan", required_argument, NULL, 'p' },
+    { "export", required_argument, NULL, 'e' },
+    { "import", required_argument, NULL, 'i' },
+    { "backup", required_argument, NULL, 'b' },
+    { "restore", required_argument, NULL, 'r' },
+    { "add-one-shot", required_argument, NULL, OPTION_ADD_ONE_SHOT },
+    { "name", required_argument, NULL, OPTION_NAME },
+    { "list-one-shots", no_argument, NULL, OPTION_LIST_ONE_SHOTS },
+    { "remove-one-shot", required_argument, NULL, OPTION_REMOVE_ONE_SHOT },
+    { "import-exceptions", required_argument, NULL, OPTION_IMPORT_EXCEPTIONS },
+    { "rule", required_argument, NULL, OPTION_RULE },
+    { "list-exceptions", no_argument, NULL, OPTION_LIST_EXCEPTIONS },
+    { "remove-exception", required_argument, NULL, OPTION_REMOVE_EXCEPTION },
+    { "help", no_argument,       NULL, 'h' },
+    { NULL,   0,                 NULL, 0   }
+  };
+
+  while ((c = getopt_long (argc, argv, "hsc:m:p:e:i:b:r:", long_options, NULL)) != -1)
     {
       switch (c)
         {
@@ -43,6 +72,73 @@ main (int argc, char **argv)
           usage ();
           return EXIT_SUCCESS;
 
+        case 'p':
+          pflag = 1;
+          if (optarg == NULL || sscanf (optarg, "%u", &pvalue) != 1 || pvalue == 0)
+            {
+              fprintf (stderr, "Invalid number of events.\n");
+              return EXIT_FAILURE;
+            }
+          break;
+
+        case 'e':
+          evalue = optarg;
+          break;
+
+        case 'i':
+          ivalue = optarg;
+          break;
+
+        case 'b':
+          bvalue = optarg;
+          break;
+
+        case 'r':
+          rvalue = optarg;
+          break;
+
+        case OPTION_ADD_ONE_SHOT:
+          one_shot_time = optarg;
+          break;
+
+        case OPTION_NAME:
+          one_shot_name = optarg;
+          break;
+
+        case OPTION_LIST_ONE_SHOTS:
+          list_one_shots = 1;
+          break;
+
+        case OPTION_REMOVE_ONE_SHOT:
+          if (optarg == NULL || sscanf (optarg, "%" SCNd64, &remove_id) != 1
+              || remove_id <= 0)
+            {
+              fprintf (stderr, "Invalid ID\n");
+              return EXIT_FAILURE;
+            }
+          break;
+
+        case OPTION_IMPORT_EXCEPTIONS:
+          exceptions_path = optarg;
+          break;
+
+        case OPTION_RULE:
+          exceptions_rule = optarg;
+          break;
+
+        case OPTION_LIST_EXCEPTIONS:
+          list_exceptions = 1;
+          break;
+
+        case OPTION_REMOVE_EXCEPTION:
+          if (optarg == NULL || sscanf (optarg, "%" SCNd64, &remove_exception_id) != 1
+              || remove_exception_id <= 0)
+            {
+              fprintf (stderr, "Invalid ID\n");
+              return EXIT_FAILURE;
+            }
+          break;
+
         case 's':
           sflag = 1;
           break;
@@ -87,8 +183,11 @@ main (int argc, char **argv)
           break;
 
         case '?':
-          if (optopt == 'c' || optopt == 'm')
+          if (optopt == 'c' || optopt == 'm' || optopt == 'p' || optopt == 'e' || optopt == 'i'
+              || optopt == 'b' || optopt == 'r')
             fprintf (stderr, "Option -%c requires an argument.\n", optopt);
+          else if (optopt > CHAR_MAX)
+            fprintf (stderr, "Option %s requires an argument.\n", argv[optind - 1]);
           else if (isprint (optopt))
             fprintf (stderr, "Unknown option '-%c'.\n\n", optopt);
           else
@@ -102,6 +201,54 @@ main (int argc, char **argv)
         }
     }
 
+  // Case option 'p'
+  if (pflag)
+    return print_plan (pvalue);
+
+  // Case one-shot options
+  if (one_shot_name != NULL && one_shot_time == NULL)
+    {
+      fprintf (stderr, "Option --name must be used together the '--add-one-shot' option\n");
+      return EXIT_FAILURE;
+    }
+  if (one_shot_time != NULL)
+    return add_one_shot (one_shot_time, one_shot_name);
+  if (remove_id > 0)
+    return remove_one_shot (remove_id);
+  if (list_one_shots)
+    return print_one_shots ();
+
+  // Case exception dates options
+  if (exceptions_rule != NULL && exceptions_path == NULL)
+    {
+      fprintf (stderr, "Option --rule must be used together the '--import-exceptions' option\n");
+      return EXIT_FAILURE;
+    }
+  if (exceptions_path != NULL)
+    return import_exceptions (exceptions_path, exceptions_rule);
+  if (remove_exception_id > 0)
+    return remove_exception (remove_exception_id);
+  if (list_exceptions)
+    return print_exceptions ();
+
+  // Case options 'e' and 'i'
+  if (evalue != NULL && ivalue != NULL)
+    {
+      fprintf (stderr, "Options --export and --import can't be used together\n");
+      return EXIT_FAILURE;
+    }
+  if (evalue != NULL || ivalue != NULL)
+    return transfer ((evalue != NULL) ? evalue : ivalue, ivalue != NULL);
+
+  // Case options 'b' and 'r'
+  if (bvalue != NULL && rvalue != NULL)
+    {
+      fprintf (stderr, "Options --backup and --restore can't be used together\n");
+      return EXIT_FAILURE;
+    }
+  if (bvalue != NULL || rvalue != NULL)
+    return backup ((bvalue != NULL) ? bvalue : rvalue, rvalue != NULL);
+
   // Case option 'c'
   if (cflag)
     {
@@ -123,17 +270,18 @@ main (int argc, char **argv)
       else
         mode = MODE_OFF;
 
-      if (connect_database (false))
+      db = gawake_db_open (false);
+      if (db == NULL)
         return EXIT_FAILURE;
 
-      rule_custom_schedule (hour,
+      rule_custom_schedule (db, hour,
                        minutes,
                        day,
                        month,
                        year,
                        mode);
 
-      disconnect_database ();
+      gawake_db_close (db);
 
       return EXIT_SUCCESS;
     }
@@ -146,12 +294,13 @@ main (int argc, char **argv)
           return EXIT_FAILURE;
         }
 
-      if (connect_database (false))
+      db = gawake_db_open (false);
+      if (db == NULL)
         return EXIT_FAILURE;
 
       // TODO
       /* schedule (); */
-      disconnect_database ();
+      gawake_db_close (db);
 
       return EXIT_SUCCESS;
     }
@@ -170,17 +319,23 @@ main (int argc, char **argv)
 
   // If there's any arguments, continue to the menu...
   // If can't connect to the database, exit
-  if (connect_database (false))
+  db = gawake_db_open (false);
+  if (db == NULL)
     return EXIT_FAILURE;
 
   // Signal handler
   // Triggered on <Ctrl C>
   signal (SIGINT, exit_handler);
 
+  // Send the changes to the scheduler; optional, the server may not be running
+  if (connect_dbus_client () == EXIT_SUCCESS)
+    gawake_db_set_change_callback (db, on_database_changed);
+
   menu ();
 
   // Close database and D-Bus connection
-  disconnect_database ();
+  gawake_db_close (db);
+  close_dbus_client ();
 
   return EXIT_SUCCESS;
 }
@@ -523,13 +678,13 @@ add_remove_rule (void)
     {
     case 1:
       get_user_input (&rule, (Table) table);
-      rule_add (&rule);
+      rule_add (db, &rule);
       break;
 
     case 2:
       printf ("Enter the rule ID:\n");
-      get_int (&id, 6, 0, INT_MAX, 0);  // the max value of ID is 65535 (uint16)
-      rule_delete ((uint16_t) id, (Table) table);
+      get_int (&id, 11, 0, INT_MAX, 0);
+      rule_delete (db, id, (Table) table);
       break;
 
     default:
@@ -568,38 +723,55 @@ usage (void)
   printf ("Gawake (cli version): A Linux software to make your PC wake up on a scheduled time.\n"\
           "It makes the rtcwake command easier.\n"\
           "\nOptions:\n"\
+          " -b, --backup FILE\n\tCopy the database to FILE, while it's in use\n"\
           " -c\tSchedule with a custom timestamp (YYYYMMDDhhmmss); "\
           "if -m isn't set, uses \"off\" as the default mode\n"\
+          " -e, --export FILE\n\tWrite the rules, configuration and custom schedule to FILE, as JSON Lines\n"\
+          "\t(CSV if FILE ends with \".csv\"; \"-\" for the standard output)\n"\
           " -h\tShow this help and exit\n"\
+          " -i, --import FILE\n\tReplace the rules, and set the configuration and custom schedule, from FILE\n"\
+          "\t(same formats as --export); nothing is changed if any record is invalid\n"\
+          " --add-one-shot YYYYMMDDhhmmss [--name NAME]\n\tQueue a one-shot wake up; many can be queued\n"\
+          " --list-one-shots\n\tPrint the upcoming one-shot wake ups\n"\
+          " --remove-one-shot ID\n\tRemove a queued one-shot wake up\n"\
+          " --import-exceptions FILE [--rule on:ID|off:ID]\n\tAdd the exception dates (YYYY-MM-DD, one per line) of FILE: the rules\n"\
+          "\tdon't run on them; only the rule ID if '--rule' is used, all of them otherwise\n"\
+          " --list-exceptions\n\tPrint the exception dates of this year on\n"\
+          " --remove-exception ID\n\tRemove an exception date\n"\
           " -m\tSet a mode; must be used together the '-c' option\n"\
+          " -p, --plan N\n\tPrint the next N events planned (turn on, turn off, custom schedule and one-shots)\n"\
+          " -r, --restore FILE\n\tReplace the database with the backup FILE, after checking it\n"\
           " -s\tDirectly run the schedule function, using the first upcoming turn on rule;\n"\
           "\tto use a custom timestamp use the '-c' option\n"\
           "\nExamples:\n"\
           " %-40sSchedule according to the next turn on rule\n"\
           " %-40sSchedule wake for 15 January 2025, at 09:45:00\n"\
-          " %-40sSchedule wake for 28 December 2025, at 15:30:00; use mode disk\n\n",
-          "gawake-cli -s", "gawake-cli -c 20250115094500", "gawake-cli -c 20251228153000 -m disk");
+          " %-40sSchedule wake for 28 December 2025, at 15:30:00; use mode disk\n"\
+          " %-40sPrint what the machine will do on the next 20 events\n"\
+          " %-40sCopy the rules to another machine\n"\
+          " %-40sAlso wake up on 2 March 2027, at 07:00:00\n"\
+          " %-40sDon't run the rules on the holidays listed\n\n",
+          "gawake-cli -s", "gawake-cli -c 20250115094500", "gawake-cli -c 20251228153000 -m disk",
+          "gawake-cli --plan 20", "gawake-cli --export rules.csv",
+          "gawake-cli --add-one-shot 20270302070000",
+          "gawake-cli --import-exceptions holidays.txt");
 }
 
 static int
 config (void)
 {
-  bool shutdown_fail;
-  bool localtime;
-  Mode default_mode;
+  Config configuration;
   int option = 0;
 
-  configuration_get_localtime (&localtime);
-  configuration_get_default_mode (&default_mode);
-  configuration_get_shutdown_fail (&shutdown_fail);
+  configuration_get_snapshot (db, &configuration);
 
   printf ("Current configuration:\n"\
           "[1]\tUse localtime:\t\t%d\n"\
 	  "[2]\tDefault mode:\t\t%s\n"\
 	  "[3]\tShutdown on fail:\t%d\n\n",
-          localtime,
-          MODE[default_mode],
-          shutdown_fail);
+          configuration.use_localtime,
+          MODE[configuration.default_mode],
+          configuration.shutdown_fail);
 
   printf ("Choose an option to edit ");
   get_int (&option, 2, 0, 3, 0);
@@ -608,7 +780,7 @@ config (void)
     case 1:
       printf ("Set a new value (0/1) ");
       get_int (&option, 2, 0, 1, 1);
-      configuration_set_localtime ((bool) option);
+      configuration_set_localtime (db, (bool) option);
       break;
 
     case 2:
@@ -617,13 +789,13 @@ config (void)
         printf ("[%d]\t%s\n", i, MODE[i]);
 
       get_int (&option, 2, 0, (MODE_LAST-1), 1);
-      configuration_set_default_mode ((Mode) option);
+      configuration_set_default_mode (db, (Mode) option);
       break;
 
     case 3:
       printf ("Set a new value (0/1) ");
       get_int (&option, 2, 0, 1, 1);
-      configuration_set_shutdown_fail ((bool) option);
+      configuration_set_shutdown_fail (db, (bool) option);
       break;
 
     default:
@@ -638,15 +810,24 @@ __attribute__((__noreturn__)) static void
 exit_handler (int sig)
 {
   printf ("\nUser interruption...\n");
-  disconnect_database ();
+  gawake_db_close (db);
+  close_dbus_client ();
   exit (EXIT_FAILURE);
 }
 
+static void
+on_database_changed (const DatabaseChange *changes, size_t length)
+{
+  trigger_update_database (changes, length);
+}
+
 int print_rules (Table table)
 {
-  Rule *rules;
-  uint16_t rowcount;
-  if (rule_get_all (table, &rules, &rowcount))
+  RuleIter iter;
+  Rule rule;
+  int ret;
+
+  if (rule_iter_begin (db, table, &iter))
     {
       DEBUG_PRINT_CONTEX;
       fprintf (stderr, RED ("ERROR: Failed to query rules\n"));
@@ -673,27 +854,27 @@ int print_rules (Table table)
     }
 
   // ROWS
-  for (int counter = 0; counter < rowcount; counter++)
+  while (rule_iter_next (&iter, &rule))
     {
       if (table == TABLE_ON)
         {
-          printf ("\n│ %03d │ %-16.15s│  %02d:%02d:00  │  %d  │  %d  │  %d  │  %d  │  %d  │  %d  │  %d  │   %-5d│",
-                  rules[counter].id, rules[counter].name,
-                  rules[counter].hour, rules[counter].minutes,
-                  rules[counter].days[0], rules[counter].days[1], rules[counter].days[2], rules[counter].days[3],
-                  rules[counter].days[4], rules[counter].days[5], rules[counter].days[6],
-                  rules[counter].active);
+          printf ("\n│ %03" PRId64 " │ %-16.15s│  %02d:%02d:00  │  %d  │  %d  │  %d  │  %d  │  %d  │  %d  │  %d  │   %-5d│",
+                  rule.id, rule.name,
+                  rule.hour, rule.minutes,
+                  rule.days[0], rule.days[1], rule.days[2], rule.days[3],
+                  rule.days[4], rule.days[5], rule.days[6],
+                  rule.active);
         }
       else
         {
-          printf ("\n│ %03d │ %-16.15s│  %02d:%02d:00  │  %d  │  %d  │  %d  │  %d  │  %d  │  %d  │  %d  │   %-5d│ %-8s│",
-                  rules[counter].id, rules[counter].name, rules[counter].hour, rules[counter].minutes,
-                  rules[counter].days[0], rules[counter].days[1], rules[counter].days[2], rules[counter].days[3],
-                  rules[counter].days[4], rules[counter].days[5], rules[counter].days[6],
-                  rules[counter].active, MODE[rules[counter].mode]);
+          printf ("\n│ %03" PRId64 " │ %-16.15s│  %02d:%02d:00  │  %d  │  %d  │  %d  │  %d  │  %d  │  %d  │  %d  │   %-5d│ %-8s│",
+                  rule.id, rule.name, rule.hour, rule.minutes,
+                  rule.days[0], rule.days[1], rule.days[2], rule.days[3],
+                  rule.days[4], rule.days[5], rule.days[6],
+                  rule.active, MODE[rule.mode]);
         }
     }
-  free (rules);
+  ret = rule_iter_end (&iter);
 
   // BOTTOM
   if (table == TABLE_ON)
@@ -705,7 +886,7 @@ int print_rules (Table table)
       printf ("\n└─────┴─────────────────┴────────────┴─────┴─────┴─────┴─────┴─────┴─────┴─────┴────────┴─────────┘\n");
     }
 
-  return EXIT_SUCCESS;
+  return ret;
 }
 
 /* REFERENCES:
@@ -716,3 +897,402 @@ int print_rules (Table table)
  *
  * rtcwake manpage: https://www.man7.org/linux/man-pages/man8/rtcwake.8.html
  */
+
+/*
+ * Load the rules of both tables with their names, to name the rules of the
+ * plan; a rule deleted since the plan was made just has no name. Returns
+ * false if they couldn't be read
+ */
+static bool
+load_rule_names (RuleSet rules[2])
+{
+  bool loaded;
+
+  rule_set_init (&rules[TABLE_ON]);
+  rule_set_init (&rules[TABLE_OFF]);
+
+  db = gawake_db_open (true);
+  if (db == NULL)
+    return false;
+
+  loaded = (rule_set_load (db, TABLE_ON, &rules[TABLE_ON]) == EXIT_SUCCESS
+            && rule_set_load_names (db, &rules[TABLE_ON]) == EXIT_SUCCESS
+            && rule_set_load (db, TABLE_OFF, &rules[TABLE_OFF]) == EXIT_SUCCESS
+            && rule_set_load_names (db, &rules[TABLE_OFF]) == EXIT_SUCCESS);
+  gawake_db_close (db);
+
+  return loaded;
+}
+
+// Print the next "count" events planned, asked to the D-Bus server, with the
+// names of the rules read from the database
+static int
+print_plan (unsigned int count)
+{
+  static const char *EVENT[] = {
+    "turn on",
+    "turn off",
+    "custom",
+    "one-shot",
+  };
+  UpcomingEvent *events = NULL;
+  RuleSet rules[2];
+  size_t length = 0;
+  char timestamp[20];
+  struct tm event_time;
+  bool names;
+
+  if (connect_dbus_client ())
+    return EXIT_FAILURE;
+
+  if (get_upcoming_events (count, &events, &length))
+    {
+      close_dbus_client ();
+      return EXIT_FAILURE;
+    }
+  close_dbus_client ();
+
+  names = load_rule_names (rules);
+  if (!names)
+    fprintf (stderr, YELLOW ("Warning: Couldn't read the names of the rules\n"));
+
+  printf ("%-16s  %-8s  %5s  %-4s  %s\n", "Time", "Event", "Rule", "Mode", "Name");
+  for (size_t i = 0; i < length; i++)
+    {
+      time_t time = (time_t) events[i].time;
+      const char *name = NULL;
+
+      localtime_r (&time, &event_time);
+      strftime (timestamp, sizeof (timestamp), "%Y-%m-%d %H:%M", &event_time);
+
+      printf ("%-16s  %-8s  ",
+              timestamp,
+              (events[i].kind < EVENT_LAST) ? EVENT[events[i].kind] : "?");
+
+      if (events[i].kind == EVENT_CUSTOM_SCHEDULE)
+        printf ("%5s  ", "-");
+      else
+        printf ("%5" PRId64 "  ", events[i].id);
+
+      // Turn on rules have no mode
+      printf ("%-4s  ",
+              (events[i].kind == EVENT_TURN_ON || events[i].mode >= MODE_LAST) ? "-" : MODE[events[i].mode]);
+
+      if (names && (events[i].kind == EVENT_TURN_ON || events[i].kind == EVENT_TURN_OFF))
+        {
+          const RuleSet *set = &rules[(events[i].kind == EVENT_TURN_OFF) ? TABLE_OFF : TABLE_ON];
+          size_t rule = rule_set_find (set, events[i].id);
+
+          if (rule < set->length)
+            name = rule_set_get_name (set, rule);
+        }
+      printf ("%s\n", (name != NULL) ? name : "-");
+    }
+
+  if (length == 0)
+    printf ("No upcoming events.\n");
+
+  rule_set_free (&rules[TABLE_ON]);
+  rule_set_free (&rules[TABLE_OFF]);
+  free (events);
+
+  return EXIT_SUCCESS;
+}
+
+// Export or import the database to/from a file
+static int
+transfer (const char *path, bool import)
+{
+  int ret;
+
+  db = gawake_db_open (!import);
+  if (db == NULL)
+    return EXIT_FAILURE;
+
+  if (!import)
+    {
+      ret = export_database (db, path);
+      gawake_db_close (db);
+      return ret;
+    }
+
+  // The import is a single transaction: the scheduler is notified once,
+  // after it's committed, to reload everything
+  ret = import_database (db, path);
+  gawake_db_close (db);
+
+  if (ret == EXIT_SUCCESS)
+    notify_reload ();
+
+  return ret;
+}
+
+// Online backup of the database, or restore of a backup
+static int
+backup (const char *path, bool restore)
+{
+  struct timespec start, end;
+  double elapsed;
+  int pages = 0, ret;
+
+  db = gawake_db_open (!restore);
+  if (db == NULL)
+    return EXIT_FAILURE;
+
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  ret = restore ? database_restore (db, path, &pages) : database_backup (db, path, &pages);
+  clock_gettime (CLOCK_MONOTONIC, &end);
+
+  gawake_db_close (db);
+
+  if (ret != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+  printf ("%s %d pages %s \"%s\" in %.1f ms (%.0f pages/s)\n",
+          restore ? "Restored" : "Backed up", pages, restore ? "from" : "to", path,
+          elapsed * 1e3, (elapsed > 0) ? pages / elapsed : 0);
+
+  if (restore)
+    notify_reload ();
+
+  return EXIT_SUCCESS;
+}
+
+// The database was replaced as a whole: the scheduler must reload everything;
+// optional, the server may not be running
+static void
+notify_reload (void)
+{
+  if (connect_dbus_client () == EXIT_SUCCESS)
+    {
+      trigger_update_database (&(DatabaseChange) { .operation = CHANGE_OTHER }, 1);
+      close_dbus_client ();
+    }
+}
+
+// Queue a one-shot wake up, on a local time timestamp (YYYYMMDDhhmmss)
+static int
+add_one_shot (const char *timestamp, const char *name)
+{
+  struct tm wake = { .tm_isdst = -1 };
+  time_t wake_time;
+  int64_t id;
+  int ret;
+
+  if (strlen (timestamp) != 14
+      || sscanf (timestamp, "%04d%02d%02d%02d%02d%02d",
+                 &wake.tm_year, &wake.tm_mon, &wake.tm_mday,
+                 &wake.tm_hour, &wake.tm_min, &wake.tm_sec) != 6)
+    {
+      fprintf (stderr, "Invalid timestamp. It must be on format \"YYYYMMDDhhmmss\".\n");
+      return EXIT_FAILURE;
+    }
+
+  wake.tm_year -= 1900;
+  wake.tm_mon -= 1;
+  wake_time = mktime (&wake);
+  if (wake_time == (time_t) -1)
+    {
+      fprintf (stderr, "Invalid timestamp.\n");
+      return EXIT_FAILURE;
+    }
+
+  db = gawake_db_open (false);
+  if (db == NULL)
+    return EXIT_FAILURE;
+
+  // Optional, the server may not be running
+  if (connect_dbus_client () == EXIT_SUCCESS)
+    gawake_db_set_change_callback (db, on_database_changed);
+
+  ret = one_shot_add (db, (name != NULL) ? name : "One-shot", (int64_t) wake_time, &id);
+  if (ret == EXIT_SUCCESS)
+    printf ("One-shot wake up queued, ID %" PRId64 "\n", id);
+
+  gawake_db_close (db);
+  close_dbus_client ();
+
+  return ret;
+}
+
+// Print the upcoming one-shot wake ups, in time order
+static int
+print_one_shots (void)
+{
+  OneShot *one_shots = NULL;
+  size_t length = 0;
+  char timestamp[20];
+  struct tm wake;
+
+  db = gawake_db_open (true);
+  if (db == NULL)
+    return EXIT_FAILURE;
+
+  if (one_shot_get_upcoming (db, (int64_t) time (NULL), &one_shots, &length))
+    {
+      gawake_db_close (db);
+      return EXIT_FAILURE;
+    }
+  gawake_db_close (db);
+
+  printf ("%5s  %-16s  %s\n", "ID", "Time", "Name");
+  for (size_t i = 0; i < length; i++)
+    {
+      time_t wake_time = (time_t) one_shots[i].time;
+
+      localtime_r (&wake_time, &wake);
+      strftime (timestamp, sizeof (timestamp), "%Y-%m-%d %H:%M", &wake);
+
+      printf ("%5" PRId64 "  %-16s  %s\n", one_shots[i].id, timestamp, one_shots[i].name);
+    }
+
+  if (length == 0)
+    printf ("No upcoming one-shot wake ups.\n");
+
+  free (one_shots);
+
+  return EXIT_SUCCESS;
+}
+
+// Remove a queued one-shot wake up
+static int
+remove_one_shot (int64_t id)
+{
+  int ret;
+
+  db = gawake_db_open (false);
+  if (db == NULL)
+    return EXIT_FAILURE;
+
+  // Optional, the server may not be running
+  if (connect_dbus_client () == EXIT_SUCCESS)
+    gawake_db_set_change_callback (db, on_database_changed);
+
+  ret = one_shot_delete (db, id);
+  if (ret == EXIT_SUCCESS)
+    printf ("One-shot wake up %" PRId64 " removed\n", id);
+
+  gawake_db_close (db);
+  close_dbus_client ();
+
+  return ret;
+}
+
+/*
+ * Add the exception dates of a file, of all the rules, or only of "rule"
+ * ("on:ID" or "off:ID")
+ */
+static int
+import_exceptions (const char *path, const char *rule)
+{
+  Table table = TABLE_ON;
+  int64_t rule_id = 0;
+  int ret;
+  size_t added;
+  char table_name[4];
+
+  if (rule != NULL)
+    {
+      if (sscanf (rule, "%3[a-z]:%" SCNd64, table_name, &rule_id) != 2
+          || rule_id <= 0)
+        {
+          fprintf (stderr, "Invalid rule. It must be on format \"on:ID\" or \"off:ID\".\n");
+          return EXIT_FAILURE;
+        }
+
+      if (strcmp (table_name, "on") == 0)
+        table = TABLE_ON;
+      else if (strcmp (table_name, "off") == 0)
+        table = TABLE_OFF;
+      else
+        {
+          fprintf (stderr, "Invalid rule. It must be on format \"on:ID\" or \"off:ID\".\n");
+          return EXIT_FAILURE;
+        }
+    }
+
+  db = gawake_db_open (false);
+  if (db == NULL)
+    return EXIT_FAILURE;
+
+  // A single transaction: the scheduler is notified once, after it's
+  // committed, to reload everything
+  ret = import_exception_dates (db, path, table, rule_id, &added);
+  gawake_db_close (db);
+
+  if (ret != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  printf ("Added %zu exception dates from \"%s\"\n", added, path);
+  if (added > 0)
+    notify_reload ();
+
+  return EXIT_SUCCESS;
+}
+
+// Print the exception dates from the beginning of this year, in date order
+static int
+print_exceptions (void)
+{
+  ExceptionDate *dates = NULL;
+  size_t length = 0;
+  char from[EXCEPTION_DATE_LENGTH];
+  time_t now = time (NULL);
+  struct tm today;
+
+  localtime_r (&now, &today);
+  strftime (from, sizeof (from), "%Y-01-01", &today);
+
+  db = gawake_db_open (true);
+  if (db == NULL)
+    return EXIT_FAILURE;
+
+  if (exception_get_dates (db, from, &dates, &length))
+    {
+      gawake_db_close (db);
+      return EXIT_FAILURE;
+    }
+  gawake_db_close (db);
+
+  printf ("%5s  %-10s  %s\n", "ID", "Date", "Rule");
+  for (size_t i = 0; i < length; i++)
+    {
+      if (dates[i].rule_id == 0)
+        printf ("%5" PRId64 "  %-10s  all\n", dates[i].id, dates[i].date);
+      else
+        printf ("%5" PRId64 "  %-10s  %s %" PRId64 "\n", dates[i].id, dates[i].date,
+                (dates[i].table == TABLE_ON) ? "on" : "off", dates[i].rule_id);
+    }
+
+  if (length == 0)
+    printf ("No exception dates.\n");
+
+  free (dates);
+
+  return EXIT_SUCCESS;
+}
+
+// Remove an exception date
+static int
+remove_exception (int64_t id)
+{
+  int ret;
+
+  db = gawake_db_open (false);
+  if (db == NULL)
+    return EXIT_FAILURE;
+
+  // Optional, the server may not be running
+  if (connect_dbus_client () == EXIT_SUCCESS)
+    gawake_db_set_change_callback (db, on_database_changed);
+
+  ret = exception_delete (db, id);
+  if (ret == EXIT_SUCCESS)
+    printf ("Exception date %" PRId64 " removed\n", id);
+
+  gawake_db_close (db);
+  close_dbus_client ();
+
+  return ret;
+}
@@ -11,6 +11,8 @@
 #include <stdbool.h>
 #include <string.h>
 #include <limits.h>
+#include <getopt.h>
+#include <time.h>
 
 #define ALLOW_MANAGING_RULES
 #define ALLOW_MANAGING_CONFIGURATION
@@ -20,6 +22,21 @@
 
 #include "../utils/debugger.h"
 #include "../utils/colors.h"
+#include "../utils/dbus-client.h"
+#include "import-export.h"
+
+// Long options without a short one
+enum
+{
+  OPTION_ADD_ONE_SHOT = CHAR_MAX + 1,
+  OPTION_NAME,
+  OPTION_LIST_ONE_SHOTS,
+  OPTION_REMOVE_ONE_SHOT,
+  OPTION_IMPORT_EXCEPTIONS,
+  OPTION_RULE,
+  OPTION_LIST_EXCEPTIONS,
+  OPTION_REMOVE_EXCEPTION,
+};
 
 static void menu (void);
 static void info (void);
@@ -32,6 +49,18 @@ static int add_remove_rule (void);
 static int confirm (void);
 static void usage (void);
 static void exit_handler (int);
+static void on_database_changed (const DatabaseChange *changes, size_t length);
 static int print_rules (Table table);
+static bool load_rule_names (RuleSet rules[2]);
+static int print_plan (unsigned int count);
+static int transfer (const char *path, bool import);
+static int backup (const char *path, bool restore);
+static void notify_reload (void);
+static int add_one_shot (const char *timestamp, const char *name);
+static int print_one_shots (void);
+static int remove_one_shot (int64_t id);
+static int import_exceptions (const char *path, const char *rule);
+static int print_exceptions (void);
+static int remove_exception (int64_t id);
 
 #endif /* __GAWAKE_CLI_H_ */
@@ -240,6 +240,98 @@ _g_dbus_codegen_marshal_BOOLEAN__OBJECT (
   g_value_set_boolean (return_value, v_return);
 }
 
+static void
+_g_dbus_codegen_marshal_BOOLEAN__OBJECT_INT64 (
+    GClosure     *closure,
+    GValue       *return_value,
+    unsigned int  n_param_values,
+    const GValue *param_values,
+    void         *invocation_hint G_GNUC_UNUSED,
+    void         *marshal_data)
+{
+  typedef gboolean (*_GDbusCodegenMarshalBoolean_ObjectInt64Func)
+       (void *data1,
+        GDBusMethodInvocation *arg_method_invocation,
+        gint64 arg_id,
+        void *data2);
+  _GDbusCodegenMarshalBoolean_ObjectInt64Func callback;
+  GCClosure *cc = (GCClosure*) closure;
+  void *data1, *data2;
+  gboolean v_return;
+
+  g_return_if_fail (return_value != NULL);
+  g_return_if_fail (n_param_values == 3);
+
+  if (G_CCLOSURE_SWAP_DATA (closure))
+    {
+      data1 = closure->data;
+      data2 = g_value_peek_pointer (param_values + 0);
+    }
+  else
+    {
+      data1 = g_value_peek_pointer (param_values + 0);
+      data2 = closure->data;
+    }
+
+  callback = (_GDbusCodegenMarshalBoolean_ObjectInt64Func)
+    (marshal_data ? marshal_data : cc->callback);
+
+  v_return =
+    callback (data1,
+              g_marshal_value_peek_object (param_values + 1),
+              g_marshal_value_peek_int64 (param_values + 2),
+              data2);
+
+  g_value_set_boolean (return_value, v_return);
+}
+
+static void
+_g_dbus_codegen_marshal_BOOLEAN__OBJECT_STRING_INT64 (
+    GClosure     *closure,
+    GValue       *return_value,
+    unsigned int  n_param_values,
+    const GValue *param_values,
+    void         *invocation_hint G_GNUC_UNUSED,
+    void         *marshal_data)
+{
+  typedef gboolean (*_GDbusCodegenMarshalBoolean_ObjectStringInt64Func)
+       (void *data1,
+        GDBusMethodInvocation *arg_method_invocation,
+        const gchar *arg_name,
+        gint64 arg_time,
+        void *data2);
+  _GDbusCodegenMarshalBoolean_ObjectStringInt64Func callback;
+  GCClosure *cc = (GCClosure*) closure;
+  void *data1, *data2;
+  gboolean v_return;
+
+  g_return_if_fail (return_value != NULL);
+  g_return_if_fail (n_param_values == 4);
+
+  if (G_CCLOSURE_SWAP_DATA (closure))
+    {
+      data1 = closure->data;
+      data2 = g_value_peek_pointer (param_values + 0);
+    }
+  else
+    {
+      data1 = g_value_peek_pointer (param_values + 0);
+      data2 = closure->data;
+    }
+
+  callback = (_GDbusCodegenMarshalBoolean_ObjectStringInt64Func)
+    (marshal_data ? marshal_data : cc->callback);
+
+  v_return =
+    callback (data1,
+              g_marshal_value_peek_object (param_values + 1),
+              g_marshal_value_peek_string (param_values + 2),
+              g_marshal_value_peek_int64 (param_values + 3),
+              data2);
+
+  g_value_set_boolean (return_value, v_return);
+}
+
 static void
 _g_dbus_codegen_marshal_BOOLEAN__OBJECT_UCHAR (
     GClosure     *closure,
@@ -285,6 +377,96 @@ _g_dbus_codegen_marshal_BOOLEAN__OBJECT_UCHAR (
   g_value_set_boolean (return_value, v_return);
 }
 
+static void
+_g_dbus_codegen_marshal_BOOLEAN__OBJECT_UINT (
+    GClosure     *closure,
+    GValue       *return_value,
+    unsigned int  n_param_values,
+    const GValue *param_values,
+    void         *invocation_hint G_GNUC_UNUSED,
+    void         *marshal_data)
+{
+  typedef gboolean (*_GDbusCodegenMarshalBoolean_ObjectUintFunc)
+       (void *data1,
+        GDBusMethodInvocation *arg_method_invocation,
+        guint arg_count,
+        void *data2);
+  _GDbusCodegenMarshalBoolean_ObjectUintFunc callback;
+  GCClosure *cc = (GCClosure*) closure;
+  void *data1, *data2;
+  gboolean v_return;
+
+  g_return_if_fail (return_value != NULL);
+  g_return_if_fail (n_param_values == 3);
+
+  if (G_CCLOSURE_SWAP_DATA (closure))
+    {
+      data1 = closure->data;
+      data2 = g_value_peek_pointer (param_values + 0);
+    }
+  else
+    {
+      data1 = g_value_peek_pointer (param_values + 0);
+      data2 = closure->data;
+    }
+
+  callback = (_GDbusCodegenMarshalBoolean_ObjectUintFunc)
+    (marshal_data ? marshal_data : cc->callback);
+
+  v_return =
+    callback (data1,
+              g_marshal_value_peek_object (param_values + 1),
+              g_marshal_value_peek_uint (param_values + 2),
+              data2);
+
+  g_value_set_boolean (return_value, v_return);
+}
+
+static void
+_g_dbus_codegen_marshal_BOOLEAN__OBJECT_VARIANT (
+    GClosure     *closure,
+    GValue       *return_value,
+    unsigned int  n_param_values,
+    const GValue *param_values,
+    void         *invocation_hint G_GNUC_UNUSED,
+    void         *marshal_data)
+{
+  typedef gboolean (*_GDbusCodegenMarshalBoolean_ObjectVariantFunc)
+       (void *data1,
+        GDBusMethodInvocation *arg_method_invocation,
+        GVariant *arg_changes,
+        void *data2);
+  _GDbusCodegenMarshalBoolean_ObjectVariantFunc callback;
+  GCClosure *cc = (GCClosure*) closure;
+  void *data1, *data2;
+  gboolean v_return;
+
+  g_return_if_fail (return_value != NULL);
+  g_return_if_fail (n_param_values == 3);
+
+  if (G_CCLOSURE_SWAP_DATA (closure))
+    {
+      data1 = closure->data;
+      data2 = g_value_peek_pointer (param_values + 0);
+    }
+  else
+    {
+      data1 = g_value_peek_pointer (param_values + 0);
+      data2 = closure->data;
+    }
+
+  callback = (_GDbusCodegenMarshalBoolean_ObjectVariantFunc)
+    (marshal_data ? marshal_data : cc->callback);
+
+  v_return =
+    callback (data1,
+              g_marshal_value_peek_object (param_values + 1),
+              g_marshal_value_peek_variant (param_values + 2),
+              data2);
+
+  g_value_set_boolean (return_value, v_return);
+}
+
 /* ------------------------------------------------------------------------
  * Code for interface io.github.kelvinnovais.Database
  * ------------------------------------------------------------------------
@@ -311,12 +493,29 @@ static unsigned GAWAKE_SERVER__DATABASE_SIGNALS[5] = { 0 };
 
 /* ---- Introspection data for io.github.kelvinnovais.Database ---- */
 
+static const _ExtendedGDBusArgInfo _gawake_server_database_method_info_update_database_IN_ARG_changes =
+{
+  {
+    -1,
+    (gchar *) "changes",
+    (gchar *) "a(y(xsyyabbyy))",
+    NULL
+  },
+  FALSE
+};
+
+static const GDBusArgInfo * const _gawake_server_database_method_info_update_database_IN_ARG_pointers[] =
+{
+  &_gawake_server_database_method_info_update_database_IN_ARG_changes.parent_struct,
+  NULL
+};
+
 static const _ExtendedGDBusMethodInfo _gawake_server_database_method_info_update_database =
 {
   {
     -1,
     (gchar *) "UpdateDatabase",
-    NULL,
+    (GDBusArgInfo **) &_gawake_server_database_method_info_update_database_IN_ARG_pointers,
     NULL,
     NULL
   },
@@ -393,121 +592,308 @@ static const _ExtendedGDBusMethodInfo _gawake_server_database_method_info_return
   FALSE
 };
 
-static const GDBusMethodInfo * const _gawake_server_database_method_info_pointers[] =
+static const _ExtendedGDBusArgInfo _gawake_server_database_method_info_get_upcoming_events_IN_ARG_count =
 {
-  &_gawake_server_database_method_info_update_database.parent_struct,
-  &_gawake_server_database_method_info_cancel_rule.parent_struct,
-  &_gawake_server_database_method_info_request_schedule.parent_struct,
-  &_gawake_server_database_method_info_request_custom_schedule.parent_struct,
-  &_gawake_server_database_method_info_return_status.parent_struct,
+  {
+    -1,
+    (gchar *) "count",
+    (gchar *) "u",
+    NULL
+  },
+  FALSE
+};
+
+static const GDBusArgInfo * const _gawake_server_database_method_info_get_upcoming_events_IN_ARG_pointers[] =
+{
+  &_gawake_server_database_method_info_get_upcoming_events_IN_ARG_count.parent_struct,
   NULL
 };
 
-static const _ExtendedGDBusSignalInfo _gawake_server_database_signal_info_database_updated =
+static const _ExtendedGDBusArgInfo _gawake_server_database_method_info_get_upcoming_events_OUT_ARG_events =
 {
   {
     -1,
-    (gchar *) "DatabaseUpdated",
-    NULL,
+    (gchar *) "events",
+    (gchar *) "a(xyxy)",
     NULL
   },
-  "database-updated"
+  FALSE
 };
 
-static const _ExtendedGDBusSignalInfo _gawake_server_database_signal_info_rule_canceled =
+static const GDBusArgInfo * const _gawake_server_database_method_info_get_upcoming_events_OUT_ARG_pointers[] =
+{
+  &_gawake_server_database_method_info_get_upcoming_events_OUT_ARG_events.parent_struct,
+  NULL
+};
+
+static const _ExtendedGDBusMethodInfo _gawake_server_database_method_info_get_upcoming_events =
 {
   {
     -1,
-    (gchar *) "RuleCanceled",
-    NULL,
+    (gchar *) "GetUpcomingEvents",
+    (GDBusArgInfo **) &_gawake_server_database_method_info_get_upcoming_events_IN_ARG_pointers,
+    (GDBusArgInfo **) &_gawake_server_database_method_info_get_upcoming_events_OUT_ARG_pointers,
     NULL
   },
-  "rule-canceled"
+  "handle-get-upcoming-events",
+  FALSE
 };
 
-static const _ExtendedGDBusSignalInfo _gawake_server_database_signal_info_schedule_requested =
+static const _ExtendedGDBusArgInfo _gawake_server_database_method_info_add_one_shot_IN_ARG_name =
 {
   {
     -1,
-    (gchar *) "ScheduleRequested",
-    NULL,
+    (gchar *) "name",
+    (gchar *) "s",
     NULL
   },
-  "schedule-requested"
+  FALSE
 };
 
-static const _ExtendedGDBusSignalInfo _gawake_server_database_signal_info_custom_schedule_requested =
+static const _ExtendedGDBusArgInfo _gawake_server_database_method_info_add_one_shot_IN_ARG_time =
 {
   {
     -1,
-    (gchar *) "CustomScheduleRequested",
-    NULL,
+    (gchar *) "time",
+    (gchar *) "x",
     NULL
   },
-  "custom-schedule-requested"
+  FALSE
 };
 
-static const _ExtendedGDBusArgInfo _gawake_server_database_signal_info_status_ARG_returned_status =
+static const GDBusArgInfo * const _gawake_server_database_method_info_add_one_shot_IN_ARG_pointers[] =
+{
+  &_gawake_server_database_method_info_add_one_shot_IN_ARG_name.parent_struct,
+  &_gawake_server_database_method_info_add_one_shot_IN_ARG_time.parent_struct,
+  NULL
+};
+
+static const _ExtendedGDBusArgInfo _gawake_server_database_method_info_add_one_shot_OUT_ARG_id =
 {
   {
     -1,
-    (gchar *) "returned_status",
-    (gchar *) "y",
+    (gchar *) "id",
+    (gchar *) "x",
     NULL
   },
   FALSE
 };
 
-static const GDBusArgInfo * const _gawake_server_database_signal_info_status_ARG_pointers[] =
+static const GDBusArgInfo * const _gawake_server_database_method_info_add_one_shot_OUT_ARG_pointers[] =
 {
-  &_gawake_server_database_signal_info_status_ARG_returned_status.parent_struct,
+  &_gawake_server_database_method_info_add_one_shot_OUT_ARG_id.parent_struct,
   NULL
 };
 
-static const _ExtendedGDBusSignalInfo _gawake_server_database_signal_info_status =
+static const _ExtendedGDBusMethodInfo _gawake_server_database_method_info_add_one_shot =
 {
   {
     -1,
-    (gchar *) "Status",
-    (GDBusArgInfo **) &_gawake_server_database_signal_info_status_ARG_pointers,
+    (gchar *) "AddOneShot",
+    (GDBusArgInfo **) &_gawake_server_database_method_info_add_one_shot_IN_ARG_pointers,
+    (GDBusArgInfo **) &_gawake_server_database_method_info_add_one_shot_OUT_ARG_pointers,
     NULL
   },
-  "status"
+  "handle-add-one-shot",
+  FALSE
 };
 
-static const GDBusSignalInfo * const _gawake_server_database_signal_info_pointers[] =
+static const _ExtendedGDBusArgInfo _gawake_server_database_method_info_list_one_shots_OUT_ARG_one_shots =
 {
-  &_gawake_server_database_signal_info_database_updated.parent_struct,
-  &_gawake_server_database_signal_info_rule_canceled.parent_struct,
-  &_gawake_server_database_signal_info_schedule_requested.parent_struct,
-  &_gawake_server_database_signal_info_custom_schedule_requested.parent_struct,
-  &_gawake_server_database_signal_info_status.parent_struct,
+  {
+    -1,
+    (gchar *) "one_shots",
+    (gchar *) "a(xsx)",
+    NULL
+  },
+  FALSE
+};
+
+static const GDBusArgInfo * const _gawake_server_database_method_info_list_one_shots_OUT_ARG_pointers[] =
+{
+  &_gawake_server_database_method_info_list_one_shots_OUT_ARG_one_shots.parent_struct,
   NULL
 };
 
-static const _ExtendedGDBusInterfaceInfo _gawake_server_database_interface_info =
+static const _ExtendedGDBusMethodInfo _gawake_server_database_method_info_list_one_shots =
 {
   {
     -1,
-    (gchar *) "io.github.kelvinnovais.Database",
-    (GDBusMethodInfo **) &_gawake_server_database_method_info_pointers,
-    (GDBusSignalInfo **) &_gawake_server_database_signal_info_pointers,
+    (gchar *) "ListOneShots",
     NULL,
+    (GDBusArgInfo **) &_gawake_server_database_method_info_list_one_shots_OUT_ARG_pointers,
     NULL
   },
-  "database",
+  "handle-list-one-shots",
+  FALSE
 };
 
+static const _ExtendedGDBusArgInfo _gawake_server_database_method_info_remove_one_shot_IN_ARG_id =
+{
+  {
+    -1,
+    (gchar *) "id",
+    (gchar *) "x",
+    NULL
+  },
+  FALSE
+};
 
-/**
- * gawake_server_database_interface_info:
- *
- * Gets a machine-readable description of the <link linkend="gdbus-interface-io-github-kelvinnovais-Database.top_of_page">io.github.kelvinnovais.Database</link> D-Bus interface.
- *
- * Returns: (transfer none): A #GDBusInterfaceInfo. Do not free.
- */
-GDBusInterfaceInfo *
-gawake_server_database_interface_info (void)
+static const GDBusArgInfo * const _gawake_server_database_method_info_remove_one_shot_IN_ARG_pointers[] =
+{
+  &_gawake_server_database_method_info_remove_one_shot_IN_ARG_id.parent_struct,
+  NULL
+};
+
+static const _ExtendedGDBusMethodInfo _gawake_server_database_method_info_remove_one_shot =
+{
+  {
+    -1,
+    (gchar *) "RemoveOneShot",
+    (GDBusArgInfo **) &_gawake_server_database_method_info_remove_one_shot_IN_ARG_pointers,
+    NULL,
+    NULL
+  },
+  "handle-remove-one-shot",
+  FALSE
+};
+
+static const GDBusMethodInfo * const _gawake_server_database_method_info_pointers[] =
+{
+  &_gawake_server_database_method_info_update_database.parent_struct,
+  &_gawake_server_database_method_info_cancel_rule.parent_struct,
+  &_gawake_server_database_method_info_request_schedule.parent_struct,
+  &_gawake_server_database_method_info_request_custom_schedule.parent_struct,
+  &_gawake_server_database_method_info_return_status.parent_struct,
+  &_gawake_server_database_method_info_get_upcoming_events.parent_struct,
+  &_gawake_server_database_method_info_add_one_shot.parent_struct,
+  &_gawake_server_database_method_info_list_one_shots.parent_struct,
+  &_gawake_server_database_method_info_remove_one_shot.parent_struct,
+  NULL
+};
+
+static const _ExtendedGDBusArgInfo _gawake_server_database_signal_info_database_updated_ARG_changes =
+{
+  {
+    -1,
+    (gchar *) "changes",
+    (gchar *) "a(y(xsyyabbyy))",
+    NULL
+  },
+  FALSE
+};
+
+static const GDBusArgInfo * const _gawake_server_database_signal_info_database_updated_ARG_pointers[] =
+{
+  &_gawake_server_database_signal_info_database_updated_ARG_changes.parent_struct,
+  NULL
+};
+
+static const _ExtendedGDBusSignalInfo _gawake_server_database_signal_info_database_updated =
+{
+  {
+    -1,
+    (gchar *) "DatabaseUpdated",
+    (GDBusArgInfo **) &_gawake_server_database_signal_info_database_updated_ARG_pointers,
+    NULL
+  },
+  "database-updated"
+};
+
+static const _ExtendedGDBusSignalInfo _gawake_server_database_signal_info_rule_canceled =
+{
+  {
+    -1,
+    (gchar *) "RuleCanceled",
+    NULL,
+    NULL
+  },
+  "rule-canceled"
+};
+
+static const _ExtendedGDBusSignalInfo _gawake_server_database_signal_info_schedule_requested =
+{
+  {
+    -1,
+    (gchar *) "ScheduleRequested",
+    NULL,
+    NULL
+  },
+  "schedule-requested"
+};
+
+static const _ExtendedGDBusSignalInfo _gawake_server_database_signal_info_custom_schedule_requested =
+{
+  {
+    -1,
+    (gchar *) "CustomScheduleRequested",
+    NULL,
+    NULL
+  },
+  "custom-schedule-requested"
+};
+
+static const _ExtendedGDBusArgInfo _gawake_server_database_signal_info_status_ARG_returned_status =
+{
+  {
+    -1,
+    (gchar *) "returned_status",
+    (gchar *) "y",
+    NULL
+  },
+  FALSE
+};
+
+static const GDBusArgInfo * const _gawake_server_database_signal_info_status_ARG_pointers[] =
+{
+  &_gawake_server_database_signal_info_status_ARG_returned_status.parent_struct,
+  NULL
+};
+
+static const _ExtendedGDBusSignalInfo _gawake_server_database_signal_info_status =
+{
+  {
+    -1,
+    (gchar *) "Status",
+    (GDBusArgInfo **) &_gawake_server_database_signal_info_status_ARG_pointers,
+    NULL
+  },
+  "status"
+};
+
+static const GDBusSignalInfo * const _gawake_server_database_signal_info_pointers[] =
+{
+  &_gawake_server_database_signal_info_database_updated.parent_struct,
+  &_gawake_server_database_signal_info_rule_canceled.parent_struct,
+  &_gawake_server_database_signal_info_schedule_requested.parent_struct,
+  &_gawake_server_database_signal_info_custom_schedule_requested.parent_struct,
+  &_gawake_server_database_signal_info_status.parent_struct,
+  NULL
+};
+
+static const _ExtendedGDBusInterfaceInfo _gawake_server_database_interface_info =
+{
+  {
+    -1,
+    (gchar *) "io.github.kelvinnovais.Database",
+    (GDBusMethodInfo **) &_gawake_server_database_method_info_pointers,
+    (GDBusSignalInfo **) &_gawake_server_database_signal_info_pointers,
+    NULL,
+    NULL
+  },
+  "database",
+};
+
+
+/**
+ * gawake_server_database_interface_info:
+ *
+ * Gets a machine-readable description of the <link linkend="gdbus-interface-io-github-kelvinnovais-Database.top_of_page">io.github.kelvinnovais.Database</link> D-Bus interface.
+ *
+ * Returns: (transfer none): A #GDBusInterfaceInfo. Do not free.
+ */
+GDBusInterfaceInfo *
+gawake_server_database_interface_info (void)
 {
   return (GDBusInterfaceInfo *) &_gawake_server_database_interface_info.parent_struct;
 }
@@ -538,7 +924,7 @@ gawake_server_database_signal_marshal_database_updated (
     void         *invocation_hint,
     void         *marshal_data)
 {
-  g_cclosure_marshal_VOID__VOID (closure,
+  g_cclosure_marshal_VOID__VARIANT (closure,
     return_value, n_param_values, param_values, invocation_hint, marshal_data);
 }
 
@@ -603,7 +989,7 @@ gawake_server_database_method_marshal_update_database (
     void         *invocation_hint,
     void         *marshal_data)
 {
-  _g_dbus_codegen_marshal_BOOLEAN__OBJECT (closure,
+  _g_dbus_codegen_marshal_BOOLEAN__OBJECT_VARIANT (closure,
     return_value, n_param_values, param_values, invocation_hint, marshal_data);
 }
 
@@ -659,6 +1045,58 @@ gawake_server_database_method_marshal_return_status (
     return_value, n_param_values, param_values, invocation_hint, marshal_data);
 }
 
+inline static void
+gawake_server_database_method_marshal_get_upcoming_events (
+    GClosure     *closure,
+    GValue       *return_value,
+    unsigned int  n_param_values,
+    const GValue *param_values,
+    void         *invocation_hint,
+    void         *marshal_data)
+{
+  _g_dbus_codegen_marshal_BOOLEAN__OBJECT_UINT (closure,
+    return_value, n_param_values, param_values, invocation_hint, marshal_data);
+}
+
+inline static void
+gawake_server_database_method_marshal_add_one_shot (
+    GClosure     *closure,
+    GValue       *return_value,
+    unsigned int  n_param_values,
+    const GValue *param_values,
+    void         *invocation_hint,
+    void         *marshal_data)
+{
+  _g_dbus_codegen_marshal_BOOLEAN__OBJECT_STRING_INT64 (closure,
+    return_value, n_param_values, param_values, invocation_hint, marshal_data);
+}
+
+inline static void
+gawake_server_database_method_marshal_list_one_shots (
+    GClosure     *closure,
+    GValue       *return_value,
+    unsigned int  n_param_values,
+    const GValue *param_values,
+    void         *invocation_hint,
+    void         *marshal_data)
+{
+  _g_dbus_codegen_marshal_BOOLEAN__OBJECT (closure,
+    return_value, n_param_values, param_values, invocation_hint, marshal_data);
+}
+
+inline static void
+gawake_server_database_method_marshal_remove_one_shot (
+    GClosure     *closure,
+    GValue       *return_value,
+    unsigned int  n_param_values,
+    const GValue *param_values,
+    void         *invocation_hint,
+    void         *marshal_data)
+{
+  _g_dbus_codegen_marshal_BOOLEAN__OBJECT_INT64 (closure,
+    return_value, n_param_values, param_values, invocation_hint, marshal_data);
+}
+
 
 /**
  * GawakeServerDatabase:
@@ -669,7 +1107,11 @@ gawake_server_database_method_marshal_return_status (
 /**
  * GawakeServerDatabaseIface:
  * @parent_iface: The parent interface.
+ * @handle_add_one_shot: Handler for the #GawakeServerDatabase::handle-add-one-shot signal.
  * @handle_cancel_rule: Handler for the #GawakeServerDatabase::handle-cancel-rule signal.
+ * @handle_get_upcoming_events: Handler for the #GawakeServerDatabase::handle-get-upcoming-events signal.
+ * @handle_list_one_shots: Handler for the #GawakeServerDatabase::handle-list-one-shots signal.
+ * @handle_remove_one_shot: Handler for the #GawakeServerDatabase::handle-remove-one-shot signal.
  * @handle_request_custom_schedule: Handler for the #GawakeServerDatabase::handle-request-custom-schedule signal.
  * @handle_request_schedule: Handler for the #GawakeServerDatabase::handle-request-schedule signal.
  * @handle_return_status: Handler for the #GawakeServerDatabase::handle-return-status signal.
@@ -694,6 +1136,7 @@ gawake_server_database_default_init (GawakeServerDatabaseIface *iface)
    * GawakeServerDatabase::handle-update-database:
    * @object: A #GawakeServerDatabase.
    * @invocation: A #GDBusMethodInvocation.
+   * @arg_changes: Argument passed by remote caller.
    *
    * Signal emitted when a remote caller is invoking the <link linkend="gdbus-method-io-github-kelvinnovais-Database.UpdateDatabase">UpdateDatabase()</link> D-Bus method.
    *
@@ -709,8 +1152,8 @@ gawake_server_database_default_init (GawakeServerDatabaseIface *iface)
     NULL,
       gawake_server_database_method_marshal_update_database,
     G_TYPE_BOOLEAN,
-    1,
-    G_TYPE_DBUS_METHOD_INVOCATION);
+    2,
+    G_TYPE_DBUS_METHOD_INVOCATION, G_TYPE_VARIANT);
 
   /**
    * GawakeServerDatabase::handle-cancel-rule:
@@ -801,10 +1244,103 @@ gawake_server_database_default_init (GawakeServerDatabaseIface *iface)
     2,
     G_TYPE_DBUS_METHOD_INVOCATION, G_TYPE_UCHAR);
 
+  /**
+   * GawakeServerDatabase::handle-get-upcoming-events:
+   * @object: A #GawakeServerDatabase.
+   * @invocation: A #GDBusMethodInvocation.
+   * @arg_count: Argument passed by remote caller.
+   *
+   * Signal emitted when a remote caller is invoking the <link linkend="gdbus-method-io-github-kelvinnovais-Database.GetUpcomingEvents">GetUpcomingEvents()</link> D-Bus method.
+   *
+   * If a signal handler returns %TRUE, it means the signal handler will handle the invocation (e.g. take a reference to @invocation and eventually call gawake_server_database_complete_get_upcoming_events() or e.g. g_dbus_method_invocation_return_error() on it) and no other signal handlers will run. If no signal handler handles the invocation, the %G_DBUS_ERROR_UNKNOWN_METHOD error is returned.
+   *
+   * Returns: %G_DBUS_METHOD_INVOCATION_HANDLED or %TRUE if the invocation was handled, %G_DBUS_METHOD_INVOCATION_UNHANDLED or %FALSE to let other signal handlers run.
+   */
+  g_signal_new ("handle-get-upcoming-events",
+    G_TYPE_FROM_INTERFACE (iface),
+    G_SIGNAL_RUN_LAST,
+    G_STRUCT_OFFSET (GawakeServerDatabaseIface, handle_get_upcoming_events),
+    g_signal_accumulator_true_handled,
+    NULL,
+      gawake_server_database_method_marshal_get_upcoming_events,
+    G_TYPE_BOOLEAN,
+    2,
+    G_TYPE_DBUS_METHOD_INVOCATION, G_TYPE_UINT);
+
+  /**
+   * GawakeServerDatabase::handle-add-one-shot:
+   * @object: A #GawakeServerDatabase.
+   * @invocation: A #GDBusMethodInvocation.
+   * @arg_name: Argument passed by remote caller.
+   * @arg_time: Argument passed by remote caller.
+   *
+   * Signal emitted when a remote caller is invoking the <link linkend="gdbus-method-io-github-kelvinnovais-Database.AddOneShot">AddOneShot()</link> D-Bus method.
+   *
+   * If a signal handler returns %TRUE, it means the signal handler will handle the invocation (e.g. take a reference to @invocation and eventually call gawake_server_database_complete_add_one_shot() or e.g. g_dbus_method_invocation_return_error() on it) and no other signal handlers will run. If no signal handler handles the invocation, the %G_DBUS_ERROR_UNKNOWN_METHOD error is returned.
+   *
+   * Returns: %G_DBUS_METHOD_INVOCATION_HANDLED or %TRUE if the invocation was handled, %G_DBUS_METHOD_INVOCATION_UNHANDLED or %FALSE to let other signal handlers run.
+   */
+  g_signal_new ("handle-add-one-shot",
+    G_TYPE_FROM_INTERFACE (iface),
+    G_SIGNAL_RUN_LAST,
+    G_STRUCT_OFFSET (GawakeServerDatabaseIface, handle_add_one_shot),
+    g_signal_accumulator_true_handled,
+    NULL,
+      gawake_server_database_method_marshal_add_one_shot,
+    G_TYPE_BOOLEAN,
+    3,
+    G_TYPE_DBUS_METHOD_INVOCATION, G_TYPE_STRING, G_TYPE_INT64);
+
+  /**
+   * GawakeServerDatabase::handle-list-one-shots:
+   * @object: A #GawakeServerDatabase.
+   * @invocation: A #GDBusMethodInvocation.
+   *
+   * Signal emitted when a remote caller is invoking the <link linkend="gdbus-method-io-github-kelvinnovais-Database.ListOneShots">ListOneShots()</link> D-Bus method.
+   *
+   * If a signal handler returns %TRUE, it means the signal handler will handle the invocation (e.g. take a reference to @invocation and eventually call gawake_server_database_complete_list_one_shots() or e.g. g_dbus_method_invocation_return_error() on it) and no other signal handlers will run. If no signal handler handles the invocation, the %G_DBUS_ERROR_UNKNOWN_METHOD error is returned.
+   *
+   * Returns: %G_DBUS_METHOD_INVOCATION_HANDLED or %TRUE if the invocation was handled, %G_DBUS_METHOD_INVOCATION_UNHANDLED or %FALSE to let other signal handlers run.
+   */
+  g_signal_new ("handle-list-one-shots",
+    G_TYPE_FROM_INTERFACE (iface),
+    G_SIGNAL_RUN_LAST,
+    G_STRUCT_OFFSET (GawakeServerDatabaseIface, handle_list_one_shots),
+    g_signal_accumulator_true_handled,
+    NULL,
+      gawake_server_database_method_marshal_list_one_shots,
+    G_TYPE_BOOLEAN,
+    1,
+    G_TYPE_DBUS_METHOD_INVOCATION);
+
+  /**
+   * GawakeServerDatabase::handle-remove-one-shot:
+   * @object: A #GawakeServerDatabase.
+   * @invocation: A #GDBusMethodInvocation.
+   * @arg_id: Argument passed by remote caller.
+   *
+   * Signal emitted when a remote caller is invoking the <link linkend="gdbus-method-io-github-kelvinnovais-Database.RemoveOneShot">RemoveOneShot()</link> D-Bus method.
+   *
+   * If a signal handler returns %TRUE, it means the signal handler will handle the invocation (e.g. take a reference to @invocation and eventually call gawake_server_database_complete_remove_one_shot() or e.g. g_dbus_method_invocation_return_error() on it) and no other signal handlers will run. If no signal handler handles the invocation, the %G_DBUS_ERROR_UNKNOWN_METHOD error is returned.
+   *
+   * Returns: %G_DBUS_METHOD_INVOCATION_HANDLED or %TRUE if the invocation was handled, %G_DBUS_METHOD_INVOCATION_UNHANDLED or %FALSE to let other signal handlers run.
+   */
+  g_signal_new ("handle-remove-one-shot",
+    G_TYPE_FROM_INTERFACE (iface),
+    G_SIGNAL_RUN_LAST,
+    G_STRUCT_OFFSET (GawakeServerDatabaseIface, handle_remove_one_shot),
+    g_signal_accumulator_true_handled,
+    NULL,
+      gawake_server_database_method_marshal_remove_one_shot,
+    G_TYPE_BOOLEAN,
+    2,
+    G_TYPE_DBUS_METHOD_INVOCATION, G_TYPE_INT64);
+
   /* GObject signals for received D-Bus signals: */
   /**
    * GawakeServerDatabase::database-updated:
    * @object: A #GawakeServerDatabase.
+   * @arg_changes: Argument.
    *
    * On the client-side, this signal is emitted whenever the D-Bus signal <link linkend="gdbus-signal-io-github-kelvinnovais-Database.DatabaseUpdated">"DatabaseUpdated"</link> is received.
    *
@@ -819,7 +1355,7 @@ gawake_server_database_default_init (GawakeServerDatabaseIface *iface)
       NULL,
       gawake_server_database_signal_marshal_database_updated,
       G_TYPE_NONE,
-      0);
+      1, G_TYPE_VARIANT);
 
   /**
    * GawakeServerDatabase::rule-canceled:
@@ -903,14 +1439,16 @@ gawake_server_database_default_init (GawakeServerDatabaseIface *iface)
 /**
  * gawake_server_database_emit_database_updated:
  * @object: A #GawakeServerDatabase.
+ * @arg_changes: Argument to pass with the signal.
  *
  * Emits the <link linkend="gdbus-signal-io-github-kelvinnovais-Database.DatabaseUpdated">"DatabaseUpdated"</link> D-Bus signal.
  */
 void
 gawake_server_database_emit_database_updated (
-    GawakeServerDatabase *object)
+    GawakeServerDatabase *object,
+    GVariant *arg_changes)
 {
-  g_signal_emit (object, GAWAKE_SERVER__DATABASE_SIGNALS[GAWAKE_SERVER__DATABASE_DATABASE_UPDATED], 0);
+  g_signal_emit (object, GAWAKE_SERVER__DATABASE_SIGNALS[GAWAKE_SERVER__DATABASE_DATABASE_UPDATED], 0, arg_changes);
 }
 
 /**
@@ -936,60 +1474,437 @@ void
 gawake_server_database_emit_schedule_requested (
     GawakeServerDatabase *object)
 {
-  g_signal_emit (object, GAWAKE_SERVER__DATABASE_SIGNALS[GAWAKE_SERVER__DATABASE_SCHEDULE_REQUESTED], 0);
+  g_signal_emit (object, GAWAKE_SERVER__DATABASE_SIGNALS[GAWAKE_SERVER__DATABASE_SCHEDULE_REQUESTED], 0);
+}
+
+/**
+ * gawake_server_database_emit_custom_schedule_requested:
+ * @object: A #GawakeServerDatabase.
+ *
+ * Emits the <link linkend="gdbus-signal-io-github-kelvinnovais-Database.CustomScheduleRequested">"CustomScheduleRequested"</link> D-Bus signal.
+ */
+void
+gawake_server_database_emit_custom_schedule_requested (
+    GawakeServerDatabase *object)
+{
+  g_signal_emit (object, GAWAKE_SERVER__DATABASE_SIGNALS[GAWAKE_SERVER__DATABASE_CUSTOM_SCHEDULE_REQUESTED], 0);
+}
+
+/**
+ * gawake_server_database_emit_status:
+ * @object: A #GawakeServerDatabase.
+ * @arg_returned_status: Argument to pass with the signal.
+ *
+ * Emits the <link linkend="gdbus-signal-io-github-kelvinnovais-Database.Status">"Status"</link> D-Bus signal.
+ */
+void
+gawake_server_database_emit_status (
+    GawakeServerDatabase *object,
+    guchar arg_returned_status)
+{
+  g_signal_emit (object, GAWAKE_SERVER__DATABASE_SIGNALS[GAWAKE_SERVER__DATABASE_STATUS], 0, arg_returned_status);
+}
+
+/**
+ * gawake_server_database_call_update_database:
+ * @proxy: A #GawakeServerDatabaseProxy.
+ * @arg_changes: Argument to pass with the method invocation.
+ * @cancellable: (nullable): A #GCancellable or %NULL.
+ * @callback: A #GAsyncReadyCallback to call when the request is satisfied or %NULL.
+ * @user_data: User data to pass to @callback.
+ *
+ * Asynchronously invokes the <link linkend="gdbus-method-io-github-kelvinnovais-Database.UpdateDatabase">UpdateDatabase()</link> D-Bus method on @proxy.
+ * When the operation is finished, @callback will be invoked in the thread-default main loop of the thread you are calling this method from (see g_main_context_push_thread_default()).
+ * You can then call gawake_server_database_call_update_database_finish() to get the result of the operation.
+ *
+ * See gawake_server_database_call_update_database_sync() for the synchronous, blocking version of this method.
+ */
+void
+gawake_server_database_call_update_database (
+    GawakeServerDatabase *proxy,
+    GVariant *arg_changes,
+    GCancellable *cancellable,
+    GAsyncReadyCallback callback,
+    gpointer user_data)
+{
+  g_dbus_proxy_call (G_DBUS_PROXY (proxy),
+    "UpdateDatabase",
+    g_variant_new ("(@a(y(xsyyabbyy)))",
+                   arg_changes),
+    G_DBUS_CALL_FLAGS_NONE,
+    -1,
+    cancellable,
+    callback,
+    user_data);
+}
+
+/**
+ * gawake_server_database_call_update_database_finish:
+ * @proxy: A #GawakeServerDatabaseProxy.
+ * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to gawake_server_database_call_update_database().
+ * @error: Return location for error or %NULL.
+ *
+ * Finishes an operation started with gawake_server_database_call_update_database().
+ *
+ * Returns: (skip): %TRUE if the call succeeded, %FALSE if @error is set.
+ */
+gboolean
+gawake_server_database_call_update_database_finish (
+    GawakeServerDatabase *proxy,
+    GAsyncResult *res,
+    GError **error)
+{
+  GVariant *_ret;
+  _ret = g_dbus_proxy_call_finish (G_DBUS_PROXY (proxy), res, error);
+  if (_ret == NULL)
+    goto _out;
+  g_variant_get (_ret,
+                 "()");
+  g_variant_unref (_ret);
+_out:
+  return _ret != NULL;
+}
+
+/**
+ * gawake_server_database_call_update_database_sync:
+ * @proxy: A #GawakeServerDatabaseProxy.
+ * @arg_changes: Argument to pass with the method invocation.
+ * @cancellable: (nullable): A #GCancellable or %NULL.
+ * @error: Return location for error or %NULL.
+ *
+ * Synchronously invokes the <link linkend="gdbus-method-io-github-kelvinnovais-Database.UpdateDatabase">UpdateDatabase()</link> D-Bus method on @proxy. The calling thread is blocked until a reply is received.
+ *
+ * See gawake_server_database_call_update_database() for the asynchronous version of this method.
+ *
+ * Returns: (skip): %TRUE if the call succeeded, %FALSE if @error is set.
+ */
+gboolean
+gawake_server_database_call_update_database_sync (
+    GawakeServerDatabase *proxy,
+    GVariant *arg_changes,
+    GCancellable *cancellable,
+    GError **error)
+{
+  GVariant *_ret;
+  _ret = g_dbus_proxy_call_sync (G_DBUS_PROXY (proxy),
+    "UpdateDatabase",
+    g_variant_new ("(@a(y(xsyyabbyy)))",
+                   arg_changes),
+    G_DBUS_CALL_FLAGS_NONE,
+    -1,
+    cancellable,
+    error);
+  if (_ret == NULL)
+    goto _out;
+  g_variant_get (_ret,
+                 "()");
+  g_variant_unref (_ret);
+_out:
+  return _ret != NULL;
+}
+
+/**
+ * gawake_server_database_call_cancel_rule:
+ * @proxy: A #GawakeServerDatabaseProxy.
+ * @cancellable: (nullable): A #GCancellable or %NULL.
+ * @callback: A #GAsyncReadyCallback to call when the request is satisfied or %NULL.
+ * @user_data: User data to pass to @callback.
+ *
+ * Asynchronously invokes the <link linkend="gdbus-method-io-github-kelvinnovais-Database.CancelRule">CancelRule()</link> D-Bus method on @proxy.
+ * When the operation is finished, @callback will be invoked in the thread-default main loop of the thread you are calling this method from (see g_main_context_push_thread_default()).
+ * You can then call gawake_server_database_call_cancel_rule_finish() to get the result of the operation.
+ *
+ * See gawake_server_database_call_cancel_rule_sync() for the synchronous, blocking version of this method.
+ */
+void
+gawake_server_database_call_cancel_rule (
+    GawakeServerDatabase *proxy,
+    GCancellable *cancellable,
+    GAsyncReadyCallback callback,
+    gpointer user_data)
+{
+  g_dbus_proxy_call (G_DBUS_PROXY (proxy),
+    "CancelRule",
+    g_variant_new ("()"),
+    G_DBUS_CALL_FLAGS_NONE,
+    -1,
+    cancellable,
+    callback,
+    user_data);
+}
+
+/**
+ * gawake_server_database_call_cancel_rule_finish:
+ * @proxy: A #GawakeServerDatabaseProxy.
+ * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to gawake_server_database_call_cancel_rule().
+ * @error: Return location for error or %NULL.
+ *
+ * Finishes an operation started with gawake_server_database_call_cancel_rule().
+ *
+ * Returns: (skip): %TRUE if the call succeeded, %FALSE if @error is set.
+ */
+gboolean
+gawake_server_database_call_cancel_rule_finish (
+    GawakeServerDatabase *proxy,
+    GAsyncResult *res,
+    GError **error)
+{
+  GVariant *_ret;
+  _ret = g_dbus_proxy_call_finish (G_DBUS_PROXY (proxy), res, error);
+  if (_ret == NULL)
+    goto _out;
+  g_variant_get (_ret,
+                 "()");
+  g_variant_unref (_ret);
+_out:
+  return _ret != NULL;
+}
+
+/**
+ * gawake_server_database_call_cancel_rule_sync:
+ * @proxy: A #GawakeServerDatabaseProxy.
+ * @cancellable: (nullable): A #GCancellable or %NULL.
+ * @error: Return location for error or %NULL.
+ *
+ * Synchronously invokes the <link linkend="gdbus-method-io-github-kelvinnovais-Database.CancelRule">CancelRule()</link> D-Bus method on @proxy. The calling thread is blocked until a reply is received.
+ *
+ * See gawake_server_database_call_cancel_rule() for the asynchronous version of this method.
+ *
+ * Returns: (skip): %TRUE if the call succeeded, %FALSE if @error is set.
+ */
+gboolean
+gawake_server_database_call_cancel_rule_sync (
+    GawakeServerDatabase *proxy,
+    GCancellable *cancellable,
+    GError **error)
+{
+  GVariant *_ret;
+  _ret = g_dbus_proxy_call_sync (G_DBUS_PROXY (proxy),
+    "CancelRule",
+    g_variant_new ("()"),
+    G_DBUS_CALL_FLAGS_NONE,
+    -1,
+    cancellable,
+    error);
+  if (_ret == NULL)
+    goto _out;
+  g_variant_get (_ret,
+                 "()");
+  g_variant_unref (_ret);
+_out:
+  return _ret != NULL;
+}
+
+/**
+ * gawake_server_database_call_request_schedule:
+ * @proxy: A #GawakeServerDatabaseProxy.
+ * @cancellable: (nullable): A #GCancellable or %NULL.
+ * @callback: A #GAsyncReadyCallback to call when the request is satisfied or %NULL.
+ * @user_data: User data to pass to @callback.
+ *
+ * Asynchronously invokes the <link linkend="gdbus-method-io-github-kelvinnovais-Database.RequestSchedule">RequestSchedule()</link> D-Bus method on @proxy.
+ * When the operation is finished, @callback will be invoked in the thread-default main loop of the thread you are calling this method from (see g_main_context_push_thread_default()).
+ * You can then call gawake_server_database_call_request_schedule_finish() to get the result of the operation.
+ *
+ * See gawake_server_database_call_request_schedule_sync() for the synchronous, blocking version of this method.
+ */
+void
+gawake_server_database_call_request_schedule (
+    GawakeServerDatabase *proxy,
+    GCancellable *cancellable,
+    GAsyncReadyCallback callback,
+    gpointer user_data)
+{
+  g_dbus_proxy_call (G_DBUS_PROXY (proxy),
+    "RequestSchedule",
+    g_variant_new ("()"),
+    G_DBUS_CALL_FLAGS_NONE,
+    -1,
+    cancellable,
+    callback,
+    user_data);
+}
+
+/**
+ * gawake_server_database_call_request_schedule_finish:
+ * @proxy: A #GawakeServerDatabaseProxy.
+ * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to gawake_server_database_call_request_schedule().
+ * @error: Return location for error or %NULL.
+ *
+ * Finishes an operation started with gawake_server_database_call_request_schedule().
+ *
+ * Returns: (skip): %TRUE if the call succeeded, %FALSE if @error is set.
+ */
+gboolean
+gawake_server_database_call_request_schedule_finish (
+    GawakeServerDatabase *proxy,
+    GAsyncResult *res,
+    GError **error)
+{
+  GVariant *_ret;
+  _ret = g_dbus_proxy_call_finish (G_DBUS_PROXY (proxy), res, error);
+  if (_ret == NULL)
+    goto _out;
+  g_variant_get (_ret,
+                 "()");
+  g_variant_unref (_ret);
+_out:
+  return _ret != NULL;
+}
+
+/**
+ * gawake_server_database_call_request_schedule_sync:
+ * @proxy: A #GawakeServerDatabaseProxy.
+ * @cancellable: (nullable): A #GCancellable or %NULL.
+ * @error: Return location for error or %NULL.
+ *
+ * Synchronously invokes the <link linkend="gdbus-method-io-github-kelvinnovais-Database.RequestSchedule">RequestSchedule()</link> D-Bus method on @proxy. The calling thread is blocked until a reply is received.
+ *
+ * See gawake_server_database_call_request_schedule() for the asynchronous version of this method.
+ *
+ * Returns: (skip): %TRUE if the call succeeded, %FALSE if @error is set.
+ */
+gboolean
+gawake_server_database_call_request_schedule_sync (
+    GawakeServerDatabase *proxy,
+    GCancellable *cancellable,
+    GError **error)
+{
+  GVariant *_ret;
+  _ret = g_dbus_proxy_call_sync (G_DBUS_PROXY (proxy),
+    "RequestSchedule",
+    g_variant_new ("()"),
+    G_DBUS_CALL_FLAGS_NONE,
+    -1,
+    cancellable,
+    error);
+  if (_ret == NULL)
+    goto _out;
+  g_variant_get (_ret,
+                 "()");
+  g_variant_unref (_ret);
+_out:
+  return _ret != NULL;
+}
+
+/**
+ * gawake_server_database_call_request_custom_schedule:
+ * @proxy: A #GawakeServerDatabaseProxy.
+ * @cancellable: (nullable): A #GCancellable or %NULL.
+ * @callback: A #GAsyncReadyCallback to call when the request is satisfied or %NULL.
+ * @user_data: User data to pass to @callback.
+ *
+ * Asynchronously invokes the <link linkend="gdbus-method-io-github-kelvinnovais-Database.RequestCustomSchedule">RequestCustomSchedule()</link> D-Bus method on @proxy.
+ * When the operation is finished, @callback will be invoked in the thread-default main loop of the thread you are calling this method from (see g_main_context_push_thread_default()).
+ * You can then call gawake_server_database_call_request_custom_schedule_finish() to get the result of the operation.
+ *
+ * See gawake_server_database_call_request_custom_schedule_sync() for the synchronous, blocking version of this method.
+ */
+void
+gawake_server_database_call_request_custom_schedule (
+    GawakeServerDatabase *proxy,
+    GCancellable *cancellable,
+    GAsyncReadyCallback callback,
+    gpointer user_data)
+{
+  g_dbus_proxy_call (G_DBUS_PROXY (proxy),
+    "RequestCustomSchedule",
+    g_variant_new ("()"),
+    G_DBUS_CALL_FLAGS_NONE,
+    -1,
+    cancellable,
+    callback,
+    user_data);
 }
 
 /**
- * gawake_server_database_emit_custom_schedule_requested:
- * @object: A #GawakeServerDatabase.
+ * gawake_server_database_call_request_custom_schedule_finish:
+ * @proxy: A #GawakeServerDatabaseProxy.
+ * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to gawake_server_database_call_request_custom_schedule().
+ * @error: Return location for error or %NULL.
  *
- * Emits the <link linkend="gdbus-signal-io-github-kelvinnovais-Database.CustomScheduleRequested">"CustomScheduleRequested"</link> D-Bus signal.
+ * Finishes an operation started with gawake_server_database_call_request_custom_schedule().
+ *
+ * Returns: (skip): %TRUE if the call succeeded, %FALSE if @error is set.
  */
-void
-gawake_server_database_emit_custom_schedule_requested (
-    GawakeServerDatabase *object)
+gboolean
+gawake_server_database_call_request_custom_schedule_finish (
+    GawakeServerDatabase *proxy,
+    GAsyncResult *res,
+    GError **error)
 {
-  g_signal_emit (object, GAWAKE_SERVER__DATABASE_SIGNALS[GAWAKE_SERVER__DATABASE_CUSTOM_SCHEDULE_REQUESTED], 0);
+  GVariant *_ret;
+  _ret = g_dbus_proxy_call_finish (G_DBUS_PROXY (proxy), res, error);
+  if (_ret == NULL)
+    goto _out;
+  g_variant_get (_ret,
+                 "()");
+  g_variant_unref (_ret);
+_out:
+  return _ret != NULL;
 }
 
 /**
- * gawake_server_database_emit_status:
- * @object: A #GawakeServerDatabase.
- * @arg_returned_status: Argument to pass with the signal.
+ * gawake_server_database_call_request_custom_schedule_sync:
+ * @proxy: A #GawakeServerDatabaseProxy.
+ * @cancellable: (nullable): A #GCancellable or %NULL.
+ * @error: Return location for error or %NULL.
  *
- * Emits the <link linkend="gdbus-signal-io-github-kelvinnovais-Database.Status">"Status"</link> D-Bus signal.
+ * Synchronously invokes the <link linkend="gdbus-method-io-github-kelvinnovais-Database.RequestCustomSchedule">RequestCustomSchedule()</link> D-Bus method on @proxy. The calling thread is blocked until a reply is received.
+ *
+ * See gawake_server_database_call_request_custom_schedule() for the asynchronous version of this method.
+ *
+ * Returns: (skip): %TRUE if the call succeeded, %FALSE if @error is set.
  */
-void
-gawake_server_database_emit_status (
-    GawakeServerDatabase *object,
-    guchar arg_returned_status)
+gboolean
+gawake_server_database_call_request_custom_schedule_sync (
+    GawakeServerDatabase *proxy,
+    GCancellable *cancellable,
+    GError **error)
 {
-  g_signal_emit (object, GAWAKE_SERVER__DATABASE_SIGNALS[GAWAKE_SERVER__DATABASE_STATUS], 0, arg_returned_status);
+  GVariant *_ret;
+  _ret = g_dbus_proxy_call_sync (G_DBUS_PROXY (proxy),
+    "RequestCustomSchedule",
+    g_variant_new ("()"),
+    G_DBUS_CALL_FLAGS_NONE,
+    -1,
+    cancellable,
+    error);
+  if (_ret == NULL)
+    goto _out;
+  g_variant_get (_ret,
+                 "()");
+  g_variant_unref (_ret);
+_out:
+  return _ret != NULL;
 }
 
 /**
- * gawake_server_database_call_update_database:
+ * gawake_server_database_call_return_status:
  * @proxy: A #GawakeServerDatabaseProxy.
+ * @arg_status: Argument to pass with the method invocation.
  * @cancellable: (nullable): A #GCancellable or %NULL.
  * @callback: A #GAsyncReadyCallback to call when the request is satisfied or %NULL.
  * @user_data: User data to pass to @callback.
  *
- * Asynchronously invokes the <link linkend="gdbus-method-io-github-kelvinnovais-Database.UpdateDatabase">UpdateDatabase()</link> D-Bus method on @proxy.
+ * Asynchronously invokes the <link linkend="gdbus-method-io-github-kelvinnovais-Database.ReturnStatus">ReturnStatus()</link> D-Bus method on @proxy.
  * When the operation is finished, @callback will be invoked in the thread-default main loop of the thread you are calling this method from (see g_main_context_push_thread_default()).
- * You can then call gawake_server_database_call_update_database_finish() to get the result of the operation.
+ * You can then call gawake_server_database_call_return_status_finish() to get the result of the operation.
  *
- * See gawake_server_database_call_update_database_sync() for the synchronous, blocking version of this method.
+ * See gawake_server_database_call_return_status_sync() for the synchronous, blocking version of this method.
  */
 void
-gawake_server_database_call_update_database (
+gawake_server_database_call_return_status (
     GawakeServerDatabase *proxy,
+    guchar arg_status,
     GCancellable *cancellable,
     GAsyncReadyCallback callback,
     gpointer user_data)
 {
   g_dbus_proxy_call (G_DBUS_PROXY (proxy),
-    "UpdateDatabase",
-    g_variant_new ("()"),
+    "ReturnStatus",
+    g_variant_new ("(y)",
+                   arg_status),
     G_DBUS_CALL_FLAGS_NONE,
     -1,
     cancellable,
@@ -998,17 +1913,17 @@ gawake_server_database_call_update_database (
 }
 
 /**
- * gawake_server_database_call_update_database_finish:
+ * gawake_server_database_call_return_status_finish:
  * @proxy: A #GawakeServerDatabaseProxy.
- * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to gawake_server_database_call_update_database().
+ * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to gawake_server_database_call_return_status().
  * @error: Return location for error or %NULL.
  *
- * Finishes an operation started with gawake_server_database_call_update_database().
+ * Finishes an operation started with gawake_server_database_call_return_status().
  *
  * Returns: (skip): %TRUE if the call succeeded, %FALSE if @error is set.
  */
 gboolean
-gawake_server_database_call_update_database_finish (
+gawake_server_database_call_return_status_finish (
     GawakeServerDatabase *proxy,
     GAsyncResult *res,
     GError **error)
@@ -1025,27 +1940,30 @@ _out:
 }
 
 /**
- * gawake_server_database_call_update_database_sync:
+ * gawake_server_database_call_return_status_sync:
  * @proxy: A #GawakeServerDatabaseProxy.
+ * @arg_status: Argument to pass with the method invocation.
  * @cancellable: (nullable): A #GCancellable or %NULL.
  * @error: Return location for error or %NULL.
  *
- * Synchronously invokes the <link linkend="gdbus-method-io-github-kelvinnovais-Database.UpdateDatabase">UpdateDatabase()</link> D-Bus method on @proxy. The calling thread is blocked until a reply is received.
+ * Synchronously invokes the <link linkend="gdbus-method-io-github-kelvinnovais-Database.ReturnStatus">ReturnStatus()</link> D-Bus method on @proxy. The calling thread is blocked until a reply is received.
  *
- * See gawake_server_database_call_update_database() for the asynchronous version of this method.
+ * See gawake_server_database_call_return_status() for the asynchronous version of this method.
  *
  * Returns: (skip): %TRUE if the call succeeded, %FALSE if @error is set.
  */
 gboolean
-gawake_server_database_call_update_database_sync (
+gawake_server_database_call_return_status_sync (
     GawakeServerDatabase *proxy,
+    guchar arg_status,
     GCancellable *cancellable,
     GError **error)
 {
   GVariant *_ret;
   _ret = g_dbus_proxy_call_sync (G_DBUS_PROXY (proxy),
-    "UpdateDatabase",
-    g_variant_new ("()"),
+    "ReturnStatus",
+    g_variant_new ("(y)",
+                   arg_status),
     G_DBUS_CALL_FLAGS_NONE,
     -1,
     cancellable,
@@ -1060,28 +1978,31 @@ _out:
 }
 
 /**
- * gawake_server_database_call_cancel_rule:
+ * gawake_server_database_call_get_upcoming_events:
  * @proxy: A #GawakeServerDatabaseProxy.
+ * @arg_count: Argument to pass with the method invocation.
  * @cancellable: (nullable): A #GCancellable or %NULL.
  * @callback: A #GAsyncReadyCallback to call when the request is satisfied or %NULL.
  * @user_data: User data to pass to @callback.
  *
- * Asynchronously invokes the <link linkend="gdbus-method-io-github-kelvinnovais-Database.CancelRule">CancelRule()</link> D-Bus method on @proxy.
+ * Asynchronously invokes the <link linkend="gdbus-method-io-github-kelvinnovais-Database.GetUpcomingEvents">GetUpcomingEvents()</link> D-Bus method on @proxy.
  * When the operation is finished, @callback will be invoked in the thread-default main loop of the thread you are calling this method from (see g_main_context_push_thread_default()).
- * You can then call gawake_server_database_call_cancel_rule_finish() to get the result of the operation.
+ * You can then call gawake_server_database_call_get_upcoming_events_finish() to get the result of the operation.
  *
- * See gawake_server_database_call_cancel_rule_sync() for the synchronous, blocking version of this method.
+ * See gawake_server_database_call_get_upcoming_events_sync() for the synchronous, blocking version of this method.
  */
 void
-gawake_server_database_call_cancel_rule (
+gawake_server_database_call_get_upcoming_events (
     GawakeServerDatabase *proxy,
+    guint arg_count,
     GCancellable *cancellable,
     GAsyncReadyCallback callback,
     gpointer user_data)
 {
   g_dbus_proxy_call (G_DBUS_PROXY (proxy),
-    "CancelRule",
-    g_variant_new ("()"),
+    "GetUpcomingEvents",
+    g_variant_new ("(u)",
+                   arg_count),
     G_DBUS_CALL_FLAGS_NONE,
     -1,
     cancellable,
@@ -1090,18 +2011,20 @@ gawake_server_database_call_cancel_rule (
 }
 
 /**
- * gawake_server_database_call_cancel_rule_finish:
+ * gawake_server_database_call_get_upcoming_events_finish:
  * @proxy: A #GawakeServerDatabaseProxy.
- * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to gawake_server_database_call_cancel_rule().
+ * @out_events: (out) (optional): Return location for return parameter or %NULL to ignore.
+ * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to gawake_server_database_call_get_upcoming_events().
  * @error: Return location for error or %NULL.
  *
- * Finishes an operation started with gawake_server_database_call_cancel_rule().
+ * Finishes an operation started with gawake_server_database_call_get_upcoming_events().
  *
  * Returns: (skip): %TRUE if the call succeeded, %FALSE if @error is set.
  */
 gboolean
-gawake_server_database_call_cancel_rule_finish (
+gawake_server_database_call_get_upcoming_events_finish (
     GawakeServerDatabase *proxy,
+    GVariant **out_events,
     GAsyncResult *res,
     GError **error)
 {
@@ -1110,34 +2033,40 @@ gawake_server_database_call_cancel_rule_finish (
   if (_ret == NULL)
     goto _out;
   g_variant_get (_ret,
-                 "()");
+                 "(@a(xyxy))",
+                 out_events);
   g_variant_unref (_ret);
 _out:
   return _ret != NULL;
 }
 
 /**
- * gawake_server_database_call_cancel_rule_sync:
+ * gawake_server_database_call_get_upcoming_events_sync:
  * @proxy: A #GawakeServerDatabaseProxy.
+ * @arg_count: Argument to pass with the method invocation.
+ * @out_events: (out) (optional): Return location for return parameter or %NULL to ignore.
  * @cancellable: (nullable): A #GCancellable or %NULL.
  * @error: Return location for error or %NULL.
  *
- * Synchronously invokes the <link linkend="gdbus-method-io-github-kelvinnovais-Database.CancelRule">CancelRule()</link> D-Bus method on @proxy. The calling thread is blocked until a reply is received.
+ * Synchronously invokes the <link linkend="gdbus-method-io-github-kelvinnovais-Database.GetUpcomingEvents">GetUpcomingEvents()</link> D-Bus method on @proxy. The calling thread is blocked until a reply is received.
  *
- * See gawake_server_database_call_cancel_rule() for the asynchronous version of this method.
+ * See gawake_server_database_call_get_upcoming_events() for the asynchronous version of this method.
  *
  * Returns: (skip): %TRUE if the call succeeded, %FALSE if @error is set.
  */
 gboolean
-gawake_server_database_call_cancel_rule_sync (
+gawake_server_database_call_get_upcoming_events_sync (
     GawakeServerDatabase *proxy,
+    guint arg_count,
+    GVariant **out_events,
     GCancellable *cancellable,
     GError **error)
 {
   GVariant *_ret;
   _ret = g_dbus_proxy_call_sync (G_DBUS_PROXY (proxy),
-    "CancelRule",
-    g_variant_new ("()"),
+    "GetUpcomingEvents",
+    g_variant_new ("(u)",
+                   arg_count),
     G_DBUS_CALL_FLAGS_NONE,
     -1,
     cancellable,
@@ -1145,35 +2074,42 @@ gawake_server_database_call_cancel_rule_sync (
   if (_ret == NULL)
     goto _out;
   g_variant_get (_ret,
-                 "()");
+                 "(@a(xyxy))",
+                 out_events);
   g_variant_unref (_ret);
 _out:
   return _ret != NULL;
 }
 
 /**
- * gawake_server_database_call_request_schedule:
+ * gawake_server_database_call_add_one_shot:
  * @proxy: A #GawakeServerDatabaseProxy.
+ * @arg_name: Argument to pass with the method invocation.
+ * @arg_time: Argument to pass with the method invocation.
  * @cancellable: (nullable): A #GCancellable or %NULL.
  * @callback: A #GAsyncReadyCallback to call when the request is satisfied or %NULL.
  * @user_data: User data to pass to @callback.
  *
- * Asynchronously invokes the <link linkend="gdbus-method-io-github-kelvinnovais-Database.RequestSchedule">RequestSchedule()</link> D-Bus method on @proxy.
+ * Asynchronously invokes the <link linkend="gdbus-method-io-github-kelvinnovais-Database.AddOneShot">AddOneShot()</link> D-Bus method on @proxy.
  * When the operation is finished, @callback will be invoked in the thread-default main loop of the thread you are calling this method from (see g_main_context_push_thread_default()).
- * You can then call gawake_server_database_call_request_schedule_finish() to get the result of the operation.
+ * You can then call gawake_server_database_call_add_one_shot_finish() to get the result of the operation.
  *
- * See gawake_server_database_call_request_schedule_sync() for the synchronous, blocking version of this method.
+ * See gawake_server_database_call_add_one_shot_sync() for the synchronous, blocking version of this method.
  */
 void
-gawake_server_database_call_request_schedule (
+gawake_server_database_call_add_one_shot (
     GawakeServerDatabase *proxy,
+    const gchar *arg_name,
+    gint64 arg_time,
     GCancellable *cancellable,
     GAsyncReadyCallback callback,
     gpointer user_data)
 {
   g_dbus_proxy_call (G_DBUS_PROXY (proxy),
-    "RequestSchedule",
-    g_variant_new ("()"),
+    "AddOneShot",
+    g_variant_new ("(sx)",
+                   arg_name,
+                   arg_time),
     G_DBUS_CALL_FLAGS_NONE,
     -1,
     cancellable,
@@ -1182,18 +2118,20 @@ gawake_server_database_call_request_schedule (
 }
 
 /**
- * gawake_server_database_call_request_schedule_finish:
+ * gawake_server_database_call_add_one_shot_finish:
  * @proxy: A #GawakeServerDatabaseProxy.
- * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to gawake_server_database_call_request_schedule().
+ * @out_id: (out) (optional): Return location for return parameter or %NULL to ignore.
+ * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to gawake_server_database_call_add_one_shot().
  * @error: Return location for error or %NULL.
  *
- * Finishes an operation started with gawake_server_database_call_request_schedule().
+ * Finishes an operation started with gawake_server_database_call_add_one_shot().
  *
  * Returns: (skip): %TRUE if the call succeeded, %FALSE if @error is set.
  */
 gboolean
-gawake_server_database_call_request_schedule_finish (
+gawake_server_database_call_add_one_shot_finish (
     GawakeServerDatabase *proxy,
+    gint64 *out_id,
     GAsyncResult *res,
     GError **error)
 {
@@ -1202,34 +2140,43 @@ gawake_server_database_call_request_schedule_finish (
   if (_ret == NULL)
     goto _out;
   g_variant_get (_ret,
-                 "()");
+                 "(x)",
+                 out_id);
   g_variant_unref (_ret);
 _out:
   return _ret != NULL;
 }
 
 /**
- * gawake_server_database_call_request_schedule_sync:
+ * gawake_server_database_call_add_one_shot_sync:
  * @proxy: A #GawakeServerDatabaseProxy.
+ * @arg_name: Argument to pass with the method invocation.
+ * @arg_time: Argument to pass with the method invocation.
+ * @out_id: (out) (optional): Return location for return parameter or %NULL to ignore.
  * @cancellable: (nullable): A #GCancellable or %NULL.
  * @error: Return location for error or %NULL.
  *
- * Synchronously invokes the <link linkend="gdbus-method-io-github-kelvinnovais-Database.RequestSchedule">RequestSchedule()</link> D-Bus method on @proxy. The calling thread is blocked until a reply is received.
+ * Synchronously invokes the <link linkend="gdbus-method-io-github-kelvinnovais-Database.AddOneShot">AddOneShot()</link> D-Bus method on @proxy. The calling thread is blocked until a reply is received.
  *
- * See gawake_server_database_call_request_schedule() for the asynchronous version of this method.
+ * See gawake_server_database_call_add_one_shot() for the asynchronous version of this method.
  *
  * Returns: (skip): %TRUE if the call succeeded, %FALSE if @error is set.
  */
 gboolean
-gawake_server_database_call_request_schedule_sync (
+gawake_server_database_call_add_one_shot_sync (
     GawakeServerDatabase *proxy,
+    const gchar *arg_name,
+    gint64 arg_time,
+    gint64 *out_id,
     GCancellable *cancellable,
     GError **error)
 {
   GVariant *_ret;
   _ret = g_dbus_proxy_call_sync (G_DBUS_PROXY (proxy),
-    "RequestSchedule",
-    g_variant_new ("()"),
+    "AddOneShot",
+    g_variant_new ("(sx)",
+                   arg_name,
+                   arg_time),
     G_DBUS_CALL_FLAGS_NONE,
     -1,
     cancellable,
@@ -1237,34 +2184,35 @@ gawake_server_database_call_request_schedule_sync (
   if (_ret == NULL)
     goto _out;
   g_variant_get (_ret,
-                 "()");
+                 "(x)",
+                 out_id);
   g_variant_unref (_ret);
 _out:
   return _ret != NULL;
 }
 
 /**
- * gawake_server_database_call_request_custom_schedule:
+ * gawake_server_database_call_list_one_shots:
  * @proxy: A #GawakeServerDatabaseProxy.
  * @cancellable: (nullable): A #GCancellable or %NULL.
  * @callback: A #GAsyncReadyCallback to call when the request is satisfied or %NULL.
  * @user_data: User data to pass to @callback.
  *
- * Asynchronously invokes the <link linkend="gdbus-method-io-github-kelvinnovais-Database.RequestCustomSchedule">RequestCustomSchedule()</link> D-Bus method on @proxy.
+ * Asynchronously invokes the <link linkend="gdbus-method-io-github-kelvinnovais-Database.ListOneShots">ListOneShots()</link> D-Bus method on @proxy.
  * When the operation is finished, @callback will be invoked in the thread-default main loop of the thread you are calling this method from (see g_main_context_push_thread_default()).
- * You can then call gawake_server_database_call_request_custom_schedule_finish() to get the result of the operation.
+ * You can then call gawake_server_database_call_list_one_shots_finish() to get the result of the operation.
  *
- * See gawake_server_database_call_request_custom_schedule_sync() for the synchronous, blocking version of this method.
+ * See gawake_server_database_call_list_one_shots_sync() for the synchronous, blocking version of this method.
  */
 void
-gawake_server_database_call_request_custom_schedule (
+gawake_server_database_call_list_one_shots (
     GawakeServerDatabase *proxy,
     GCancellable *cancellable,
     GAsyncReadyCallback callback,
     gpointer user_data)
 {
   g_dbus_proxy_call (G_DBUS_PROXY (proxy),
-    "RequestCustomSchedule",
+    "ListOneShots",
     g_variant_new ("()"),
     G_DBUS_CALL_FLAGS_NONE,
     -1,
@@ -1274,18 +2222,20 @@ gawake_server_database_call_request_custom_schedule (
 }
 
 /**
- * gawake_server_database_call_request_custom_schedule_finish:
+ * gawake_server_database_call_list_one_shots_finish:
  * @proxy: A #GawakeServerDatabaseProxy.
- * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to gawake_server_database_call_request_custom_schedule().
+ * @out_one_shots: (out) (optional): Return location for return parameter or %NULL to ignore.
+ * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to gawake_server_database_call_list_one_shots().
  * @error: Return location for error or %NULL.
  *
- * Finishes an operation started with gawake_server_database_call_request_custom_schedule().
+ * Finishes an operation started with gawake_server_database_call_list_one_shots().
  *
  * Returns: (skip): %TRUE if the call succeeded, %FALSE if @error is set.
  */
 gboolean
-gawake_server_database_call_request_custom_schedule_finish (
+gawake_server_database_call_list_one_shots_finish (
     GawakeServerDatabase *proxy,
+    GVariant **out_one_shots,
     GAsyncResult *res,
     GError **error)
 {
@@ -1294,33 +2244,36 @@ gawake_server_database_call_request_custom_schedule_finish (
   if (_ret == NULL)
     goto _out;
   g_variant_get (_ret,
-                 "()");
+                 "(@a(xsx))",
+                 out_one_shots);
   g_variant_unref (_ret);
 _out:
   return _ret != NULL;
 }
 
 /**
- * gawake_server_database_call_request_custom_schedule_sync:
+ * gawake_server_database_call_list_one_shots_sync:
  * @proxy: A #GawakeServerDatabaseProxy.
+ * @out_one_shots: (out) (optional): Return location for return parameter or %NULL to ignore.
  * @cancellable: (nullable): A #GCancellable or %NULL.
  * @error: Return location for error or %NULL.
  *
- * Synchronously invokes the <link linkend="gdbus-method-io-github-kelvinnovais-Database.RequestCustomSchedule">RequestCustomSchedule()</link> D-Bus method on @proxy. The calling thread is blocked until a reply is received.
+ * Synchronously invokes the <link linkend="gdbus-method-io-github-kelvinnovais-Database.ListOneShots">ListOneShots()</link> D-Bus method on @proxy. The calling thread is blocked until a reply is received.
  *
- * See gawake_server_database_call_request_custom_schedule() for the asynchronous version of this method.
+ * See gawake_server_database_call_list_one_shots() for the asynchronous version of this method.
  *
  * Returns: (skip): %TRUE if the call succeeded, %FALSE if @error is set.
  */
 gboolean
-gawake_server_database_call_request_custom_schedule_sync (
+gawake_server_database_call_list_one_shots_sync (
     GawakeServerDatabase *proxy,
+    GVariant **out_one_shots,
     GCancellable *cancellable,
     GError **error)
 {
   GVariant *_ret;
   _ret = g_dbus_proxy_call_sync (G_DBUS_PROXY (proxy),
-    "RequestCustomSchedule",
+    "ListOneShots",
     g_variant_new ("()"),
     G_DBUS_CALL_FLAGS_NONE,
     -1,
@@ -1329,38 +2282,39 @@ gawake_server_database_call_request_custom_schedule_sync (
   if (_ret == NULL)
     goto _out;
   g_variant_get (_ret,
-                 "()");
+                 "(@a(xsx))",
+                 out_one_shots);
   g_variant_unref (_ret);
 _out:
   return _ret != NULL;
 }
 
 /**
- * gawake_server_database_call_return_status:
+ * gawake_server_database_call_remove_one_shot:
  * @proxy: A #GawakeServerDatabaseProxy.
- * @arg_status: Argument to pass with the method invocation.
+ * @arg_id: Argument to pass with the method invocation.
  * @cancellable: (nullable): A #GCancellable or %NULL.
  * @callback: A #GAsyncReadyCallback to call when the request is satisfied or %NULL.
  * @user_data: User data to pass to @callback.
  *
- * Asynchronously invokes the <link linkend="gdbus-method-io-github-kelvinnovais-Database.ReturnStatus">ReturnStatus()</link> D-Bus method on @proxy.
+ * Asynchronously invokes the <link linkend="gdbus-method-io-github-kelvinnovais-Database.RemoveOneShot">RemoveOneShot()</link> D-Bus method on @proxy.
  * When the operation is finished, @callback will be invoked in the thread-default main loop of the thread you are calling this method from (see g_main_context_push_thread_default()).
- * You can then call gawake_server_database_call_return_status_finish() to get the result of the operation.
+ * You can then call gawake_server_database_call_remove_one_shot_finish() to get the result of the operation.
  *
- * See gawake_server_database_call_return_status_sync() for the synchronous, blocking version of this method.
+ * See gawake_server_database_call_remove_one_shot_sync() for the synchronous, blocking version of this method.
  */
 void
-gawake_server_database_call_return_status (
+gawake_server_database_call_remove_one_shot (
     GawakeServerDatabase *proxy,
-    guchar arg_status,
+    gint64 arg_id,
     GCancellable *cancellable,
     GAsyncReadyCallback callback,
     gpointer user_data)
 {
   g_dbus_proxy_call (G_DBUS_PROXY (proxy),
-    "ReturnStatus",
-    g_variant_new ("(y)",
-                   arg_status),
+    "RemoveOneShot",
+    g_variant_new ("(x)",
+                   arg_id),
     G_DBUS_CALL_FLAGS_NONE,
     -1,
     cancellable,
@@ -1369,17 +2323,17 @@ gawake_server_database_call_return_status (
 }
 
 /**
- * gawake_server_database_call_return_status_finish:
+ * gawake_server_database_call_remove_one_shot_finish:
  * @proxy: A #GawakeServerDatabaseProxy.
- * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to gawake_server_database_call_return_status().
+ * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to gawake_server_database_call_remove_one_shot().
  * @error: Return location for error or %NULL.
  *
- * Finishes an operation started with gawake_server_database_call_return_status().
+ * Finishes an operation started with gawake_server_database_call_remove_one_shot().
  *
  * Returns: (skip): %TRUE if the call succeeded, %FALSE if @error is set.
  */
 gboolean
-gawake_server_database_call_return_status_finish (
+gawake_server_database_call_remove_one_shot_finish (
     GawakeServerDatabase *proxy,
     GAsyncResult *res,
     GError **error)
@@ -1396,30 +2350,30 @@ _out:
 }
 
 /**
- * gawake_server_database_call_return_status_sync:
+ * gawake_server_database_call_remove_one_shot_sync:
  * @proxy: A #GawakeServerDatabaseProxy.
- * @arg_status: Argument to pass with the method invocation.
+ * @arg_id: Argument to pass with the method invocation.
  * @cancellable: (nullable): A #GCancellable or %NULL.
  * @error: Return location for error or %NULL.
  *
- * Synchronously invokes the <link linkend="gdbus-method-io-github-kelvinnovais-Database.ReturnStatus">ReturnStatus()</link> D-Bus method on @proxy. The calling thread is blocked until a reply is received.
+ * Synchronously invokes the <link linkend="gdbus-method-io-github-kelvinnovais-Database.RemoveOneShot">RemoveOneShot()</link> D-Bus method on @proxy. The calling thread is blocked until a reply is received.
  *
- * See gawake_server_database_call_return_status() for the asynchronous version of this method.
+ * See gawake_server_database_call_remove_one_shot() for the asynchronous version of this method.
  *
  * Returns: (skip): %TRUE if the call succeeded, %FALSE if @error is set.
  */
 gboolean
-gawake_server_database_call_return_status_sync (
+gawake_server_database_call_remove_one_shot_sync (
     GawakeServerDatabase *proxy,
-    guchar arg_status,
+    gint64 arg_id,
     GCancellable *cancellable,
     GError **error)
 {
   GVariant *_ret;
   _ret = g_dbus_proxy_call_sync (G_DBUS_PROXY (proxy),
-    "ReturnStatus",
-    g_variant_new ("(y)",
-                   arg_status),
+    "RemoveOneShot",
+    g_variant_new ("(x)",
+                   arg_id),
     G_DBUS_CALL_FLAGS_NONE,
     -1,
     cancellable,
@@ -1523,6 +2477,87 @@ gawake_server_database_complete_return_status (
     g_variant_new ("()"));
 }
 
+/**
+ * gawake_server_database_complete_get_upcoming_events:
+ * @object: A #GawakeServerDatabase.
+ * @invocation: (transfer full): A #GDBusMethodInvocation.
+ * @events: Parameter to return.
+ *
+ * Helper function used in service implementations to finish handling invocations of the <link linkend="gdbus-method-io-github-kelvinnovais-Database.GetUpcomingEvents">GetUpcomingEvents()</link> D-Bus method. If you instead want to finish handling an invocation by returning an error, use g_dbus_method_invocation_return_error() or similar.
+ *
+ * This method will free @invocation, you cannot use it afterwards.
+ */
+void
+gawake_server_database_complete_get_upcoming_events (
+    GawakeServerDatabase *object G_GNUC_UNUSED,
+    GDBusMethodInvocation *invocation,
+    GVariant *events)
+{
+  g_dbus_method_invocation_return_value (invocation,
+    g_variant_new ("(@a(xyxy))",
+                   events));
+}
+
+/**
+ * gawake_server_database_complete_add_one_shot:
+ * @object: A #GawakeServerDatabase.
+ * @invocation: (transfer full): A #GDBusMethodInvocation.
+ * @id: Parameter to return.
+ *
+ * Helper function used in service implementations to finish handling invocations of the <link linkend="gdbus-method-io-github-kelvinnovais-Database.AddOneShot">AddOneShot()</link> D-Bus method. If you instead want to finish handling an invocation by returning an error, use g_dbus_method_invocation_return_error() or similar.
+ *
+ * This method will free @invocation, you cannot use it afterwards.
+ */
+void
+gawake_server_database_complete_add_one_shot (
+    GawakeServerDatabase *object G_GNUC_UNUSED,
+    GDBusMethodInvocation *invocation,
+    gint64 id)
+{
+  g_dbus_method_invocation_return_value (invocation,
+    g_variant_new ("(x)",
+                   id));
+}
+
+/**
+ * gawake_server_database_complete_list_one_shots:
+ * @object: A #GawakeServerDatabase.
+ * @invocation: (transfer full): A #GDBusMethodInvocation.
+ * @one_shots: Parameter to return.
+ *
+ * Helper function used in service implementations to finish handling invocations of the <link linkend="gdbus-method-io-github-kelvinnovais-Database.ListOneShots">ListOneShots()</link> D-Bus method. If you instead want to finish handling an invocation by returning an error, use g_dbus_method_invocation_return_error() or similar.
+ *
+ * This method will free @invocation, you cannot use it afterwards.
+ */
+void
+gawake_server_database_complete_list_one_shots (
+    GawakeServerDatabase *object G_GNUC_UNUSED,
+    GDBusMethodInvocation *invocation,
+    GVariant *one_shots)
+{
+  g_dbus_method_invocation_return_value (invocation,
+    g_variant_new ("(@a(xsx))",
+                   one_shots));
+}
+
+/**
+ * gawake_server_database_complete_remove_one_shot:
+ * @object: A #GawakeServerDatabase.
+ * @invocation: (transfer full): A #GDBusMethodInvocation.
+ *
+ * Helper function used in service implementations to finish handling invocations of the <link linkend="gdbus-method-io-github-kelvinnovais-Database.RemoveOneShot">RemoveOneShot()</link> D-Bus method. If you instead want to finish handling an invocation by returning an error, use g_dbus_method_invocation_return_error() or similar.
+ *
+ * This method will free @invocation, you cannot use it afterwards.
+ */
+void
+gawake_server_database_complete_remove_one_shot (
+    GawakeServerDatabase *object G_GNUC_UNUSED,
+    GDBusMethodInvocation *invocation)
+{
+  g_dbus_method_invocation_return_value (invocation,
+    g_variant_new ("()"));
+}
+
 /* ------------------------------------------------------------------------ */
 
 /**
@@ -2080,7 +3115,8 @@ gawake_server_database_skeleton_dbus_interface_flush (GDBusInterfaceSkeleton *_s
 
 static void
 _gawake_server_database_on_signal_database_updated (
-    GawakeServerDatabase *object)
+    GawakeServerDatabase *object,
+    GVariant *arg_changes)
 {
   GawakeServerDatabaseSkeleton *skeleton = GAWAKE_SERVER_DATABASE_SKELETON (object);
 
@@ -2088,7 +3124,8 @@ _gawake_server_database_on_signal_database_updated (
   GVariant   *signal_variant;
   connections = g_dbus_interface_skeleton_get_connections (G_DBUS_INTERFACE_SKELETON (skeleton));
 
-  signal_variant = g_variant_ref_sink (g_variant_new ("()"));
+  signal_variant = g_variant_ref_sink (g_variant_new ("(@a(y(xsyyabbyy)))",
+                   arg_changes));
   for (l = connections; l != NULL; l = l->next)
     {
       GDBusConnection *connection = l->data;
@@ -31,10 +31,30 @@ struct _GawakeServerDatabaseIface
   GTypeInterface parent_iface;
 
 
+  gboolean (*handle_add_one_shot) (
+    GawakeServerDatabase *object,
+    GDBusMethodInvocation *invocation,
+    const gchar *arg_name,
+    gint64 arg_time);
+
   gboolean (*handle_cancel_rule) (
     GawakeServerDatabase *object,
     GDBusMethodInvocation *invocation);
 
+  gboolean (*handle_get_upcoming_events) (
+    GawakeServerDatabase *object,
+    GDBusMethodInvocation *invocation,
+    guint arg_count);
+
+  gboolean (*handle_list_one_shots) (
+    GawakeServerDatabase *object,
+    GDBusMethodInvocation *invocation);
+
+  gboolean (*handle_remove_one_shot) (
+    GawakeServerDatabase *object,
+    GDBusMethodInvocation *invocation,
+    gint64 arg_id);
+
   gboolean (*handle_request_custom_schedule) (
     GawakeServerDatabase *object,
     GDBusMethodInvocation *invocation);
@@ -50,13 +70,15 @@ struct _GawakeServerDatabaseIface
 
   gboolean (*handle_update_database) (
     GawakeServerDatabase *object,
-    GDBusMethodInvocation *invocation);
+    GDBusMethodInvocation *invocation,
+    GVariant *arg_changes);
 
   void (*custom_schedule_requested) (
     GawakeServerDatabase *object);
 
   void (*database_updated) (
-    GawakeServerDatabase *object);
+    GawakeServerDatabase *object,
+    GVariant *arg_changes);
 
   void (*rule_canceled) (
     GawakeServerDatabase *object);
@@ -97,11 +119,31 @@ void gawake_server_database_complete_return_status (
     GawakeServerDatabase *object,
     GDBusMethodInvocation *invocation);
 
+void gawake_server_database_complete_get_upcoming_events (
+    GawakeServerDatabase *object,
+    GDBusMethodInvocation *invocation,
+    GVariant *events);
+
+void gawake_server_database_complete_add_one_shot (
+    GawakeServerDatabase *object,
+    GDBusMethodInvocation *invocation,
+    gint64 id);
+
+void gawake_server_database_complete_list_one_shots (
+    GawakeServerDatabase *object,
+    GDBusMethodInvocation *invocation,
+    GVariant *one_shots);
+
+void gawake_server_database_complete_remove_one_shot (
+    GawakeServerDatabase *object,
+    GDBusMethodInvocation *invocation);
+
 
 
 /* D-Bus signal emissions functions: */
 void gawake_server_database_emit_database_updated (
-    GawakeServerDatabase *object);
+    GawakeServerDatabase *object,
+    GVariant *arg_changes);
 
 void gawake_server_database_emit_rule_canceled (
     GawakeServerDatabase *object);
@@ -121,6 +163,7 @@ void gawake_server_database_emit_status (
 /* D-Bus method calls: */
 void gawake_server_database_call_update_database (
     GawakeServerDatabase *proxy,
+    GVariant *arg_changes,
     GCancellable *cancellable,
     GAsyncReadyCallback callback,
     gpointer user_data);
@@ -132,6 +175,7 @@ gboolean gawake_server_database_call_update_database_finish (
 
 gboolean gawake_server_database_call_update_database_sync (
     GawakeServerDatabase *proxy,
+    GVariant *arg_changes,
     GCancellable *cancellable,
     GError **error);
 
@@ -201,6 +245,84 @@ gboolean gawake_server_database_call_return_status_sync (
     GCancellable *cancellable,
     GError **error);
 
+void gawake_server_database_call_get_upcoming_events (
+    GawakeServerDatabase *proxy,
+    guint arg_count,
+    GCancellable *cancellable,
+    GAsyncReadyCallback callback,
+    gpointer user_data);
+
+gboolean gawake_server_database_call_get_upcoming_events_finish (
+    GawakeServerDatabase *proxy,
+    GVariant **out_events,
+    GAsyncResult *res,
+    GError **error);
+
+gboolean gawake_server_database_call_get_upcoming_events_sync (
+    GawakeServerDatabase *proxy,
+    guint arg_count,
+    GVariant **out_events,
+    GCancellable *cancellable,
+    GError **error);
+
+void gawake_server_database_call_add_one_shot (
+    GawakeServerDatabase *proxy,
+    const gchar *arg_name,
+    gint64 arg_time,
+    GCancellable *cancellable,
+    GAsyncReadyCallback callback,
+    gpointer user_data);
+
+gboolean gawake_server_database_call_add_one_shot_finish (
+    GawakeServerDatabase *proxy,
+    gint64 *out_id,
+    GAsyncResult *res,
+    GError **error);
+
+gboolean gawake_server_database_call_add_one_shot_sync (
+    GawakeServerDatabase *proxy,
+    const gchar *arg_name,
+    gint64 arg_time,
+    gint64 *out_id,
+    GCancellable *cancellable,
+    GError **error);
+
+void gawake_server_database_call_list_one_shots (
+    GawakeServerDatabase *proxy,
+    GCancellable *cancellable,
+    GAsyncReadyCallback callback,
+    gpointer user_data);
+
+gboolean gawake_server_database_call_list_one_shots_finish (
+    GawakeServerDatabase *proxy,
+    GVariant **out_one_shots,
+    GAsyncResult *res,
+    GError **error);
+
+gboolean gawake_server_database_call_list_one_shots_sync (
+    GawakeServerDatabase *proxy,
+    GVariant **out_one_shots,
+    GCancellable *cancellable,
+    GError **error);
+
+void gawake_server_database_call_remove_one_shot (
+    GawakeServerDatabase *proxy,
+    gint64 arg_id,
+    GCancellable *cancellable,
+    GAsyncReadyCallback callback,
+    gpointer user_data);
+
+gboolean gawake_server_database_call_remove_one_shot_finish (
+    GawakeServerDatabase *proxy,
+    GAsyncResult *res,
+    GError **error);
+
+gboolean gawake_server_database_call_remove_one_shot_sync (
+    GawakeServerDatabase *proxy,
+    gint64 arg_id,
+    GCancellable *cancellable,
+    GError **error);
+
 
 
 /* ---- */
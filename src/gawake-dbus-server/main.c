@@ -53,6 +53,8 @@ int main (void)
   g_main_loop_run (loop);
 
   g_bus_unown_name (owner_id);
+  upcoming_events_close ();
+  one_shot_schedule_close ();
 
   return EXIT_SUCCESS;
 }
@@ -73,6 +75,10 @@ on_name_acquired (GDBusConnection *connection,
   g_signal_connect (interface, "handle-request-schedule", G_CALLBACK (on_handle_request_schedule), NULL);
   g_signal_connect (interface, "handle-request-custom-schedule", G_CALLBACK (on_handle_request_custom_schedule), NULL);
   g_signal_connect (interface, "handle-return-status", G_CALLBACK (on_handle_return_status), NULL);
+  g_signal_connect (interface, "handle-get-upcoming-events", G_CALLBACK (on_handle_get_upcoming_events), NULL);
+  g_signal_connect (interface, "handle-add-one-shot", G_CALLBACK (on_handle_add_one_shot), NULL);
+  g_signal_connect (interface, "handle-list-one-shots", G_CALLBACK (on_handle_list_one_shots), NULL);
+  g_signal_connect (interface, "handle-remove-one-shot", G_CALLBACK (on_handle_remove_one_shot), NULL);
 
   error = NULL;
   g_dbus_interface_skeleton_export (G_DBUS_INTERFACE_SKELETON (interface),
@@ -104,10 +110,14 @@ static void on_name_lost (GDBusConnection *connection,
 static gboolean
 on_handle_update_database (GawakeServerDatabase    *interface,
                            GDBusMethodInvocation   *invocation,
+                           GVariant                *changes,
                            gpointer                user_data)
 {
-  DEBUG_PRINT (("Received update database request"));
-  gawake_server_database_emit_database_updated (interface);
+  DEBUG_PRINT (("Received update database request, %zu change(s)",
+                g_variant_n_children (changes)));
+  // Relay the changes, so the scheduler doesn't need to reload everything;
+  // it only takes them as the rules to read again
+  gawake_server_database_emit_database_updated (interface, changes);
   gawake_server_database_complete_update_database (interface, invocation);
   return TRUE;
 }
@@ -157,6 +167,143 @@ on_handle_return_status (GawakeServerDatabase    *interface,
   return TRUE;
 }
 
+static gboolean
+on_handle_get_upcoming_events (GawakeServerDatabase    *interface,
+                               GDBusMethodInvocation   *invocation,
+                               guint                   count,
+                               gpointer                user_data)
+{
+  GVariant *events;
+
+  DEBUG_PRINT (("Received upcoming events request, %u event(s)", count));
+
+  if (upcoming_events_get (count, &events))
+    {
+      g_dbus_method_invocation_return_error (invocation,
+                                             G_DBUS_ERROR,
+                                             G_DBUS_ERROR_FAILED,
+                                             "Couldn't read the rules");
+      return TRUE;
+    }
+
+  gawake_server_database_complete_get_upcoming_events (interface, invocation, events);
+  return TRUE;
+}
+
+static gboolean
+on_handle_add_one_shot (GawakeServerDatabase    *interface,
+                        GDBusMethodInvocation   *invocation,
+                        const gchar             *name,
+                        gint64                  time,
+                        gpointer                user_data)
+{
+  gint64 id;
+
+  DEBUG_PRINT (("Received add one-shot request, at %" G_GINT64_FORMAT, time));
+
+  if (check_caller (invocation))
+    {
+      g_dbus_method_invocation_return_error (invocation,
+                                             G_DBUS_ERROR,
+                                             G_DBUS_ERROR_ACCESS_DENIED,
+                                             "Not allowed to add one-shot schedules");
+      return TRUE;
+    }
+
+  if (one_shot_schedule_add (name, time, &id))
+    {
+      g_dbus_method_invocation_return_error (invocation,
+                                             G_DBUS_ERROR,
+                                             G_DBUS_ERROR_INVALID_ARGS,
+                                             "Couldn't add the one-shot schedule");
+      return TRUE;
+    }
+
+  emit_one_shots_changed (interface);
+  gawake_server_database_complete_add_one_shot (interface, invocation, id);
+  return TRUE;
+}
+
+static gboolean
+on_handle_list_one_shots (GawakeServerDatabase    *interface,
+                          GDBusMethodInvocation   *invocation,
+                          gpointer                user_data)
+{
+  GVariant *one_shots;
+
+  DEBUG_PRINT (("Received list one-shots request"));
+
+  if (one_shot_schedule_list (&one_shots))
+    {
+      g_dbus_method_invocation_return_error (invocation,
+                                             G_DBUS_ERROR,
+                                             G_DBUS_ERROR_FAILED,
+                                             "Couldn't read the one-shot schedules");
+      return TRUE;
+    }
+
+  gawake_server_database_complete_list_one_shots (interface, invocation, one_shots);
+  return TRUE;
+}
+
+static gboolean
+on_handle_remove_one_shot (GawakeServerDatabase    *interface,
+                           GDBusMethodInvocation   *invocation,
+                           gint64                  id,
+                           gpointer                user_data)
+{
+  DEBUG_PRINT (("Received remove one-shot request, ID %" G_GINT64_FORMAT, id));
+
+  if (check_caller (invocation))
+    {
+      g_dbus_method_invocation_return_error (invocation,
+                                             G_DBUS_ERROR,
+                                             G_DBUS_ERROR_ACCESS_DENIED,
+                                             "Not allowed to remove one-shot schedules");
+      return TRUE;
+    }
+
+  if (one_shot_schedule_remove (id))
+    {
+      g_dbus_method_invocation_return_error (invocation,
+                                             G_DBUS_ERROR,
+                                             G_DBUS_ERROR_INVALID_ARGS,
+                                             "Couldn't remove the one-shot schedule");
+      return TRUE;
+    }
+
+  emit_one_shots_changed (interface);
+  gawake_server_database_complete_remove_one_shot (interface, invocation);
+  return TRUE;
+}
+
+// The one-shot schedules aren't rules: a single CHANGE_OTHER makes the
+// scheduler load them again
+static void emit_one_shots_changed (GawakeServerDatabase *interface)
+{
+  GVariantBuilder builder, days;
+
+  g_variant_builder_init (&days, G_VARIANT_TYPE ("ab"));
+  for (int d = 0; d < 7; d++)
+    g_variant_builder_add (&days, "b", FALSE);
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE (DATABASE_CHANGES_TYPE));
+  g_variant_builder_add (&builder,
+                         "(y(xsyy@abbyy))",
+                         (guchar) CHANGE_OTHER,
+                         (gint64) 0,
+                         "",
+                         (guchar) 0,
+                         (guchar) 0,
+                         g_variant_builder_end (&days),
+                         FALSE,
+                         (guchar) 0,
+                         (guchar) 0);
+
+  gawake_server_database_emit_database_updated (interface,
+                                                g_variant_builder_end (&builder));
+}
+
 // Although systemd already takes care of the user that executes the code,
 // this function acts as an additional security layer
 static gint check_user (void)
@@ -190,6 +337,96 @@ static gint check_user (void)
   return EXIT_SUCCESS;
 }
 
+// The one-shot methods write to the database, which only root and the
+// gawake user or group may do; the bus policy is the first layer, this is
+// the second
+static gint check_caller (GDBusMethodInvocation *invocation)
+{
+  GDBusConnection *connection = g_dbus_method_invocation_get_connection (invocation);
+  const gchar *sender = g_dbus_method_invocation_get_sender (invocation);
+  GError *error = NULL;
+  GVariant *reply;
+  guint32 caller_uid;
+  uid_t gawake_uid;
+  gid_t gawake_gid;
+  gid_t *groups;
+  gchar *caller_name;
+  gint n_groups = 0;
+  gint ret = EXIT_FAILURE;
+
+  struct passwd *p;
+
+  // Ask the bus who is calling: the sender name alone can't be trusted
+  reply = g_dbus_connection_call_sync (connection,
+                                       "org.freedesktop.DBus",
+                                       "/org/freedesktop/DBus",
+                                       "org.freedesktop.DBus",
+                                       "GetConnectionUnixUser",
+                                       g_variant_new ("(s)", sender),
+                                       G_VARIANT_TYPE ("(u)"),
+                                       G_DBUS_CALL_FLAGS_NONE,
+                                       -1,
+                                       NULL,
+                                       &error);
+  if (reply == NULL)
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR: Couldn't query the caller UID: %s\n", error->message);
+      g_error_free (error);
+      return EXIT_FAILURE;
+    }
+  g_variant_get (reply, "(u)", &caller_uid);
+  g_variant_unref (reply);
+
+  if (caller_uid == 0)
+    return EXIT_SUCCESS;
+
+  // Query gawake user information
+  if ((p = getpwnam ("gawake")) == NULL)
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR: Couldn't query gawake UID\n");
+      return EXIT_FAILURE;
+    }
+  gawake_uid = p->pw_uid;
+  gawake_gid = p->pw_gid;
+
+  if (caller_uid == gawake_uid)
+    return EXIT_SUCCESS;
+
+  // Otherwise the caller must be on the gawake group
+  if ((p = getpwuid (caller_uid)) == NULL)
+    {
+      DEBUG_PRINT (("Caller UID %u has no passwd entry", caller_uid));
+      return EXIT_FAILURE;
+    }
+  caller_name = g_strdup (p->pw_name);
+
+  getgrouplist (caller_name, p->pw_gid, NULL, &n_groups);
+  groups = g_new (gid_t, n_groups);
+  if (getgrouplist (caller_name, p->pw_gid, groups, &n_groups) != -1)
+    {
+      for (gint i = 0; i < n_groups; i++)
+        {
+          if (groups[i] == gawake_gid)
+            {
+              ret = EXIT_SUCCESS;
+              break;
+            }
+        }
+    }
+
+  if (ret != EXIT_SUCCESS)
+    {
+      DEBUG_PRINT (("Caller %s (UID %u) isn't on the gawake group", caller_name, caller_uid));
+    }
+
+  g_free (groups);
+  g_free (caller_name);
+
+  return ret;
+}
+
 static void exit_handler (int sig)
 {
   g_main_loop_quit (loop);
@@ -7,9 +7,13 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <pwd.h>
+#include <grp.h>
 #include <signal.h>
 
 #include "dbus-server.h"
+#include "upcoming-events.h"
+#include "one-shot-schedule.h"
+#include "../database-connection/gawake-types.h"
 
 #include "../utils/debugger.h"
 
@@ -24,6 +28,7 @@ static void on_name_lost (GDBusConnection *connection,
 static gboolean
 on_handle_update_database (GawakeServerDatabase    *interface,
                            GDBusMethodInvocation   *invocation,
+                           GVariant                *changes,
                            gpointer                user_data);
 
 static gboolean
@@ -47,8 +52,36 @@ on_handle_return_status (GawakeServerDatabase    *interface,
                          const guchar            status_received,
                          gpointer                user_data);
 
+static gboolean
+on_handle_get_upcoming_events (GawakeServerDatabase    *interface,
+                               GDBusMethodInvocation   *invocation,
+                               guint                   count,
+                               gpointer                user_data);
+
+static gboolean
+on_handle_add_one_shot (GawakeServerDatabase    *interface,
+                        GDBusMethodInvocation   *invocation,
+                        const gchar             *name,
+                        gint64                  time,
+                        gpointer                user_data);
+
+static gboolean
+on_handle_list_one_shots (GawakeServerDatabase    *interface,
+                          GDBusMethodInvocation   *invocation,
+                          gpointer                user_data);
+
+static gboolean
+on_handle_remove_one_shot (GawakeServerDatabase    *interface,
+                           GDBusMethodInvocation   *invocation,
+                           gint64                  id,
+                           gpointer                user_data);
+
+static void emit_one_shots_changed (GawakeServerDatabase *interface);
+
 static gint check_user (void);
 
+static gint check_caller (GDBusMethodInvocation *invocation);
+
 static void exit_handler (int sig);
 
 #endif /* __GAWAKE_SERVICE_H_ */
@@ -0,0 +1,98 @@
+/* one-shot-schedule.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Answer AddOneShot, ListOneShots and RemoveOneShot: the server is the only
+ * D-Bus service with write access to the database, so the changes are made
+ * here, through the database-connection library
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "one-shot-schedule.h"
+#define ALLOW_MANAGING_RULES
+#include "../database-connection/database-connection.h"
+#undef ALLOW_MANAGING_RULES
+#include "../utils/debugger.h"
+
+// Opened on the first request, with write access
+static GawakeDb *db = NULL;
+
+static int open_database (void)
+{
+  if (db != NULL)
+    return EXIT_SUCCESS;
+
+  db = gawake_db_open (false);
+
+  return (db == NULL) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// Queue a one-shot wake up; see one_shot_add ()
+int one_shot_schedule_add (const gchar *name, gint64 time, gint64 *id)
+{
+  if (open_database ())
+    return EXIT_FAILURE;
+
+  return one_shot_add (db, name, time, id);
+}
+
+// Get the upcoming one-shot wake ups, in time order, as ONE_SHOTS_TYPE
+int one_shot_schedule_list (GVariant **one_shots)
+{
+  GVariantBuilder builder;
+  OneShot *list = NULL;
+  size_t length = 0;
+
+  if (open_database ()
+      || one_shot_get_upcoming (db, (int64_t) time (NULL), &list, &length))
+    return EXIT_FAILURE;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE (ONE_SHOTS_TYPE));
+  for (size_t i = 0; i < length; i++)
+    {
+      g_variant_builder_add (&builder,
+                             "(xsx)",
+                             (gint64) list[i].id,
+                             list[i].name,
+                             (gint64) list[i].time);
+    }
+  *one_shots = g_variant_builder_end (&builder);
+  free (list);
+
+  return EXIT_SUCCESS;
+}
+
+// Remove a one-shot wake up; fails if there's none with the id
+int one_shot_schedule_remove (gint64 id)
+{
+  if (open_database ())
+    return EXIT_FAILURE;
+
+  return one_shot_delete (db, id);
+}
+
+void one_shot_schedule_close (void)
+{
+  gawake_db_close (db);
+  db = NULL;
+}
@@ -0,0 +1,11 @@
+#ifndef ONE_SHOT_SCHEDULE_H_
+#define ONE_SHOT_SCHEDULE_H_
+
+#include <glib.h>
+
+int one_shot_schedule_add (const gchar *name, gint64 time, gint64 *id);
+int one_shot_schedule_list (GVariant **one_shots);
+int one_shot_schedule_remove (gint64 id);
+void one_shot_schedule_close (void);
+
+#endif /* ONE_SHOT_SCHEDULE_H_ */
@@ -0,0 +1,212 @@
+/* upcoming-events.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Answer GetUpcomingEvents: the rules are compiled the same way the scheduler
+ * does (skipping them on their exception dates), and the events (with the
+ * one-shot wake ups) are taken from an iterator, one at a time, so the cost
+ * grows with the number of events requested, not with the horizon.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "upcoming-events.h"
+#include "../database-connection/database-connection.h"
+#include "../gawaked/week-index.h"
+#include "../gawaked/event-iterator.h"
+#include "../utils/debugger.h"
+
+static int load_rules (Table table, RuleSet *rules, WeekIndex *index);
+static int load_custom_schedule (EventIterator *iterator,
+                                 bool use_localtime,
+                                 time_t now);
+static int load_exceptions (time_t now);
+
+// Opened on the first request
+static GawakeDb *db = NULL;
+// Kept between the calls, to reuse the allocated memory
+static RuleSet on_rules, off_rules;
+static WeekIndex on_index, off_index;
+static ExceptionCalendar exceptions;
+
+/*
+ * Get the next "count" events, from now, as UPCOMING_EVENTS_TYPE; "count"
+ * is limited to MAX_UPCOMING_EVENTS
+ */
+int upcoming_events_get (guint count, GVariant **events)
+{
+  GVariantBuilder builder;
+  EventIterator iterator;
+  UpcomingEvent event;
+  Config config;
+  OneShot *one_shots = NULL;
+  size_t one_shots_length = 0;
+  time_t now = time (NULL);
+#if PREPROCESSOR_DEBUG
+  gint64 started = g_get_monotonic_time ();
+#endif
+
+  if (db == NULL)
+    {
+#if DATABASE_IMAGE
+      db = gawake_db_open_image ();
+#else
+      db = gawake_db_open (true);
+#endif
+      if (db == NULL)
+        return EXIT_FAILURE;
+    }
+
+  // On DATABASE_IMAGE, load the changes of the file
+  if (gawake_db_refresh_image (db, NULL))
+    return EXIT_FAILURE;
+
+  if (configuration_get_snapshot (db, &config)
+      || load_rules (TABLE_ON, &on_rules, &on_index)
+      || load_rules (TABLE_OFF, &off_rules, &off_index)
+      || load_exceptions (now))
+    return EXIT_FAILURE;
+
+  event_iterator_init (&iterator, now, &on_index, config.use_localtime,
+                       &off_index);
+  if (load_custom_schedule (&iterator, config.use_localtime, now)
+      || one_shot_get_upcoming (db, now, &one_shots, &one_shots_length))
+    return EXIT_FAILURE;
+  event_iterator_add_one_shots (&iterator, one_shots, one_shots_length);
+  event_iterator_add_exceptions (&iterator, &exceptions);
+
+  if (count > MAX_UPCOMING_EVENTS)
+    count = MAX_UPCOMING_EVENTS;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE (UPCOMING_EVENTS_TYPE));
+  for (guint i = 0; i < count && event_iterator_next (&iterator, &event); i++)
+    {
+      g_variant_builder_add (&builder,
+                             "(xyxy)",
+                             (gint64) event.time,
+                             (guchar) event.kind,
+                             (gint64) event.id,
+                             (guchar) event.mode);
+    }
+  *events = g_variant_builder_end (&builder);
+  free (one_shots);
+
+  DEBUG_PRINT (("%zu upcoming events computed in %.3f ms",
+                g_variant_n_children (*events),
+                (g_get_monotonic_time () - started) / 1e3));
+
+  return EXIT_SUCCESS;
+}
+
+void upcoming_events_close (void)
+{
+  gawake_db_close (db);
+  db = NULL;
+
+  rule_set_free (&on_rules);
+  rule_set_free (&off_rules);
+  week_index_free (&on_index);
+  week_index_free (&off_index);
+  exception_calendar_free (&exceptions);
+}
+
+// Compile the active rules of the table; the names aren't needed
+static int load_rules (Table table, RuleSet *rules, WeekIndex *index)
+{
+  bool days[7];
+
+  week_index_reset (index);
+
+  if (rule_set_load (db, table, rules))
+    return EXIT_FAILURE;
+
+  for (size_t i = rule_set_next_active (rules, 0); i < rules->length;
+       i = rule_set_next_active (rules, i + 1))
+    {
+      days_from_mask (rules->days_masks[i], days);
+      if (week_index_add (index,
+                          rules->ids[i],
+                          rules->minutes[i] / 60,
+                          rules->minutes[i] % 60,
+                          days,
+                          (Mode) rules->modes[i]))
+        return EXIT_FAILURE;
+    }
+
+  week_index_sort (index);
+
+  return EXIT_SUCCESS;
+}
+
+// Add the custom schedule to the events, if it's upcoming
+static int load_custom_schedule (EventIterator *iterator,
+                                 bool use_localtime,
+                                 time_t now)
+{
+  RtcwakeArgs custom;
+  struct tm timestamp = { 0 };
+  time_t custom_time;
+
+  if (rule_get_custom_schedule (db, &custom))
+    return EXIT_FAILURE;
+
+  if (!custom.found)
+    return EXIT_SUCCESS;
+
+  timestamp.tm_year = custom.year - 1900;
+  timestamp.tm_mon = custom.month - 1;
+  timestamp.tm_mday = custom.day;
+  timestamp.tm_hour = custom.hour;
+  timestamp.tm_min = custom.minutes;
+  timestamp.tm_isdst = -1;
+  custom_time = use_localtime ? mktime (&timestamp) : timegm (&timestamp);
+
+  if (custom_time != (time_t) -1 && custom_time > now)
+    event_iterator_add_custom (iterator, custom_time, custom.mode);
+
+  return EXIT_SUCCESS;
+}
+
+// Compile the exception dates, as the scheduler does: this year and the next
+static int load_exceptions (time_t now)
+{
+  ExceptionDate *dates;
+  size_t length;
+  struct tm today;
+  char from[EXCEPTION_DATE_LENGTH];
+  int ret = EXIT_SUCCESS;
+
+  localtime_r (&now, &today);
+  exception_calendar_reset (&exceptions, today.tm_year);
+  snprintf (from, sizeof (from), "%04d-01-01", today.tm_year + 1900);
+
+  if (exception_get_dates (db, from, &dates, &length))
+    return EXIT_FAILURE;
+
+  for (size_t i = 0; i < length && ret == EXIT_SUCCESS; i++)
+    ret = exception_calendar_add (&exceptions, dates[i].date,
+                                  dates[i].table, dates[i].rule_id);
+
+  free (dates);
+
+  return ret;
+}
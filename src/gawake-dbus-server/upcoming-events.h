@@ -0,0 +1,9 @@
+#ifndef UPCOMING_EVENTS_H_
+#define UPCOMING_EVENTS_H_
+
+#include <glib.h>
+
+int upcoming_events_get (guint count, GVariant **events);
+void upcoming_events_close (void);
+
+#endif /* UPCOMING_EVENTS_H_ */
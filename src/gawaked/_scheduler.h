@@ -5,10 +5,20 @@
 #include <sqlite3.h>
 #include <stdio.h>
 #include <string.h>
+#include <stdarg.h>
 #include <unistd.h>
-#include <pthread.h>
+#include <signal.h>
+#include <glib-unix.h>
+#include <gio/gio.h>
 
 #include "week-day.h"
+#include "deadline-timer.h"
+#include "week-index.h"
+#include "one-shot-heap.h"
+#include "exception-calendar.h"
+#include "scheduler-database.h"
+#include "database-integrity.h"
+#include "schedule-plan.h"
 
 #include "../utils/get-time.h"
 #include "../utils/debugger.h"
@@ -16,21 +26,62 @@
 
 #include "../gawake-dbus-server/dbus-server.h"
 
-// Threads
-static void *gsd_listener (void *args);
-// static void *login1_listener (void *args);
-static void *timed_checker (void *args);
-static void finalize_gsd_listener (void);
-// static void finalize_login1_listener (void);
-static void finalize_timed_checker (void);
+// What the deadline timer is armed for
+typedef enum {
+  DEADLINE_DAY_CHANGED,
+  DEADLINE_NOTIFICATION,
+  DEADLINE_OFF_RULE
+} Deadline;
+
+// Replaced when the time zone changes; the tests watch a file of their own
+#ifndef LOCALTIME_PATH
+#define LOCALTIME_PATH "/etc/localtime"
+#endif
+
+// Queries that failed because the database was busy are tried again
+#define QUERY_ATTEMPTS 3
+
+typedef enum {
+  RTCWAKE_ARGS_FAILURE,
+  RTCWAKE_ARGS_SUCESS,
+  RTCWAKE_ARGS_NOT_FOUND,
+  INVALID_RTCWAKE_ARGS
+} RtcwakeArgsReturn;
+
+// Main loop
+static void plan_deadline (void);
+static gboolean on_deadline_reached (gint fd, GIOCondition condition, gpointer user_data);
+static gboolean on_sigterm (gpointer user_data);
+static void on_localtime_changed (GFileMonitor *monitor,
+                                  GFile *file,
+                                  GFile *other_file,
+                                  GFileMonitorEvent event_type,
+                                  gpointer user_data);
+static void replan_on_time_change (void);
+static gint64 get_suspended_time (void);
+static void finalize_loop (void);
 
 // Database calls
 static int query_upcoming_off_rule (void);
+static int load_off_rules (void);
 static int query_upcoming_on_rule (bool use_default_mode);
+static int find_upcoming_off_rule (void);
+static int find_upcoming_on_rule (void);
 static int query_custom_schedule (void);
+static int load_one_shots (void);
+static int load_exceptions (void);
+static const WeekIndexEntry *
+get_upcoming_entry (const WeekIndex *index,
+                    Table table,
+                    bool use_localtime,
+                    struct tm *upcoming,
+                    time_t *upcoming_time);
 
 // Signals
-static void on_database_updated_signal (void);
+static void on_database_updated_signal (GawakeServerDatabase *proxy,
+                                        GVariant *changes,
+                                        gpointer user_data);
+static int apply_changes (GVariant *changes);
 static void on_rule_canceled_signal (void);
 static void on_schedule_requested_signal (void);
 static void on_custom_schedule_requested_signal (void);
@@ -44,30 +95,21 @@ static void on_custom_schedule_requested_signal (void);
 //                                 gpointer user_data);
 
 // Utils
-static int day_changed (void);
-static void sync_time (void);
 static int notify_user (int ret);
-static double get_time_remaining (void);
+static int prepare_rtcwake_args (void);
+static int set_run_shutdown (int ret);
+static bool retry_busy (int attempt);
+static bool notified_upcoming_rule (void);
+static void refresh_notified_on_rule (void);
 static void schedule_finalize (int ret);
+static Deadline get_next_deadline (time_t *deadline);
 
-// int take_inhibitor_lock (void);
-static void prepare_for_shutdown (int sig);
+// Simulation
+static time_t get_virtual_time (void);
+static void simulate_off_rule (void);
+static void print_simulated_event (const char *event, const char *format, ...)
+  __attribute__ ((format (printf, 2, 3)));
 
-typedef enum {
-  RTCWAKE_ARGS_FAILURE,
-  RTCWAKE_ARGS_SUCESS,
-  RTCWAKE_ARGS_NOT_FOUND,
-  INVALID_RTCWAKE_ARGS
-} RtcwakeArgsReturn;
-
-#define ALLOC 256
-#define BUFFER_ALLOC 5
-
-// Defining a short sleep time for debug purposes
-#if PREPROCESSOR_DEBUG >= 1
-#define CHECK_DELAY (10)   /* in seconds */
-#else
-#define CHECK_DELAY (10 * 60)   /* in seconds */
-#endif
+// int take_inhibitor_lock (void);
 
 #endif /* SCHEDULER_PRIVATE_H_ */
@@ -0,0 +1,224 @@
+/* database-integrity.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Integrity verdict of the database, checked on the scheduler connection.
+ *
+ * The full "PRAGMA integrity_check" is O(database size), so it only runs on
+ * the first verification, when the database file is replaced, and every
+ * INTEGRITY_CHECK_INTERVAL hours. Otherwise, the verdict is cached while
+ * "PRAGMA data_version" (changed by commits of other connections) stays the
+ * same, and "PRAGMA quick_check" is run when it changes (or, with
+ * DATABASE_IMAGE, when the image is loaded again: its data_version doesn't
+ * change).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include "database-integrity.h"
+#include "scheduler-database.h"
+#include "../database-connection/gawake-types.h"
+#include "../utils/debugger.h"
+
+#define SECONDS_PER_HOUR 3600
+
+typedef enum {
+  CHECK_CACHED,
+  CHECK_QUICK,
+  CHECK_FULL
+} CheckPath;
+
+#if PREPROCESSOR_DEBUG
+static const char *const CHECK_PATH[] = { "cached verdict", "quick_check", "integrity_check" };
+#endif
+
+static bool verified = false;       // is there a verdict?
+static bool verdict = false;
+static bool image_reloaded = false; // not checked since it was loaded again
+static int data_version;
+static dev_t file_device;
+static ino_t file_inode;
+static time_t last_full_check;      // monotonic seconds
+
+static time_t monotonic_seconds (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec;
+}
+
+// Run an integrity_check or quick_check statement; "ok" is its single row if
+// the database is fine
+static int run_check (SchedulerStatement statement, bool *ok)
+{
+  int rc;
+  struct sqlite3_stmt *stmt;
+
+  stmt = scheduler_database_statement (statement);
+  if (stmt == NULL)
+    return EXIT_FAILURE;
+
+  *ok = false;
+  while ((rc = sqlite3_step (stmt)) == SQLITE_ROW)
+    {
+      const unsigned char *result = sqlite3_column_text (stmt, 0);
+      if (result != NULL && strcmp ((const char *) result, "ok") == 0)
+        *ok = true;
+    }
+  if (rc != SQLITE_DONE)
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR (failed checking database integrity): %s\n",
+               sqlite3_errmsg (scheduler_database_get ()));
+      sqlite3_reset (stmt);
+      return EXIT_FAILURE;
+    }
+  sqlite3_reset (stmt);
+
+  return EXIT_SUCCESS;
+}
+
+static int get_data_version (int *version)
+{
+  int rc;
+  struct sqlite3_stmt *stmt;
+
+  stmt = scheduler_database_statement (STATEMENT_DATA_VERSION);
+  if (stmt == NULL)
+    return EXIT_FAILURE;
+
+  rc = sqlite3_step (stmt);
+  if (rc != SQLITE_ROW)
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR (failed getting the data version): %s\n",
+               sqlite3_errmsg (scheduler_database_get ()));
+      sqlite3_reset (stmt);
+      return EXIT_FAILURE;
+    }
+  *version = sqlite3_column_int (stmt, 0);
+  sqlite3_reset (stmt);
+
+  return EXIT_SUCCESS;
+}
+
+/*
+ * Verify the database integrity, running only the check that is needed.
+ * Returns EXIT_SUCCESS if the database is fine.
+ */
+int database_integrity_verify (void)
+{
+  int version;
+  bool ok, reloaded;
+  struct stat file;
+  CheckPath path;
+
+#if PREPROCESSOR_DEBUG
+  struct timespec start, end;
+  clock_gettime (CLOCK_MONOTONIC, &start);
+#endif
+
+  if (stat (DB_PATH, &file) == -1)
+    {
+      DEBUG_PRINT_CONTEX;
+      perror ("ERROR: Couldn't get the database file status");
+      return EXIT_FAILURE;
+    }
+
+  // The database file was replaced: the connection still reads the old one
+  if (verified && (file.st_dev != file_device || file.st_ino != file_inode))
+    {
+      DEBUG_PRINT (("Database file replaced, reopening it"));
+      scheduler_database_close ();
+      verified = false;
+    }
+
+  // Before the other statements: they're prepared again on a new image
+  if (scheduler_database_refresh (&reloaded))
+    return EXIT_FAILURE;
+  image_reloaded |= reloaded;
+
+  if (get_data_version (&version))
+    return EXIT_FAILURE;
+
+  // DECIDE WHICH CHECK IS NEEDED
+  if (!verified
+      || monotonic_seconds () - last_full_check >= INTEGRITY_CHECK_INTERVAL * SECONDS_PER_HOUR)
+    path = CHECK_FULL;
+  else if (version != data_version || image_reloaded)
+    path = CHECK_QUICK;
+  else
+    path = CHECK_CACHED;
+
+  switch (path)
+    {
+    case CHECK_FULL:
+      if (run_check (STATEMENT_INTEGRITY_CHECK, &ok))
+        return EXIT_FAILURE;
+      last_full_check = monotonic_seconds ();
+      verdict = ok;
+      break;
+
+    case CHECK_QUICK:
+      if (run_check (STATEMENT_QUICK_CHECK, &ok))
+        return EXIT_FAILURE;
+      verdict = ok;
+      break;
+
+    case CHECK_CACHED:
+      break;
+
+    default:
+      return EXIT_FAILURE;
+    }
+
+  verified = true;
+  image_reloaded = false;
+  data_version = version;
+  file_device = file.st_dev;
+  file_inode = file.st_ino;
+
+#if PREPROCESSOR_DEBUG
+  clock_gettime (CLOCK_MONOTONIC, &end);
+  DEBUG_PRINT_TIME (("Database integrity (%s): %s, %.3f ms",
+                     CHECK_PATH[path],
+                     verdict ? "ok" : "failed",
+                     (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6));
+#endif
+
+  if (verdict == false)
+    {
+      fprintf (stderr, "ERROR: database integrity check failed\n");
+      return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
+
+// Forget the verdict: the next verification runs the full check
+void database_integrity_invalidate (void)
+{
+  verified = false;
+}
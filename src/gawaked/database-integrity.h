@@ -0,0 +1,7 @@
+#ifndef DATABASE_INTEGRITY_H_
+#define DATABASE_INTEGRITY_H_
+
+int database_integrity_verify (void);
+void database_integrity_invalidate (void);
+
+#endif /* DATABASE_INTEGRITY_H_ */
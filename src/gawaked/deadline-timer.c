@@ -0,0 +1,167 @@
+/* deadline-timer.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * One-shot timer armed on an absolute wall clock time (timerfd with
+ * TFD_TIMER_ABSTIME); it replaces the periodic polling + sleep () of the
+ * scheduler: the kernel wakes the process exactly at the deadline.
+ *
+ * The file descriptor is watched by the scheduler main loop; re-arming it
+ * replaces the previous deadline, so the plan can change at any time.
+ *
+ * Since the deadline is absolute on CLOCK_REALTIME, a suspended system
+ * wakes the timer as soon as it resumes past the deadline. The timer is
+ * also canceled (TFD_TIMER_CANCEL_ON_SET) when the wall clock is set (NTP
+ * step, date change by the admin), so the deadline can be computed again.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+
+#include "deadline-timer.h"
+#include "../utils/debugger.h"
+
+static int timerfd_backend_create (void);
+static int timerfd_backend_set_time (int fd, time_t deadline);
+static ssize_t timerfd_backend_read (int fd, uint64_t *expirations);
+
+static const DeadlineTimerBackend timerfd_backend = {
+  .create = timerfd_backend_create,
+  .set_time = timerfd_backend_set_time,
+  .read = timerfd_backend_read,
+};
+
+static const DeadlineTimerBackend *backend = &timerfd_backend;
+static int timer_fd = -1;
+static time_t armed_deadline;
+
+static int timerfd_backend_create (void)
+{
+  // Non-blocking: the main loop only reads it when it's ready
+  return timerfd_create (CLOCK_REALTIME, TFD_CLOEXEC | TFD_NONBLOCK);
+}
+
+static int timerfd_backend_set_time (int fd, time_t deadline)
+{
+  // it_interval is zero: one-shot timer
+  struct itimerspec spec = {
+    .it_value.tv_sec = deadline,
+  };
+
+  return timerfd_settime (fd, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET, &spec, NULL);
+}
+
+static ssize_t timerfd_backend_read (int fd, uint64_t *expirations)
+{
+  return read (fd, expirations, sizeof (*expirations));
+}
+
+// Set the backend of the timer, before deadline_timer_init (); NULL restores
+// timerfd
+void deadline_timer_set_backend (const DeadlineTimerBackend *timer_backend)
+{
+  backend = (timer_backend != NULL) ? timer_backend : &timerfd_backend;
+}
+
+int deadline_timer_init (void)
+{
+  if (timer_fd >= 0)
+    return EXIT_SUCCESS;
+
+  timer_fd = backend->create ();
+  if (timer_fd < 0)
+    {
+      DEBUG_PRINT_CONTEX;
+      perror ("ERROR: Couldn't create the deadline timer");
+      return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
+
+int deadline_timer_get_fd (void)
+{
+  return timer_fd;
+}
+
+// Arm the timer to expire once, at the given time; a deadline in the past
+// makes the timer expire immediately
+int deadline_timer_arm (time_t deadline)
+{
+  if (backend->set_time (timer_fd, deadline) == -1)
+    {
+      DEBUG_PRINT_CONTEX;
+      perror ("ERROR: Couldn't arm the deadline timer");
+      return EXIT_FAILURE;
+    }
+
+  armed_deadline = deadline;
+  DEBUG_PRINT_TIME (("Deadline timer armed, remaining: %.0f s",
+                     difftime (deadline, time (NULL))));
+
+  return EXIT_SUCCESS;
+}
+
+// Consume the expiration of the timer; must be called when its file descriptor
+// becomes readable
+DeadlineTimerEvent deadline_timer_acknowledge (void)
+{
+  uint64_t expirations;
+
+  if (backend->read (timer_fd, &expirations) != sizeof (expirations))
+    {
+      // ECANCELED: discontinuous change of the wall clock
+      if (errno == ECANCELED)
+        {
+          DEBUG_PRINT_TIME (("Wall clock changed, the deadline timer was canceled"));
+          return DEADLINE_TIMER_CLOCK_CHANGED;
+        }
+
+      // EAGAIN: the timer was re-armed after becoming readable
+      if (errno != EAGAIN)
+        {
+          DEBUG_PRINT_CONTEX;
+          perror ("ERROR: Failed reading the deadline timer");
+        }
+      return DEADLINE_TIMER_FAILED;
+    }
+
+#if PREPROCESSOR_DEBUG
+  // Trigger error: how late the timer woke the process up
+  struct timespec now;
+  clock_gettime (CLOCK_REALTIME, &now);
+  DEBUG_PRINT_TIME (("Deadline reached; trigger error: %.3f ms",
+                     (now.tv_sec - armed_deadline) * 1e3 + now.tv_nsec / 1e6));
+#endif
+
+  return DEADLINE_TIMER_EXPIRED;
+}
+
+void deadline_timer_close (void)
+{
+  if (timer_fd >= 0)
+    close (timer_fd);
+
+  timer_fd = -1;
+}
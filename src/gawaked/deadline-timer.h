@@ -0,0 +1,30 @@
+#ifndef DEADLINE_TIMER_H_
+#define DEADLINE_TIMER_H_
+
+#include <time.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+// Why the timer file descriptor became readable
+typedef enum {
+  DEADLINE_TIMER_EXPIRED,
+  DEADLINE_TIMER_CLOCK_CHANGED,   // the wall clock was set: re-plan
+  DEADLINE_TIMER_FAILED
+} DeadlineTimerEvent;
+
+// Operations on the timer, timerfd by default; replaceable, so the scheduler
+// can run on a virtual clock and the clock changes can be simulated
+typedef struct {
+  int (*create) (void);                             // file descriptor, or -1
+  int (*set_time) (int fd, time_t deadline);        // 0, or -1 (errno set)
+  ssize_t (*read) (int fd, uint64_t *expirations);  // like read ()
+} DeadlineTimerBackend;
+
+void deadline_timer_set_backend (const DeadlineTimerBackend *backend);
+int deadline_timer_init (void);
+int deadline_timer_get_fd (void);
+int deadline_timer_arm (time_t deadline);
+DeadlineTimerEvent deadline_timer_acknowledge (void);
+void deadline_timer_close (void);
+
+#endif /* DEADLINE_TIMER_H_ */
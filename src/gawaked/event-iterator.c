@@ -0,0 +1,268 @@
+/* event-iterator.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * The compiled rules are already sorted by minute of the week, so the events
+ * of a table are its entries in order, wrapping to the next week: each table
+ * keeps a cursor, and the next event is the earliest among the cursors (and
+ * the custom schedule). Getting an event only advances one cursor, so asking
+ * for N events costs N steps, without computing the plan again. The
+ * one-shot wake ups are already sorted, so they're a cursor of their own.
+ * The rules on their exception dates are skipped when the cursor gets to
+ * them: the date of the day is known, so it's a bit test.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "event-iterator.h"
+#include "../utils/debugger.h"
+
+static void cursor_init (EventCursor *cursor,
+                         const WeekIndex *index,
+                         EventKind kind,
+                         bool use_localtime,
+                         time_t now);
+static void cursor_set_next (EventCursor *cursor);
+static time_t cursor_make_time (const EventCursor *cursor, int day, int minutes);
+static void cursor_advance (EventCursor *cursor);
+static void cursor_skip_exceptions (EventCursor *cursor, const ExceptionCalendar *exceptions);
+
+void event_iterator_init (EventIterator *iterator,
+                          time_t now,
+                          const WeekIndex *on_index,
+                          bool on_rules_localtime,
+                          const WeekIndex *off_index)
+{
+  cursor_init (&iterator->cursors[0], on_index, EVENT_TURN_ON, on_rules_localtime, now);
+  // Turn off rules always follow the local time
+  cursor_init (&iterator->cursors[1], off_index, EVENT_TURN_OFF, true, now);
+  iterator->custom_pending = false;
+  iterator->one_shots = NULL;
+  iterator->one_shots_length = 0;
+  iterator->one_shot_position = 0;
+  iterator->exceptions = NULL;
+}
+
+// The custom schedule is a single event, merged with the ones of the rules
+void event_iterator_add_custom (EventIterator *iterator, time_t time, Mode mode)
+{
+  iterator->custom = (UpcomingEvent) {
+    .time = time,
+    .kind = EVENT_CUSTOM_SCHEDULE,
+    .id = 0,
+    .mode = mode,
+  };
+  iterator->custom_pending = true;
+}
+
+// The one-shot wake ups, in time order; they must be kept while iterating
+void event_iterator_add_one_shots (EventIterator *iterator,
+                                   const OneShot *one_shots,
+                                   size_t length)
+{
+  iterator->one_shots = one_shots;
+  iterator->one_shots_length = length;
+  iterator->one_shot_position = 0;
+}
+
+// The exception dates; they must be kept while iterating
+void event_iterator_add_exceptions (EventIterator *iterator,
+                                    const ExceptionCalendar *exceptions)
+{
+  iterator->exceptions = exceptions;
+}
+
+// Get the next event, in time order; returns false if there are no events
+bool event_iterator_next (EventIterator *iterator, UpcomingEvent *event)
+{
+  EventCursor *earliest = NULL;
+  const OneShot *one_shot = NULL;
+
+  for (int i = 0; i < 2; i++)
+    {
+      EventCursor *cursor = &iterator->cursors[i];
+
+      if (cursor->index->length == 0)
+        continue;
+
+      cursor_skip_exceptions (cursor, iterator->exceptions);
+
+      if (earliest == NULL || cursor->next < earliest->next)
+        earliest = cursor;
+    }
+
+  if (iterator->one_shot_position < iterator->one_shots_length)
+    one_shot = &iterator->one_shots[iterator->one_shot_position];
+
+  if (iterator->custom_pending
+      && (earliest == NULL || iterator->custom.time <= earliest->next)
+      && (one_shot == NULL || iterator->custom.time <= one_shot->time))
+    {
+      *event = iterator->custom;
+      iterator->custom_pending = false;
+      return true;
+    }
+
+  if (one_shot != NULL && (earliest == NULL || one_shot->time <= earliest->next))
+    {
+      *event = (UpcomingEvent) {
+        .time = one_shot->time,
+        .kind = EVENT_ONE_SHOT,
+        .id = one_shot->id,
+        .mode = MODE_NO,
+      };
+      iterator->one_shot_position++;
+      return true;
+    }
+
+  if (earliest == NULL)
+    return false;
+
+  const WeekIndexEntry *entry = &earliest->index->entries[earliest->position];
+  *event = (UpcomingEvent) {
+    .time = earliest->next,
+    .kind = earliest->kind,
+    .id = entry->id,
+    .mode = (Mode) entry->mode,
+  };
+
+  cursor_advance (earliest);
+
+  return true;
+}
+
+// Point the cursor to the first entry after the current minute
+static void cursor_init (EventCursor *cursor,
+                         const WeekIndex *index,
+                         EventKind kind,
+                         bool use_localtime,
+                         time_t now)
+{
+  const WeekIndexEntry *entry;
+  int minute, minutes_ahead;
+
+  cursor->index = index;
+  cursor->kind = kind;
+  cursor->use_localtime = use_localtime;
+  cursor->day = -1;
+
+  if (use_localtime)
+    localtime_r (&now, &cursor->week_start);
+  else
+    gmtime_r (&now, &cursor->week_start);
+
+  minute = WEEK_MINUTE (cursor->week_start.tm_wday,
+                        cursor->week_start.tm_hour,
+                        cursor->week_start.tm_min);
+
+  // Back to Sunday, 00:00; normalized when the event time is made
+  cursor->week_start.tm_mday -= cursor->week_start.tm_wday;
+  cursor->week_start.tm_hour = 0;
+  cursor->week_start.tm_min = 0;
+  cursor->week_start.tm_sec = 0;
+
+  entry = week_index_next (index, minute, &minutes_ahead);
+  if (entry == NULL)
+    return;
+
+  cursor->position = entry - index->entries;
+  // Wrapped: the first event is on the next week
+  cursor->week = (entry->minute <= minute) ? 1 : 0;
+  cursor_set_next (cursor);
+}
+
+/*
+ * Set the time of the entry the cursor points to. The beginning of its day
+ * is computed once: while the events are on the same day, and it has 24 h,
+ * the time is just an offset from it
+ */
+static void cursor_set_next (EventCursor *cursor)
+{
+  const WeekIndexEntry *entry = &cursor->index->entries[cursor->position];
+  int day = cursor->week * 7 + entry->minute / MINUTES_PER_DAY;
+  int minutes = entry->minute % MINUTES_PER_DAY;
+
+  if (day != cursor->day)
+    {
+      struct tm date;
+
+      cursor->day = day;
+      cursor->day_start = cursor_make_time (cursor, day, 0);
+      cursor->uniform_day = (cursor_make_time (cursor, day + 1, 0) - cursor->day_start
+                             == MINUTES_PER_DAY * 60);
+
+      if (cursor->use_localtime)
+        localtime_r (&cursor->day_start, &date);
+      else
+        gmtime_r (&cursor->day_start, &date);
+      cursor->year = date.tm_year;
+      cursor->yday = date.tm_yday;
+    }
+
+  if (cursor->uniform_day)
+    cursor->next = cursor->day_start + minutes * 60;
+  else
+    cursor->next = cursor_make_time (cursor, day, minutes);
+}
+
+// Time of the minute of the day, some days after the beginning of the first week
+static time_t cursor_make_time (const EventCursor *cursor, int day, int minutes)
+{
+  struct tm event = cursor->week_start;
+
+  event.tm_mday += day;
+  event.tm_hour = minutes / 60;
+  event.tm_min = minutes % 60;
+
+  return week_index_make_time (&event, cursor->use_localtime);
+}
+
+static void cursor_advance (EventCursor *cursor)
+{
+  if (++cursor->position == cursor->index->length)
+    {
+      cursor->position = 0;
+      cursor->week++;
+    }
+
+  cursor_set_next (cursor);
+}
+
+/*
+ * Move the cursor past the entries on their exception dates. The calendar
+ * only covers some years, so it stops, at most, after them
+ */
+static void cursor_skip_exceptions (EventCursor *cursor, const ExceptionCalendar *exceptions)
+{
+  if (exceptions == NULL)
+    return;
+
+  for (;;)
+    {
+      const WeekIndexEntry *entry = &cursor->index->entries[cursor->position];
+      Table table = (cursor->kind == EVENT_TURN_OFF) ? TABLE_OFF : TABLE_ON;
+
+      if (!exception_calendar_skips (exceptions, table, entry->id, cursor->year, cursor->yday))
+        return;
+
+      cursor_advance (cursor);
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef EVENT_ITERATOR_H_
+#define EVENT_ITERATOR_H_
+
+#include <time.h>
+#include <stdbool.h>
+
+#include "week-index.h"
+#include "exception-calendar.h"
+
+// Position on the compiled rules of a table, possibly some weeks ahead
+typedef struct
+{
+  const WeekIndex *index;
+  EventKind kind;
+  bool use_localtime;
+  size_t position;      // entry of the next event
+  int week;             // weeks after the first one
+  struct tm week_start; // Sunday, 00:00, of the first week
+  time_t next;          // time of the next event
+  // Beginning of the day of the next event, to avoid a mktime () per event;
+  // only used if the day has 24 h (no DST change)
+  int day;              // days after week_start; -1 if not computed
+  time_t day_start;
+  bool uniform_day;
+  int year, yday;       // date of the day, as tm_year and tm_yday
+} EventCursor;
+
+// Upcoming events of the compiled rules (and the custom schedule and the
+// one-shot wake ups), merged in time order, without the ones on exception
+// dates; each event is computed only when it's requested
+typedef struct
+{
+  EventCursor cursors[2];   // turn on, turn off
+  UpcomingEvent custom;
+  bool custom_pending;
+  const OneShot *one_shots; // in time order
+  size_t one_shots_length;
+  size_t one_shot_position;
+  const ExceptionCalendar *exceptions;  // NULL: none
+} EventIterator;
+
+void event_iterator_init (EventIterator *iterator,
+                          time_t now,
+                          const WeekIndex *on_index,
+                          bool on_rules_localtime,
+                          const WeekIndex *off_index);
+void event_iterator_add_custom (EventIterator *iterator, time_t time, Mode mode);
+void event_iterator_add_one_shots (EventIterator *iterator,
+                                   const OneShot *one_shots,
+                                   size_t length);
+void event_iterator_add_exceptions (EventIterator *iterator,
+                                    const ExceptionCalendar *exceptions);
+bool event_iterator_next (EventIterator *iterator, UpcomingEvent *event);
+
+#endif /* EVENT_ITERATOR_H_ */
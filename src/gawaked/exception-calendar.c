@@ -0,0 +1,202 @@
+/* exception-calendar.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * The exception dates (e.g. holidays) are compiled into bitsets of the days
+ * of the year, 366 bits per year, so checking whether a rule runs on a date
+ * is a bit test on the tm_year and tm_yday the scheduler already has.
+ * Exceptions of all the rules have a bitset of their own; the rules with
+ * dates of their own (usually few) get one each, found by a binary search,
+ * with the dates of all the rules merged in.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "exception-calendar.h"
+#include "../utils/debugger.h"
+
+#define INITIAL_ALLOC 4
+
+#define IS_LEAP_YEAR(year) \
+  (((year) % 4 == 0 && (year) % 100 != 0) || (year) % 400 == 0)
+
+static const int DAYS_BEFORE_MONTH[12] = {
+  0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334
+};
+
+void exception_calendar_init (ExceptionCalendar *calendar)
+{
+  memset (calendar, 0, sizeof (*calendar));
+}
+
+// Remove all the dates, and cover the years from "first_year" (as tm_year);
+// the allocated memory is kept to be reused
+void exception_calendar_reset (ExceptionCalendar *calendar, int first_year)
+{
+  calendar->first_year = first_year;
+  memset (calendar->all, 0, sizeof (calendar->all));
+  calendar->length = 0;
+}
+
+static int compare_scope (const ExceptionScope *scope, Table table, int64_t rule_id)
+{
+  if (scope->table != table)
+    return (scope->table < table) ? -1 : 1;
+  if (scope->rule_id != rule_id)
+    return (scope->rule_id < rule_id) ? -1 : 1;
+  return 0;
+}
+
+// Index of the scope, or where it would be inserted
+static size_t find_scope (const ExceptionCalendar *calendar, Table table, int64_t rule_id)
+{
+  size_t low = 0, high = calendar->length;
+
+  while (low < high)
+    {
+      size_t middle = low + (high - low) / 2;
+
+      if (compare_scope (&calendar->scopes[middle], table, rule_id) < 0)
+        low = middle + 1;
+      else
+        high = middle;
+    }
+
+  return low;
+}
+
+// Get the scope of the rule, adding it (with the dates of all the rules) if
+// it's new; NULL on failure
+static ExceptionScope *get_scope (ExceptionCalendar *calendar, Table table, int64_t rule_id)
+{
+  size_t i = find_scope (calendar, table, rule_id);
+  ExceptionScope *scope;
+
+  if (i < calendar->length && compare_scope (&calendar->scopes[i], table, rule_id) == 0)
+    return &calendar->scopes[i];
+
+  if (calendar->length == calendar->allocated)
+    {
+      size_t allocated = (calendar->allocated == 0) ? INITIAL_ALLOC : calendar->allocated * 2;
+      ExceptionScope *scopes = realloc (calendar->scopes, allocated * sizeof (*scopes));
+      if (scopes == NULL)
+        {
+          DEBUG_PRINT_CONTEX;
+          fprintf (stderr, "ERROR: Failed to allocate memory\n");
+          return NULL;
+        }
+
+      calendar->scopes = scopes;
+      calendar->allocated = allocated;
+    }
+
+  scope = &calendar->scopes[i];
+  memmove (scope + 1, scope, (calendar->length - i) * sizeof (*scope));
+  calendar->length++;
+
+  scope->table = table;
+  scope->rule_id = rule_id;
+  memcpy (scope->days, calendar->all, sizeof (scope->days));
+
+  return scope;
+}
+
+/*
+ * Add an exception date ('YYYY-MM-DD'): of all the rules if "rule_id" is 0,
+ * else of that rule of "table". Dates out of the years covered are ignored
+ */
+int exception_calendar_add (ExceptionCalendar *calendar,
+                            const char *date,
+                            Table table,
+                            int64_t rule_id)
+{
+  int year, month, day, offset, bit;
+
+  if (sscanf (date, "%4d-%2d-%2d", &year, &month, &day) != 3
+      || month < 1 || month > 12 || day < 1 || day > 31)
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR: Invalid exception date \"%s\"\n", date);
+      return EXIT_FAILURE;
+    }
+
+  offset = (year - 1900) - calendar->first_year;
+  if (offset < 0 || offset >= EXCEPTION_CALENDAR_YEARS)
+    return EXIT_SUCCESS;
+
+  // Same as tm_yday
+  bit = offset * EXCEPTION_CALENDAR_DAYS
+    + DAYS_BEFORE_MONTH[month - 1] + (month > 2 && IS_LEAP_YEAR (year)) + day - 1;
+
+  if (rule_id == 0)
+    {
+      calendar->all[bit / 64] |= UINT64_C (1) << (bit % 64);
+      // The rules with dates of their own also skip these
+      for (size_t i = 0; i < calendar->length; i++)
+        calendar->scopes[i].days[bit / 64] |= UINT64_C (1) << (bit % 64);
+    }
+  else
+    {
+      ExceptionScope *scope = get_scope (calendar, table, rule_id);
+      if (scope == NULL)
+        return EXIT_FAILURE;
+
+      scope->days[bit / 64] |= UINT64_C (1) << (bit % 64);
+    }
+
+  return EXIT_SUCCESS;
+}
+
+/*
+ * Whether the rule doesn't run on the date; "year" and "yday" as tm_year and
+ * tm_yday. Dates out of the years covered have no exceptions
+ */
+bool exception_calendar_skips (const ExceptionCalendar *calendar,
+                               Table table,
+                               int64_t rule_id,
+                               int year,
+                               int yday)
+{
+  const uint64_t *days = calendar->all;
+  int offset = year - calendar->first_year, bit;
+
+  if (offset < 0 || offset >= EXCEPTION_CALENDAR_YEARS)
+    return false;
+
+  if (calendar->length > 0)
+    {
+      size_t i = find_scope (calendar, table, rule_id);
+
+      if (i < calendar->length && compare_scope (&calendar->scopes[i], table, rule_id) == 0)
+        days = calendar->scopes[i].days;
+    }
+
+  bit = offset * EXCEPTION_CALENDAR_DAYS + yday;
+
+  return (days[bit / 64] >> (bit % 64)) & 1;
+}
+
+void exception_calendar_free (ExceptionCalendar *calendar)
+{
+  free (calendar->scopes);
+  exception_calendar_init (calendar);
+}
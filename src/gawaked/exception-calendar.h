@@ -0,0 +1,48 @@
+#ifndef EXCEPTION_CALENDAR_H_
+#define EXCEPTION_CALENDAR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../database-connection/gawake-types.h"
+
+// The year being planned and the next one, so a week ahead always fits
+#define EXCEPTION_CALENDAR_YEARS 2
+#define EXCEPTION_CALENDAR_DAYS 366
+#define EXCEPTION_CALENDAR_WORDS \
+  ((EXCEPTION_CALENDAR_YEARS * EXCEPTION_CALENDAR_DAYS + 63) / 64)
+
+// Exception dates of a scope: bit (year * 366 + day of the year)
+typedef struct
+{
+  Table table;
+  int64_t rule_id;
+  uint64_t days[EXCEPTION_CALENDAR_WORDS];
+} ExceptionScope;
+
+// Exception dates compiled into bitsets: one for all the rules, and one for
+// each rule with dates of its own
+typedef struct
+{
+  int first_year;           // as tm_year: years since 1900
+  uint64_t all[EXCEPTION_CALENDAR_WORDS];
+  ExceptionScope *scopes;   // sorted by table and rule id
+  size_t length;
+  size_t allocated;
+} ExceptionCalendar;
+
+void exception_calendar_init (ExceptionCalendar *calendar);
+void exception_calendar_reset (ExceptionCalendar *calendar, int first_year);
+int exception_calendar_add (ExceptionCalendar *calendar,
+                            const char *date,
+                            Table table,
+                            int64_t rule_id);
+bool exception_calendar_skips (const ExceptionCalendar *calendar,
+                               Table table,
+                               int64_t rule_id,
+                               int year,
+                               int yday);
+void exception_calendar_free (ExceptionCalendar *calendar);
+
+#endif /* EXCEPTION_CALENDAR_H_ */
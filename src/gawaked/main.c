@@ -28,8 +28,53 @@
 // PID: Process ID
 static pid_t pid;
 
-int main (void)
+// Resident: instead of exiting after rtcwake, stay alive and schedule again
+// when the system resumes
+static bool resident = false;
+
+int main (int argc, char **argv)
 {
+  int c;
+  time_t simulate_from, simulate_to;
+  bool simulate = false;
+  static const struct option long_options[] = {
+    { "resident", no_argument,       NULL, 'r' },
+    { "simulate", required_argument, NULL, 's' },
+    { "help",     no_argument,       NULL, 'h' },
+    { NULL,       0,                 NULL, 0   }
+  };
+
+  while ((c = getopt_long (argc, argv, "rs:h", long_options, NULL)) != -1)
+    {
+      switch (c)
+        {
+        case 'r':
+          resident = true;
+          break;
+
+        case 's':
+          if (parse_simulation_range (optarg, &simulate_from, &simulate_to))
+            {
+              fprintf (stderr, "Invalid range. It must be on format \"YYYYMMDD..YYYYMMDD\".\n");
+              return EXIT_FAILURE;
+            }
+          simulate = true;
+          break;
+
+        case 'h':
+          usage ();
+          return EXIT_SUCCESS;
+
+        default:
+          usage ();
+          return EXIT_FAILURE;
+        }
+    }
+
+  // Simulation: no privileges, scheduler child or rtcwake are needed
+  if (simulate)
+    return scheduler_simulate (simulate_from, simulate_to);
+
   // Init privileges utility (get gawake uid/gid)
   if (init_privileges ())
     exit (EXIT_FAILURE);
@@ -56,6 +101,23 @@ int main (void)
       fprintf (stderr, "Error on pipe\n");
       exit (EXIT_FAILURE);
     }
+
+  // Resident: the parent tells the child, through another pipe, that rtcwake
+  // returned (the system resumed)
+  int resume_fd[2] = { -1, -1 };
+  if (resident)
+    {
+      if (pipe (resume_fd) == -1)
+        {
+          DEBUG_PRINT_CONTEX;
+          fprintf (stderr, "Error on pipe\n");
+          exit (EXIT_FAILURE);
+        }
+
+      // The child may end first (SIGTERM): a failed write is handled
+      signal (SIGPIPE, SIG_IGN);
+    }
+
   pid = fork ();
 
   if (pid < 0)
@@ -83,12 +145,18 @@ int main (void)
           // No need to exit
         }
 
-      // Call gawake-scheduler:
-      int scheduler_return;
-
       // Close the read file descriptor
       close (fd[0]);
 
+      if (resident)
+        {
+          close (resume_fd[1]);
+          exit (resident_scheduler (fd[1], resume_fd[0]));
+        }
+
+      // Call gawake-scheduler:
+      int scheduler_return;
+
       // Call scheduler function, passing pointer to arguments that must be filled
       scheduler_return = scheduler (&rtcwake_args);
 
@@ -131,6 +199,12 @@ int main (void)
       // Close write file descriptor
       close (fd[1]);
 
+      if (resident)
+        {
+          close (resume_fd[0]);
+          return resident_loop (fd[0], resume_fd[1]);
+        }
+
       // Wait for child process
       wait (&exit_status);
 
@@ -161,7 +235,7 @@ int main (void)
         }
 
       // Read values returned from child
-      if (read (fd[0], &rtcwake_args, RtcwakeArgs_s) == -1)
+      if (read (fd[0], &rtcwake_args, RtcwakeArgs_s) != RtcwakeArgs_s)
         {
           DEBUG_PRINT_CONTEX;
           fprintf (stderr, "ERROR when reading from pipe\n");
@@ -171,65 +245,218 @@ int main (void)
       // close pipe, as it won't be used anymore
       close (fd[0]);
 
-      DEBUG_PRINT (("RtcwakeArgs fields read from pipe by gawaked process:\n"\
-              "\tFound: %d\n\tShutdown: %d"\
-              "\n\t(HH:MM) %02d:%02d (DD/MM/YYYY) %02d/%02d/%d"\
-              "\n\tMode: %d",
-              rtcwake_args.found, rtcwake_args.run_shutdown,
-              rtcwake_args.hour, rtcwake_args.minutes,
-              rtcwake_args.day, rtcwake_args.month, rtcwake_args.year,
-              rtcwake_args.mode));
-
-      // Being paranoic for security, re-check the parameters;
-      if (validade_rtcwake_args (&rtcwake_args) == -1)
-        {
-          DEBUG_PRINT_CONTEX;
-          fprintf (stderr, "ERROR: failed on rtcwake arguments validation\n");
-          exit (EXIT_FAILURE);
-        }
+      if (run_rtcwake (rtcwake_args))
+        exit (EXIT_FAILURE);
+    }
 
-      // Run shutdown if it's the case
-      if (rtcwake_args.run_shutdown)
-        {
-          DEBUG_PRINT (("Shutdown"));
-          system (SHUTDOWN);
-          exit (EXIT_SUCCESS);
-        }
+  return EXIT_SUCCESS;
+}
+
+/*
+ * Scheduler child of a resident gawaked: the scheduler is set up once, and
+ * run again each time the parent tells that rtcwake returned, so a
+ * sleep/wake cycle doesn't pay for a new process, D-Bus proxy and database
+ * connection
+ */
+static int resident_scheduler (int args_fd, int resume_fd)
+{
+  RtcwakeArgs rtcwake_args;
+  bool terminate = false;
+  char resumed;
+  int ret = EXIT_SUCCESS;
+
+  if (scheduler_init (&rtcwake_args))
+    {
+      close (args_fd);
+      close (resume_fd);
+      return EXIT_FAILURE;
+    }
+
+  while (!terminate)
+    {
+      if (scheduler_run (&terminate))
+        break;
+
+      DEBUG_PRINT (("RtcwakeArgs fields returned by scheduler_run ():\n"\
+                    "\tFound: %d\n\tShutdown: %d"\
+                    "\n\t(HH:MM) %02d:%02d (DD/MM/YYYY) %02d/%02d/%d"\
+                    "\n\tMode: %d",
+                    rtcwake_args.found, rtcwake_args.shutdown_fail,
+                    rtcwake_args.hour, rtcwake_args.minutes,
+                    rtcwake_args.day, rtcwake_args.month, rtcwake_args.year,
+                    rtcwake_args.mode));
 
-      // Prepare command
-      char *command;
-      command = (char *) malloc (COMMAND_LENGTH * sizeof (char));
-      if (command == NULL)
+      if (write (args_fd, &rtcwake_args, RtcwakeArgs_s) == -1)
         {
           DEBUG_PRINT_CONTEX;
-          fprintf (stderr, "ERROR: couldn't allocate memory\n");
-          exit (EXIT_FAILURE);
+          fprintf (stderr, "ERROR when writing to pipe\n");
+          ret = EXIT_FAILURE;
+          break;
         }
-      snprintf (command,
-                COMMAND_LENGTH,
-                COMMAND_BEGINNING COMMAND_ARGUMENTS
-                COMMAND_TIMESTAMP "%d%02d%02d%02d%02d00"
-                COMMAND_MODE "%s",
-                rtcwake_args.year, rtcwake_args.month, rtcwake_args.day, rtcwake_args.hour, rtcwake_args.minutes,
+
+      if (terminate)
+        break;
+
+      // Block until rtcwake returns: the system resumed (or the parent ended)
+      if (read (resume_fd, &resumed, sizeof (resumed)) != sizeof (resumed))
+        break;
+    }
+
+  scheduler_end ();
+  close (args_fd);
+  close (resume_fd);
+
+  return ret;
+}
+
+// Parent of a resident gawaked: run rtcwake for each RtcwakeArgs sent by the
+// scheduler, until it ends
+static int resident_loop (int args_fd, int resume_fd)
+{
+  RtcwakeArgs rtcwake_args;
+  int exit_status;
+  const char resumed = 'r';
+
+  while (read (args_fd, &rtcwake_args, RtcwakeArgs_s) == RtcwakeArgs_s)
+    {
+      // A failed rtcwake doesn't end gawaked: the scheduler tries again on
+      // the next rule
+      run_rtcwake (rtcwake_args);
+
+      // The system resumed: let the scheduler plan the next deadline
+      if (write (resume_fd, &resumed, sizeof (resumed)) == -1)
+        break;
+    }
+
+  close (args_fd);
+  close (resume_fd);
+
+  // Wait for child process
+  wait (&exit_status);
+
+  if (!WIFEXITED (exit_status) || WEXITSTATUS (exit_status) != EXIT_SUCCESS)
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR: scheduler child process exited unsuccessfully; "\
+               "terminating parent process\n");
+      return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
+
+// Run rtcwake (or shutdown) with the arguments returned by the scheduler;
+// it returns when the system resumes
+static int run_rtcwake (RtcwakeArgs rtcwake_args)
+{
+  DEBUG_PRINT (("RtcwakeArgs fields read from pipe by gawaked process:\n"\
+          "\tFound: %d\n\tShutdown: %d"\
+          "\n\t(HH:MM) %02d:%02d (DD/MM/YYYY) %02d/%02d/%d"\
+          "\n\tMode: %d",
+          rtcwake_args.found, rtcwake_args.run_shutdown,
+          rtcwake_args.hour, rtcwake_args.minutes,
+          rtcwake_args.day, rtcwake_args.month, rtcwake_args.year,
+          rtcwake_args.mode));
+
+  // Being paranoic for security, re-check the parameters;
+  if (validade_rtcwake_args (&rtcwake_args) == -1)
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR: failed on rtcwake arguments validation\n");
+      return EXIT_FAILURE;
+    }
+
+  // Run shutdown if it's the case
+  if (rtcwake_args.run_shutdown)
+    {
+      DEBUG_PRINT (("Shutdown"));
+      system (SHUTDOWN);
+      exit (EXIT_SUCCESS);
+    }
+
+  // Prepare command
+  char *command;
+  command = (char *) malloc (COMMAND_LENGTH * sizeof (char));
+  if (command == NULL)
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR: couldn't allocate memory\n");
+      return EXIT_FAILURE;
+    }
+  snprintf (command,
+            COMMAND_LENGTH,
+            COMMAND_BEGINNING COMMAND_ARGUMENTS
+            COMMAND_TIMESTAMP "%d%02d%02d%02d%02d00"
+            COMMAND_MODE "%s",
+            rtcwake_args.year, rtcwake_args.month, rtcwake_args.day, rtcwake_args.hour, rtcwake_args.minutes,
 #if MODE_ALWAYS_ON
-                // Set mode to "on" if this is a developing/debug version
-                "on");
+            // Set mode to "on" if this is a developing/debug version
+            "on");
 #else
-                MODE[rtcwake_args.mode]);
+            MODE[rtcwake_args.mode]);
 #endif
 
-      DEBUG_PRINT (("Command: %s\nLength: %ld", command, COMMAND_LENGTH));
+  DEBUG_PRINT (("Command: %s\nLength: %ld", command, COMMAND_LENGTH));
 
-      raise_privileges ();
-      system (command);
-      drop_privileges_permanently ();
+  raise_privileges ();
+  system (command);
+  // A resident gawaked runs rtcwake again on the next cycle
+  if (resident)
+    drop_privileges ();
+  else
+    drop_privileges_permanently ();
 
-      free (command);
-    }
+  free (command);
 
   return EXIT_SUCCESS;
 }
 
+/*
+ * Parse "YYYYMMDD..YYYYMMDD" into the beginning (00:00, local time) of both
+ * days; the range doesn't include the last day
+ */
+static int parse_simulation_range (const char *range, time_t *from, time_t *to)
+{
+  struct tm from_tm = { 0 }, to_tm = { 0 };
+  int length = 0;
+
+  if (sscanf (range, "%4d%2d%2d..%4d%2d%2d%n",
+              &from_tm.tm_year, &from_tm.tm_mon, &from_tm.tm_mday,
+              &to_tm.tm_year, &to_tm.tm_mon, &to_tm.tm_mday, &length) != 6
+      || range[length] != '\0'
+      || strlen (range) != 18)
+    return EXIT_FAILURE;
+
+  from_tm.tm_year -= 1900;
+  from_tm.tm_mon -= 1;
+  from_tm.tm_isdst = -1;
+  to_tm.tm_year -= 1900;
+  to_tm.tm_mon -= 1;
+  to_tm.tm_isdst = -1;
+
+  *from = mktime (&from_tm);
+  *to = mktime (&to_tm);
+
+  if (*from == (time_t) -1 || *to == (time_t) -1 || *from >= *to)
+    return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
+}
+
+static void usage (void)
+{
+  printf ("Usage: gawaked [OPTION]\n"
+          "Gawake scheduler: turns off the system on the turn off rules, "
+          "setting the upcoming turn on rule with rtcwake.\n\n"
+          "  -r, --resident    stay alive across suspend and resume, scheduling "
+          "again when the system resumes\n"
+          "  -s, --simulate FROM..TO\n"
+          "                    run the scheduler on a virtual clock, from the day\n"
+          "                    FROM up to the day TO (YYYYMMDD..YYYYMMDD), and print\n"
+          "                    its decisions\n"
+          "  -h, --help        show this help\n");
+}
+
 // TODO remove this function (?)
 static void exit_handler (int sig)
 {
@@ -240,4 +467,3 @@ static void exit_handler (int sig)
 
   exit (EXIT_SUCCESS);
 }
-
@@ -5,6 +5,9 @@
 #include <unistd.h>
 #include <stdio.h>
 #include <string.h>
+#include <stdbool.h>
+#include <signal.h>
+#include <getopt.h>
 #include <sys/wait.h>
 #include <sys/prctl.h>
 
@@ -30,6 +33,11 @@
                         + strlen (COMMAND_MODE) + strlen (MODE[rtcwake_args.mode])\
                         + 1)
 
+static int resident_scheduler (int args_fd, int resume_fd);
+static int resident_loop (int args_fd, int resume_fd);
+static int run_rtcwake (RtcwakeArgs rtcwake_args);
+static int parse_simulation_range (const char *range, time_t *from, time_t *to);
+static void usage (void);
 static void exit_handler (int sig);
 
 #endif /* __GAWAKED_H_ */
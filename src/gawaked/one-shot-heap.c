@@ -0,0 +1,151 @@
+/* one-shot-heap.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * The one-shot wake ups are kept in a binary min-heap: the upcoming one is
+ * always the root, so it's read without a search, and the expired ones are
+ * removed from the root, in O(log n) each.
+ * The database returns them in time order, and a sorted array is already a
+ * heap: pushed in that order, none of them moves up, so loading them is
+ * O(n).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "one-shot-heap.h"
+#include "../utils/debugger.h"
+
+#define INITIAL_ALLOC 16
+
+// Order by time; same time: deterministic order
+static int is_before (const OneShotEntry *a, const OneShotEntry *b)
+{
+  return (a->time != b->time) ? a->time < b->time : a->id < b->id;
+}
+
+static void swap (OneShotEntry *a, OneShotEntry *b)
+{
+  OneShotEntry tmp = *a;
+
+  *a = *b;
+  *b = tmp;
+}
+
+void one_shot_heap_init (OneShotHeap *heap)
+{
+  heap->entries = NULL;
+  heap->length = 0;
+  heap->allocated = 0;
+}
+
+int one_shot_heap_push (OneShotHeap *heap, int64_t id, int64_t time)
+{
+  size_t i;
+
+  if (heap->length == heap->allocated)
+    {
+      size_t allocated = (heap->allocated == 0) ? INITIAL_ALLOC : heap->allocated * 2;
+      OneShotEntry *entries = realloc (heap->entries, allocated * sizeof (*entries));
+      if (entries == NULL)
+        {
+          DEBUG_PRINT_CONTEX;
+          fprintf (stderr, "ERROR: Failed to allocate memory\n");
+          return EXIT_FAILURE;
+        }
+
+      heap->entries = entries;
+      heap->allocated = allocated;
+    }
+
+  i = heap->length++;
+  heap->entries[i] = (OneShotEntry) {
+    .time = time,
+    .id = id,
+  };
+
+  // Sift up
+  while (i > 0 && is_before (&heap->entries[i], &heap->entries[(i - 1) / 2]))
+    {
+      swap (&heap->entries[i], &heap->entries[(i - 1) / 2]);
+      i = (i - 1) / 2;
+    }
+
+  return EXIT_SUCCESS;
+}
+
+// Get the upcoming one-shot wake up; NULL if there's none
+const OneShotEntry *one_shot_heap_peek (const OneShotHeap *heap)
+{
+  return (heap->length > 0) ? &heap->entries[0] : NULL;
+}
+
+// Remove the upcoming one-shot wake up
+void one_shot_heap_pop (OneShotHeap *heap)
+{
+  size_t i = 0;
+
+  if (heap->length == 0)
+    return;
+
+  heap->entries[0] = heap->entries[--heap->length];
+
+  // Sift down
+  for (;;)
+    {
+      size_t left = 2 * i + 1, right = left + 1, smallest = i;
+
+      if (left < heap->length && is_before (&heap->entries[left], &heap->entries[smallest]))
+        smallest = left;
+      if (right < heap->length && is_before (&heap->entries[right], &heap->entries[smallest]))
+        smallest = right;
+      if (smallest == i)
+        break;
+
+      swap (&heap->entries[i], &heap->entries[smallest]);
+      i = smallest;
+    }
+}
+
+// Remove the one-shot wake ups up to "now"; returns how many were removed
+size_t one_shot_heap_prune (OneShotHeap *heap, int64_t now)
+{
+  size_t removed = 0;
+
+  while (heap->length > 0 && heap->entries[0].time <= now)
+    {
+      one_shot_heap_pop (heap);
+      removed++;
+    }
+
+  return removed;
+}
+
+// Remove all the entries, keeping the allocated memory to be reused
+void one_shot_heap_reset (OneShotHeap *heap)
+{
+  heap->length = 0;
+}
+
+void one_shot_heap_free (OneShotHeap *heap)
+{
+  free (heap->entries);
+  one_shot_heap_init (heap);
+}
@@ -0,0 +1,31 @@
+#ifndef ONE_SHOT_HEAP_H_
+#define ONE_SHOT_HEAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// A queued one-shot wake up
+typedef struct
+{
+  int64_t time;       // seconds since the epoch
+  int64_t id;
+} OneShotEntry;
+
+// Binary min-heap of the one-shot wake ups, by time: the upcoming one is
+// the root
+typedef struct
+{
+  OneShotEntry *entries;
+  size_t length;
+  size_t allocated;
+} OneShotHeap;
+
+void one_shot_heap_init (OneShotHeap *heap);
+int one_shot_heap_push (OneShotHeap *heap, int64_t id, int64_t time);
+const OneShotEntry *one_shot_heap_peek (const OneShotHeap *heap);
+void one_shot_heap_pop (OneShotHeap *heap);
+size_t one_shot_heap_prune (OneShotHeap *heap, int64_t now);
+void one_shot_heap_reset (OneShotHeap *heap);
+void one_shot_heap_free (OneShotHeap *heap);
+
+#endif /* ONE_SHOT_HEAP_H_ */
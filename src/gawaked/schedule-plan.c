@@ -0,0 +1,46 @@
+/* schedule-plan.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * The plan computed by the scheduler. It's written and read only from the
+ * scheduler's main loop, so a reload replaces it in place: no reader can
+ * see it half built.
+ */
+
+#include "schedule-plan.h"
+
+static SchedulePlan current = { .off_rule.found = false };
+
+// Replace the current plan
+void schedule_plan_publish (const UpcomingOffRule *off_rule)
+{
+  current.off_rule = *off_rule;
+}
+
+const SchedulePlan *schedule_plan_get (void)
+{
+  return &current;
+}
+
+// Forget the current plan
+void schedule_plan_clear (void)
+{
+  current = (SchedulePlan) { .off_rule.found = false };
+}
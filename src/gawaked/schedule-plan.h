@@ -0,0 +1,15 @@
+#ifndef SCHEDULE_PLAN_H_
+#define SCHEDULE_PLAN_H_
+
+#include "scheduler.h"
+
+// The plan computed by the scheduler
+typedef struct {
+  UpcomingOffRule off_rule;
+} SchedulePlan;
+
+void schedule_plan_publish (const UpcomingOffRule *off_rule);
+const SchedulePlan *schedule_plan_get (void);
+void schedule_plan_clear (void);
+
+#endif /* SCHEDULE_PLAN_H_ */
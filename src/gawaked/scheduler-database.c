@@ -0,0 +1,333 @@
+/* scheduler-database.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Read-only connection owned by the scheduler, kept open while it runs; it's
+ * a GawakeDb of its own, so the library queries don't share any state with
+ * the other programs.
+ * The statements are prepared once, on their first use, and only reset and
+ * rebound on each query; the connection reads the changes made by the
+ * server, since SQLite checks the database file on each new transaction.
+ *
+ * With DATABASE_IMAGE, the queries run on a copy of the database in memory,
+ * without file locks nor disk reads; scheduler_database_refresh () loads it
+ * again when the file changed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "scheduler-database.h"
+#include "database-integrity.h"
+#include "../database-connection/gawake-types.h"
+#include "../utils/debugger.h"
+
+static GawakeDb *db = NULL;
+static sqlite3_stmt *statements[STATEMENT_COUNT];
+
+// Index matches SchedulerStatement
+static const char *const SQL[STATEMENT_COUNT] = {
+  // STATEMENT_INTEGRITY_CHECK
+  "PRAGMA integrity_check;",
+  // STATEMENT_QUICK_CHECK
+  "PRAGMA quick_check;",
+  // STATEMENT_DATA_VERSION
+  "PRAGMA data_version;",
+  // STATEMENT_RULES_ON: turn on rules have no mode; both are covered by the
+  // (active, days_mask, minute) indexes
+  "SELECT id, minute, days_mask, 0 FROM rules_turnon WHERE active = 1;",
+  // STATEMENT_RULES_OFF
+  "SELECT id, minute, days_mask, mode FROM rules_turnoff WHERE active = 1;",
+  // STATEMENT_RULE_ON: a single rule, if it's active; to patch the compiled
+  // rules without trusting the values of the DatabaseUpdated signal
+  "SELECT minute, days_mask, 0 FROM rules_turnon WHERE id = ?1 AND active = 1;",
+  // STATEMENT_RULE_OFF
+  "SELECT minute, days_mask, mode FROM rules_turnoff WHERE id = ?1 AND active = 1;",
+  // STATEMENT_ONE_SHOTS: the upcoming ones, in time order, from the
+  // (wake_time) index
+  "SELECT id, wake_time FROM one_shot_schedule WHERE wake_time > ?1 ORDER BY wake_time;",
+  // STATEMENT_EXCEPTIONS: the dates of the years covered by the calendar
+  // ('YYYY-01-01' bounds), a range of the (date, rule_table, rule_id) index
+  "SELECT date, rule_table, rule_id FROM exception_dates WHERE date >= ?1 AND date < ?2;",
+};
+
+#if PREPROCESSOR_DEBUG
+/*
+ * Print the query plan of the statement; the queries of the rules must
+ * search the indexes, a "SCAN" means a full table scan
+ */
+static void explain_statement (const char *sql)
+{
+  sqlite3_stmt *stmt;
+  char *explain = sqlite3_mprintf ("EXPLAIN QUERY PLAN %s", sql);
+
+  if (explain == NULL)
+    return;
+
+  if (sqlite3_prepare_v2 (gawake_db_get_connection (db), explain, -1, &stmt, NULL) == SQLITE_OK)
+    {
+      while (sqlite3_step (stmt) == SQLITE_ROW)
+        {
+          const char *detail = (const char *) sqlite3_column_text (stmt, 3);
+
+          DEBUG_PRINT (("Query plan of \"%s\": %s%s", sql, detail,
+                        (detail != NULL && strncmp (detail, "SCAN", 4) == 0) ?
+                        " (WARNING: full scan)" : ""));
+        }
+      sqlite3_finalize (stmt);
+    }
+
+  sqlite3_free (explain);
+}
+#endif
+
+int scheduler_database_open (void)
+{
+  if (db != NULL)
+    return EXIT_SUCCESS;
+
+  // The security options are enabled by the library
+#if DATABASE_IMAGE
+  db = gawake_db_open_image ();
+#else
+  db = gawake_db_open (true);
+#endif
+  if (db == NULL)
+    return EXIT_FAILURE;
+
+  sqlite3_exec (gawake_db_get_connection (db),
+                "PRAGMA cell_size_check=ON; PRAGMA mmap_size=0; PRAGMA trusted_schema=OFF;",
+                NULL, 0, NULL);
+
+  // data_version values are specific to a connection
+  database_integrity_invalidate ();
+
+  DEBUG_PRINT (("Scheduler database connection opened"));
+
+  return EXIT_SUCCESS;
+}
+
+sqlite3 *scheduler_database_get (void)
+{
+  return (db != NULL) ? gawake_db_get_connection (db) : NULL;
+}
+
+// Get the connection for the library queries, opening it if needed; returns
+// NULL on failure
+GawakeDb *scheduler_database_get_db (void)
+{
+  if (scheduler_database_open ())
+    return NULL;
+
+  return db;
+}
+
+// If the last query failed because another program held the database for
+// longer than the busy timeout
+bool scheduler_database_busy (void)
+{
+  int rc;
+
+  if (db == NULL)
+    return false;
+
+  rc = sqlite3_errcode (gawake_db_get_connection (db));
+
+  return (rc == SQLITE_BUSY || rc == SQLITE_LOCKED);
+}
+
+/*
+ * Get the statement, ready to be bound and stepped; the connection is opened
+ * and the statement prepared if needed. Returns NULL on failure.
+ */
+sqlite3_stmt *scheduler_database_statement (SchedulerStatement statement)
+{
+  int rc;
+  sqlite3_stmt *stmt;
+
+  if (scheduler_database_open ())
+    return NULL;
+
+  stmt = statements[statement];
+  if (stmt == NULL)
+    {
+      rc = sqlite3_prepare_v3 (gawake_db_get_connection (db), SQL[statement], -1,
+                               SQLITE_PREPARE_PERSISTENT, &stmt, NULL);
+      if (rc != SQLITE_OK)
+        {
+          DEBUG_PRINT_CONTEX;
+          fprintf (stderr, "ERROR: Failed preparing statement: %s\n"\
+                   "SQL: %s\n", sqlite3_errmsg (gawake_db_get_connection (db)), SQL[statement]);
+          return NULL;
+        }
+
+      statements[statement] = stmt;
+#if PREPROCESSOR_DEBUG
+      explain_statement (SQL[statement]);
+#endif
+      return stmt;
+    }
+
+  // The previous result (or error) was already handled
+  sqlite3_reset (stmt);
+  sqlite3_clear_bindings (stmt);
+
+  return stmt;
+}
+
+static void finalize_statements (void)
+{
+  for (int i = 0; i < STATEMENT_COUNT; i++)
+    {
+      sqlite3_finalize (statements[i]);
+      statements[i] = NULL;
+    }
+}
+
+/*
+ * See the changes of the database file; only needed with DATABASE_IMAGE,
+ * reloaded tells if the image was loaded again (i.e. the data may have
+ * changed)
+ */
+int scheduler_database_refresh (bool *reloaded)
+{
+  *reloaded = false;
+
+  if (scheduler_database_open ())
+    return EXIT_FAILURE;
+
+  if (gawake_db_refresh_image (db, reloaded))
+    return EXIT_FAILURE;
+
+  // Prepared on the previous image
+  if (*reloaded)
+    finalize_statements ();
+
+  return EXIT_SUCCESS;
+}
+
+/*
+ * Compile the active rules of the table into the index: a single query,
+ * instead of one for each week day
+ */
+int scheduler_database_load_rules (Table table, WeekIndex *index)
+{
+  int rc;
+  bool days[7];
+  struct sqlite3_stmt *stmt;
+
+  week_index_reset (index);
+
+  stmt = scheduler_database_statement ((table == TABLE_OFF) ? STATEMENT_RULES_OFF : STATEMENT_RULES_ON);
+  if (stmt == NULL)
+    return EXIT_FAILURE;
+
+  while ((rc = sqlite3_step (stmt)) == SQLITE_ROW)
+    {
+      int minute = sqlite3_column_int (stmt, 1);    // minute of the day
+
+      days_from_mask ((uint8_t) sqlite3_column_int (stmt, 2), days);
+
+      if (week_index_add (index,
+                          sqlite3_column_int64 (stmt, 0),
+                          minute / 60,
+                          minute % 60,
+                          days,
+                          (Mode) sqlite3_column_int (stmt, 3)))
+        {
+          sqlite3_reset (stmt);
+          return EXIT_FAILURE;
+        }
+    }
+
+  if (rc != SQLITE_DONE)
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR (failed while querying rules time): %s\n",
+               sqlite3_errmsg (scheduler_database_get ()));
+      sqlite3_reset (stmt);
+      return EXIT_FAILURE;
+    }
+  // Release the read transaction, so the server can write
+  sqlite3_reset (stmt);
+
+  week_index_sort (index);
+
+  DEBUG_PRINT (("Compiled %zu entries from %s", index->length, TABLE[table]));
+
+  return EXIT_SUCCESS;
+}
+
+/*
+ * Compile a rule again, from the database: if it was deleted or deactivated,
+ * it's just removed. The index must be sorted afterwards.
+ */
+int scheduler_database_load_rule (Table table, int64_t id, WeekIndex *index)
+{
+  int rc, minute;
+  bool days[7];
+  struct sqlite3_stmt *stmt;
+
+  week_index_remove (index, id);
+
+  stmt = scheduler_database_statement ((table == TABLE_OFF) ? STATEMENT_RULE_OFF : STATEMENT_RULE_ON);
+  if (stmt == NULL)
+    return EXIT_FAILURE;
+
+  sqlite3_bind_int64 (stmt, 1, id);
+
+  rc = sqlite3_step (stmt);
+  if (rc == SQLITE_ROW)
+    {
+      minute = sqlite3_column_int (stmt, 0);    // minute of the day
+      days_from_mask ((uint8_t) sqlite3_column_int (stmt, 1), days);
+
+      if (week_index_add (index, id, minute / 60, minute % 60, days,
+                          (Mode) sqlite3_column_int (stmt, 2)))
+        {
+          sqlite3_reset (stmt);
+          return EXIT_FAILURE;
+        }
+    }
+  else if (rc != SQLITE_DONE)
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR (failed while querying rule %" PRId64 "): %s\n", id,
+               sqlite3_errmsg (scheduler_database_get ()));
+      sqlite3_reset (stmt);
+      return EXIT_FAILURE;
+    }
+  // Release the read transaction, so the server can write
+  sqlite3_reset (stmt);
+
+  DEBUG_PRINT (("Rule %" PRId64 " of %s compiled again: %s", id, TABLE[table],
+                (rc == SQLITE_ROW) ? "active" : "deleted or inactive"));
+
+  return EXIT_SUCCESS;
+}
+
+void scheduler_database_close (void)
+{
+  finalize_statements ();
+
+  gawake_db_close (db);
+  db = NULL;
+}
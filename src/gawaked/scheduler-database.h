@@ -0,0 +1,35 @@
+#ifndef SCHEDULER_DATABASE_H_
+#define SCHEDULER_DATABASE_H_
+
+#include <stdbool.h>
+#include <sqlite3.h>
+
+#include "week-index.h"
+#include "../database-connection/database-connection.h"
+
+// Statements used only by the scheduler, prepared once on its connection;
+// the configuration and the custom schedule are read through the library
+typedef enum {
+  STATEMENT_INTEGRITY_CHECK,
+  STATEMENT_QUICK_CHECK,
+  STATEMENT_DATA_VERSION,
+  STATEMENT_RULES_ON,
+  STATEMENT_RULES_OFF,
+  STATEMENT_RULE_ON,
+  STATEMENT_RULE_OFF,
+  STATEMENT_ONE_SHOTS,
+  STATEMENT_EXCEPTIONS,
+  STATEMENT_COUNT
+} SchedulerStatement;
+
+int scheduler_database_open (void);
+sqlite3 *scheduler_database_get (void);
+GawakeDb *scheduler_database_get_db (void);
+bool scheduler_database_busy (void);
+int scheduler_database_refresh (bool *reloaded);
+sqlite3_stmt *scheduler_database_statement (SchedulerStatement statement);
+int scheduler_database_load_rules (Table table, WeekIndex *index);
+int scheduler_database_load_rule (Table table, int64_t id, WeekIndex *index);
+void scheduler_database_close (void);
+
+#endif /* SCHEDULER_DATABASE_H_ */
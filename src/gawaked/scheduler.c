@@ -23,87 +23,78 @@
 
 /*
  * These are static (and private to this file) variables.
- * They are shared among:
- * -> timed_checker and gsd_listener threads;
- * -> functions in this file that are called by the threads;
+ * They are shared among the callbacks dispatched by the scheduler main loop,
+ * which owns the deadline timer, the D-Bus signals and the database reloads;
+ * since everything runs on a single thread, no locking is needed.
  *
  * These variables shouldn't be used on other files.
  */
-static volatile bool canceled = false;
-static UpcomingOffRule upcoming_off_rule;
+static bool canceled = false;
 static RtcwakeArgs *rtcwake_args;
-static GMainLoop *gsd_loop; // *login1_loop;
-static GawakeServerDatabase *gsd_proxy;
+static GMainLoop *loop;
+static GawakeServerDatabase *gsd_proxy = NULL;
+
+// Deadline the timer is armed for
+static Deadline armed_deadline;
+// Rule time of the upcoming off rule whose notification was already emitted
+static time_t notified = 0;
+// Value returned by the query of the turn on rule, done on the notification
+static int on_rule_ret = RTCWAKE_ARGS_FAILURE;
+static guint timer_source = 0;
+// Watches the time zone of the system
+static GFileMonitor *localtime_monitor = NULL;
+// Runs of the scheduler (resident gawaked), and the time the system had been
+// suspended when the last one ended
+static unsigned int runs = 0;
+static gint64 last_suspended_time = 0;
+// SIGTERM received: the scheduler won't run again
+static bool terminating = false;
+// Clock of the simulation
+static time_t virtual_now = 0;
+
+// Active rules, compiled for the lookup of the upcoming one; they are
+// patched by the changes carried by the DatabaseUpdated signal
+static WeekIndex on_index, off_index;
+static bool on_index_loaded = false, off_index_loaded = false;
+// Upcoming one-shot wake ups, loaded with the turn on rules
+static OneShotHeap one_shots;
+// Dates the rules don't run on, loaded with the rules
+static ExceptionCalendar exceptions;
+// Turn on rules follow the local time or UTC (config)
+static bool on_rules_localtime = true;
+// Notification time, in seconds (config)
+static NotificationTime notification_time = 0;
 
 /* static int inhibitor_lock_fd = -1; */
 /* static GDBusConnection *login1_proxy = NULL; */
 
-static pthread_t timed_checker_thread, dbus_listener_thread; // login1_listener_thread;
-static pthread_mutex_t upcoming_off_rule_mutex, rtcwake_args_mutex, booleans_mutex;
-
 int scheduler (RtcwakeArgs *rtcwake_args_ptr)
 {
-  signal (SIGTERM, prepare_for_shutdown);
-
-  rtcwake_args = rtcwake_args_ptr;
-
-  pthread_mutex_init (&upcoming_off_rule_mutex, NULL);
-  pthread_mutex_init (&rtcwake_args_mutex, NULL);
-  pthread_mutex_init (&booleans_mutex, NULL);
-
-  // CREATE THREADS
-  if (pthread_create (&dbus_listener_thread, NULL, &gsd_listener, NULL) != 0)
-    {
-      DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "ERROR: Failed to create gsd_listener thread\n");
-      return EXIT_FAILURE;
-    }
-  if (pthread_create (&timed_checker_thread, NULL, &timed_checker, rtcwake_args) != 0)
-    {
-      DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "ERROR: Failed to create timed_checker thread\n");
-      return EXIT_FAILURE;
-    }
-  /* if (pthread_create (&login1_listener_thread, NULL, &login1_listener, NULL) != 0) */
-  /*   { */
-  /*     DEBUG_PRINT_CONTEX; */
-  /*     fprintf (stderr, "ERROR: Failed to create login1_listener thread. Ignoring it\n"); */
-  /*   } */
+  bool terminate;
+  int ret;
 
-  // JOIN THREADS
-  if (pthread_join (dbus_listener_thread, NULL) != 0)
-    {
-      DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "ERROR: Failed to join gsd_listener thread\n");
-      return EXIT_FAILURE;
-    }
-  if (pthread_join (timed_checker_thread, NULL) != 0)
-    {
-      DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "ERROR: Failed to join timed_checker thread\n");
-      return EXIT_FAILURE;
-    }
-  /* if (pthread_join (login1_listener_thread, NULL) != 0) */
-  /*   { */
-  /*     DEBUG_PRINT_CONTEX; */
-  /*     fprintf (stderr, "ERROR: Failed to join login1_listener thread. Ignoring it\n"); */
-  /*   } */
+  if (scheduler_init (rtcwake_args_ptr))
+    return EXIT_FAILURE;
 
-  pthread_mutex_destroy (&upcoming_off_rule_mutex);
-  pthread_mutex_destroy (&rtcwake_args_mutex);
-  pthread_mutex_destroy (&booleans_mutex);
+  ret = scheduler_run (&terminate);
+  scheduler_end ();
 
-  return EXIT_SUCCESS;
+  return ret;
 }
 
-// Thread 1: listen to GawakeServerDatabase (DBus) signals
-// TODO (improvement) can https://docs.gtk.org/gio/func.bus_watch_name.html be used instead?
-// try to used it with login1 on a single main loop
-static void *gsd_listener (void *args)
+// Set up what is kept across the runs of the scheduler: D-Bus proxy, deadline
+// timer, time zone monitor and database connection
+int scheduler_init (RtcwakeArgs *rtcwake_args_ptr)
 {
-  DEBUG_PRINT (("Started gsd_listener thread"));
   GError *error = NULL;
 
+  rtcwake_args = rtcwake_args_ptr;
+
+  // SIGTERM is handled by the main loop, not inside a signal handler
+  g_unix_signal_add (SIGTERM, on_sigterm, NULL);
+
+  // LISTEN TO GawakeServerDatabase (DBus) SIGNALS
+  // TODO (improvement) can https://docs.gtk.org/gio/func.bus_watch_name.html be used instead?
   gsd_proxy = gawake_server_database_proxy_new_for_bus_sync (G_BUS_TYPE_SYSTEM,         // bus_type
                                                              G_DBUS_PROXY_FLAGS_NONE,   // flags
                                                              "io.github.kelvinnovais.GawakeServer",  // name
@@ -113,129 +104,285 @@ static void *gsd_listener (void *args)
 
   if (error != NULL)
     {
+      // Keep going: turn off rules are still applied, without the signals
       fprintf (stderr, "Unable to get gsd_proxy: %s\n", error->message);
       g_error_free (error);
-      return NULL;
+      error = NULL;
     }
+  else
+    {
+      // Database updated
+      g_signal_connect (gsd_proxy, "database-updated", G_CALLBACK (on_database_updated_signal), NULL);
 
-  // Database updated
-  g_signal_connect (gsd_proxy, "database-updated", G_CALLBACK (on_database_updated_signal), NULL);
+      // Cancel schedule
+      g_signal_connect (gsd_proxy, "rule-canceled", G_CALLBACK (on_rule_canceled_signal), NULL);
+
+      // Immediate schedule
+      g_signal_connect (gsd_proxy, "schedule-requested", G_CALLBACK (on_schedule_requested_signal), NULL);
+
+      // Custom schedule
+      g_signal_connect (gsd_proxy, "custom-schedule-requested", G_CALLBACK (on_custom_schedule_requested_signal), NULL);
+    }
 
-  // Cancel schedule
-  g_signal_connect (gsd_proxy, "rule-canceled", G_CALLBACK (on_rule_canceled_signal), NULL);
+  // WAIT FOR THE UPCOMING DEADLINE
+  if (deadline_timer_init ())
+    {
+      if (gsd_proxy != NULL)
+        g_object_unref (gsd_proxy);
+      gsd_proxy = NULL;
+      return EXIT_FAILURE;
+    }
 
-  // Immediate schedule
-  g_signal_connect (gsd_proxy, "schedule-requested", G_CALLBACK (on_schedule_requested_signal), NULL);
+  // TIME ZONE CHANGES
+  // Rule times are computed on the local time: when the time zone is changed,
+  // /etc/localtime is replaced
+  GFile *localtime_file = g_file_new_for_path (LOCALTIME_PATH);
+  localtime_monitor = g_file_monitor_file (localtime_file, G_FILE_MONITOR_WATCH_MOVES, NULL, &error);
+  g_object_unref (localtime_file);
+  if (error != NULL)
+    {
+      // Keep going: clock changes are still detected by the timer
+      fprintf (stderr, "Unable to monitor the time zone: %s\n", error->message);
+      g_error_free (error);
+      error = NULL;
+    }
+  else
+    {
+      g_signal_connect (localtime_monitor, "changed", G_CALLBACK (on_localtime_changed), NULL);
+    }
 
-  // Custom schedule
-  g_signal_connect (gsd_proxy, "custom-schedule-requested", G_CALLBACK (on_custom_schedule_requested_signal), NULL);
+  // The connection is kept open while the scheduler runs; if it fails now,
+  // it's retried on the next query
+  scheduler_database_open ();
 
-  gsd_loop = g_main_loop_new (NULL, FALSE);
-  g_main_loop_run (gsd_loop);
+  // Readers always find a plan
+  schedule_plan_publish (&(UpcomingOffRule) { .found = false });
 
-  g_main_loop_unref (gsd_loop);
-  g_object_unref (gsd_proxy);
+  loop = g_main_loop_new (NULL, FALSE);
 
-  return NULL;
+  return EXIT_SUCCESS;
 }
 
-/* Thread 2: periodically make a check:
- * -> if there's a turn off upcoming rule, calculate how much time lacks to
- * to run that rule; also notify the user at the right time;
+/*
+ * Wait for the upcoming turn off rule (or a schedule request), and fill the
+ * RtcwakeArgs; "terminate" tells if it was requested by SIGTERM, in which
+ * case the scheduler must not run again.
  *
- * -> if there's NOT a turn off for today, check if there's a new one when the
- * day changes (I'm considering the  possibility of the device be active across days)
+ * On a resident gawaked, it's called again when rtcwake returns, i.e. the
+ * system resumed: everything set up by scheduler_init () is reused, so only
+ * the lookup of the upcoming rule is done before the timer is re-armed.
  */
-static void *timed_checker (void *args)
+int scheduler_run (bool *terminate)
 {
-  DEBUG_PRINT (("Started timed_checker thread"));
-  double time_remaining;
+  // Resume-to-armed latency
+  gint64 started = g_get_monotonic_time ();
+  // Resume detection: the time suspended grows; rtcwake also returns when it
+  // failed, or when there was no rule
+  gint64 suspended = (runs++ > 0) ? get_suspended_time () - last_suspended_time : 0;
+
+  // A new cycle: nothing from the previous one is kept
+  canceled = false;
+  terminating = false;
+  on_rule_ret = RTCWAKE_ARGS_FAILURE;
+  memset (rtcwake_args, 0, sizeof (*rtcwake_args));
+
+  // Check rules for today
+  query_upcoming_off_rule ();
+  plan_deadline ();
+  timer_source = g_unix_fd_add (deadline_timer_get_fd (), G_IO_IN, on_deadline_reached, NULL);
 
-  if (pthread_setcancelstate (PTHREAD_CANCEL_ENABLE, NULL) != 0)
+  if (runs > 1)
     {
-      DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "pthread_setcancelstate failed\n");
+      // Reading the two clocks apart has a jitter of microseconds
+      if (suspended > 1000)
+        printf ("Resumed after %.3f s suspended, deadline armed %.3f ms later\n",
+                suspended / 1e6, (g_get_monotonic_time () - started) / 1e3);
+      else
+        printf ("Scheduling again, the system wasn't suspended; deadline armed %.3f ms later\n",
+                (g_get_monotonic_time () - started) / 1e3);
+      fflush (stdout);
+    }
+  else
+    {
+      DEBUG_PRINT (("Deadline armed %.3f ms after the scheduler started",
+                    (g_get_monotonic_time () - started) / 1e3));
     }
 
-  // Check rules for today
-  query_upcoming_off_rule ();
+  g_main_loop_run (loop);
 
-  sync_time ();
+  DEBUG_PRINT_TIME (("Scheduling"));
 
-  TIMED_CHECKER_LOOP:
-  while (1)
-    {
-      DEBUG_PRINT_TIME (("New lap on timed_checker main loop"));
+  if (timer_source != 0)
+    g_source_remove (timer_source);
+  timer_source = 0;
 
-      if (!upcoming_off_rule.found && day_changed ())
-        {
-          DEBUG_PRINT (("Querying turn off rule because day changed"));
-          query_upcoming_off_rule ();
-        }
+  // To tell, on the next run, if the system was suspended meanwhile
+  last_suspended_time = get_suspended_time ();
 
-      // Calculate time until the upcoming off rule, if the rule was found
-      if (upcoming_off_rule.found)
-        {
-          time_remaining = get_time_remaining ();
-          DEBUG_PRINT (("Missing time: %f s", time_remaining));
-
-          /*
-           * If the time missing is lesser than the delay + notification +
-           *  minimum sync time, exit the loop to emit notification
-           */
-          if (time_remaining <= (CHECK_DELAY + upcoming_off_rule.notification_time + 60))
-            break;
-        }
+  *terminate = terminating;
+  return EXIT_SUCCESS;
+}
 
-      sleep (CHECK_DELAY);
-    }
+void scheduler_end (void)
+{
+  deadline_timer_close ();
+  if (localtime_monitor != NULL)
+    g_object_unref (localtime_monitor);
+  localtime_monitor = NULL;
+  scheduler_database_close ();
+  week_index_free (&on_index);
+  week_index_free (&off_index);
+  one_shot_heap_free (&one_shots);
+  exception_calendar_free (&exceptions);
+  on_index_loaded = off_index_loaded = false;
+  runs = 0;
+  schedule_plan_clear ();
+  if (loop != NULL)
+    g_main_loop_unref (loop);
+  loop = NULL;
+  if (gsd_proxy != NULL)
+    g_object_unref (gsd_proxy);
+  gsd_proxy = NULL;
+}
 
-  DEBUG_PRINT_TIME (("Left timed_checker main loop"));
+/*
+ * Time spent suspended since the boot, in microseconds: CLOCK_BOOTTIME
+ * includes it, while CLOCK_MONOTONIC doesn't
+ */
+static gint64 get_suspended_time (void)
+{
+  struct timespec boottime, monotonic;
 
-  int ret = query_upcoming_on_rule (false);
+  clock_gettime (CLOCK_BOOTTIME, &boottime);
+  clock_gettime (CLOCK_MONOTONIC, &monotonic);
 
-  // If querying rule failed, and the user wants to shutdown in this exception,
-  // set this action to true
-  if  (ret != EXIT_SUCCESS && rtcwake_args->shutdown_fail == true)
-    rtcwake_args->run_shutdown = true;
-  else
-    rtcwake_args->run_shutdown = false;
+  return (boottime.tv_sec - monotonic.tv_sec) * G_USEC_PER_SEC
+         + (boottime.tv_nsec - monotonic.tv_nsec) / 1000;
+}
+
+// Arm the deadline timer for the upcoming deadline
+static void plan_deadline (void)
+{
+  time_t deadline;
 
-  // Wait until notification time - Note #1
-  if ((time_remaining - upcoming_off_rule.notification_time) > 0)
-    sleep (time_remaining - upcoming_off_rule.notification_time);
+  armed_deadline = get_next_deadline (&deadline);
+  deadline_timer_arm (deadline);
+}
+
+/* The armed deadline was reached, without any polling:
+ * -> if there's a turn off upcoming rule, the timer expires at the notification
+ * time to notify the user, and then at the rule time to run it;
+ *
+ * -> if there's NOT a turn off for today, it expires when the day changes to check
+ * if there's a new one (I'm considering the  possibility of the device be active across days)
+ *
+ * Signals that change the plan (database updated, rule canceled) re-arm the
+ * timer immediately; so does a change of the wall clock, which cancels it
+ */
+static gboolean on_deadline_reached (gint fd, GIOCondition condition, gpointer user_data)
+{
+  const SchedulePlan *plan;
 
-  // Emit custom notification according to the returned value
-  notify_user (ret);
+  switch (deadline_timer_acknowledge ())
+    {
+    case DEADLINE_TIMER_EXPIRED:
+      break;
 
+    case DEADLINE_TIMER_CLOCK_CHANGED:
+      replan_on_time_change ();
+      return G_SOURCE_CONTINUE;
 
-  // Wait until time the rule must be triggered
-  sleep (get_time_remaining ());
+    case DEADLINE_TIMER_FAILED:
+    default:
+      return G_SOURCE_CONTINUE;
+    }
 
-  /*
-   * IF
-   * (1) the schedule was canceled
-   *      OR
-   * (2) querying rules failed and the action is to NOT shutdown in this case
-   * then return to the main loop
-   */
-  if (canceled ||
-      (ret != RTCWAKE_ARGS_SUCESS && rtcwake_args->run_shutdown == false))
+  switch (armed_deadline)
     {
-      // Sleep 1 minute to get another rule, and go back to main loop
-      sleep (60);
-      canceled = false;
+    case DEADLINE_DAY_CHANGED:
+      DEBUG_PRINT (("Querying turn off rule because day changed"));
       query_upcoming_off_rule ();
-      DEBUG_PRINT_TIME (("Returning to timed_checker main loop"));
-      goto TIMED_CHECKER_LOOP;
+      break;
+
+    case DEADLINE_NOTIFICATION:
+      on_rule_ret = prepare_rtcwake_args ();
+
+      // Emit custom notification according to the returned value - Note #1
+      notify_user (on_rule_ret);
+      plan = schedule_plan_get ();
+      notified = plan->off_rule.rule_time;
+      break;
+
+    case DEADLINE_OFF_RULE:
+      /*
+       * IF
+       * (1) the schedule was canceled
+       *      OR
+       * (2) querying rules failed and the action is to NOT shutdown in this case
+       * then get another rule; the rule that has just been reached isn't
+       * found again, since it isn't bigger than the current time
+       */
+      if (canceled ||
+          (on_rule_ret != RTCWAKE_ARGS_SUCESS && rtcwake_args->run_shutdown == false))
+        {
+          canceled = false;
+          query_upcoming_off_rule ();
+          DEBUG_PRINT_TIME (("Rule skipped, waiting for the next deadline"));
+          break;
+        }
+
+      // ELSE, continue to schedule
+      timer_source = 0;
+      finalize_loop ();
+      return G_SOURCE_REMOVE;
+
+    default:
+      break;
     }
 
-  // ELSE, continue to schedule
-  finalize_gsd_listener ();
-  /* finalize_login1_listener (); */
-  DEBUG_PRINT_TIME (("Scheduling"));
+  plan_deadline ();
+  return G_SOURCE_CONTINUE;
+}
 
-  return NULL;
+/*
+ * The wall clock was set (NTP step, manual change) or the time zone changed:
+ * the rule times were computed for another clock, so look up the upcoming
+ * rules again and re-arm the timer right away, instead of waiting for the
+ * deadline computed before. A suspended system doesn't need this: the
+ * deadline is absolute, so the timer expires as soon as it resumes past it.
+ */
+static void replan_on_time_change (void)
+{
+  DEBUG_PRINT_TIME (("Time changed, re-planning"));
+
+  if (off_index_loaded)
+    find_upcoming_off_rule ();
+  else
+    query_upcoming_off_rule ();
+
+  refresh_notified_on_rule ();
+  plan_deadline ();
+}
+
+static void on_localtime_changed (GFileMonitor *monitor,
+                                  GFile *file,
+                                  GFile *other_file,
+                                  GFileMonitorEvent event_type,
+                                  gpointer user_data)
+{
+  // Only changes of the content (or the replacement of the file) matter
+  if (event_type != G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT
+      && event_type != G_FILE_MONITOR_EVENT_CREATED
+      && event_type != G_FILE_MONITOR_EVENT_DELETED
+      && event_type != G_FILE_MONITOR_EVENT_RENAMED
+      && event_type != G_FILE_MONITOR_EVENT_MOVED_IN)
+    return;
+
+  DEBUG_PRINT_TIME (("Time zone changed (event %d)", event_type));
+
+  // Read the time zone again, for localtime ()/mktime ()
+  tzset ();
+  replan_on_time_change ();
 }
 
 /* Thread 3: listen to org.freedesktop.login1 to know when the user
@@ -334,549 +481,396 @@ static void *timed_checker (void *args)
 /*   return EXIT_SUCCESS; */
 /* } */
 
-// Checks if the day of the week was changed and returns a boolean
-static int day_changed (void)
+static int query_upcoming_off_rule (void)
 {
-  // Keeps the last checked week day; starts is initialized as -1, so the function
-  // always returns true on the first call; this behaviour is wanted
-  static int last_week_day = -1;
   int ret;
 
-  // Note: this structure is statically allocated, no need to free
-  struct tm *timeinfo;
+  for (int attempt = 1; (ret = load_off_rules ()) && retry_busy (attempt); attempt++);
 
-  // Get current time
-  get_time_tm (&timeinfo);
-
-  DEBUG_PRINT (("timeinfo->tm_wday: %d; last_week_day: %d", timeinfo->tm_wday, last_week_day));
-  if (timeinfo->tm_wday != last_week_day)
-    ret = 1;   // day changed
-  else
-    ret =  0;   // day not changed
-
-  // Update the variable
-  last_week_day = timeinfo->tm_wday;
+  if (ret)
+    {
+      // SET UPCOMING RULE AS NOT FOUND
+      schedule_plan_publish (&(UpcomingOffRule) {
+                               .found = false,
+                               .notification_time = notification_time,
+                             });
+      return EXIT_FAILURE;
+    }
 
-  return ret;
+  return find_upcoming_off_rule ();
 }
 
-static int query_upcoming_off_rule (void)
+// Read the configuration and compile the active turn off rules
+static int load_off_rules (void)
 {
-  int rc, now, ruletime;
-  bool is_localtime = true;
-
-  struct tm *timeinfo;
-  struct sqlite3_stmt *stmt;
-
-  sqlite3 *db;
-
-  // Index(0 to 6) matches tm_wday; these strings refer to SQLite columns name
-  char query[ALLOC], buffer[BUFFER_ALLOC];
-
-  // SET UPCOMING RULE AS NOT FOUND
-  pthread_mutex_lock (&upcoming_off_rule_mutex);
-  upcoming_off_rule.found = false;
-  pthread_mutex_unlock (&upcoming_off_rule_mutex);
-
-  // OPEN DATABASE
-  rc = sqlite3_open_v2 (DB_PATH, &db, SQLITE_OPEN_READONLY, NULL);
-  if (rc != SQLITE_OK)
-    {
-      DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "Couldn't open database: %s\n", sqlite3_errmsg (db));
-      return EXIT_FAILURE;
-    }
+  Config config;
 
-  // ENABLE SECURITY OPTIONS
-  sqlite3_db_config (db, SQLITE_DBCONFIG_DEFENSIVE, 0, 0);
-  sqlite3_db_config (db, SQLITE_DBCONFIG_ENABLE_TRIGGER, 0, 0);
-  sqlite3_db_config (db, SQLITE_DBCONFIG_ENABLE_VIEW, 0, 0);
-  sqlite3_db_config (db, SQLITE_DBCONFIG_TRUSTED_SCHEMA, 0, 0);
-  sqlite3_exec (db,
-                "PRAGMA cell_size_check=ON; PRAGMA mmap_size=0; PRAGMA trusted_schema=OFF;",
-                 NULL, 0, NULL);
-  // Check database integrity
-  bool integrity = false;
-  rc = sqlite3_prepare_v2 (db,
-                           "PRAGMA integrity_check;",
-                           -1,
-                           &stmt,
-                           NULL);
-  if (rc != SQLITE_OK)
-    {
-      DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "ERROR: Failed checking database integrity\n");
-      sqlite3_close (db);
-      return EXIT_FAILURE;
-    }
-  while ((rc = sqlite3_step (stmt)) == SQLITE_ROW)
-    {
-      char result[3];
-      snprintf (result, 3, "%s", sqlite3_column_text (stmt, 0));
-      if (strcmp (result, "ok") == 0)
-        integrity = true;
-    }
-  if (rc != SQLITE_DONE)
-    {
-      DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "ERROR (failed checking database integrity): %s\n", sqlite3_errmsg (db));
-      sqlite3_close (db);
-      return EXIT_FAILURE;
-    }
-  sqlite3_finalize (stmt);
-  if (integrity == false)
-    {
-      fprintf (stderr, "ERROR: database integrity check failed\n");
-      return EXIT_FAILURE;
-    }
+  if (database_integrity_verify ())
+    return EXIT_FAILURE;
 
   // GET THE DATABASE CONFIG
-  rc = sqlite3_prepare_v2 (db,
-                           "SELECT notification_time, localtime "\
-                           "FROM config WHERE id = 1;",
-                           -1,
-                           &stmt,
-                           NULL);
-  if (rc != SQLITE_OK)
+  if (configuration_get_snapshot (scheduler_database_get_db (), &config))
     {
       DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "ERROR: Failed getting config information\n");
-      sqlite3_close (db);
+      fprintf (stderr, "ERROR: failed getting config information\n");
       return EXIT_FAILURE;
     }
-  while ((rc = sqlite3_step (stmt)) == SQLITE_ROW)
-    {
-      pthread_mutex_lock (&upcoming_off_rule_mutex);
+  // Convert to seconds
+  notification_time = (NotificationTime) config.notification_time * 60;
 
-      // Notification time
-      upcoming_off_rule.notification_time = (NotificationTime) sqlite3_column_int (stmt, 0);
-      // Convert to seconds
-      upcoming_off_rule.notification_time *= 60;
+  // COMPILE THE ACTIVE TURN OFF RULES, AND THE EXCEPTION DATES
+  off_index_loaded = false;
+  if (scheduler_database_load_rules (TABLE_OFF, &off_index) || load_exceptions ())
+    return EXIT_FAILURE;
+  off_index_loaded = true;
 
-      is_localtime = (bool) sqlite3_column_int (stmt, 1);
+  return EXIT_SUCCESS;
+}
 
-      pthread_mutex_unlock (&upcoming_off_rule_mutex);
-    }
-  if (rc != SQLITE_DONE)
+// Look up the upcoming turn off rule on the compiled rules, and publish it
+static int find_upcoming_off_rule (void)
+{
+  struct tm *timeinfo, upcoming;
+  const WeekIndexEntry *entry;
+  UpcomingOffRule upcoming_off_rule = {
+    .found = false,
+    .notification_time = notification_time,
+  };
+
+  // GET THE UPCOMING RULE, WITHIN A WEEK (OR LATER, ON EXCEPTION DATES)
+  // Turn off rules always follow the local time
+  entry = get_upcoming_entry (&off_index, TABLE_OFF, true, &upcoming, &upcoming_off_rule.rule_time);
+  if (entry == NULL)
     {
-      DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "ERROR (failed getting config information): %s\n", sqlite3_errmsg (db));
-      sqlite3_close (db);
-      return EXIT_FAILURE;
+      DEBUG_PRINT (("Any turn off rule found"));
+      schedule_plan_publish (&upcoming_off_rule);
+      return EXIT_SUCCESS;
     }
-  sqlite3_finalize (stmt);
 
-  // GET THE CURRENT TIME
-  // hour, minutes and seconds as integer members
   get_time_tm (&timeinfo);
-  // Concatenate: HHMM as a string
-  snprintf (buffer, BUFFER_ALLOC, "%02d%02d", timeinfo->tm_hour, timeinfo->tm_min);
-  // HHMM as an integer, leading zeros doesn't matter
-  now = atoi (buffer);
-
-  // QUERY TURN OFF RULES
-  // This query SQL returns time on format HHMM
-  snprintf (query,
-            ALLOC,
-            "SELECT strftime ('%%H%%M', rule_time), mode "\
-            "FROM rules_turnoff "\
-            "WHERE %s = 1 AND active = 1 "\
-            "ORDER BY time (rule_time) ASC;",
-            DAYS[timeinfo->tm_wday]);
-
-  rc = sqlite3_prepare_v2 (db, query, -1, &stmt, NULL);
-  if (rc != SQLITE_OK)
+
+  upcoming_off_rule.found = true;
+  upcoming_off_rule.tomorrow = (upcoming.tm_mday != timeinfo->tm_mday);
+  upcoming_off_rule.hour = upcoming.tm_hour;
+  upcoming_off_rule.minutes = upcoming.tm_min;
+  upcoming_off_rule.day = upcoming.tm_mday;
+  upcoming_off_rule.month = upcoming.tm_mon + 1;
+  upcoming_off_rule.year = upcoming.tm_year + 1900;
+  upcoming_off_rule.mode = (Mode) entry->mode;
+
+  DEBUG_PRINT (("Upcoming off rule fields:\n"\
+                "\tFound: %d\n\tTomorrow: %d\n\tHour: %02d\n\t"\
+                "Minutes: %02d\n\tMode: %d\n\tNotification time: %d s",
+                upcoming_off_rule.found, upcoming_off_rule.tomorrow,
+                upcoming_off_rule.hour, upcoming_off_rule.minutes,
+                upcoming_off_rule.mode, upcoming_off_rule.notification_time));
+
+  schedule_plan_publish (&upcoming_off_rule);
+
+  return EXIT_SUCCESS;
+}
+
+static int query_upcoming_on_rule (bool use_default_mode)
+{
+  Config config;
+
+  rtcwake_args->found = false;
+
+  if (database_integrity_verify ())
+    return RTCWAKE_ARGS_FAILURE;
+
+  // GET THE DATABASE CONFIG
+  if (configuration_get_snapshot (scheduler_database_get_db (), &config))
     {
       DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "ERROR: Failed querying turn off rules for today\n");
-      sqlite3_close (db);
-      return EXIT_FAILURE;
+      fprintf (stderr, "ERROR: failed getting config information\n");
+      return RTCWAKE_ARGS_FAILURE;
     }
+  on_rules_localtime = config.use_localtime;
+  rtcwake_args->shutdown_fail = config.shutdown_fail;
 
-  // Get all rules today, ordered by time:
-  // the first rule that is bigger than now is a valid rule
-  char timestamp[5]; // HHMM'\0' = 5 characters
-  while ((rc = sqlite3_step (stmt)) == SQLITE_ROW)
+  // Mode
+  if (use_default_mode)
+    rtcwake_args->mode = config.default_mode;
+  else
     {
-      ruletime = sqlite3_column_int (stmt, 0);
-      if (ruletime > now)
-        {
-          DEBUG_PRINT (("Rule time: %d\nNow: %d\nBigger? %d", ruletime, now, (ruletime > now)?1:0));
-          pthread_mutex_lock (&upcoming_off_rule_mutex);
+      const SchedulePlan *plan = schedule_plan_get ();
+      rtcwake_args->mode = plan->off_rule.mode;
+    }
 
-          // Set "rule found?" to true
-          upcoming_off_rule.found = true;
+  // COMPILE THE ACTIVE TURN ON RULES AND THE EXCEPTION DATES, AND QUEUE THE
+  // ONE-SHOT WAKE UPS
+  on_index_loaded = false;
+  if (scheduler_database_load_rules (TABLE_ON, &on_index)
+      || load_exceptions () || load_one_shots ())
+    return RTCWAKE_ARGS_FAILURE;
+  on_index_loaded = true;
 
-          // Set tomorrow to false
-          upcoming_off_rule.tomorrow = false;
+  return find_upcoming_on_rule ();
+}
 
-          // Hour and minutes
-          sqlite3_snprintf (5, timestamp, "%s", sqlite3_column_text (stmt, 0));
-          sscanf (timestamp, "%02d%02d", &upcoming_off_rule.hour, &upcoming_off_rule.minutes);
+/*
+ * Look up the upcoming wake up: the turn on rule on the compiled rules, or
+ * the upcoming one-shot wake up, if it's earlier. Mode and shutdown_fail are
+ * kept from the last query
+ */
+static int find_upcoming_on_rule (void)
+{
+  struct tm upcoming;
+  time_t upcoming_time, now;
+  const OneShotEntry *one_shot;
+  bool found_rule;
 
-          // Fill time_t
-          timeinfo->tm_hour = upcoming_off_rule.hour;
-          timeinfo->tm_min = upcoming_off_rule.minutes;
-          timeinfo->tm_sec = 00;
-          /* ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
-           * Note: other fields (day, month, year) on timeinfo were not changed;
-           * they were filled by get_time_tm (), and refers to today.
-           */
+  rtcwake_args->found = false;
 
-          // Mode
-          upcoming_off_rule.mode = (Mode) sqlite3_column_int (stmt, 1);
+  if (get_time (&now))
+    return RTCWAKE_ARGS_FAILURE;
 
-          pthread_mutex_unlock (&upcoming_off_rule_mutex);
-          break;
-        }
-    }
+  // GET THE UPCOMING RULE, WITHIN A WEEK (OR LATER, ON EXCEPTION DATES)
+  found_rule = (get_upcoming_entry (&on_index, TABLE_ON, on_rules_localtime,
+                                    &upcoming, &upcoming_time) != NULL);
 
-  if (rc != SQLITE_DONE && rc != SQLITE_ROW)
+  // AND THE UPCOMING ONE-SHOT WAKE UP, AT THE ROOT OF THE HEAP
+  one_shot_heap_prune (&one_shots, now);
+  one_shot = one_shot_heap_peek (&one_shots);
+  if (one_shot != NULL && (!found_rule || one_shot->time < upcoming_time))
     {
-      DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "ERROR (failed while querying rules time): %s\n", sqlite3_errmsg (db));
-      sqlite3_close (db);
-      return EXIT_FAILURE;
-    }
-  sqlite3_finalize (stmt);
+      DEBUG_PRINT (("One-shot wake up %" PRId64 " comes before the turn on rules", one_shot->id));
 
-  // If didn't find a match for today, try to find a rule for tomorrow
-  if (upcoming_off_rule.found == false)
+      upcoming_time = (time_t) one_shot->time;
+      if (on_rules_localtime)
+        localtime_r (&upcoming_time, &upcoming);
+      else
+        gmtime_r (&upcoming_time, &upcoming);
+    }
+  else if (!found_rule)
     {
-      char date[9]; // YYYYMMDD'\0' = 9 characters
-
-      // Update week day
-      int tomorrow_wday = timeinfo->tm_wday + 1;
-      if (tomorrow_wday >= 7)
-        tomorrow_wday = 0;
-
-      snprintf (query,
-          ALLOC,
-          "SELECT strftime ('%%H%%M', rule_time), mode, "
-          "strftime ('%%Y%%m%%d', 'now', '%s', '+1 day') "\
-          "FROM rules_turnoff "\
-          "WHERE %s = 1 AND active = 1 "\
-          "ORDER BY time (rule_time) ASC "\
-          "LIMIT 1;",
-          is_localtime ? "localtime":"utc",
-          DAYS[tomorrow_wday]);
-
-      rc = sqlite3_prepare_v2 (db, query, -1, &stmt, NULL);
-      if (rc != SQLITE_OK)
-        {
-          DEBUG_PRINT_CONTEX;
-          fprintf (stderr, "ERROR: Failed querying turn off rules for today\n");
-          sqlite3_close (db);
-          return EXIT_FAILURE;
-        }
+      fprintf (stderr, "WARNING: Any turn on rule found.\n");
+      return RTCWAKE_ARGS_NOT_FOUND;
+    }
 
-      while ((rc = sqlite3_step (stmt)) == SQLITE_ROW)
-        {
-          pthread_mutex_lock (&upcoming_off_rule_mutex);
+  // ELSE, RETURN PARAMETERS
+  rtcwake_args->found = true;
+  rtcwake_args->hour = upcoming.tm_hour;
+  rtcwake_args->minutes = upcoming.tm_min;
+  rtcwake_args->day = upcoming.tm_mday;
+  rtcwake_args->month = upcoming.tm_mon + 1;
+  rtcwake_args->year = upcoming.tm_year + 1900;
 
-          ruletime = sqlite3_column_int (stmt, 0);
+  DEBUG_PRINT (("RtcwakeArgs fields:\n"\
+                "\tFound: %d\n\tShutdown: %d"\
+                "\n\t[HH:MM] %02d:%02d\n\t[DD/MM/YYYY] %02d/%02d/%d"\
+                "\n\tMode: %d",
+                rtcwake_args->found, rtcwake_args->shutdown_fail,
+                rtcwake_args->hour, rtcwake_args->minutes,
+                rtcwake_args->day, rtcwake_args->month, rtcwake_args->year,
+                rtcwake_args->mode));
 
-          // Set "rule found?" to true
-          upcoming_off_rule.found = true;
+  if (validade_rtcwake_args (rtcwake_args) == -1)
+    return INVALID_RTCWAKE_ARGS;
+  else
+    return RTCWAKE_ARGS_SUCESS;
+}
 
-          // Set tomorrow to true
-          upcoming_off_rule.tomorrow = true;
+/*
+ * Load the upcoming one-shot wake ups into the heap; they come in time order,
+ * so each one is pushed without moving
+ */
+static int load_one_shots (void)
+{
+  int rc;
+  time_t now;
+  struct sqlite3_stmt *stmt;
 
-          // Hour and minutes
-          sqlite3_snprintf (5, timestamp, "%s", sqlite3_column_text (stmt, 0));
-          sscanf (timestamp, "%02d%02d", &upcoming_off_rule.hour, &upcoming_off_rule.minutes);
-          // Date
-          sqlite3_snprintf (9, date, "%s", sqlite3_column_text (stmt, 2));
-          sscanf (date, "%04d%02d%02d",
-                  &upcoming_off_rule.year, &upcoming_off_rule.month, &upcoming_off_rule.day);
+  one_shot_heap_reset (&one_shots);
 
-          // Fill time_t with tomorrow date and rule time
-          timeinfo->tm_hour = upcoming_off_rule.hour;
-          timeinfo->tm_min = upcoming_off_rule.minutes;
-          timeinfo->tm_sec = 00;
-          timeinfo->tm_mday = upcoming_off_rule.day;
-          timeinfo->tm_mon = upcoming_off_rule.month - 1;
-          timeinfo->tm_year = upcoming_off_rule.year - 1900;
+  if (get_time (&now))
+    return EXIT_FAILURE;
 
-          // Mode
-          upcoming_off_rule.mode = (Mode) sqlite3_column_int (stmt, 1);
+  stmt = scheduler_database_statement (STATEMENT_ONE_SHOTS);
+  if (stmt == NULL)
+    return EXIT_FAILURE;
 
-          pthread_mutex_unlock (&upcoming_off_rule_mutex);
-        }
+  sqlite3_bind_int64 (stmt, 1, now);
 
-      if (rc != SQLITE_DONE && rc != SQLITE_ROW)
+  while ((rc = sqlite3_step (stmt)) == SQLITE_ROW)
+    {
+      if (one_shot_heap_push (&one_shots,
+                              sqlite3_column_int64 (stmt, 0),
+                              sqlite3_column_int64 (stmt, 1)))
         {
-          DEBUG_PRINT_CONTEX;
-          fprintf (stderr, "ERROR (failed while querying rules time): %s\n", sqlite3_errmsg (db));
-          sqlite3_close (db);
+          sqlite3_reset (stmt);
           return EXIT_FAILURE;
         }
-      sqlite3_finalize (stmt);
     }
 
-  // Make rule_time
-  upcoming_off_rule.rule_time = mktime (timeinfo);
-  // If fails
-  if (upcoming_off_rule.rule_time == (time_t) -1)
+  if (rc != SQLITE_DONE)
     {
       DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "ERROR: failed to make time\n");
-      upcoming_off_rule.found = false;
+      fprintf (stderr, "ERROR (failed while querying one-shot wake ups): %s\n",
+               sqlite3_errmsg (scheduler_database_get ()));
+      sqlite3_reset (stmt);
       return EXIT_FAILURE;
     }
+  // Release the read transaction, so the server can write
+  sqlite3_reset (stmt);
 
-  DEBUG_PRINT (("Upcoming off rule fields:\n"\
-                "\tFound: %d\n\tTomorrow: %d\n\tHour: %02d\n\t"\
-                "Minutes: %02d\n\tMode: %d\n\tNotification time: %d s",
-                upcoming_off_rule.found, upcoming_off_rule.tomorrow,
-                upcoming_off_rule.hour, upcoming_off_rule.minutes,
-                upcoming_off_rule.mode, upcoming_off_rule.notification_time));
+  DEBUG_PRINT (("Queued %zu one-shot wake ups", one_shots.length));
 
   return EXIT_SUCCESS;
 }
 
-static int query_upcoming_on_rule (bool use_default_mode)
+/*
+ * Compile the exception dates of this year and the next one into the
+ * calendar
+ */
+static int load_exceptions (void)
 {
-  int rc, now, ruletime, id_match = -1;
-  bool is_localtime = true;
-
-  struct tm *timeinfo;
+  int rc;
+  time_t now;
+  struct tm today;
+  char from[EXCEPTION_DATE_LENGTH], to[EXCEPTION_DATE_LENGTH];
   struct sqlite3_stmt *stmt;
 
-  sqlite3 *db;
+  if (get_time (&now))
+    return EXIT_FAILURE;
+  localtime_r (&now, &today);
 
-  // Index(0 to 6) matches tm_wday; these strings refer to SQLite columns name
-  char query[ALLOC], buffer[BUFFER_ALLOC], date[9];
+  exception_calendar_reset (&exceptions, today.tm_year);
+  snprintf (from, sizeof (from), "%04d-01-01", today.tm_year + 1900);
+  snprintf (to, sizeof (to), "%04d-01-01", today.tm_year + 1900 + EXCEPTION_CALENDAR_YEARS);
 
-  pthread_mutex_lock (&rtcwake_args_mutex);
-  rtcwake_args->found = false;
-  pthread_mutex_unlock (&rtcwake_args_mutex);
+  stmt = scheduler_database_statement (STATEMENT_EXCEPTIONS);
+  if (stmt == NULL)
+    return EXIT_FAILURE;
 
-  // OPEN DATABASE
-  rc = sqlite3_open_v2 (DB_PATH, &db, SQLITE_OPEN_READONLY, NULL);
-  if (rc != SQLITE_OK)
-    {
-      DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "Couldn't open database: %s\n", sqlite3_errmsg (db));
-      return RTCWAKE_ARGS_FAILURE;
-    }
+  sqlite3_bind_text (stmt, 1, from, -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text (stmt, 2, to, -1, SQLITE_TRANSIENT);
 
-  // ENABLE SECURITY OPTIONS
-  sqlite3_db_config (db, SQLITE_DBCONFIG_DEFENSIVE, 0, 0);
-  sqlite3_db_config (db, SQLITE_DBCONFIG_ENABLE_TRIGGER, 0, 0);
-  sqlite3_db_config (db, SQLITE_DBCONFIG_ENABLE_VIEW, 0, 0);
-  sqlite3_db_config (db, SQLITE_DBCONFIG_TRUSTED_SCHEMA, 0, 0);
-  sqlite3_exec (db,
-                "PRAGMA cell_size_check=ON; PRAGMA mmap_size=0; PRAGMA trusted_schema=OFF;",
-                 NULL, 0, NULL);
-  // Check database integrity
-  bool integrity = false;
-  rc = sqlite3_prepare_v2 (db,
-                           "PRAGMA integrity_check;",
-                           -1,
-                           &stmt,
-                           NULL);
-  if (rc != SQLITE_OK)
-    {
-      DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "ERROR: Failed checking database integrity\n");
-      sqlite3_close (db);
-      return EXIT_FAILURE;
-    }
   while ((rc = sqlite3_step (stmt)) == SQLITE_ROW)
     {
-      char result[3];
-      snprintf (result, 3, "%s", sqlite3_column_text (stmt, 0));
-      if (strcmp (result, "ok") == 0)
-        integrity = true;
+      if (exception_calendar_add (&exceptions,
+                                  (const char *) sqlite3_column_text (stmt, 0),
+                                  (sqlite3_column_int (stmt, 1) == TABLE_OFF) ? TABLE_OFF : TABLE_ON,
+                                  sqlite3_column_int64 (stmt, 2)))
+        {
+          sqlite3_reset (stmt);
+          return EXIT_FAILURE;
+        }
     }
+
   if (rc != SQLITE_DONE)
     {
       DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "ERROR (failed checking database integrity): %s\n", sqlite3_errmsg (db));
-      sqlite3_close (db);
-      return EXIT_FAILURE;
-    }
-  sqlite3_finalize (stmt);
-  if (integrity == false)
-    {
-      fprintf (stderr, "ERROR: database integrity check failed\n");
+      fprintf (stderr, "ERROR (failed while querying exception dates): %s\n",
+               sqlite3_errmsg (scheduler_database_get ()));
+      sqlite3_reset (stmt);
       return EXIT_FAILURE;
     }
+  // Release the read transaction, so the server can write
+  sqlite3_reset (stmt);
 
-  // GET THE DATABASE CONFIG
-  rc = sqlite3_prepare_v2 (db,
-                           "SELECT localtime, default_mode, shutdown_fail "\
-                           "FROM config WHERE id = 1;",
-                           -1,
-                           &stmt,
-                           NULL);
-  if (rc != SQLITE_OK)
-    {
-      DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "ERROR: Failed getting config information\n");
-      sqlite3_close (db);
-      return RTCWAKE_ARGS_FAILURE;
-    }
-  while ((rc = sqlite3_step (stmt)) == SQLITE_ROW)
-    {
-      // Localtime
-      is_localtime = (bool) sqlite3_column_int (stmt, 0);
+  DEBUG_PRINT (("Compiled the exception dates, %zu rule(s) with dates of their own",
+                exceptions.length));
 
-      pthread_mutex_lock (&rtcwake_args_mutex);
-      // Mode
-      if (use_default_mode)
-        rtcwake_args->mode = (Mode) sqlite3_column_int (stmt, 1);
-      else
-        rtcwake_args->mode = upcoming_off_rule.mode;
+  return EXIT_SUCCESS;
+}
 
-      // Shutdown on failure
-      rtcwake_args->shutdown_fail = sqlite3_column_int (stmt, 2);
-      pthread_mutex_unlock (&rtcwake_args_mutex);
-    }
-  if (rc != SQLITE_DONE)
-    {
-      DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "ERROR (failed getting config information): %s\n", sqlite3_errmsg (db));
-      sqlite3_close (db);
-      return RTCWAKE_ARGS_FAILURE;
-    }
-  sqlite3_finalize (stmt);
+/*
+ * Get the upcoming rule of the index, after the current time, wrapping to the
+ * next weeks; the rules are skipped on their exception dates. "upcoming" and
+ * "upcoming_time" receive its date and time, on local time or UTC. Returns
+ * NULL if there's no rule, or all of them are skipped on the years covered by
+ * the calendar.
+ */
+static const WeekIndexEntry *
+get_upcoming_entry (const WeekIndex *index,
+                    Table table,
+                    bool use_localtime,
+                    struct tm *upcoming,
+                    time_t *upcoming_time)
+{
+  time_t now;
+  struct tm start;
+  int minute, minutes_ahead, total_ahead = 0;
+  const WeekIndexEntry *entry;
 
-  // GET THE CURRENT TIME
-  // hour, minutes and seconds as integer members
-  get_time_tm (&timeinfo);
-  // Concatenate: HHMM as a string
-  snprintf (buffer, BUFFER_ALLOC, "%02d%02d", timeinfo->tm_hour, timeinfo->tm_min);
-  // HHMM as an integer, leading zeros doesn't matter
-  now = atoi (buffer);
-
-  DEBUG_PRINT (("Trying to get schedule for today\n"));
-
-  // Create an SQL statement to get today's active rules time; tm_wday = number of the week
-  snprintf (query,
-            ALLOC,
-            "SELECT id, strftime('%%H%%M', rule_time), strftime('%%Y%%m%%d', 'now', '%s') "\
-            "FROM rules_turnon "\
-            "WHERE %s = 1 AND active = 1 "\
-            "ORDER BY time(rule_time) ASC;",
-            is_localtime ? "localtime" : "utc",
-            DAYS[timeinfo->tm_wday]);
-
-  rc = sqlite3_prepare_v2 (db, query, -1, &stmt, NULL);
-  if (rc != SQLITE_OK)
-    {
-      DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "ERROR: Failed while querying rules to make schedule for today\n");
-      sqlite3_close (db);
-      return RTCWAKE_ARGS_FAILURE;
-    }
+  if (get_time (&now))
+    return NULL;
 
-  // Get all rules today, ordered by time; the first rule that has a bigger time than now is a valid
-  while ((rc = sqlite3_step (stmt)) == SQLITE_ROW)
+  if (use_localtime)
+    localtime_r (&now, &start);
+  else
+    gmtime_r (&now, &start);
+
+  minute = WEEK_MINUTE (start.tm_wday, start.tm_hour, start.tm_min);
+
+  while (total_ahead < EXCEPTION_CALENDAR_YEARS * EXCEPTION_CALENDAR_DAYS * MINUTES_PER_DAY)
     {
-      int id = sqlite3_column_int (stmt, 0);
-      ruletime = sqlite3_column_int (stmt, 1);
-      if (now < ruletime)
+      entry = week_index_next (index, minute, &minutes_ahead);
+      if (entry == NULL)
+        return NULL;
+
+      minute = entry->minute;
+      total_ahead += minutes_ahead;
+
+      // Move the wall clock to the rule time; the date is normalized
+      *upcoming = start;
+      upcoming->tm_min += total_ahead;
+      upcoming->tm_sec = 0;
+      *upcoming_time = week_index_make_time (upcoming, use_localtime);
+      if (!use_localtime)
+        gmtime_r (upcoming_time, upcoming);
+
+      if (*upcoming_time == (time_t) -1)
         {
-          id_match = id;
-          snprintf (date, 9, "%s", sqlite3_column_text (stmt, 2));               // YYYYMMDD
-          snprintf (buffer, BUFFER_ALLOC, "%s", sqlite3_column_text (stmt, 1));  // HHMM
-          break;
+          DEBUG_PRINT_CONTEX;
+          fprintf (stderr, "ERROR: failed to make time\n");
+          return NULL;
         }
-      }
-    if (rc != SQLITE_DONE && rc != SQLITE_ROW)
-      {
-        DEBUG_PRINT_CONTEX;
-        fprintf (stderr, "ERROR (failed scheduling for today): %s\n", sqlite3_errmsg (db));
-        sqlite3_close (db);
-        return RTCWAKE_ARGS_FAILURE;
-      }
-  sqlite3_finalize (stmt);
-
-  // IF IT WASN'T POSSIBLE TO SCHEDULE FOR TODAY, TRY ON THE NEXT DAYS
-  if (id_match < 0)
-    {
-      DEBUG_PRINT (("Any time matched. Trying to schedule for tomorrow or later\n"));
-      // search for a matching rule within a week
-      for (int i = 1; i <= 7; i++)
+
+      // The rules of the same minute are next to each other on the index
+      for (; entry < index->entries + index->length && entry->minute == minute; entry++)
         {
-          int wday_num = week_day (timeinfo->tm_wday + i);
-          if (wday_num == -1)
-            {
-              DEBUG_PRINT_CONTEX;
-              fprintf (stderr, "ERROR: Failed to get schedule for for tomorrow or later (on wday function)\n");
-              sqlite3_close (db);
-              return RTCWAKE_ARGS_FAILURE;
-            }
-
-          /*
-           * The first rule after today is a valid match;
-           * also calculate the day: now + number of day until the matching rule,
-           * represented by the index i of the loop
-           */
-          snprintf (query,
-                    ALLOC,
-                    "SELECT id, strftime('%%Y%%m%%d', 'now', '%s', '+%d day'), strftime('%%H%%M', rule_time) "\
-                    "FROM rules_turnon "\
-                    "WHERE %s = 1 AND active = 1 "\
-                    "ORDER BY time(rule_time) ASC LIMIT 1;",
-                    is_localtime ? "localtime" : "utc",
-                    i,
-                    DAYS[wday_num]);
-
-          rc = sqlite3_prepare_v2 (db, query, -1, &stmt, NULL);
-          if (rc != SQLITE_OK)
-            {
-              DEBUG_PRINT_CONTEX;
-              fprintf (stderr, "ERROR: Failed scheduling for after\n");
-              return RTCWAKE_ARGS_FAILURE;
-            }
-          while ((rc = sqlite3_step (stmt)) == SQLITE_ROW)
-            {
-              id_match = sqlite3_column_int (stmt, 0);
-              snprintf (date, 9, "%s", sqlite3_column_text (stmt, 1)); // YYYYMMDD
-              snprintf (buffer,
-                        BUFFER_ALLOC,
-                        "%s",
-                        sqlite3_column_text (stmt, 2)); // HHMM
-            }
-          if (rc != SQLITE_DONE)
-            {
-              DEBUG_PRINT_CONTEX;
-              fprintf (stderr, "ERROR (failed scheduling for after): %s\n", sqlite3_errmsg (db));
-              sqlite3_close (db);
-              return RTCWAKE_ARGS_FAILURE;
-            }
-          sqlite3_finalize (stmt);
-
-          if (id_match >= 0)
-            break;
+          if (!exception_calendar_skips (&exceptions, table, entry->id,
+                                         upcoming->tm_year, upcoming->tm_yday))
+            return entry;
+
+          DEBUG_PRINT (("Rule %" PRId64 " skipped on %04d-%02d-%02d, an exception date", entry->id,
+                        upcoming->tm_year + 1900, upcoming->tm_mon + 1, upcoming->tm_mday));
         }
     }
 
-  // IF ANY RULE WAS FOUND, SEND RETURN AS RULE NOT FOUND
-  if (id_match < 0)
-    {
-      fprintf (stderr, "WARNING: Any turn on rule found.\n");
-      return RTCWAKE_ARGS_NOT_FOUND;
-    }
+  return NULL;
+}
 
-  // ELSE, RETURN PARAMETERS
-  pthread_mutex_lock (&rtcwake_args_mutex);
+static int query_custom_schedule (void)
+{
+  GawakeDb *db;
+  Config config;
 
-  rtcwake_args->found = true;
+  rtcwake_args->found = false;
+
+  // Also loads the changes, on DATABASE_IMAGE
+  if (database_integrity_verify ())
+    return RTCWAKE_ARGS_FAILURE;
 
-  sscanf (buffer, "%02d%02d",
-          &(rtcwake_args->hour),
-          &(rtcwake_args->minutes));
+  // GET THE DATABASE CONFIG
+  db = scheduler_database_get_db ();
+  if (configuration_get_snapshot (db, &config))
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, "ERROR: failed getting config information\n");
+      return RTCWAKE_ARGS_FAILURE;
+    }
+  rtcwake_args->shutdown_fail = config.shutdown_fail;
 
-  sscanf (date, "%04d%02d%02d",
-          &(rtcwake_args->year),
-          &(rtcwake_args->month),
-          &(rtcwake_args->day));
+  // GET THE CUSTOM RULE
+  if (rule_get_custom_schedule (db, rtcwake_args))
+    return RTCWAKE_ARGS_FAILURE;
 
-  pthread_mutex_unlock (&rtcwake_args_mutex);
+  // Validated below, even if it was never set
+  rtcwake_args->found = true;
 
   DEBUG_PRINT (("RtcwakeArgs fields:\n"\
                 "\tFound: %d\n\tShutdown: %d"\
@@ -893,138 +887,115 @@ static int query_upcoming_on_rule (bool use_default_mode)
     return RTCWAKE_ARGS_SUCESS;
 }
 
-static int query_custom_schedule (void)
+/*
+ * Get the upcoming deadline (absolute time) the scheduler must wait for:
+ * the notification and the time of the upcoming turn off rule, if it was found;
+ * otherwise, the beginning of the next day, to look for a new rule
+ */
+static Deadline get_next_deadline (time_t *deadline)
 {
-  int rc;
-  struct sqlite3_stmt *stmt;
-  sqlite3 *db;
-  char query[ALLOC];
+  const SchedulePlan *plan = schedule_plan_get ();
+  bool found = plan->off_rule.found;
+  time_t rule_time = plan->off_rule.rule_time;
+  NotificationTime rule_notification_time = plan->off_rule.notification_time;
 
-  pthread_mutex_lock (&rtcwake_args_mutex);
-  rtcwake_args->found = false;
-  pthread_mutex_unlock (&rtcwake_args_mutex);
-
-  // OPEN DATABASE
-  rc = sqlite3_open_v2 (DB_PATH, &db, SQLITE_OPEN_READONLY, NULL);
-  if (rc != SQLITE_OK)
+  // A canceled rule isn't notified, only awaited to look for the next one
+  if (found && !canceled && notified != rule_time)
     {
-      DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "Couldn't open database: %s\n", sqlite3_errmsg (db));
-      return RTCWAKE_ARGS_FAILURE;
+      // If the notification time was already missed, the timer expires
+      // immediately - Note #1
+      *deadline = rule_time - rule_notification_time;
+      return DEADLINE_NOTIFICATION;
     }
 
-  // GET THE DATABASE CONFIG
-  rc = sqlite3_prepare_v2 (db,
-                           "SELECT shutdown_fail "\
-                           "FROM config WHERE id = 1;",
-                           -1,
-                           &stmt,
-                           NULL);
-  if (rc != SQLITE_OK)
-    {
-      DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "ERROR: Failed getting config information\n");
-      sqlite3_close (db);
-      return RTCWAKE_ARGS_FAILURE;
-    }
-  while ((rc = sqlite3_step (stmt)) == SQLITE_ROW)
+  if (found)
     {
-      pthread_mutex_lock (&rtcwake_args_mutex);
-      rtcwake_args->shutdown_fail = sqlite3_column_int (stmt, 0);
-      pthread_mutex_unlock (&rtcwake_args_mutex);
+      *deadline = rule_time;
+      return DEADLINE_OFF_RULE;
     }
-  if (rc != SQLITE_DONE)
-    {
-      DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "ERROR (failed getting config information): %s\n", sqlite3_errmsg (db));
-      sqlite3_close (db);
-      return RTCWAKE_ARGS_FAILURE;
-    }
-  sqlite3_finalize (stmt);
 
-  // Create an SQL statement to get the custom rule
-  snprintf (query,
-            ALLOC,
-            "SELECT hour, minutes, day, month, year, mode "\
-            "FROM custom_schedule "\
-            "WHERE id = 1;");
+  // Next day, at 00:00:00
+  struct tm *timeinfo;
+  get_time_tm (&timeinfo);
+  timeinfo->tm_mday += 1;
+  timeinfo->tm_hour = timeinfo->tm_min = timeinfo->tm_sec = 0;
+  timeinfo->tm_isdst = -1;    // let mktime () handle DST changes
+  *deadline = mktime (timeinfo);
 
-  rc = sqlite3_prepare_v2 (db, query, -1, &stmt, NULL);
-  if (rc != SQLITE_OK)
-    {
-      DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "ERROR: Failed while querying custom rule\n"\
-               "SQL: %s\n", query);
-      sqlite3_close (db);
-      return RTCWAKE_ARGS_FAILURE;
-    }
+  return DEADLINE_DAY_CHANGED;
+}
 
-  // Get values
-  while ((rc = sqlite3_step (stmt)) == SQLITE_ROW)
-    {
-      pthread_mutex_lock (&rtcwake_args_mutex);
+// Was the user already notified about the upcoming turn off rule?
+static bool notified_upcoming_rule (void)
+{
+  const SchedulePlan *plan = schedule_plan_get ();
 
-      rtcwake_args->hour = sqlite3_column_int (stmt, 0);
-      rtcwake_args->minutes = sqlite3_column_int (stmt, 1);
+  return (plan->off_rule.found && notified == plan->off_rule.rule_time);
+}
 
-      rtcwake_args->day = sqlite3_column_int (stmt, 2);
-      rtcwake_args->month = sqlite3_column_int (stmt, 3);
-      rtcwake_args->year = sqlite3_column_int (stmt, 4);
-      rtcwake_args->mode = sqlite3_column_int (stmt, 5);
+// If the user was already notified about the upcoming turn off rule, look up
+// again the turn on rule used when it's reached
+static void refresh_notified_on_rule (void)
+{
+  if (!notified_upcoming_rule ())
+    return;
 
-      pthread_mutex_unlock (&rtcwake_args_mutex);
-    }
-  if (rc != SQLITE_DONE && rc != SQLITE_ROW)
+  if (!on_index_loaded)
+    on_rule_ret = prepare_rtcwake_args ();
+  else
     {
-      DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "ERROR: %s\n", sqlite3_errmsg (db));
-      sqlite3_close (db);
-      return RTCWAKE_ARGS_FAILURE;
+      const SchedulePlan *plan = schedule_plan_get ();
+      rtcwake_args->mode = plan->off_rule.mode;
+
+      on_rule_ret = set_run_shutdown (find_upcoming_on_rule ());
     }
-  sqlite3_finalize (stmt);
+}
 
-  pthread_mutex_lock (&rtcwake_args_mutex);
-  rtcwake_args->found = true;
-  pthread_mutex_unlock (&rtcwake_args_mutex);
+// Query the upcoming turn on rule, to be used when the upcoming off rule is reached
+static int prepare_rtcwake_args (void)
+{
+  int ret;
 
-  DEBUG_PRINT (("RtcwakeArgs fields:\n"\
-                "\tFound: %d\n\tShutdown: %d"\
-                "\n\t[HH:MM] %02d:%02d\n\t[DD/MM/YYYY] %02d/%02d/%d"\
-                "\n\tMode: %d",
-                rtcwake_args->found, rtcwake_args->shutdown_fail,
-                rtcwake_args->hour, rtcwake_args->minutes,
-                rtcwake_args->day, rtcwake_args->month, rtcwake_args->year,
-                rtcwake_args->mode));
+  for (int attempt = 1;
+       (ret = query_upcoming_on_rule (false)) == RTCWAKE_ARGS_FAILURE && retry_busy (attempt);
+       attempt++);
 
-  if (validade_rtcwake_args (rtcwake_args) == -1)
-    return INVALID_RTCWAKE_ARGS;
-  else
-    return RTCWAKE_ARGS_SUCESS;
+  return set_run_shutdown (ret);
 }
 
-static void sync_time (void)
+/*
+ * The database stays busy longer than the busy timeout only when a client
+ * holds a long write transaction; the decision (on the upcoming off rule) is
+ * not dropped because of it: the query runs again, a few times
+ */
+static bool retry_busy (int attempt)
 {
-  struct tm *timeinfo;
-
-  // Get current time
-  get_time_tm (&timeinfo);
+  if (attempt >= QUERY_ATTEMPTS || !scheduler_database_busy ())
+    return false;
 
-  // Calculate how many seconds lacks for the next minute
-  int sync_diff = 60 - timeinfo->tm_sec;
+  DEBUG_PRINT_TIME (("Database busy, querying again (attempt %d of %d)", attempt + 1, QUERY_ATTEMPTS));
+  return true;
+}
 
-  // If time is already synced, do nothing
-  if (sync_diff == 60)
-    sync_diff = 0;
+static int set_run_shutdown (int ret)
+{
+  // If querying rule failed, and the user wants to shutdown in this exception,
+  // set this action to true
+  if  (ret != RTCWAKE_ARGS_SUCESS && rtcwake_args->shutdown_fail == true)
+    rtcwake_args->run_shutdown = true;
+  else
+    rtcwake_args->run_shutdown = false;
 
-  DEBUG_PRINT_TIME (("Syncing time"));
-  sleep (sync_diff);
-  DEBUG_PRINT_TIME (("Time synced"));
+  return ret;
 }
 
 static int notify_user (int ret)
 {
   GError *error = NULL;
 
+  if (gsd_proxy == NULL)
+    return EXIT_FAILURE;
+
   gawake_server_database_call_return_status_sync (gsd_proxy,
                                                   ret,
                                                   NULL,     // cancellable
@@ -1043,29 +1014,128 @@ static int notify_user (int ret)
   return EXIT_SUCCESS;
 }
 
-static double get_time_remaining (void)
+static void on_database_updated_signal (GawakeServerDatabase *proxy,
+                                        GVariant *changes,
+                                        gpointer user_data)
 {
-  double diff;
-  time_t now;
+#if PREPROCESSOR_DEBUG
+  gint64 arrival = g_get_monotonic_time ();
+#endif
+
+  // Patch the compiled rules; if the changes can't be applied, query
+  // everything again
+  if (apply_changes (changes))
+    {
+      DEBUG_PRINT (("Querying turn off rule because database updated (full reload)"));
+      query_upcoming_off_rule ();
 
-  get_time (&now);
-  diff = difftime (upcoming_off_rule.rule_time, now);    // seconds
-  if (diff < 0)
-    diff = 0;
+      // If the user was already notified about this rule, just refresh
+      // the turn on rule used when it's reached
+      if (notified_upcoming_rule ())
+        on_rule_ret = prepare_rtcwake_args ();
+    }
+
+  plan_deadline ();
 
-  return diff;
+  DEBUG_PRINT (("Deadline re-planned %.3f ms after the signal arrival",
+                (g_get_monotonic_time () - arrival) / 1e3));
 }
 
-static void on_database_updated_signal (void)
+/*
+ * Apply the changes named by the DatabaseUpdated signal to the compiled
+ * rules, and look up again only the upcoming rules that could be affected.
+ * Any local user can send the signal through the server, so its values
+ * aren't trusted: it only tells which rules changed, and each one is read
+ * again from the database.
+ * Returns EXIT_FAILURE if a full reload is needed: no changes (older
+ * clients), changes not related to a single rule, invalid values, or rules
+ * that were never loaded.
+ */
+static int apply_changes (GVariant *changes)
 {
-  DEBUG_PRINT (("Querying turn off rule because database updated"));
-  query_upcoming_off_rule ();
+  GVariantIter iter;
+  GVariant *days;
+  guchar operation, hour, minutes, mode, table;
+  gint64 id;
+  gboolean active;
+  const gchar *name;
+  bool off_changed = false, on_changed = false;
+
+  if (changes == NULL
+      || !g_variant_is_of_type (changes, G_VARIANT_TYPE (DATABASE_CHANGES_TYPE))
+      || g_variant_n_children (changes) == 0
+      || !off_index_loaded)
+    return EXIT_FAILURE;
+
+  // VALIDATE ALL THE CHANGES BEFORE PATCHING
+  g_variant_iter_init (&iter, changes);
+  while (g_variant_iter_next (&iter, "(y(x&syy@abbyy))",
+                              &operation, &id, &name, &hour, &minutes,
+                              &days, &active, &mode, &table))
+    {
+      bool valid = (operation == CHANGE_ADD || operation == CHANGE_EDIT || operation == CHANGE_DELETE)
+        && (table == TABLE_ON || table == TABLE_OFF);
+
+      g_variant_unref (days);
+      if (!valid)
+        return EXIT_FAILURE;
+    }
+
+  // Also loads the changes, with DATABASE_IMAGE
+  if (database_integrity_verify ())
+    return EXIT_FAILURE;
+
+  // PATCH THE COMPILED RULES, AS THEY'RE ON THE DATABASE
+  g_variant_iter_init (&iter, changes);
+  while (g_variant_iter_next (&iter, "(y(x&syy@abbyy))",
+                              &operation, &id, &name, &hour, &minutes,
+                              &days, &active, &mode, &table))
+    {
+      g_variant_unref (days);
+
+      // Turn on rules are loaded when the turn off rule is notified
+      if (table == TABLE_ON && !on_index_loaded)
+        continue;
+
+      if (scheduler_database_load_rule ((Table) table, id,
+                                        (table == TABLE_OFF) ? &off_index : &on_index))
+        return EXIT_FAILURE;
+
+      if (table == TABLE_OFF)
+        off_changed = true;
+      else
+        on_changed = true;
+    }
+
+  DEBUG_PRINT (("Changes applied to the compiled rules"));
+
+  // LOOK UP THE AFFECTED UPCOMING RULES
+  if (off_changed)
+    {
+      week_index_sort (&off_index);
+      find_upcoming_off_rule ();
+    }
+  if (on_changed)
+    week_index_sort (&on_index);
+
+  if (off_changed || on_changed)
+    refresh_notified_on_rule ();
+
+  return EXIT_SUCCESS;
 }
 
 static void on_rule_canceled_signal (void)
 {
-  DEBUG_PRINT (("Rule canceled by signal"));
+#if PREPROCESSOR_DEBUG
+  gint64 arrival = g_get_monotonic_time ();
+#endif
+
+  DEBUG_PRINT_TIME (("Rule canceled by signal"));
   canceled = true;
+  plan_deadline ();
+
+  DEBUG_PRINT (("Deadline re-planned %.3f ms after the signal arrival",
+                (g_get_monotonic_time () - arrival) / 1e3));
 }
 
 static void on_schedule_requested_signal (void)
@@ -1160,15 +1230,16 @@ static void on_custom_schedule_requested_signal (void)
 /*                 shutdown ? "yes" : "no")); */
 /* } */
 
-static void prepare_for_shutdown (int sig)
+static gboolean on_sigterm (gpointer user_data)
 {
   DEBUG_PRINT (("Preparing for shutdown"));
+  terminating = true;
 
   // QUERY UPCOMING RULE AND OVERRIDE SOME VALUES
   int ret = query_upcoming_on_rule (true);
   // Override some values:
   // Set mode to "no"
-  rtcwake_args->mode = NO;
+  rtcwake_args->mode = MODE_NO;
   // Do not shutdown using gawaked
   rtcwake_args->shutdown_fail = false;
 
@@ -1181,6 +1252,8 @@ static void prepare_for_shutdown (int sig)
 
   // FINALLY, FINALIZE THE SCHEDULE
   schedule_finalize (ret);
+
+  return G_SOURCE_REMOVE;
 }
 
 static void schedule_finalize (int ret) {
@@ -1192,9 +1265,7 @@ static void schedule_finalize (int ret) {
       // Set action to shutdown
       rtcwake_args->run_shutdown = true;
 
-      finalize_timed_checker ();
-      finalize_gsd_listener ();
-      /* finalize_login1_listener (); */
+      finalize_loop ();
     }
   // On failure and "shutdown on failure" disabled, just notify the user
   else if (ret != RTCWAKE_ARGS_SUCESS && rtcwake_args->shutdown_fail == false)
@@ -1206,45 +1277,174 @@ static void schedule_finalize (int ret) {
   // On success
   else
     {
-      finalize_timed_checker ();
-      finalize_gsd_listener ();
-      /* finalize_login1_listener (); */
+      finalize_loop ();
     }
 }
 
-static void finalize_gsd_listener (void)
+static void finalize_loop (void)
 {
-  DEBUG_PRINT_TIME (("Finalizing gsd_listener thread..."));
-  g_main_loop_quit (gsd_loop);
-  DEBUG_PRINT_TIME (("gsd_listener thread finilized"));
+  DEBUG_PRINT_TIME (("Finalizing scheduler main loop..."));
+  g_main_loop_quit (loop);
 }
 
-/* static void finalize_login1_listener (void) */
-/* { */
-/*   DEBUG_PRINT_TIME (("Finalizing login1_listener thread...")); */
-/*   g_main_loop_quit (login1_loop); */
-/*   DEBUG_PRINT_TIME (("login1_listener thread finilized")); */
-/* } */
+/*
+ * SIMULATION
+ * The scheduler runs on a virtual clock, from "from" to "to": instead of
+ * arming the timer, the clock jumps straight to each deadline. Every
+ * notification, turn off and rtcwake decision is printed, and after a turn
+ * off the clock jumps to the wake up set by rtcwake. The rules don't change
+ * while simulating, so they are loaded only once; there's no D-Bus, timer or
+ * rtcwake.
+ */
+int scheduler_simulate (time_t from, time_t to)
+{
+  RtcwakeArgs simulated_args;
+  time_t deadline;
+  unsigned long deadlines = 0, turn_offs = 0;
+  gint64 started = g_get_monotonic_time ();
+  int ret = EXIT_SUCCESS;
+
+  memset (&simulated_args, 0, sizeof (simulated_args));
+  rtcwake_args = &simulated_args;
+  virtual_now = from;
+  set_time_source (get_virtual_time);
+
+  schedule_plan_publish (&(UpcomingOffRule) { .found = false });
+
+  if (scheduler_database_open ()
+      || load_off_rules ()
+      || query_upcoming_on_rule (true) == RTCWAKE_ARGS_FAILURE)
+    {
+      fprintf (stderr, "ERROR: Couldn't load the rules to simulate\n");
+      ret = EXIT_FAILURE;
+      goto end;
+    }
+
+  find_upcoming_off_rule ();
+
+  // Jump from deadline to deadline
+  while (true)
+    {
+      Deadline reached = get_next_deadline (&deadline);
+      const SchedulePlan *plan;
+
+      if (deadline >= to)
+        break;
+
+      if (deadline > virtual_now)
+        virtual_now = deadline;
+      deadlines++;
+
+      switch (reached)
+        {
+        case DEADLINE_DAY_CHANGED:
+          find_upcoming_off_rule ();
+          break;
+
+        case DEADLINE_NOTIFICATION:
+          plan = schedule_plan_get ();
+          notified = plan->off_rule.rule_time;
+          print_simulated_event ("notification", "turn off at %02d:%02d (%s)",
+                                 plan->off_rule.hour, plan->off_rule.minutes,
+                                 MODE[plan->off_rule.mode]);
 
-static void finalize_timed_checker (void)
+          refresh_notified_on_rule ();
+          break;
+
+        case DEADLINE_OFF_RULE:
+          turn_offs++;
+          simulate_off_rule ();
+          find_upcoming_off_rule ();
+          break;
+
+        default:
+          break;
+        }
+    }
+
+  printf ("Simulated %lu deadlines (%lu turn offs) in %.3f ms\n",
+          deadlines, turn_offs, (g_get_monotonic_time () - started) / 1e3);
+
+end:
+  set_time_source (NULL);
+  scheduler_database_close ();
+  week_index_free (&on_index);
+  week_index_free (&off_index);
+  one_shot_heap_free (&one_shots);
+  exception_calendar_free (&exceptions);
+  on_index_loaded = off_index_loaded = false;
+  schedule_plan_clear ();
+
+  return ret;
+}
+
+static time_t get_virtual_time (void)
+{
+  return virtual_now;
+}
+
+// The upcoming turn off rule was reached on the virtual clock: print what
+// gawaked would do, and move the clock to the wake up
+static void simulate_off_rule (void)
 {
-  DEBUG_PRINT_TIME (("Finalizing timed_checker thread..."));
-  int ret = pthread_cancel (timed_checker_thread);
+  struct tm wake_up = { 0 };
+  time_t wake_up_time;
 
-  if (ret != 0)
+  if (on_rule_ret != RTCWAKE_ARGS_SUCESS && rtcwake_args->run_shutdown == false)
     {
-      DEBUG_PRINT_CONTEX;
-      fprintf (stderr, "Failed when finilizing timed_checker thread");
+      print_simulated_event ("skipped", "no valid turn on rule (status %d)", on_rule_ret);
+      return;
+    }
+
+  if (rtcwake_args->run_shutdown)
+    {
+      // Nothing wakes the system up: the simulation goes on as if the user
+      // turned it on right away
+      print_simulated_event ("turn off", "shutdown (status %d)", on_rule_ret);
+      return;
+    }
+
+  print_simulated_event ("turn off", "rtcwake --date %d%02d%02d%02d%02d00 -m %s",
+                         rtcwake_args->year, rtcwake_args->month, rtcwake_args->day,
+                         rtcwake_args->hour, rtcwake_args->minutes,
+                         (rtcwake_args->mode < MODE_LAST) ? MODE[rtcwake_args->mode] : "no");
+
+  // The system is suspended (or off) until the wake up
+  wake_up.tm_year = rtcwake_args->year - 1900;
+  wake_up.tm_mon = rtcwake_args->month - 1;
+  wake_up.tm_mday = rtcwake_args->day;
+  wake_up.tm_hour = rtcwake_args->hour;
+  wake_up.tm_min = rtcwake_args->minutes;
+  wake_up.tm_isdst = -1;
+  wake_up_time = on_rules_localtime ? mktime (&wake_up) : timegm (&wake_up);
+
+  if (wake_up_time != (time_t) -1 && wake_up_time > virtual_now)
+    {
+      virtual_now = wake_up_time;
+      print_simulated_event ("wake up", "from %s", (rtcwake_args->mode < MODE_LAST) ? MODE[rtcwake_args->mode] : "no");
     }
+}
+
+static void print_simulated_event (const char *event, const char *format, ...)
+{
+  char timestamp[20];
+  struct tm now;
+  va_list args;
+
+  localtime_r (&virtual_now, &now);
+  strftime (timestamp, sizeof (timestamp), "%Y-%m-%d %H:%M", &now);
+  printf ("%s  %-12s  ", timestamp, event);
+
+  va_start (args, format);
+  vprintf (format, args);
+  va_end (args);
 
-  DEBUG_PRINT_TIME (("timed_checker thread finilized"));
+  printf ("\n");
 }
 
 /*
- * Note #1: if the scheduler is triggered late, but even though it can get a rule
- * to be executed in the current loop lap, there will be the possibility that the
- * remaining time to emit the notification can be lesser than the one set by the user;
- * in this case, the difftime on get_time_remaining () will return a negative number.
- * For this kind of exception, the sleep will be skip and the notification emitted
- * late.
+ * Note #1: if the scheduler is started (or the rule is added) late, there will be the
+ * possibility that the remaining time to emit the notification can be lesser than
+ * the one set by the user; in this case, the notification deadline is already in
+ * the past, the timer expires immediately and the notification is emitted late.
  */
@@ -3,7 +3,7 @@
 
 #include <time.h>
 
-#include "../utils/gawake-types.h"
+#include "../database-connection/gawake-types.h"
 
 // Structure for the upcoming turn off rule
 typedef struct {
@@ -23,4 +23,13 @@ typedef struct {
 
 int scheduler (RtcwakeArgs *rtcwake_args_ptr);
 
+// The same, split for a resident gawaked, which runs the scheduler once per
+// sleep/wake cycle: scheduler_init () -> scheduler_run ()... -> scheduler_end ()
+int scheduler_init (RtcwakeArgs *rtcwake_args_ptr);
+int scheduler_run (bool *terminate);
+void scheduler_end (void);
+
+// Run the scheduler on a virtual clock, printing its decisions
+int scheduler_simulate (time_t from, time_t to);
+
 #endif /* SCHEDULER_H_ */
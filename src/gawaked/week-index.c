@@ -0,0 +1,195 @@
+/* week-index.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * The active rules of a table are compiled into a sorted array of minutes of
+ * the week (one entry per enabled day), so the upcoming rule is found with a
+ * single binary search, wrapping to the next week, instead of a query per day
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "week-index.h"
+#include "../utils/debugger.h"
+
+#define INITIAL_ALLOC 16
+
+void week_index_init (WeekIndex *index)
+{
+  index->entries = NULL;
+  index->length = 0;
+  index->allocated = 0;
+}
+
+// Add a rule (unsorted); week_index_sort () must be called after the last one
+int week_index_add (WeekIndex *index,
+                    int64_t id,
+                    uint8_t hour,
+                    uint8_t minutes,
+                    const bool days[7],
+                    Mode mode)
+{
+  for (int wday = 0; wday < 7; wday++)
+    {
+      if (!days[wday])
+        continue;
+
+      if (index->length == index->allocated)
+        {
+          size_t allocated = (index->allocated == 0) ? INITIAL_ALLOC : index->allocated * 2;
+          WeekIndexEntry *entries = realloc (index->entries, allocated * sizeof (*entries));
+          if (entries == NULL)
+            {
+              DEBUG_PRINT_CONTEX;
+              fprintf (stderr, "ERROR: Failed to allocate memory\n");
+              return EXIT_FAILURE;
+            }
+
+          index->entries = entries;
+          index->allocated = allocated;
+        }
+
+      index->entries[index->length++] = (WeekIndexEntry) {
+        .minute = WEEK_MINUTE (wday, hour, minutes),
+        .id = id,
+        .mode = (uint8_t) mode,
+      };
+    }
+
+  return EXIT_SUCCESS;
+}
+
+static int compare_entries (const void *a, const void *b)
+{
+  const WeekIndexEntry *x = a, *y = b;
+
+  if (x->minute != y->minute)
+    return (x->minute < y->minute) ? -1 : 1;
+
+  // Same time: deterministic order
+  return (x->id > y->id) - (x->id < y->id);
+}
+
+void week_index_sort (WeekIndex *index)
+{
+  if (index->length > 1)
+    qsort (index->entries, index->length, sizeof (*index->entries), compare_entries);
+}
+
+/*
+ * Get the first rule strictly after the given minute of the week, wrapping to
+ * the next week if there's none left on this one; "minutes_ahead" receives the
+ * number of minutes until it, in [1, MINUTES_PER_WEEK].
+ * Returns NULL if the index is empty.
+ */
+const WeekIndexEntry *week_index_next (const WeekIndex *index,
+                                       int minute,
+                                       int *minutes_ahead)
+{
+  size_t low = 0, high = index->length;
+  const WeekIndexEntry *entry;
+
+  if (index->length == 0)
+    return NULL;
+
+  // Upper bound: the first entry bigger than "minute"
+  while (low < high)
+    {
+      size_t middle = low + (high - low) / 2;
+
+      if (index->entries[middle].minute <= minute)
+        low = middle + 1;
+      else
+        high = middle;
+    }
+
+  entry = &index->entries[(low == index->length) ? 0 : low];
+
+  *minutes_ahead = entry->minute - minute;
+  if (*minutes_ahead <= 0)
+    *minutes_ahead += MINUTES_PER_WEEK;
+
+  return entry;
+}
+
+/*
+ * Time of the date of a rule, normalizing it as mktime ()/timegm () do. On
+ * local time, a minute skipped by a DST change (e.g. 02:30 when 02:00 becomes
+ * 03:00) is the first one after the gap, not as far past it as it was inside:
+ * the rules of the gap keep their order with the ones right after it
+ */
+time_t week_index_make_time (struct tm *date, bool use_localtime)
+{
+  struct tm wall;
+  time_t wanted, time, before;
+
+  if (!use_localtime)
+    return timegm (date);
+
+  // The wall clock asked for, as a number; timegm () only normalizes it
+  wall = *date;
+  wanted = timegm (&wall);
+
+  date->tm_isdst = -1;    // let mktime () handle DST changes
+  time = mktime (date);
+  wall = *date;
+  if (time == (time_t) -1 || timegm (&wall) == wanted)
+    return time;
+
+  // Back to the end of the gap: the minutes after it show a later wall clock
+  for (before = time - 60; localtime_r (&before, &wall) != NULL; before -= 60)
+    {
+      if (timegm (&wall) <= wanted)
+        break;
+      time = before;
+    }
+
+  localtime_r (&time, date);
+
+  return time;
+}
+
+// Remove the entries of a rule, keeping the order
+void week_index_remove (WeekIndex *index, int64_t id)
+{
+  size_t kept = 0;
+
+  for (size_t i = 0; i < index->length; i++)
+    {
+      if (index->entries[i].id != id)
+        index->entries[kept++] = index->entries[i];
+    }
+
+  index->length = kept;
+}
+
+// Remove all the entries, keeping the allocated memory to be reused
+void week_index_reset (WeekIndex *index)
+{
+  index->length = 0;
+}
+
+void week_index_free (WeekIndex *index)
+{
+  free (index->entries);
+  week_index_init (index);
+}
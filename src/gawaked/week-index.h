@@ -0,0 +1,49 @@
+#ifndef WEEK_INDEX_H_
+#define WEEK_INDEX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "../database-connection/gawake-types.h"
+
+#define MINUTES_PER_DAY (24 * 60)
+#define MINUTES_PER_WEEK (7 * MINUTES_PER_DAY)
+
+// Minute of the week, from Sunday 00:00 (0) to Saturday 23:59 (MINUTES_PER_WEEK - 1)
+#define WEEK_MINUTE(wday, hour, minutes) ((wday) * MINUTES_PER_DAY + (hour) * 60 + (minutes))
+
+// A rule, on one of its days
+typedef struct
+{
+  int64_t id;
+  uint16_t minute;    // minute of the week
+  uint8_t mode;
+} WeekIndexEntry;
+
+// Active rules compiled into an array, sorted by minute of the week
+typedef struct
+{
+  WeekIndexEntry *entries;
+  size_t length;
+  size_t allocated;
+} WeekIndex;
+
+void week_index_init (WeekIndex *index);
+int week_index_add (WeekIndex *index,
+                    int64_t id,
+                    uint8_t hour,
+                    uint8_t minutes,
+                    const bool days[7],
+                    Mode mode);
+void week_index_sort (WeekIndex *index);
+const WeekIndexEntry *week_index_next (const WeekIndex *index,
+                                       int minute,
+                                       int *minutes_ahead);
+time_t week_index_make_time (struct tm *date, bool use_localtime);
+void week_index_remove (WeekIndex *index, int64_t id);
+void week_index_reset (WeekIndex *index);
+void week_index_free (WeekIndex *index);
+
+#endif /* WEEK_INDEX_H_ */
@@ -51,18 +51,47 @@ gint connect_dbus_client (void)
 void close_dbus_client (void)
 {
   error = NULL;
-  g_object_unref (proxy);
+  if (proxy != NULL)
+    g_object_unref (proxy);
+  proxy = NULL;
 }
 
 /* 06/01/2024
  * Íres, minha tia, descanse em paz, nós te amamos muito
  */
 
-int trigger_update_database (void)
+// Send the changes, so the scheduler can patch its plan instead of
+// reloading everything
+int trigger_update_database (const DatabaseChange *changes, size_t length)
 {
-  DEBUG_PRINT (("Update database signal"));
+  GVariantBuilder builder, days;
+
+  DEBUG_PRINT (("Update database signal, %zu change(s)", length));
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE (DATABASE_CHANGES_TYPE));
+  for (size_t i = 0; i < length; i++)
+    {
+      const Rule *rule = &changes[i].rule;
+
+      g_variant_builder_init (&days, G_VARIANT_TYPE ("ab"));
+      for (int d = 0; d < 7; d++)
+        g_variant_builder_add (&days, "b", (gboolean) rule->days[d]);
+
+      g_variant_builder_add (&builder,
+                             "(y(xsyy@abbyy))",
+                             (guchar) changes[i].operation,
+                             rule->id,
+                             rule->name,
+                             rule->hour,
+                             rule->minutes,
+                             g_variant_builder_end (&days),
+                             (gboolean) rule->active,
+                             (guchar) rule->mode,
+                             (guchar) rule->table);
+    }
 
   gawake_server_database_call_update_database_sync (proxy,
+                                                    g_variant_builder_end (&builder),
                                                     NULL,     // cancellable
                                                     &error);
 
@@ -137,3 +166,57 @@ int trigger_custom_schedule (void)
     }
   return EXIT_SUCCESS;
 }
+
+// Get the next "count" events planned, in time order; "events" must be freed
+int get_upcoming_events (unsigned int count, UpcomingEvent **events, size_t *length)
+{
+  GVariant *reply = NULL;
+  GVariantIter iter;
+  gint64 time;
+  guchar kind, mode;
+  gint64 id;
+  size_t i = 0;
+
+  DEBUG_PRINT (("Get upcoming events, %u event(s)", count));
+
+  gawake_server_database_call_get_upcoming_events_sync (proxy,
+                                                        count,
+                                                        &reply,
+                                                        NULL,     // cancellable
+                                                        &error);
+
+  if (error != NULL)
+    {
+      fprintf (stderr,
+               RED ("Error: Couldn't get the upcoming events: %s\n"),
+               error->message);
+
+      g_error_free (error);
+      error = NULL;
+      return EXIT_FAILURE;
+    }
+
+  *length = g_variant_n_children (reply);
+  *events = malloc ((*length > 0 ? *length : 1) * sizeof (**events));
+  if (*events == NULL)
+    {
+      DEBUG_PRINT_CONTEX;
+      fprintf (stderr, RED ("ERROR: Failed to allocate memory\n"));
+      g_variant_unref (reply);
+      return EXIT_FAILURE;
+    }
+
+  g_variant_iter_init (&iter, reply);
+  while (g_variant_iter_next (&iter, "(xyxy)", &time, &kind, &id, &mode))
+    {
+      (*events)[i++] = (UpcomingEvent) {
+        .time = time,
+        .kind = (EventKind) kind,
+        .id = id,
+        .mode = (Mode) mode,
+      };
+    }
+
+  g_variant_unref (reply);
+  return EXIT_SUCCESS;
+}
@@ -1,12 +1,18 @@
 #ifndef DBUS_CLIENT_H_
 #define DBUS_CLIENT_H_
 
+#include <stddef.h>
+
+#include "../database-connection/gawake-types.h"
+
 int connect_dbus_client (void);
 void close_dbus_client (void);
 
-int trigger_update_database (void);
+int trigger_update_database (const DatabaseChange *changes, size_t length);
 int trigger_cancel_rule (void);
 int trigger_schedule (void);
 int trigger_custom_schedule (void);
 
+int get_upcoming_events (unsigned int count, UpcomingEvent **events, size_t *length);
+
 #endif /* DBUS_CLIENT_H */
@@ -20,11 +20,27 @@
 
 #include "get-time.h"
 
+static time_t system_time (void);
+
+// Replaceable, so the code depending on the current time can run on a
+// virtual clock (e.g. to check how clock steps are handled)
+static TimeSource time_source = system_time;
+
+static time_t system_time (void)
+{
+  return time (NULL);
+}
+
+// Set the source of the current time; NULL restores the system time
+void set_time_source (TimeSource source)
+{
+  time_source = (source != NULL) ? source : system_time;
+}
+
 // Get the system time (now) as struct tm
 int get_time_tm (struct tm **timeinfo)
 {
-  time_t rawtime;
-  time (&rawtime);
+  time_t rawtime = time_source ();
 
   // If fails
   if (rawtime == (time_t) -1)
@@ -40,7 +56,7 @@ int get_time_tm (struct tm **timeinfo)
 // Get the system time (now) as time_t
 int get_time (time_t *time_now)
 {
-  time (time_now);
+  *time_now = time_source ();
   if (*time_now ==  (time_t) -1)
     {
       fprintf (stderr, "ERROR: failed while getting time\n");
@@ -5,7 +5,11 @@
 #include <stdlib.h>
 #include <stdio.h>
 
+// Source of the current time; time () by default
+typedef time_t (*TimeSource) (void);
+
 int get_time_tm (struct tm **timeinfo);
 int get_time (time_t *time_now);
+void set_time_source (TimeSource source);
 
 #endif /* GET_TIME_H_ */
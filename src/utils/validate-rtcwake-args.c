@@ -18,8 +18,77 @@
  * SPDX-License-Identifier: GPL-3.0-or-later
  */
 
+#include <stdbool.h>
+#include <time.h>
+
 #include "validate-rtcwake-args.h"
 #include "debugger.h"
 #include "get-time.h"
 
+int
+validade_rtcwake_args (RtcwakeArgs *rtcwake_args)
+{
+  DEBUG_PRINT (("Validating rtcwake_args..."));
+
+  bool hour, minutes, date, year, mode;
+  hour = minutes = date = year  = mode = false;
+  int ret;
+  struct tm *timeinfo;
+
+  // Hour
+  if (rtcwake_args->hour >= 0 && rtcwake_args->hour <= 23)
+    hour = true;
+
+  // Minutes
+  if (rtcwake_args->minutes >= 0 && rtcwake_args->minutes <= 59)
+    minutes = true;
+
+  // Date
+  struct tm input = {
+    .tm_mday = rtcwake_args->day,
+    .tm_mon = rtcwake_args->month - 1,
+    .tm_year = rtcwake_args->year - 1900,
+  };
+  time_t generated_time = mktime (&input);
+  timeinfo = localtime (&generated_time);
+  if (generated_time == -1
+      || rtcwake_args->day != timeinfo->tm_mday
+      || rtcwake_args->month != timeinfo->tm_mon + 1
+      || rtcwake_args->year != timeinfo->tm_year + 1900)
+    date = false;
+  else
+    date = true;
+
+  // Year (must be this year or at most the next, only)
+  get_time_tm (&timeinfo);
+  if (rtcwake_args->year > (timeinfo->tm_year + 1900 + 1))
+    year = false;
+  else
+    year = true;
+
+  switch (rtcwake_args->mode)
+    {
+    case MODE_MEM:
+    case MODE_DISK:
+    case MODE_OFF:
+    case MODE_NO:
+      mode = true;
+      break;
+
+    case MODE_LAST:
+    default:
+      mode = false;
+    }
+
+  if (hour && minutes && date && year && mode)
+    ret = 1;    // valid
+  else
+    ret = -1;   // invalid
+
+  DEBUG_PRINT (("RtcwakeArgs validation:\n"\
+                "\tHour: %d\n\tMinutes: %d\n\tDate: %d\n\tYear: %d\n"\
+                "\tMode: %d\n\tthis_year: %d\n\t--> Passed: %d",
+                hour, minutes, date, year, mode, timeinfo->tm_year + 1900, ret));
 
+  return ret;
+}
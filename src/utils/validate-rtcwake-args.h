@@ -0,0 +1,9 @@
+#ifndef VALIDATE_RTCWAKE_ARGS_H_
+#define VALIDATE_RTCWAKE_ARGS_H_
+
+#include "../database-connection/gawake-types.h"
+
+// 1 if the arguments are valid, -1 otherwise
+int validade_rtcwake_args (RtcwakeArgs *rtcwake_args);
+
+#endif /* VALIDATE_RTCWAKE_ARGS_H_ */
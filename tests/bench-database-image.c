@@ -0,0 +1,165 @@
+/* bench-database-image.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * A decision of the scheduler read from the database file, against from an
+ * image of it in memory (the DATABASE_IMAGE option), right after another
+ * connection changed the database and with the file out of the OS cache:
+ * the image is loaded again, while the file connection reads the pages it
+ * needs. A decision is the refresh of the image and a pass over the active
+ * turn off rules. Both must read the same rules.
+ *
+ * The cache is evicted with posix_fadvise (), so it's best effort: pages
+ * still mapped by another process stay.
+ *
+ * Argument: the schema of the database (src/database.sql)
+ */
+
+#define ALLOW_MANAGING_RULES
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "test-utils.h"
+#include "test-database.h"
+#include "../src/database-connection/database-connection.h"
+
+#define RUNS 30
+
+static const int SIZES[] = { 1000, 100000 };
+
+static Rule rules[100000];
+
+static void evict (const char *path)
+{
+  int fd = open (path, O_RDONLY);
+
+  if (fd == -1)
+    return;
+
+  fdatasync (fd);
+  posix_fadvise (fd, 0, 0, POSIX_FADV_DONTNEED);
+  close (fd);
+}
+
+static int compare_double (const void *a, const void *b)
+{
+  double x = *(const double *) a, y = *(const double *) b;
+
+  return (x > y) - (x < y);
+}
+
+// Active turn off rules; -1 on error
+static int count_active (GawakeDb *db)
+{
+  sqlite3_stmt *stmt;
+  int count = 0, rc;
+
+  if (sqlite3_prepare_v2 (gawake_db_get_connection (db),
+                          "SELECT id, minute, days_mask, mode FROM rules_turnoff WHERE active = 1;",
+                          -1, &stmt, NULL) != SQLITE_OK)
+    return -1;
+
+  while ((rc = sqlite3_step (stmt)) == SQLITE_ROW)
+    count++;
+  sqlite3_finalize (stmt);
+
+  return (rc == SQLITE_DONE) ? count : -1;
+}
+
+// p50 and p90 of a decision, in ms
+static void measure (GawakeDb *writer, GawakeDb *reader, int size, double *p50, double *p90)
+{
+  double times[RUNS];
+  struct timespec start;
+  bool reloaded;
+
+  for (int i = 0; i < RUNS; i++)
+    {
+      bool active = (i % 2 == 1);
+      int expected = active ? size : size - 1;
+
+      // The change another program would make
+      CHECK (rule_enable_disable (writer, 1, TABLE_OFF, active) == EXIT_SUCCESS);
+
+      evict (DB_PATH);
+      evict (DB_PATH "-wal");
+
+      clock_gettime (CLOCK_MONOTONIC, &start);
+      CHECK (gawake_db_refresh_image (reader, &reloaded) == EXIT_SUCCESS);
+      CHECK (count_active (reader) == expected);
+      times[i] = elapsed_ms (&start);
+    }
+
+  qsort (times, RUNS, sizeof (double), compare_double);
+  *p50 = times[RUNS / 2];
+  *p90 = times[RUNS * 9 / 10];
+}
+
+int main (int argc, char *argv[])
+{
+  for (size_t s = 0; s < sizeof (SIZES) / sizeof (SIZES[0]); s++)
+    {
+      GawakeDb *writer, *file, *image;
+      double file_p50, file_p90, image_p50, image_p90;
+      int size = SIZES[s];
+
+      if (argc < 2 || test_database_create (argv[1]))
+        return EXIT_FAILURE;
+
+      writer = gawake_db_open (false);
+      if (writer == NULL)
+        return EXIT_FAILURE;
+
+      for (int i = 0; i < size; i++)
+        {
+          snprintf (rules[i].name, RULE_NAME_LENGTH, "Rule %d", i + 1);
+          rules[i].hour = i % 24;
+          rules[i].minutes = i % 60;
+          for (int d = 0; d < 7; d++)
+            rules[i].days[d] = true;
+          rules[i].active = true;
+          rules[i].mode = MODE_OFF;
+          rules[i].table = TABLE_OFF;
+        }
+      CHECK (rule_add_many (writer, rules, size) == EXIT_SUCCESS);
+
+      file = gawake_db_open (true);
+      image = gawake_db_open_image ();
+      if (!CHECK (file != NULL && image != NULL))
+        return check_result ();
+
+      // The file connection ignores the refresh
+      measure (writer, file, size, &file_p50, &file_p90);
+      measure (writer, image, size, &image_p50, &image_p90);
+
+      printf ("%6d rules, changed, cold cache: file %.3f / %.3f ms, "
+              "image %.3f / %.3f ms (p50 / p90)\n",
+              size, file_p50, file_p90, image_p50, image_p90);
+
+      gawake_db_close (image);
+      gawake_db_close (file);
+      gawake_db_close (writer);
+    }
+
+  return check_result ();
+}
@@ -0,0 +1,127 @@
+/* bench-database-integrity.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Verification of the database integrity by the scheduler, with 1k, 10k and
+ * 100k rules, on each of its paths:
+ * - full: the first verification (PRAGMA integrity_check);
+ * - quick: after another connection committed a change (PRAGMA quick_check);
+ * - cached: nothing changed (PRAGMA data_version only).
+ * The change committed before each quick check isn't timed.
+ *
+ * Argument: the schema of the database (src/database.sql)
+ */
+
+#define ALLOW_MANAGING_RULES
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "test-utils.h"
+#include "test-database.h"
+#include "../src/database-connection/database-connection.h"
+#include "../src/gawaked/scheduler-database.h"
+#include "../src/gawaked/database-integrity.h"
+
+#define MAX_RULES 100000
+#define FULL_CHECKS 10
+#define QUICK_CHECKS 100
+#define CACHED_CHECKS 10000
+
+static Rule rules[MAX_RULES];
+
+static void run (size_t length, const char *schema)
+{
+  GawakeDb *db;
+  struct timespec start;
+  double full_ms = 0, quick_ms = 0, cached_ms = 0;
+
+  if (test_database_create (schema) || (db = gawake_db_open (false)) == NULL)
+    {
+      CHECK (false);
+      return;
+    }
+
+  srand (1);
+  for (size_t i = 0; i < length; i++)
+    {
+      int mask = 1 + rand () % 127;
+
+      snprintf (rules[i].name, RULE_NAME_LENGTH, "Rule %zu", i + 1);
+      rules[i].hour = rand () % 24;
+      rules[i].minutes = rand () % 60;
+      for (int d = 0; d < 7; d++)
+        rules[i].days[d] = mask & (1 << d);
+      rules[i].active = true;
+      rules[i].mode = MODE_OFF;
+      rules[i].table = TABLE_OFF;
+    }
+
+  // On a new table, the rules get the ids 1 to length
+  if (!CHECK (rule_add_many (db, rules, length) == EXIT_SUCCESS)
+      || !CHECK (scheduler_database_open () == EXIT_SUCCESS))
+    {
+      gawake_db_close (db);
+      return;
+    }
+
+  for (int i = 0; i < FULL_CHECKS; i++)
+    {
+      database_integrity_invalidate ();
+      clock_gettime (CLOCK_MONOTONIC, &start);
+      CHECK (database_integrity_verify () == EXIT_SUCCESS);
+      full_ms += elapsed_ms (&start);
+    }
+
+  for (int i = 0; i < QUICK_CHECKS; i++)
+    {
+      int changed = rand () % length;
+
+      rules[changed].active = !rules[changed].active;
+      CHECK (rule_enable_disable (db, changed + 1, TABLE_OFF, rules[changed].active) == EXIT_SUCCESS);
+
+      clock_gettime (CLOCK_MONOTONIC, &start);
+      CHECK (database_integrity_verify () == EXIT_SUCCESS);
+      quick_ms += elapsed_ms (&start);
+    }
+
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < CACHED_CHECKS; i++)
+    CHECK (database_integrity_verify () == EXIT_SUCCESS);
+  cached_ms = elapsed_ms (&start);
+
+  printf ("%6zu rules: full %8.3f ms, quick %8.3f ms, cached %6.3f ms per verification\n",
+          length, full_ms / FULL_CHECKS, quick_ms / QUICK_CHECKS, cached_ms / CACHED_CHECKS);
+
+  scheduler_database_close ();
+  gawake_db_close (db);
+}
+
+int main (int argc, char *argv[])
+{
+  if (argc < 2)
+    return EXIT_FAILURE;
+
+  run (1000, argv[1]);
+  run (10000, argv[1]);
+  run (MAX_RULES, argv[1]);
+
+  return check_result ();
+}
@@ -0,0 +1,126 @@
+/* bench-event-iterator.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * The upcoming 10k events of 1k turn on and 1k turn off rules on random times
+ * and days, with exception dates, from a week with a DST change: what the
+ * D-Bus server computes for GetUpcomingEvents. The median of the runs must
+ * stay in the low milliseconds, and the events in time order.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "test-utils.h"
+#include "../src/gawaked/event-iterator.h"
+
+#define TIMEZONE "CET-1CEST,M3.5.0,M10.5.0/3"
+#define RULES 1000
+#define EVENTS 10000
+#define RUNS 51
+#define MAX_MEDIAN_MS 5.0
+
+static int compare_double (const void *a, const void *b)
+{
+  double x = *(const double *) a, y = *(const double *) b;
+
+  return (x > y) - (x < y);
+}
+
+static void add_rules (WeekIndex *index, Mode mode)
+{
+  for (int i = 0; i < RULES; i++)
+    {
+      int mask = 1 + rand () % 127;
+      bool days[7];
+
+      for (int d = 0; d < 7; d++)
+        days[d] = mask & (1 << d);
+      CHECK (week_index_add (index, i + 1, rand () % 24, rand () % 60, days, mode) == EXIT_SUCCESS);
+    }
+
+  week_index_sort (index);
+}
+
+int main (void)
+{
+  WeekIndex on, off;
+  ExceptionCalendar exceptions;
+  EventIterator iterator;
+  UpcomingEvent event;
+  struct timespec start;
+  struct tm from = { .tm_year = 2026 - 1900, .tm_mon = 2, .tm_mday = 25, .tm_hour = 12, .tm_isdst = -1 };
+  double times[RUNS];
+  time_t now;
+  int64_t last = 0;
+  bool ordered = true;
+  size_t events = 0;
+
+  setenv ("TZ", TIMEZONE, 1);
+  tzset ();
+  now = mktime (&from);
+
+  srand (1);
+  week_index_init (&on);
+  week_index_init (&off);
+  add_rules (&on, MODE_OFF);
+  add_rules (&off, MODE_MEM);
+
+  exception_calendar_init (&exceptions);
+  exception_calendar_reset (&exceptions, from.tm_year);
+  CHECK (exception_calendar_add (&exceptions, "2026-04-03", TABLE_ON, 0) == EXIT_SUCCESS);
+  CHECK (exception_calendar_add (&exceptions, "2026-04-06", TABLE_ON, 0) == EXIT_SUCCESS);
+  for (int i = 1; i <= 50; i++)
+    CHECK (exception_calendar_add (&exceptions, "2026-03-30", TABLE_OFF, i * 7) == EXIT_SUCCESS);
+
+  for (int r = 0; r < RUNS; r++)
+    {
+      clock_gettime (CLOCK_MONOTONIC, &start);
+
+      event_iterator_init (&iterator, now, &on, true, &off);
+      event_iterator_add_exceptions (&iterator, &exceptions);
+      for (events = 0; events < EVENTS && event_iterator_next (&iterator, &event); events++)
+        {
+          if (event.time < last)
+            ordered = false;
+          last = event.time;
+        }
+
+      times[r] = elapsed_ms (&start);
+      last = 0;
+    }
+
+  qsort (times, RUNS, sizeof (double), compare_double);
+
+  CHECK (events == EVENTS);
+  CHECK (ordered);
+  CHECK (times[RUNS / 2] < MAX_MEDIAN_MS);
+
+  printf ("%d events of %zu + %zu entries: %.3f ms median, %.3f ms max (%.0f ns per event)\n",
+          EVENTS, on.length, off.length, times[RUNS / 2], times[RUNS - 1],
+          times[RUNS / 2] * 1e6 / EVENTS);
+
+  exception_calendar_free (&exceptions);
+  week_index_free (&on);
+  week_index_free (&off);
+
+  return check_result ();
+}
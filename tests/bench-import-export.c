@@ -0,0 +1,132 @@
+/* bench-import-export.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Export and import of a file of 100k rules, as JSON Lines and as CSV: rules
+ * per second of each direction. The import of each export is exported again,
+ * and must give the same file.
+ *
+ * Argument: the schema of the database (src/database.sql)
+ */
+
+#define ALLOW_MANAGING_RULES
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "test-utils.h"
+#include "test-database.h"
+#include "../src/database-connection/database-connection.h"
+#include "../src/gawake-cli/import-export.h"
+
+#define RULES 100000
+
+static Rule rules[RULES];
+
+static bool same_files (const char *a, const char *b)
+{
+  FILE *first = fopen (a, "r"), *second = fopen (b, "r");
+  bool same = (first != NULL && second != NULL);
+  int c;
+
+  while (same && (c = getc (first)) != EOF)
+    same = (getc (second) == c);
+  if (same)
+    same = (getc (second) == EOF);
+
+  if (first != NULL)
+    fclose (first);
+  if (second != NULL)
+    fclose (second);
+
+  return same;
+}
+
+static void run (GawakeDb *db, const char *first, const char *second)
+{
+  struct timespec start;
+  double export_ms, import_ms;
+  int out;
+
+  // The summaries of the library would be mixed with the results
+  fflush (stdout);
+  out = dup (STDOUT_FILENO);
+  if (!CHECK (out != -1 && freopen ("/dev/null", "w", stdout) != NULL))
+    return;
+
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  CHECK (export_database (db, first) == EXIT_SUCCESS);
+  export_ms = elapsed_ms (&start);
+
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  CHECK (import_database (db, first) == EXIT_SUCCESS);
+  import_ms = elapsed_ms (&start);
+
+  CHECK (export_database (db, second) == EXIT_SUCCESS);
+
+  fflush (stdout);
+  dup2 (out, STDOUT_FILENO);
+  close (out);
+
+  CHECK (same_files (first, second));
+
+  printf ("%d rules, %-10s export %8.1f ms (%7.0f rules/s), import %8.1f ms (%7.0f rules/s)\n",
+          RULES, strrchr (first, '.') + 1, export_ms, RULES / export_ms * 1e3,
+          import_ms, RULES / import_ms * 1e3);
+}
+
+int main (int argc, char *argv[])
+{
+  GawakeDb *db;
+
+  if (argc < 2 || test_database_create (argv[1]))
+    return EXIT_FAILURE;
+
+  db = gawake_db_open (false);
+  if (db == NULL)
+    return EXIT_FAILURE;
+
+  srand (1);
+  for (int i = 0; i < RULES; i++)
+    {
+      int mask = 1 + rand () % 127;
+
+      snprintf (rules[i].name, RULE_NAME_LENGTH, "Rule %d", i + 1);
+      rules[i].hour = rand () % 24;
+      rules[i].minutes = rand () % 60;
+      for (int d = 0; d < 7; d++)
+        rules[i].days[d] = mask & (1 << d);
+      rules[i].active = rand () % 2;
+      rules[i].mode = rand () % MODE_LAST;
+      rules[i].table = (i % 2) ? TABLE_OFF : TABLE_ON;
+    }
+
+  if (CHECK (rule_add_many (db, rules, RULES) == EXIT_SUCCESS))
+    {
+      run (db, DB_DIR "first.jsonl", DB_DIR "second.jsonl");
+      run (db, DB_DIR "first.csv", DB_DIR "second.csv");
+    }
+
+  gawake_db_close (db);
+
+  return check_result ();
+}
@@ -0,0 +1,184 @@
+/* bench-rule-batch.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Rows per second of the rule operations, one row at a time (a transaction
+ * each) against the batched variants (a single transaction): add, edit,
+ * enable/disable and delete of 500 and 5000 rules.
+ *
+ * Argument: the schema of the database (src/database.sql)
+ */
+
+#define ALLOW_MANAGING_RULES
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "test-utils.h"
+#include "test-database.h"
+#include "../src/database-connection/database-connection.h"
+
+#define MAX_RULES 5000
+
+typedef enum {
+  OPERATION_ADD,
+  OPERATION_EDIT,
+  OPERATION_ACTIVE,
+  OPERATION_DELETE,
+  OPERATION_LAST
+} Operation;
+
+static const char *OPERATION[] = { "add", "edit", "enable/disable", "delete" };
+
+static Rule rules[MAX_RULES];
+static int64_t ids[MAX_RULES];
+
+// Ids are never reused: each run gets the next ones
+static int64_t next_id = 1;
+
+static void fill_rules (size_t length)
+{
+  for (size_t i = 0; i < length; i++)
+    {
+      int mask = 1 + rand () % 127;
+
+      snprintf (rules[i].name, RULE_NAME_LENGTH, "Rule %zu", i + 1);
+      rules[i].id = ids[i] = next_id + i;
+      rules[i].hour = rand () % 24;
+      rules[i].minutes = rand () % 60;
+      for (int d = 0; d < 7; d++)
+        rules[i].days[d] = mask & (1 << d);
+      rules[i].active = true;
+      rules[i].mode = MODE_OFF;
+      rules[i].table = TABLE_OFF;
+    }
+  next_id += length;
+}
+
+static void move_rules (size_t length)
+{
+  for (size_t i = 0; i < length; i++)
+    rules[i].minutes = (rules[i].minutes + 1) % 60;
+}
+
+static int run_single (GawakeDb *db, Operation operation, size_t length)
+{
+  int ret = EXIT_SUCCESS;
+
+  for (size_t i = 0; i < length && ret == EXIT_SUCCESS; i++)
+    {
+      switch (operation)
+        {
+        case OPERATION_ADD:
+          ret = rule_add (db, &rules[i]);
+          break;
+
+        case OPERATION_EDIT:
+          ret = rule_edit (db, &rules[i]);
+          break;
+
+        case OPERATION_ACTIVE:
+          ret = rule_enable_disable (db, ids[i], TABLE_OFF, false);
+          break;
+
+        case OPERATION_DELETE:
+          ret = rule_delete (db, ids[i], TABLE_OFF);
+          break;
+
+        case OPERATION_LAST:
+        default:
+          ret = EXIT_FAILURE;
+        }
+    }
+
+  return ret;
+}
+
+static int run_many (GawakeDb *db, Operation operation, size_t length)
+{
+  switch (operation)
+    {
+    case OPERATION_ADD:
+      return rule_add_many (db, rules, length);
+
+    case OPERATION_EDIT:
+      return rule_edit_many (db, rules, length);
+
+    case OPERATION_ACTIVE:
+      return rule_set_active_many (db, ids, length, TABLE_OFF, false);
+
+    case OPERATION_DELETE:
+      return rule_delete_many (db, ids, length, TABLE_OFF);
+
+    case OPERATION_LAST:
+    default:
+      return EXIT_FAILURE;
+    }
+}
+
+// Rows per second of each operation, on "length" new rules
+static void run (GawakeDb *db, bool many, size_t length, double *rows_per_second)
+{
+  struct timespec start;
+
+  fill_rules (length);
+
+  for (Operation operation = OPERATION_ADD; operation < OPERATION_LAST; operation++)
+    {
+      if (operation == OPERATION_EDIT)
+        move_rules (length);
+
+      clock_gettime (CLOCK_MONOTONIC, &start);
+      CHECK ((many ? run_many (db, operation, length)
+                   : run_single (db, operation, length)) == EXIT_SUCCESS);
+      rows_per_second[operation] = length * 1e3 / elapsed_ms (&start);
+    }
+}
+
+int main (int argc, char *argv[])
+{
+  const size_t lengths[] = { 500, MAX_RULES };
+  double single[OPERATION_LAST], many[OPERATION_LAST];
+  GawakeDb *db;
+
+  if (argc < 2 || test_database_create (argv[1]))
+    return EXIT_FAILURE;
+
+  db = gawake_db_open (false);
+  if (db == NULL)
+    return EXIT_FAILURE;
+
+  srand (1);
+
+  for (size_t l = 0; l < sizeof (lengths) / sizeof (lengths[0]); l++)
+    {
+      run (db, false, lengths[l], single);
+      run (db, true, lengths[l], many);
+
+      for (Operation operation = OPERATION_ADD; operation < OPERATION_LAST; operation++)
+        printf ("%5zu rules, %-14s %10.0f rows/s single, %10.0f rows/s batched (%.0fx)\n",
+                lengths[l], OPERATION[operation], single[operation],
+                many[operation], many[operation] / single[operation]);
+    }
+
+  gawake_db_close (db);
+
+  return check_result ();
+}
@@ -0,0 +1,141 @@
+/* bench-rule-reload.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Reload of the week index after a change on a single rule, with 10k rules:
+ * compiling the whole table again, against compiling only the changed rule
+ * (what the scheduler does with the changes it receives). Both indexes must
+ * end up equal. The refresh of the database, common to both, is timed apart.
+ *
+ * Argument: the schema of the database (src/database.sql)
+ */
+
+#define ALLOW_MANAGING_RULES
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test-utils.h"
+#include "test-database.h"
+#include "../src/database-connection/database-connection.h"
+#include "../src/gawaked/scheduler-database.h"
+#include "../src/gawaked/database-integrity.h"
+#include "../src/gawaked/week-index.h"
+
+#define RULES 10000
+#define UPDATES 200
+
+static Rule rules[RULES];
+
+static bool same_index (const WeekIndex *a, const WeekIndex *b)
+{
+  if (a->length != b->length)
+    return false;
+
+  for (size_t i = 0; i < a->length; i++)
+    {
+      if (a->entries[i].id != b->entries[i].id
+          || a->entries[i].minute != b->entries[i].minute
+          || a->entries[i].mode != b->entries[i].mode)
+        return false;
+    }
+
+  return true;
+}
+
+int main (int argc, char *argv[])
+{
+  GawakeDb *db;
+  WeekIndex full, delta;
+  struct timespec start;
+  double refresh_ms = 0, full_ms = 0, delta_ms = 0;
+
+  if (argc < 2 || test_database_create (argv[1]))
+    return EXIT_FAILURE;
+
+  db = gawake_db_open (false);
+  if (db == NULL)
+    return EXIT_FAILURE;
+
+  srand (1);
+  for (int i = 0; i < RULES; i++)
+    {
+      int mask = 1 + rand () % 127;
+
+      snprintf (rules[i].name, RULE_NAME_LENGTH, "Rule %d", i + 1);
+      rules[i].hour = rand () % 24;
+      rules[i].minutes = rand () % 60;
+      for (int d = 0; d < 7; d++)
+        rules[i].days[d] = mask & (1 << d);
+      rules[i].active = true;
+      rules[i].mode = MODE_OFF;
+      rules[i].table = TABLE_OFF;
+    }
+
+  // On a new table, the rules get the ids 1 to RULES
+  if (!CHECK (rule_add_many (db, rules, RULES) == EXIT_SUCCESS)
+      || !CHECK (scheduler_database_open () == EXIT_SUCCESS))
+    {
+      gawake_db_close (db);
+      return check_result ();
+    }
+
+  week_index_init (&full);
+  week_index_init (&delta);
+  CHECK (database_integrity_verify () == EXIT_SUCCESS);
+  CHECK (scheduler_database_load_rules (TABLE_OFF, &delta) == EXIT_SUCCESS);
+
+  for (int i = 0; i < UPDATES; i++)
+    {
+      int changed = rand () % RULES;
+
+      rules[changed].active = !rules[changed].active;
+      CHECK (rule_enable_disable (db, changed + 1, TABLE_OFF, rules[changed].active) == EXIT_SUCCESS);
+
+      clock_gettime (CLOCK_MONOTONIC, &start);
+      CHECK (database_integrity_verify () == EXIT_SUCCESS);
+      refresh_ms += elapsed_ms (&start);
+
+      clock_gettime (CLOCK_MONOTONIC, &start);
+      CHECK (scheduler_database_load_rules (TABLE_OFF, &full) == EXIT_SUCCESS);
+      full_ms += elapsed_ms (&start);
+
+      clock_gettime (CLOCK_MONOTONIC, &start);
+      CHECK (scheduler_database_load_rule (TABLE_OFF, changed + 1, &delta) == EXIT_SUCCESS);
+      week_index_sort (&delta);
+      delta_ms += elapsed_ms (&start);
+    }
+
+  CHECK (same_index (&full, &delta));
+
+  printf ("%d rules (%zu entries), %d changes: refresh %.3f ms, "
+          "full reload %.3f ms, delta %.3f ms per change (%.0fx)\n",
+          RULES, full.length, UPDATES, refresh_ms / UPDATES,
+          full_ms / UPDATES, delta_ms / UPDATES,
+          (delta_ms > 0) ? full_ms / delta_ms : 0);
+
+  week_index_free (&full);
+  week_index_free (&delta);
+  scheduler_database_close ();
+  gawake_db_close (db);
+
+  return check_result ();
+}
@@ -0,0 +1,201 @@
+/* bench-week-index.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Lookup of the upcoming rule on the week index, with 10, 1k and 100k rules
+ * on random times and days: time to compile the index, and time per lookup.
+ * A sample of the lookups is checked against a linear scan.
+ *
+ * The same rules are also looked up with SQL, as the scheduler did before the
+ * index (query_upcoming_off_rule ()): the first active rule of the day after
+ * the current minute, then the days after it, on a prepared statement. Its
+ * lookups are fewer (they take milliseconds on 100k rules), and all of them
+ * are checked against the index.
+ *
+ * Argument: the schema of the database (src/database.sql)
+ */
+
+#define ALLOW_MANAGING_RULES
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "test-utils.h"
+#include "test-database.h"
+#include "../src/database-connection/database-connection.h"
+#include "../src/gawaked/week-index.h"
+
+#define LOOKUPS 1000000
+#define SQL_LOOKUPS 1000
+#define CHECKED_LOOKUPS 1000
+#define MAX_RULES 100000
+
+// Minutes looked up, drawn before timing
+static int minutes[LOOKUPS];
+
+static Rule rules[MAX_RULES];
+
+// Minutes ahead found by the SQL lookups
+static int sql_ahead[SQL_LOOKUPS];
+
+// Minutes until the first entry strictly after "minute", scanning all of them
+static int linear_minutes_ahead (const WeekIndex *index, int minute)
+{
+  int best = MINUTES_PER_WEEK + 1;
+
+  for (size_t i = 0; i < index->length; i++)
+    {
+      int ahead = index->entries[i].minute - minute;
+
+      if (ahead <= 0)
+        ahead += MINUTES_PER_WEEK;
+      if (ahead < best)
+        best = ahead;
+    }
+
+  return best;
+}
+
+// Minutes until the first rule strictly after "minute", a query per day;
+// -1 if there's none
+static int sql_minutes_ahead (sqlite3_stmt *stmt, int minute)
+{
+  int day = minute / MINUTES_PER_DAY, of_day = minute % MINUTES_PER_DAY;
+
+  // The eighth day is the same week day, on the next week
+  for (int i = 0; i <= 7; i++)
+    {
+      int found = -1;
+
+      sqlite3_bind_int (stmt, 1, 1 << ((day + i) % 7));
+      sqlite3_bind_int (stmt, 2, (i == 0) ? of_day : -1);
+      if (sqlite3_step (stmt) == SQLITE_ROW)
+        found = sqlite3_column_int (stmt, 0);
+      sqlite3_reset (stmt);
+
+      if (found >= 0)
+        return i * MINUTES_PER_DAY + found - of_day;
+    }
+
+  return -1;
+}
+
+static void run (size_t length, const char *schema)
+{
+  WeekIndex index;
+  GawakeDb *db;
+  sqlite3_stmt *stmt = NULL;
+  struct timespec start;
+  double build_ms, lookup_ms, sql_ms = 0;
+  long checksum = 0;
+  int ahead;
+
+  week_index_init (&index);
+  srand (1);
+
+  for (size_t i = 0; i < length; i++)
+    {
+      int mask = 1 + rand () % 127;
+
+      rules[i] = (Rule) {
+        .hour = rand () % 24,
+        .minutes = rand () % 60,
+        .active = true,
+        .mode = MODE_OFF,
+        .table = TABLE_OFF,
+      };
+      snprintf (rules[i].name, RULE_NAME_LENGTH, "Rule %zu", i + 1);
+      for (int d = 0; d < 7; d++)
+        rules[i].days[d] = mask & (1 << d);
+    }
+
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (size_t i = 0; i < length; i++)
+    week_index_add (&index, (int64_t) i + 1, rules[i].hour, rules[i].minutes, rules[i].days, MODE_OFF);
+  week_index_sort (&index);
+  build_ms = elapsed_ms (&start);
+
+  for (int i = 0; i < LOOKUPS; i++)
+    minutes[i] = rand () % MINUTES_PER_WEEK;
+
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < LOOKUPS; i++)
+    {
+      if (week_index_next (&index, minutes[i], &ahead) != NULL)
+        checksum += ahead;
+    }
+  lookup_ms = elapsed_ms (&start);
+
+  for (int i = 0; i < CHECKED_LOOKUPS; i++)
+    {
+      int minute = rand () % MINUTES_PER_WEEK;
+
+      week_index_next (&index, minute, &ahead);
+      CHECK (ahead == linear_minutes_ahead (&index, minute));
+    }
+
+  // The same rules on the database
+  if (test_database_create (schema) || (db = gawake_db_open (false)) == NULL)
+    {
+      CHECK (false);
+      week_index_free (&index);
+      return;
+    }
+
+  if (CHECK (rule_add_many (db, rules, length) == EXIT_SUCCESS)
+      && CHECK (sqlite3_prepare_v2 (gawake_db_get_connection (db),
+                                    "SELECT minute FROM rules_turnoff "
+                                    "WHERE active = 1 AND days_mask & ?1 AND minute > ?2 "
+                                    "ORDER BY minute LIMIT 1;",
+                                    -1, &stmt, NULL) == SQLITE_OK))
+    {
+      clock_gettime (CLOCK_MONOTONIC, &start);
+      for (int i = 0; i < SQL_LOOKUPS; i++)
+        sql_ahead[i] = sql_minutes_ahead (stmt, minutes[i]);
+      sql_ms = elapsed_ms (&start);
+
+      for (int i = 0; i < SQL_LOOKUPS; i++)
+        {
+          week_index_next (&index, minutes[i], &ahead);
+          CHECK (ahead == sql_ahead[i]);
+        }
+    }
+
+  printf ("%7zu rules (%7zu entries): compiled in %8.3f ms, %6.1f ns per lookup, "
+          "SQL %9.1f ns per lookup (%.0fx) (%ld)\n",
+          length, index.length, build_ms, lookup_ms * 1e6 / LOOKUPS, sql_ms * 1e6 / SQL_LOOKUPS,
+          (lookup_ms > 0) ? (sql_ms / SQL_LOOKUPS) / (lookup_ms / LOOKUPS) : 0, checksum);
+
+  sqlite3_finalize (stmt);
+  gawake_db_close (db);
+  week_index_free (&index);
+}
+
+int main (int argc, char *argv[])
+{
+  if (argc < 2)
+    return EXIT_FAILURE;
+
+  run (10, argv[1]);
+  run (1000, argv[1]);
+  run (MAX_RULES, argv[1]);
+
+  return check_result ();
+}
@@ -0,0 +1,199 @@
+/* test-database-backup.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Backup of a seeded database, and its restore over a changed one. The
+ * restore rejects a file that isn't a Gawake database (or not a database at
+ * all), one of a newer schema version and a corrupted one, and the live
+ * database is left untouched
+ *
+ * Argument: the schema of the database (src/database.sql)
+ */
+
+#define ALLOW_MANAGING_RULES
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "test-utils.h"
+#include "test-database.h"
+#include "../src/database-connection/database-connection.h"
+
+#define RULES 500
+#define BACKUP_PATH DB_DIR "backup.db"
+#define NOT_GAWAKE_PATH DB_DIR "not-gawake.db"
+#define TEXT_PATH DB_DIR "text.db"
+#define NEWER_PATH DB_DIR "newer.db"
+#define CORRUPTED_PATH DB_DIR "corrupted.db"
+#define PAGE_SIZE 4096
+
+static Rule rules[RULES];
+
+// The rules of both tables and the configuration, as text; NULL on failure
+static char *summary (GawakeDb *db)
+{
+  sqlite3_stmt *stmt;
+  char *text = NULL;
+
+  if (sqlite3_prepare_v2 (gawake_db_get_connection (db),
+                          "SELECT (SELECT group_concat (id || rule_name || minute || active, ',') "
+                          "FROM rules_turnon) || ';' || "
+                          "(SELECT group_concat (id || rule_name || minute || mode, ',') "
+                          "FROM rules_turnoff) || ';' || "
+                          "(SELECT notification_time FROM config WHERE id = 1);",
+                          -1, &stmt, NULL) != SQLITE_OK)
+    return NULL;
+
+  if (sqlite3_step (stmt) == SQLITE_ROW && sqlite3_column_text (stmt, 0) != NULL)
+    text = strdup ((const char *) sqlite3_column_text (stmt, 0));
+  sqlite3_finalize (stmt);
+
+  return text;
+}
+
+static bool same_summary (GawakeDb *db, const char *expected)
+{
+  char *current = summary (db);
+  bool same = (current != NULL && expected != NULL && strcmp (current, expected) == 0);
+
+  free (current);
+
+  return same;
+}
+
+static int run_sql (const char *path, const char *sql)
+{
+  sqlite3 *connection;
+  int rc;
+
+  rc = sqlite3_open_v2 (path, &connection, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL);
+  if (rc == SQLITE_OK)
+    rc = sqlite3_exec (connection, sql, NULL, NULL, NULL);
+  sqlite3_close (connection);
+
+  return (rc == SQLITE_OK) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Copy a file, writing "garbage" over "length" bytes at "offset" (if any)
+static int copy_file (const char *from, const char *to, long offset, size_t length)
+{
+  FILE *source = fopen (from, "rb"), *destination = fopen (to, "wb");
+  int c, ret = EXIT_SUCCESS;
+  long position = 0;
+
+  if (source == NULL || destination == NULL)
+    ret = EXIT_FAILURE;
+
+  while (ret == EXIT_SUCCESS && (c = getc (source)) != EOF)
+    {
+      if (position >= offset && position < offset + (long) length)
+        c = 0xA5;
+      putc (c, destination);
+      position++;
+    }
+
+  if (source != NULL)
+    fclose (source);
+  if (destination != NULL && fclose (destination))
+    ret = EXIT_FAILURE;
+
+  // The garbage must be inside the file
+  return (offset >= 0 && position < offset + (long) length) ? EXIT_FAILURE : ret;
+}
+
+static void check_rejected (GawakeDb *db, const char *path, const char *expected)
+{
+  int pages;
+
+  CHECK (database_restore (db, path, &pages) == EXIT_FAILURE);
+  CHECK (same_summary (db, expected));
+}
+
+int main (int argc, char *argv[])
+{
+  GawakeDb *db;
+  char *seeded, sql[64];
+  int pages = 0;
+
+  if (argc < 2 || test_database_create (argv[1]))
+    return EXIT_FAILURE;
+
+  db = gawake_db_open (false);
+  if (db == NULL)
+    return EXIT_FAILURE;
+
+  for (int i = 0; i < RULES; i++)
+    {
+      snprintf (rules[i].name, RULE_NAME_LENGTH, "Rule %d", i + 1);
+      rules[i].hour = i % 24;
+      rules[i].minutes = i % 60;
+      rules[i].days[i % 7] = true;
+      rules[i].active = (i % 3 != 0);
+      rules[i].mode = MODE_OFF;
+      rules[i].table = (i % 2) ? TABLE_OFF : TABLE_ON;
+    }
+  CHECK (rule_add_many (db, rules, RULES) == EXIT_SUCCESS);
+  seeded = summary (db);
+
+  unlink (BACKUP_PATH);
+  CHECK (database_backup (db, BACKUP_PATH, &pages) == EXIT_SUCCESS);
+  CHECK (pages > 3);
+  // Not over the database itself
+  CHECK (database_backup (db, DB_PATH, &pages) == EXIT_FAILURE);
+
+  // Changed after the backup, then restored
+  CHECK (rule_delete (db, 1, TABLE_ON) == EXIT_SUCCESS);
+  CHECK (rule_add (db, &rules[0]) == EXIT_SUCCESS);
+  CHECK (!same_summary (db, seeded));
+
+  CHECK (database_restore (db, BACKUP_PATH, &pages) == EXIT_SUCCESS);
+  CHECK (same_summary (db, seeded));
+
+  // Rejected: the restored database is kept
+  unlink (NOT_GAWAKE_PATH);
+  CHECK (run_sql (NOT_GAWAKE_PATH, "CREATE TABLE notes (text TEXT); INSERT INTO notes VALUES ('x');")
+         == EXIT_SUCCESS);
+  check_rejected (db, NOT_GAWAKE_PATH, seeded);
+
+  // The schema itself: text, not a database
+  CHECK (copy_file (argv[1], TEXT_PATH, -1, 0) == EXIT_SUCCESS);
+  check_rejected (db, TEXT_PATH, seeded);
+
+  snprintf (sql, sizeof (sql), "PRAGMA user_version = %d;", DB_SCHEMA_VERSION + 1);
+  CHECK (copy_file (BACKUP_PATH, NEWER_PATH, -1, 0) == EXIT_SUCCESS);
+  CHECK (run_sql (NEWER_PATH, sql) == EXIT_SUCCESS);
+  check_rejected (db, NEWER_PATH, seeded);
+
+  // A page of the rules overwritten
+  CHECK (copy_file (BACKUP_PATH, CORRUPTED_PATH, 2 * PAGE_SIZE + 8, 64) == EXIT_SUCCESS);
+  check_rejected (db, CORRUPTED_PATH, seeded);
+
+  // The rejected files didn't leave anything behind: a valid one still works
+  CHECK (rule_delete (db, 2, TABLE_OFF) == EXIT_SUCCESS);
+  CHECK (database_restore (db, BACKUP_PATH, &pages) == EXIT_SUCCESS);
+  CHECK (same_summary (db, seeded));
+
+  free (seeded);
+  gawake_db_close (db);
+
+  return check_result ();
+}
@@ -0,0 +1,105 @@
+/* test-database.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Database of a test: each test is built with a DB_DIR of its own, on the
+ * build directory, and creates the database there from the schema
+ * (src/database.sql), removing the one left by a previous run
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sqlite3.h>
+
+#include "test-database.h"
+#include "../src/database-connection/gawake-types.h"
+
+static char *read_file (const char *path)
+{
+  FILE *file;
+  char *content = NULL;
+  long size;
+
+  file = fopen (path, "r");
+  if (file == NULL)
+    {
+      perror ("ERROR: Couldn't open the schema");
+      return NULL;
+    }
+
+  if (fseek (file, 0, SEEK_END) == 0 && (size = ftell (file)) >= 0
+      && fseek (file, 0, SEEK_SET) == 0
+      && (content = malloc (size + 1)) != NULL)
+    {
+      if (fread (content, 1, size, file) == (size_t) size)
+        content[size] = '\0';
+      else
+        {
+          free (content);
+          content = NULL;
+        }
+    }
+  fclose (file);
+
+  if (content == NULL)
+    fprintf (stderr, "ERROR: Couldn't read the schema\n");
+
+  return content;
+}
+
+int test_database_create (const char *schema_path)
+{
+  sqlite3 *db;
+  char *schema, *error = NULL;
+  int rc;
+
+  if (mkdir (DB_DIR, 0700) == -1 && errno != EEXIST)
+    {
+      perror ("ERROR: Couldn't create the database directory");
+      return EXIT_FAILURE;
+    }
+
+  unlink (DB_PATH);
+  unlink (DB_PATH "-wal");
+  unlink (DB_PATH "-shm");
+
+  schema = read_file (schema_path);
+  if (schema == NULL)
+    return EXIT_FAILURE;
+
+  rc = sqlite3_open_v2 (DB_PATH, &db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL);
+  if (rc == SQLITE_OK)
+    rc = sqlite3_exec (db, schema, NULL, NULL, &error);
+
+  if (rc != SQLITE_OK)
+    {
+      fprintf (stderr, "ERROR: Couldn't create the database: %s\n",
+               (error != NULL) ? error : sqlite3_errmsg (db));
+      sqlite3_free (error);
+    }
+
+  sqlite3_close (db);
+  free (schema);
+
+  return (rc == SQLITE_OK) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,6 @@
+#ifndef TEST_DATABASE_H_
+#define TEST_DATABASE_H_
+
+int test_database_create (const char *schema_path);
+
+#endif /* TEST_DATABASE_H_ */
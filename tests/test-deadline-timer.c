@@ -0,0 +1,105 @@
+/* test-deadline-timer.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * The deadline timer, on the real clock: a deadline in the past expires at
+ * once, one in the near future expires on time (the trigger error is printed,
+ * in milliseconds), and one replaced before it's reached never expires
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <poll.h>
+
+#include "test-utils.h"
+#include "../src/gawaked/deadline-timer.h"
+
+// Late wake ups tolerated, on a loaded machine
+#define MAX_TRIGGER_ERROR_MS 250
+
+// Wait up to timeout_ms for the timer to become readable
+static bool wait_timer (int timeout_ms)
+{
+  struct pollfd timer = {
+    .fd = deadline_timer_get_fd (),
+    .events = POLLIN,
+  };
+
+  return poll (&timer, 1, timeout_ms) == 1;
+}
+
+static void test_past_deadline (void)
+{
+  CHECK (deadline_timer_arm (time (NULL) - 60) == EXIT_SUCCESS);
+  CHECK (wait_timer (100));
+  CHECK (deadline_timer_acknowledge () == DEADLINE_TIMER_EXPIRED);
+}
+
+static void test_near_deadline (void)
+{
+  struct timespec now;
+  time_t deadline;
+  double trigger_error;
+
+  // One to two seconds ahead: the timer is armed on whole seconds
+  clock_gettime (CLOCK_REALTIME, &now);
+  deadline = now.tv_sec + 2;
+  CHECK (deadline_timer_arm (deadline) == EXIT_SUCCESS);
+
+  // Not before the deadline...
+  CHECK (!wait_timer (900));
+  // ...but right after it
+  CHECK (wait_timer (2000));
+
+  clock_gettime (CLOCK_REALTIME, &now);
+  trigger_error = (now.tv_sec - deadline) * 1e3 + now.tv_nsec / 1e6;
+  printf ("Trigger error: %.3f ms\n", trigger_error);
+
+  CHECK (trigger_error >= 0 && trigger_error < MAX_TRIGGER_ERROR_MS);
+  CHECK (deadline_timer_acknowledge () == DEADLINE_TIMER_EXPIRED);
+}
+
+static void test_replaced_deadline (void)
+{
+  time_t now = time (NULL);
+
+  // Re-arming replaces the deadline, as the scheduler does when the plan
+  // changes: the first one is canceled
+  CHECK (deadline_timer_arm (now + 1) == EXIT_SUCCESS);
+  CHECK (deadline_timer_arm (now + 3600) == EXIT_SUCCESS);
+
+  CHECK (!wait_timer (2500));
+  // Nothing expired (EAGAIN)
+  CHECK (deadline_timer_acknowledge () == DEADLINE_TIMER_FAILED);
+}
+
+int main (void)
+{
+  if (deadline_timer_init ())
+    return EXIT_FAILURE;
+
+  test_past_deadline ();
+  test_near_deadline ();
+  test_replaced_deadline ();
+
+  deadline_timer_close ();
+
+  return check_result ();
+}
@@ -0,0 +1,202 @@
+/* test-event-iterator.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Order of the events merged by the iterator: turn on and turn off rules,
+ * the custom schedule and the one-shot wake ups (on the same time, the custom
+ * schedule, then the one-shot wake ups, then the rules), the wrap from
+ * Saturday to the next week, the exception dates, and a day with a DST change,
+ * where the times aren't an offset from the beginning of the day.
+ *
+ * The local time is Central Europe: on 2026-03-29, 02:00 CET becomes
+ * 03:00 CEST; a rule in the gap runs at 03:00, before the ones after it
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "test-utils.h"
+#include "../src/gawaked/event-iterator.h"
+
+#define TIMEZONE "CET-1CEST,M3.5.0,M10.5.0/3"
+
+static const bool EVERY_DAY[7] = { true, true, true, true, true, true, true };
+static const bool SUNDAY[7] = { true, false, false, false, false, false, false };
+
+typedef struct
+{
+  int64_t time;
+  EventKind kind;
+  int64_t id;
+} Expected;
+
+// Seconds since the epoch of a UTC time of 2026
+static int64_t utc (int month, int day, int hour, int minutes)
+{
+  struct tm date = {
+    .tm_year = 2026 - 1900,
+    .tm_mon = month - 1,
+    .tm_mday = day,
+    .tm_hour = hour,
+    .tm_min = minutes,
+  };
+
+  return timegm (&date);
+}
+
+static void check_events (EventIterator *iterator, const Expected *expected, size_t length)
+{
+  UpcomingEvent event;
+
+  for (size_t i = 0; i < length; i++)
+    {
+      if (!CHECK (event_iterator_next (iterator, &event)))
+        return;
+
+      if (!CHECK (event.time == expected[i].time && event.kind == expected[i].kind
+                  && event.id == expected[i].id))
+        fprintf (stderr, "  event %zu: %lld, kind %d, id %lld; expected %lld, kind %d, id %lld\n",
+                 i, (long long) event.time, event.kind, (long long) event.id,
+                 (long long) expected[i].time, expected[i].kind, (long long) expected[i].id);
+    }
+}
+
+static void test_merge (void)
+{
+  WeekIndex on, off;
+  EventIterator iterator;
+  ExceptionCalendar exceptions;
+  const OneShot one_shots[] = {
+    { .id = 3, .time = utc (3, 28, 12, 0) },
+    { .id = 7, .time = utc (3, 29, 5, 0) },   // with turn on rule 1
+  };
+  // From Saturday, 2026-03-28, 12:00 CET
+  const Expected expected[] = {
+    { utc (3, 28, 12, 0), EVENT_ONE_SHOT, 3 },
+    { utc (3, 28, 21, 0), EVENT_CUSTOM_SCHEDULE, 0 },
+    { utc (3, 28, 21, 0), EVENT_TURN_OFF, 1 },
+    // DST change: 02:30 doesn't exist, it's 03:00 CEST; then UTC + 2
+    { utc (3, 29, 1, 0), EVENT_TURN_ON, 2 },
+    { utc (3, 29, 1, 10), EVENT_TURN_ON, 4 },
+    { utc (3, 29, 5, 0), EVENT_ONE_SHOT, 7 },
+    { utc (3, 29, 5, 0), EVENT_TURN_ON, 1 },
+    { utc (3, 29, 20, 0), EVENT_TURN_OFF, 1 },
+    { utc (3, 29, 20, 0), EVENT_TURN_OFF, 2 },
+    // 2026-03-30: exception of all the rules
+    { utc (3, 31, 5, 0), EVENT_TURN_ON, 1 },
+    { utc (3, 31, 20, 0), EVENT_TURN_OFF, 1 },
+    // 2026-04-01: exception of turn on rule 1 only
+    { utc (4, 1, 20, 0), EVENT_TURN_OFF, 1 },
+    { utc (4, 2, 5, 0), EVENT_TURN_ON, 1 },
+    { utc (4, 2, 20, 0), EVENT_TURN_OFF, 1 },
+    { utc (4, 3, 5, 0), EVENT_TURN_ON, 1 },
+    { utc (4, 3, 20, 0), EVENT_TURN_OFF, 1 },
+    { utc (4, 4, 5, 0), EVENT_TURN_ON, 1 },
+    { utc (4, 4, 20, 0), EVENT_TURN_OFF, 1 },
+    // Wrapped to the next week, with no DST change
+    { utc (4, 5, 0, 30), EVENT_TURN_ON, 2 },
+    { utc (4, 5, 1, 10), EVENT_TURN_ON, 4 },
+    { utc (4, 5, 5, 0), EVENT_TURN_ON, 1 },
+    { utc (4, 5, 20, 0), EVENT_TURN_OFF, 1 },
+    { utc (4, 5, 20, 0), EVENT_TURN_OFF, 2 },
+    { utc (4, 6, 5, 0), EVENT_TURN_ON, 1 },
+  };
+
+  week_index_init (&on);
+  week_index_init (&off);
+  exception_calendar_init (&exceptions);
+
+  CHECK (week_index_add (&on, 1, 7, 0, EVERY_DAY, MODE_OFF) == EXIT_SUCCESS);
+  CHECK (week_index_add (&on, 2, 2, 30, SUNDAY, MODE_OFF) == EXIT_SUCCESS);
+  CHECK (week_index_add (&on, 4, 3, 10, SUNDAY, MODE_OFF) == EXIT_SUCCESS);
+  CHECK (week_index_add (&off, 2, 22, 0, SUNDAY, MODE_DISK) == EXIT_SUCCESS);
+  CHECK (week_index_add (&off, 1, 22, 0, EVERY_DAY, MODE_OFF) == EXIT_SUCCESS);
+  week_index_sort (&on);
+  week_index_sort (&off);
+
+  exception_calendar_reset (&exceptions, 2026 - 1900);
+  CHECK (exception_calendar_add (&exceptions, "2026-03-30", TABLE_ON, 0) == EXIT_SUCCESS);
+  CHECK (exception_calendar_add (&exceptions, "2026-04-01", TABLE_ON, 1) == EXIT_SUCCESS);
+
+  event_iterator_init (&iterator, utc (3, 28, 11, 0), &on, true, &off);
+  event_iterator_add_custom (&iterator, utc (3, 28, 21, 0), MODE_MEM);
+  event_iterator_add_one_shots (&iterator, one_shots, 2);
+  event_iterator_add_exceptions (&iterator, &exceptions);
+
+  check_events (&iterator, expected, sizeof (expected) / sizeof (expected[0]));
+
+  exception_calendar_free (&exceptions);
+  week_index_free (&on);
+  week_index_free (&off);
+}
+
+// Turn on rules on UTC don't follow the DST change; turn off rules always do
+static void test_utc (void)
+{
+  WeekIndex on, off;
+  EventIterator iterator;
+  const Expected expected[] = {
+    { utc (3, 29, 2, 30), EVENT_TURN_ON, 2 },
+    { utc (3, 29, 20, 0), EVENT_TURN_OFF, 2 },
+    { utc (4, 5, 2, 30), EVENT_TURN_ON, 2 },
+  };
+
+  week_index_init (&on);
+  week_index_init (&off);
+  CHECK (week_index_add (&on, 2, 2, 30, SUNDAY, MODE_OFF) == EXIT_SUCCESS);
+  CHECK (week_index_add (&off, 2, 22, 0, SUNDAY, MODE_DISK) == EXIT_SUCCESS);
+
+  event_iterator_init (&iterator, utc (3, 28, 11, 0), &on, false, &off);
+  check_events (&iterator, expected, sizeof (expected) / sizeof (expected[0]));
+
+  week_index_free (&on);
+  week_index_free (&off);
+}
+
+static void test_empty (void)
+{
+  WeekIndex on, off;
+  EventIterator iterator;
+  UpcomingEvent event;
+
+  week_index_init (&on);
+  week_index_init (&off);
+
+  event_iterator_init (&iterator, utc (3, 28, 11, 0), &on, true, &off);
+  event_iterator_add_custom (&iterator, utc (3, 28, 21, 0), MODE_MEM);
+  CHECK (event_iterator_next (&iterator, &event) && event.kind == EVENT_CUSTOM_SCHEDULE);
+  CHECK (!event_iterator_next (&iterator, &event));
+
+  week_index_free (&on);
+  week_index_free (&off);
+}
+
+int main (void)
+{
+  setenv ("TZ", TIMEZONE, 1);
+  tzset ();
+
+  test_merge ();
+  test_utc ();
+  test_empty ();
+
+  return check_result ();
+}
@@ -0,0 +1,135 @@
+/* test-exception-calendar.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * The dates compiled into the bitsets of the exception calendar: the leap
+ * days (29 February, and 31 December, the 366th day), the dates of all the
+ * rules added before and after the ones of a single rule, and the dates out
+ * of the two years covered
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "test-utils.h"
+#include "../src/gawaked/exception-calendar.h"
+
+#define YEAR(year) ((year) - 1900)
+
+static void test_leap_year (void)
+{
+  ExceptionCalendar calendar;
+
+  exception_calendar_init (&calendar);
+  exception_calendar_reset (&calendar, YEAR (2028));
+
+  CHECK (exception_calendar_add (&calendar, "2028-02-29", TABLE_ON, 0) == EXIT_SUCCESS);
+  CHECK (exception_calendar_add (&calendar, "2028-12-31", TABLE_ON, 0) == EXIT_SUCCESS);
+  CHECK (exception_calendar_add (&calendar, "2029-03-01", TABLE_ON, 0) == EXIT_SUCCESS);
+
+  // tm_yday of 29 February is 59, and of 31 December, 365
+  CHECK (exception_calendar_skips (&calendar, TABLE_ON, 1, YEAR (2028), 59));
+  CHECK (!exception_calendar_skips (&calendar, TABLE_ON, 1, YEAR (2028), 58));
+  CHECK (!exception_calendar_skips (&calendar, TABLE_ON, 1, YEAR (2028), 60));
+  CHECK (exception_calendar_skips (&calendar, TABLE_ON, 1, YEAR (2028), 365));
+  CHECK (!exception_calendar_skips (&calendar, TABLE_ON, 1, YEAR (2028), 364));
+
+  // The next year doesn't overlap the 366th day; 1 March is its day 59
+  CHECK (!exception_calendar_skips (&calendar, TABLE_ON, 1, YEAR (2029), 0));
+  CHECK (exception_calendar_skips (&calendar, TABLE_ON, 1, YEAR (2029), 59));
+  CHECK (!exception_calendar_skips (&calendar, TABLE_ON, 1, YEAR (2029), 60));
+
+  exception_calendar_free (&calendar);
+}
+
+static void test_scopes (void)
+{
+  ExceptionCalendar calendar;
+
+  exception_calendar_init (&calendar);
+  exception_calendar_reset (&calendar, YEAR (2026));
+
+  // Of all the rules, before the rule has dates of its own
+  CHECK (exception_calendar_add (&calendar, "2026-01-01", TABLE_ON, 0) == EXIT_SUCCESS);
+  CHECK (exception_calendar_add (&calendar, "2026-06-15", TABLE_OFF, 5) == EXIT_SUCCESS);
+  // And after
+  CHECK (exception_calendar_add (&calendar, "2026-12-25", TABLE_ON, 0) == EXIT_SUCCESS);
+  CHECK (exception_calendar_add (&calendar, "2026-03-10", TABLE_ON, 5) == EXIT_SUCCESS);
+
+  CHECK (calendar.length == 2);
+
+  // Rule 5 of the turn off table: its date and the ones of all the rules
+  CHECK (exception_calendar_skips (&calendar, TABLE_OFF, 5, YEAR (2026), 0));
+  CHECK (exception_calendar_skips (&calendar, TABLE_OFF, 5, YEAR (2026), 165));
+  CHECK (exception_calendar_skips (&calendar, TABLE_OFF, 5, YEAR (2026), 358));
+  CHECK (!exception_calendar_skips (&calendar, TABLE_OFF, 5, YEAR (2026), 68));
+
+  // The rule of the same id on the other table has its own date
+  CHECK (exception_calendar_skips (&calendar, TABLE_ON, 5, YEAR (2026), 68));
+  CHECK (!exception_calendar_skips (&calendar, TABLE_ON, 5, YEAR (2026), 165));
+  CHECK (exception_calendar_skips (&calendar, TABLE_ON, 5, YEAR (2026), 358));
+
+  // Any other rule: only the dates of all the rules
+  CHECK (exception_calendar_skips (&calendar, TABLE_OFF, 6, YEAR (2026), 0));
+  CHECK (exception_calendar_skips (&calendar, TABLE_OFF, 6, YEAR (2026), 358));
+  CHECK (!exception_calendar_skips (&calendar, TABLE_OFF, 6, YEAR (2026), 165));
+
+  // The memory is kept, but the dates are gone
+  exception_calendar_reset (&calendar, YEAR (2026));
+  CHECK (!exception_calendar_skips (&calendar, TABLE_OFF, 5, YEAR (2026), 165));
+  CHECK (!exception_calendar_skips (&calendar, TABLE_OFF, 5, YEAR (2026), 0));
+
+  exception_calendar_free (&calendar);
+}
+
+static void test_out_of_range (void)
+{
+  ExceptionCalendar calendar;
+
+  exception_calendar_init (&calendar);
+  exception_calendar_reset (&calendar, YEAR (2026));
+
+  // Ignored, not failed
+  CHECK (exception_calendar_add (&calendar, "2025-12-31", TABLE_ON, 0) == EXIT_SUCCESS);
+  CHECK (exception_calendar_add (&calendar, "2028-01-01", TABLE_ON, 0) == EXIT_SUCCESS);
+  CHECK (exception_calendar_add (&calendar, "2028-01-01", TABLE_ON, 3) == EXIT_SUCCESS);
+  CHECK (calendar.length == 0);
+
+  // Nothing is skipped out of the years covered, even on the same day of the year
+  CHECK (exception_calendar_add (&calendar, "2027-12-31", TABLE_ON, 0) == EXIT_SUCCESS);
+  CHECK (exception_calendar_skips (&calendar, TABLE_ON, 1, YEAR (2027), 364));
+  CHECK (!exception_calendar_skips (&calendar, TABLE_ON, 1, YEAR (2025), 364));
+  CHECK (!exception_calendar_skips (&calendar, TABLE_ON, 1, YEAR (2028), 364));
+  CHECK (!exception_calendar_skips (&calendar, TABLE_ON, 1, YEAR (2028), 0));
+
+  CHECK (exception_calendar_add (&calendar, "2026-13-01", TABLE_ON, 0) == EXIT_FAILURE);
+  CHECK (exception_calendar_add (&calendar, "holidays", TABLE_ON, 0) == EXIT_FAILURE);
+
+  exception_calendar_free (&calendar);
+}
+
+int main (void)
+{
+  test_leap_year ();
+  test_scopes ();
+  test_out_of_range ();
+
+  return check_result ();
+}
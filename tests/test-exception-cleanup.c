@@ -0,0 +1,171 @@
+/* test-exception-cleanup.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * The exception dates of a single rule are deleted with it: by a rule
+ * delete, by the import (which replaces all the rules) and, for the ones left
+ * before schema version 7, by the migration
+ *
+ * Argument: the schema of the database (src/database.sql)
+ */
+
+#define ALLOW_MANAGING_RULES
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sqlite3.h>
+
+#include "test-utils.h"
+#include "test-database.h"
+#include "../src/database-connection/database-connection.h"
+#include "../src/gawake-cli/import-export.h"
+
+#define IMPORT_PATH DB_DIR "import.jsonl"
+
+// Exception dates of rule_id (0: of all the rules) on table; -1 on error
+static int count_exceptions (GawakeDb *db, Table table, int64_t rule_id)
+{
+  ExceptionDate *dates;
+  size_t length;
+  int count = 0;
+
+  if (exception_get_dates (db, "", &dates, &length))
+    return -1;
+
+  for (size_t i = 0; i < length; i++)
+    {
+      if (dates[i].rule_id == rule_id && (rule_id == 0 || dates[i].table == table))
+        count++;
+    }
+
+  free (dates);
+  return count;
+}
+
+static int add_exception (GawakeDb *db, const char *date, Table table, int64_t rule_id)
+{
+  size_t added;
+
+  return exception_add_dates (db, &date, 1, table, rule_id, &added);
+}
+
+static int write_import_file (void)
+{
+  FILE *file = fopen (IMPORT_PATH, "w");
+
+  if (file == NULL)
+    return EXIT_FAILURE;
+
+  fputs ("{\"record\":\"rule\",\"table\":\"on\",\"name\":\"Day\",\"time\":\"07:00\","\
+         "\"days\":\"1111111\",\"active\":true}\n", file);
+
+  return fclose (file) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// Back to schema version 6, with an exception left by a deleted rule
+static int downgrade_with_orphan (void)
+{
+  sqlite3 *connection;
+  int rc;
+
+  rc = sqlite3_open_v2 (DB_PATH, &connection, SQLITE_OPEN_READWRITE, NULL);
+  if (rc == SQLITE_OK)
+    rc = sqlite3_exec (connection,
+                       "DROP INDEX exception_dates_rule;"
+                       "INSERT INTO exception_dates (date, rule_table, rule_id) "
+                       "VALUES ('2026-12-31', 1, 99);"
+                       "PRAGMA user_version = 6;", NULL, NULL, NULL);
+  sqlite3_close (connection);
+
+  return (rc == SQLITE_OK) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main (int argc, char *argv[])
+{
+  GawakeDb *db;
+  Rule on = {
+    .name = "Morning",
+    .hour = 7,
+    .days = { true, true, true, true, true, true, true },
+    .active = true,
+    .table = TABLE_ON,
+  };
+  Rule off = {
+    .name = "Night",
+    .hour = 22,
+    .days = { true, true, true, true, true, true, true },
+    .active = true,
+    .mode = MODE_OFF,
+    .table = TABLE_OFF,
+  };
+
+  if (argc < 2 || test_database_create (argv[1]) || write_import_file ())
+    return EXIT_FAILURE;
+
+  db = gawake_db_open (false);
+  if (db == NULL)
+    return EXIT_FAILURE;
+
+  // Turn on rules 1 and 2, turn off rule 1
+  CHECK (rule_add (db, &on) == EXIT_SUCCESS);
+  CHECK (rule_add (db, &on) == EXIT_SUCCESS);
+  CHECK (rule_add (db, &off) == EXIT_SUCCESS);
+
+  CHECK (add_exception (db, "2026-12-25", TABLE_ON, 0) == EXIT_SUCCESS);
+  CHECK (add_exception (db, "2026-12-24", TABLE_ON, 1) == EXIT_SUCCESS);
+  CHECK (add_exception (db, "2026-12-24", TABLE_ON, 2) == EXIT_SUCCESS);
+  CHECK (add_exception (db, "2026-12-24", TABLE_OFF, 1) == EXIT_SUCCESS);
+
+  // Only the ones of the deleted rule, not the ones of the same id on the other table
+  CHECK (rule_delete (db, 1, TABLE_ON) == EXIT_SUCCESS);
+  CHECK (count_exceptions (db, TABLE_ON, 1) == 0);
+  CHECK (count_exceptions (db, TABLE_ON, 2) == 1);
+  CHECK (count_exceptions (db, TABLE_OFF, 1) == 1);
+  CHECK (count_exceptions (db, TABLE_ON, 0) == 1);
+
+  // A failed delete keeps them
+  CHECK (rule_delete (db, 5, TABLE_ON) != EXIT_SUCCESS);
+  CHECK (count_exceptions (db, TABLE_ON, 2) == 1);
+
+  // The import gives new ids to the rules: the dates of all the rules are kept
+  CHECK (import_database (db, IMPORT_PATH) == EXIT_SUCCESS);
+  CHECK (count_exceptions (db, TABLE_ON, 2) == 0);
+  CHECK (count_exceptions (db, TABLE_OFF, 1) == 0);
+  CHECK (count_exceptions (db, TABLE_ON, 0) == 1);
+
+  CHECK (add_exception (db, "2026-12-24", TABLE_ON, 3) == EXIT_SUCCESS);
+  gawake_db_close (db);
+
+  // The migration deletes the ones already left behind
+  CHECK (downgrade_with_orphan () == EXIT_SUCCESS);
+  db = gawake_db_open (false);
+  if (db == NULL)
+    return EXIT_FAILURE;
+
+  CHECK (count_exceptions (db, TABLE_OFF, 99) == 0);
+  CHECK (count_exceptions (db, TABLE_ON, 3) == 1);
+  CHECK (count_exceptions (db, TABLE_ON, 0) == 1);
+  CHECK (rule_delete (db, 3, TABLE_ON) == EXIT_SUCCESS);
+  CHECK (count_exceptions (db, TABLE_ON, 3) == 0);
+
+  gawake_db_close (db);
+
+  return check_result ();
+}
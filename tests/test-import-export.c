@@ -0,0 +1,203 @@
+/* test-import-export.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * An export imported and exported again gives the same file, as JSON Lines
+ * and as CSV, with names that need escaping; an import with an invalid record
+ * changes nothing, even the records before it, and reports its line
+ *
+ * Argument: the schema of the database (src/database.sql)
+ */
+
+#define ALLOW_MANAGING_RULES
+#define ALLOW_MANAGING_CONFIGURATION
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "test-utils.h"
+#include "test-database.h"
+#include "../src/database-connection/database-connection.h"
+#include "../src/gawake-cli/import-export.h"
+
+#define FIRST_JSON DB_DIR "first.jsonl"
+#define SECOND_JSON DB_DIR "second.jsonl"
+#define FIRST_CSV DB_DIR "first.csv"
+#define SECOND_CSV DB_DIR "second.csv"
+#define INVALID DB_DIR "invalid.jsonl"
+#define AFTER_INVALID DB_DIR "after-invalid.jsonl"
+#define ERRORS DB_DIR "errors.txt"
+
+// Contents of a file; NULL on failure
+static char *read_all (const char *path)
+{
+  FILE *file = fopen (path, "r");
+  char *content = NULL;
+  size_t length = 0;
+
+  if (file == NULL)
+    return NULL;
+
+  if (getdelim (&content, &length, '\0', file) == -1)
+    {
+      free (content);
+      content = NULL;
+    }
+  fclose (file);
+
+  return content;
+}
+
+static bool same_files (const char *a, const char *b)
+{
+  char *first = read_all (a), *second = read_all (b);
+  bool same = (first != NULL && second != NULL && strcmp (first, second) == 0);
+
+  free (first);
+  free (second);
+
+  return same;
+}
+
+static bool file_has (const char *path, const char *text)
+{
+  char *content = read_all (path);
+  bool found = (content != NULL && strstr (content, text) != NULL);
+
+  free (content);
+
+  return found;
+}
+
+static int write_file (const char *path, const char *content)
+{
+  FILE *file = fopen (path, "w");
+
+  if (file == NULL)
+    return EXIT_FAILURE;
+
+  fputs (content, file);
+
+  return fclose (file) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+static int seed (GawakeDb *db)
+{
+  Rule rules[] = {
+    { .name = "Morning", .hour = 7, .minutes = 5, .days = { false, true, true, true, true, true, false },
+      .active = true, .table = TABLE_ON },
+    { .name = "Weekend, late", .hour = 10, .days = { true, false, false, false, false, false, true },
+      .active = false, .table = TABLE_ON },
+    { .name = "Say \"night\"", .hour = 23, .minutes = 59, .days = { true, true, true, true, true, true, true },
+      .active = true, .mode = MODE_MEM, .table = TABLE_OFF },
+    { .name = "C:\\backup", .hour = 0, .minutes = 0, .days = { false, false, false, false, false, true, false },
+      .active = true, .mode = MODE_DISK, .table = TABLE_OFF },
+    { .name = " spaced", .hour = 12, .minutes = 30, .days = { false, false, true, false, false, false, false },
+      .active = false, .mode = MODE_OFF, .table = TABLE_OFF },
+  };
+
+  for (size_t i = 0; i < sizeof (rules) / sizeof (rules[0]); i++)
+    {
+      if (rule_add (db, &rules[i]))
+        return EXIT_FAILURE;
+    }
+
+  if (configuration_set_localtime (db, false)
+      || configuration_set_default_mode (db, MODE_DISK)
+      || configuration_set_notification_time (db, 12)
+      || configuration_set_shutdown_fail (db, true))
+    return EXIT_FAILURE;
+
+  return rule_custom_schedule (db, 9, 45, 15, 1, 2030, MODE_MEM);
+}
+
+// Run the import with its errors written to ERRORS
+static int import_with_errors (GawakeDb *db, const char *path)
+{
+  int saved = dup (STDERR_FILENO), errors, ret;
+
+  errors = open (ERRORS, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+  if (saved == -1 || errors == -1)
+    return EXIT_FAILURE;
+
+  fflush (stderr);
+  dup2 (errors, STDERR_FILENO);
+  ret = import_database (db, path);
+  fflush (stderr);
+  dup2 (saved, STDERR_FILENO);
+  close (errors);
+  close (saved);
+
+  return ret;
+}
+
+int main (int argc, char *argv[])
+{
+  GawakeDb *db;
+
+  if (argc < 2 || test_database_create (argv[1]))
+    return EXIT_FAILURE;
+
+  db = gawake_db_open (false);
+  if (db == NULL)
+    return EXIT_FAILURE;
+
+  CHECK (seed (db) == EXIT_SUCCESS);
+
+  // Round trips; the ids change, but they aren't exported
+  CHECK (export_database (db, FIRST_JSON) == EXIT_SUCCESS);
+  CHECK (import_database (db, FIRST_JSON) == EXIT_SUCCESS);
+  CHECK (export_database (db, SECOND_JSON) == EXIT_SUCCESS);
+  CHECK (same_files (FIRST_JSON, SECOND_JSON));
+  CHECK (file_has (FIRST_JSON, "\"name\":\"Say \\\"night\\\"\""));
+  CHECK (file_has (FIRST_JSON, "\"name\":\"C:\\\\backup\""));
+
+  CHECK (export_database (db, FIRST_CSV) == EXIT_SUCCESS);
+  CHECK (import_database (db, FIRST_CSV) == EXIT_SUCCESS);
+  CHECK (export_database (db, SECOND_CSV) == EXIT_SUCCESS);
+  CHECK (same_files (FIRST_CSV, SECOND_CSV));
+  CHECK (file_has (FIRST_CSV, "\"Weekend, late\""));
+  CHECK (file_has (FIRST_CSV, "\"Say \"\"night\"\"\""));
+
+  // The CSV import gives back the database of the JSON Lines one
+  CHECK (export_database (db, SECOND_JSON) == EXIT_SUCCESS);
+  CHECK (same_files (FIRST_JSON, SECOND_JSON));
+
+  // Line 4 is invalid: the configuration and the rules before it aren't kept
+  CHECK (write_file (INVALID,
+                     "{\"record\":\"config\",\"notification_time\":42}\n"
+                     "{\"record\":\"rule\",\"table\":\"on\",\"name\":\"New\",\"time\":\"06:00\",\"days\":\"1111111\"}\n"
+                     "\n"
+                     "{\"record\":\"rule\",\"table\":\"on\",\"name\":\"Bad\",\"time\":\"24:00\",\"days\":\"1111111\"}\n"
+                     "{\"record\":\"rule\",\"table\":\"on\",\"name\":\"After\",\"time\":\"06:30\",\"days\":\"1111111\"}\n")
+         == EXIT_SUCCESS);
+  CHECK (import_with_errors (db, INVALID) == EXIT_FAILURE);
+  CHECK (file_has (ERRORS, "line 4:"));
+
+  CHECK (export_database (db, AFTER_INVALID) == EXIT_SUCCESS);
+  CHECK (same_files (FIRST_JSON, AFTER_INVALID));
+
+  gawake_db_close (db);
+
+  return check_result ();
+}
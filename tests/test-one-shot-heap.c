@@ -0,0 +1,142 @@
+/* test-one-shot-heap.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * The one-shot wake ups come out of the heap in time order, whatever the
+ * order they were pushed in; on the same time, by id. The prune removes the
+ * ones up to "now", including the ones on "now" itself
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "test-utils.h"
+#include "../src/gawaked/one-shot-heap.h"
+
+#define RANDOM_ENTRIES 1000
+
+static void test_order (void)
+{
+  OneShotHeap heap;
+  const OneShotEntry *entry;
+  // Out of order, with ties on the time pushed in both id orders
+  static const OneShotEntry pushed[] = {
+    { .time = 500, .id = 1 },
+    { .time = 100, .id = 9 },
+    { .time = 300, .id = 4 },
+    { .time = 100, .id = 2 },
+    { .time = 700, .id = 3 },
+    { .time = 300, .id = 8 },
+    { .time = 200, .id = 5 },
+    { .time = 100, .id = 6 },
+  };
+  static const int64_t expected_ids[] = { 2, 6, 9, 5, 4, 8, 1, 3 };
+  size_t count = sizeof (pushed) / sizeof (pushed[0]);
+
+  one_shot_heap_init (&heap);
+  CHECK (one_shot_heap_peek (&heap) == NULL);
+
+  for (size_t i = 0; i < count; i++)
+    CHECK (one_shot_heap_push (&heap, pushed[i].id, pushed[i].time) == EXIT_SUCCESS);
+  CHECK (heap.length == count);
+
+  for (size_t i = 0; i < count; i++)
+    {
+      entry = one_shot_heap_peek (&heap);
+      if (!CHECK (entry != NULL))
+        break;
+      CHECK (entry->id == expected_ids[i]);
+      one_shot_heap_pop (&heap);
+    }
+
+  CHECK (one_shot_heap_peek (&heap) == NULL);
+  // Popping an empty heap does nothing
+  one_shot_heap_pop (&heap);
+  CHECK (heap.length == 0);
+
+  one_shot_heap_free (&heap);
+}
+
+static void test_random (void)
+{
+  OneShotHeap heap;
+  const OneShotEntry *entry;
+  OneShotEntry last = { .time = -1, .id = -1 };
+  bool ordered = true;
+
+  one_shot_heap_init (&heap);
+
+  srand (1);
+  for (int i = 0; i < RANDOM_ENTRIES; i++)
+    CHECK (one_shot_heap_push (&heap, i + 1, rand () % 100) == EXIT_SUCCESS);
+
+  while ((entry = one_shot_heap_peek (&heap)) != NULL)
+    {
+      if (entry->time < last.time || (entry->time == last.time && entry->id < last.id))
+        ordered = false;
+      last = *entry;
+      one_shot_heap_pop (&heap);
+    }
+  CHECK (ordered);
+
+  one_shot_heap_free (&heap);
+}
+
+static void test_prune (void)
+{
+  OneShotHeap heap;
+  const OneShotEntry *entry;
+
+  one_shot_heap_init (&heap);
+  CHECK (one_shot_heap_prune (&heap, 1000) == 0);
+
+  CHECK (one_shot_heap_push (&heap, 1, 300) == EXIT_SUCCESS);
+  CHECK (one_shot_heap_push (&heap, 2, 100) == EXIT_SUCCESS);
+  CHECK (one_shot_heap_push (&heap, 3, 200) == EXIT_SUCCESS);
+  CHECK (one_shot_heap_push (&heap, 4, 200) == EXIT_SUCCESS);
+  CHECK (one_shot_heap_push (&heap, 5, 201) == EXIT_SUCCESS);
+
+  CHECK (one_shot_heap_prune (&heap, 99) == 0);
+  CHECK (heap.length == 5);
+
+  // The ones on "now" itself have expired; the next second hasn't
+  CHECK (one_shot_heap_prune (&heap, 200) == 3);
+  entry = one_shot_heap_peek (&heap);
+  CHECK (entry != NULL && entry->id == 5 && entry->time == 201);
+
+  CHECK (one_shot_heap_prune (&heap, 300) == 2);
+  CHECK (one_shot_heap_peek (&heap) == NULL);
+
+  // The memory is kept for the next ones
+  CHECK (one_shot_heap_push (&heap, 6, 400) == EXIT_SUCCESS);
+  one_shot_heap_reset (&heap);
+  CHECK (one_shot_heap_peek (&heap) == NULL && heap.allocated > 0);
+
+  one_shot_heap_free (&heap);
+}
+
+int main (void)
+{
+  test_order ();
+  test_random ();
+  test_prune ();
+
+  return check_result ();
+}
@@ -0,0 +1,91 @@
+/* test-query-plans.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Query plans of the scheduler statements on the current schema: the rules,
+ * one-shots and exception dates are read from their indexes, without a full
+ * table scan nor a temporary b-tree for the order
+ *
+ * Argument: the schema of the database (src/database.sql)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test-utils.h"
+#include "test-database.h"
+#include "../src/database-connection/database-connection.h"
+#include "../src/gawaked/scheduler-database.h"
+
+// Check that each step of the plan of the statement uses "index"
+static void check_plan (SchedulerStatement statement, const char *index)
+{
+  sqlite3_stmt *stmt = scheduler_database_statement (statement), *explain;
+  char *sql;
+  int steps = 0;
+
+  if (!CHECK (stmt != NULL))
+    return;
+
+  sql = sqlite3_mprintf ("EXPLAIN QUERY PLAN %s", sqlite3_sql (stmt));
+  if (!CHECK (sql != NULL))
+    return;
+
+  if (CHECK (sqlite3_prepare_v2 (scheduler_database_get (), sql, -1, &explain, NULL) == SQLITE_OK))
+    {
+      while (sqlite3_step (explain) == SQLITE_ROW)
+        {
+          const char *detail = (const char *) sqlite3_column_text (explain, 3);
+          bool indexed = detail != NULL
+            && strncmp (detail, "SEARCH ", 7) == 0
+            && (strstr (detail, "USING COVERING INDEX ") != NULL
+                || strstr (detail, "USING INDEX ") != NULL)
+            && strstr (detail, index) != NULL;
+
+          if (!CHECK (indexed))
+            fprintf (stderr, "Plan of \"%s\": %s\n", sqlite3_sql (stmt), detail);
+          steps++;
+        }
+      sqlite3_finalize (explain);
+    }
+
+  CHECK (steps == 1);
+  sqlite3_free (sql);
+}
+
+int main (int argc, char *argv[])
+{
+  if (argc < 2 || test_database_create (argv[1]))
+    return EXIT_FAILURE;
+
+  if (!CHECK (scheduler_database_open () == EXIT_SUCCESS))
+    return check_result ();
+
+  check_plan (STATEMENT_RULES_ON, "rules_turnon_schedule (active=?)");
+  check_plan (STATEMENT_RULES_OFF, "rules_turnoff_schedule (active=?)");
+  check_plan (STATEMENT_ONE_SHOTS, "one_shot_schedule_time (wake_time>?)");
+  // The UNIQUE (date, rule_table, rule_id) constraint
+  check_plan (STATEMENT_EXCEPTIONS, "sqlite_autoindex_exception_dates_1 (date>? AND date<?)");
+
+  scheduler_database_close ();
+
+  return check_result ();
+}
@@ -0,0 +1,159 @@
+/* test-rule-set.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * The rules of a table loaded into a RuleSet: ids that don't fit in 16 or 32
+ * bits, the walk over the active flags across their 64-bit words, and the
+ * names loaded by a second query, after rules were deleted and added
+ *
+ * Argument: the schema of the database (src/database.sql)
+ */
+
+#define ALLOW_MANAGING_RULES
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test-utils.h"
+#include "test-database.h"
+#include "../src/database-connection/database-connection.h"
+
+#define RULES 200
+#define BIG_ID INT64_C (4294967301)   // 2^32 + 5
+
+// Indexes of the active rules: the edges of the words of flags
+static const size_t ACTIVE[] = { 0, 63, 64, 127, 128, 191, 199 };
+
+static bool name_is (const RuleSet *set, int64_t id, const char *expected)
+{
+  size_t i = rule_set_find (set, id);
+  const char *name;
+
+  if (i == set->length)
+    return false;
+
+  name = rule_set_get_name (set, i);
+  if (expected == NULL)
+    return name == NULL;
+
+  return name != NULL && strcmp (name, expected) == 0;
+}
+
+int main (int argc, char *argv[])
+{
+  GawakeDb *db;
+  RuleSet set;
+  Rule rules[RULES];
+  int64_t inactive[RULES];
+  size_t inactive_length = 0, found = 0, i;
+
+  if (argc < 2 || test_database_create (argv[1]))
+    return EXIT_FAILURE;
+
+  db = gawake_db_open (false);
+  if (db == NULL)
+    return EXIT_FAILURE;
+
+  // Ids 1 to RULES, then two that don't fit in 16 and 32 bits
+  for (i = 0; i < RULES; i++)
+    {
+      rules[i] = (Rule) {
+        .hour = 22,
+        .days = { true, true, true, true, true, true, true },
+        .active = true,
+        .mode = MODE_OFF,
+        .table = TABLE_OFF,
+      };
+      snprintf (rules[i].name, RULE_NAME_LENGTH, "Rule %zu", i + 1);
+    }
+  CHECK (rule_add_many (db, rules, RULES) == EXIT_SUCCESS);
+  CHECK (sqlite3_exec (gawake_db_get_connection (db),
+                       "INSERT INTO rules_turnoff (id, rule_name, minute, days_mask, active, mode) "
+                       "VALUES (70000, 'Wide', 0, 127, 0, 2), (4294967301, 'Big', 1439, 64, 1, 1);",
+                       NULL, NULL, NULL) == SQLITE_OK);
+
+  for (i = 0; i < RULES; i++)
+    {
+      bool active = false;
+
+      for (size_t a = 0; a < sizeof (ACTIVE) / sizeof (ACTIVE[0]); a++)
+        active = active || (ACTIVE[a] == i);
+      if (!active)
+        inactive[inactive_length++] = (int64_t) i + 1;
+    }
+  CHECK (rule_set_active_many (db, inactive, inactive_length, TABLE_OFF, false) == EXIT_SUCCESS);
+
+  rule_set_init (&set);
+  CHECK (rule_set_load (db, TABLE_OFF, &set) == EXIT_SUCCESS);
+  CHECK (set.length == RULES + 2);
+
+  // Found by the whole id, not a truncated one (70000 % 65536 = 4464)
+  CHECK (rule_set_find (&set, 70000) == RULES);
+  CHECK (rule_set_find (&set, BIG_ID) == RULES + 1);
+  CHECK (rule_set_find (&set, 4464) == set.length);
+  CHECK (rule_set_find (&set, RULES + 1) == set.length);
+  CHECK (set.ids[RULES + 1] == BIG_ID && set.minutes[RULES + 1] == 1439);
+  CHECK (set.days_masks[RULES + 1] == 64 && set.modes[RULES + 1] == MODE_DISK);
+
+  // Only the active ones, in order, across the words
+  for (i = rule_set_next_active (&set, 0); i < set.length; i = rule_set_next_active (&set, i + 1))
+    {
+      if (found < sizeof (ACTIVE) / sizeof (ACTIVE[0]))
+        CHECK (i == ACTIVE[found]);
+      else
+        CHECK (i == RULES + 1);
+      found++;
+    }
+  CHECK (found == sizeof (ACTIVE) / sizeof (ACTIVE[0]) + 1);
+  CHECK (rule_set_next_active (&set, 65) == 127);
+  CHECK (rule_set_next_active (&set, 192) == 199);
+  CHECK (rule_set_next_active (&set, set.length) == set.length);
+
+  // The names are only read when asked for
+  CHECK (rule_set_get_name (&set, 0) == NULL);
+
+  // Rules deleted and added between the two queries
+  CHECK (rule_delete (db, 2, TABLE_OFF) == EXIT_SUCCESS);
+  CHECK (rule_delete (db, 70000, TABLE_OFF) == EXIT_SUCCESS);
+  CHECK (rule_add (db, &rules[0]) == EXIT_SUCCESS);
+
+  CHECK (rule_set_load_names (db, &set) == EXIT_SUCCESS);
+  CHECK (set.length == RULES + 2);
+  CHECK (name_is (&set, 1, "Rule 1"));
+  CHECK (name_is (&set, 2, NULL));
+  CHECK (name_is (&set, 3, "Rule 3"));
+  CHECK (name_is (&set, RULES, "Rule 200"));
+  CHECK (name_is (&set, 70000, NULL));
+  CHECK (name_is (&set, BIG_ID, "Big"));
+  CHECK (rule_set_find (&set, BIG_ID + 1) == set.length);
+
+  // Loaded again: the current rules
+  CHECK (rule_set_load (db, TABLE_OFF, &set) == EXIT_SUCCESS);
+  CHECK (rule_set_load_names (db, &set) == EXIT_SUCCESS);
+  CHECK (set.length == RULES + 1);
+  CHECK (name_is (&set, BIG_ID + 1, "Rule 1"));
+  CHECK (rule_set_find (&set, 2) == set.length);
+
+  rule_set_free (&set);
+  gawake_db_close (db);
+
+  return check_result ();
+}
@@ -0,0 +1,262 @@
+/* test-scheduler-clock.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * The scheduler main loop on a virtual clock, with a turn off rule at 22:00
+ * and a turn on rule at 07:00, every day (notification: 5 min before); the
+ * test tells when the virtual timer expires, and when the wall clock was set
+ * (ECANCELED). After each step, the deadline the scheduler arms again is
+ * checked:
+ * - the clock steps forward, past the rule: the rule of the next day;
+ * - the clock steps backward: the rule of the same day again;
+ * - the time zone changes (LOCALTIME_PATH is replaced): the same rule, at
+ *   22:00 on the new time zone;
+ * - the notification deadline expires, and then the rule one: the scheduler
+ *   returns the wake up at 07:00 of the next day.
+ * The timer must be armed again within REARM_BOUND_MS of each step, i.e. of
+ * the event that interrupts the wait (the handlers only re-plan the
+ * deadline); the time zone step waits for the file monitor, so it isn't
+ * bounded.
+ *
+ * Argument: the schema of the database (src/database.sql)
+ */
+
+#define ALLOW_MANAGING_RULES
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <glib.h>
+
+#include "test-utils.h"
+#include "test-database.h"
+#include "virtual-clock.h"
+#include "../src/database-connection/database-connection.h"
+#include "../src/gawaked/scheduler.h"
+
+#define NOTIFICATION_TIME (5 * 60)    // config of the schema, in seconds
+#define STEP_TIMEOUT_MS 5000
+#define REARM_BOUND_MS 50
+
+typedef enum {
+  STEP_STARTED,
+  STEP_FORWARD,
+  STEP_BACKWARD,
+  STEP_TIME_ZONE,
+  STEP_NOTIFICATION,
+  STEP_OFF_RULE
+} Step;
+
+static const char *STEP[] = {
+  "started", "clock stepped forward", "clock stepped backward",
+  "time zone changed", "notification", "turn off rule",
+};
+
+static Step step = STEP_STARTED;
+static int step_arms = 0;
+static struct timespec step_started;
+
+// Replace the watched /etc/localtime, as timedatectl does; TZ tells the new
+// time zone
+static void change_time_zone (const char *time_zone)
+{
+  FILE *file = fopen (LOCALTIME_PATH ".new", "w");
+
+  setenv ("TZ", time_zone, 1);
+  tzset ();
+
+  if (file == NULL)
+    {
+      perror ("ERROR: Couldn't write the time zone");
+      return;
+    }
+  fprintf (file, "%s\n", time_zone);
+  fclose (file);
+
+  if (rename (LOCALTIME_PATH ".new", LOCALTIME_PATH) == -1)
+    perror ("ERROR: Couldn't replace the time zone");
+}
+
+// Deadline the scheduler must arm after the step
+static time_t expected_deadline (void)
+{
+  switch (step)
+    {
+    case STEP_STARTED:
+    case STEP_BACKWARD:
+    case STEP_TIME_ZONE:
+      return virtual_clock_local_time (0, 22, 0) - NOTIFICATION_TIME;
+
+    case STEP_FORWARD:
+      return virtual_clock_local_time (1, 22, 0) - NOTIFICATION_TIME;
+
+    case STEP_NOTIFICATION:
+      return virtual_clock_local_time (0, 22, 0);
+
+    case STEP_OFF_RULE:
+    default:
+      return (time_t) -1;
+    }
+}
+
+static void next_step (void)
+{
+  step++;
+  step_arms = virtual_timer_arms ();
+  clock_gettime (CLOCK_MONOTONIC, &step_started);
+
+  switch (step)
+    {
+    case STEP_FORWARD:
+      // Monday, 23:00: today's rule was missed
+      virtual_clock_set (virtual_clock_local_time (0, 23, 0));
+      break;
+
+    case STEP_BACKWARD:
+      // Monday, 08:00
+      virtual_clock_set (virtual_clock_local_time (0, 8, 0));
+      break;
+
+    case STEP_TIME_ZONE:
+      // Three hours ahead of UTC: Monday, 11:00
+      change_time_zone ("UTC-3");
+      break;
+
+    case STEP_NOTIFICATION:
+    case STEP_OFF_RULE:
+      virtual_timer_expire ();
+      break;
+
+    case STEP_STARTED:
+    default:
+      break;
+    }
+}
+
+/*
+ * Run on the main loop of the scheduler: once the timer was armed again after
+ * the step, check the deadline and take the next step; the turn off rule
+ * ends the loop
+ */
+static gboolean drive (gpointer user_data)
+{
+  time_t armed;
+  double latency_ms;
+
+  if (step == STEP_OFF_RULE)
+    return G_SOURCE_REMOVE;
+
+  if (virtual_timer_arms () == step_arms)
+    {
+      if (elapsed_ms (&step_started) < STEP_TIMEOUT_MS)
+        return G_SOURCE_CONTINUE;
+
+      fprintf (stderr, "ERROR: The timer wasn't armed again after: %s\n", STEP[step]);
+      CHECK (false);
+      exit (check_result ());
+    }
+
+  armed = virtual_timer_armed ();
+  latency_ms = virtual_timer_armed_after (&step_started);
+  printf ("%-24s armed at %.24s, %.3f ms after the step\n", STEP[step], ctime (&armed), latency_ms);
+  if (!CHECK (armed == expected_deadline ()))
+    fprintf (stderr, "\texpected at %s", ctime (&(time_t) { expected_deadline () }));
+  if (step != STEP_STARTED && step != STEP_TIME_ZONE)
+    CHECK (latency_ms < REARM_BOUND_MS);
+
+  next_step ();
+  return G_SOURCE_CONTINUE;
+}
+
+static int add_rules (void)
+{
+  GawakeDb *db;
+  Rule off = {
+    .name = "Night",
+    .hour = 22,
+    .days = { true, true, true, true, true, true, true },
+    .active = true,
+    .mode = MODE_MEM,
+    .table = TABLE_OFF,
+  };
+  Rule on = {
+    .name = "Morning",
+    .hour = 7,
+    .days = { true, true, true, true, true, true, true },
+    .active = true,
+    .mode = MODE_MEM,
+    .table = TABLE_ON,
+  };
+  int ret;
+
+  db = gawake_db_open (false);
+  if (db == NULL)
+    return EXIT_FAILURE;
+
+  ret = rule_add (db, &off) || rule_add (db, &on);
+  gawake_db_close (db);
+
+  return ret ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+int main (int argc, char *argv[])
+{
+  RtcwakeArgs rtcwake_args;
+  bool terminate;
+  struct tm start = {
+    .tm_year = 2030 - 1900,
+    .tm_mon = 0,
+    .tm_mday = 7,     // Monday
+    .tm_hour = 10,
+  };
+
+  setenv ("TZ", "UTC0", 1);
+  tzset ();
+
+  if (argc < 2 || test_database_create (argv[1]) || add_rules ())
+    return EXIT_FAILURE;
+
+  // The time zone the scheduler watches
+  change_time_zone ("UTC0");
+
+  virtual_clock_install (timegm (&start));
+
+  if (scheduler_init (&rtcwake_args))
+    return EXIT_FAILURE;
+
+  step_arms = virtual_timer_arms ();
+  clock_gettime (CLOCK_MONOTONIC, &step_started);
+  g_timeout_add (10, drive, NULL);
+
+  CHECK (scheduler_run (&terminate) == EXIT_SUCCESS);
+  scheduler_end ();
+
+  CHECK (step == STEP_OFF_RULE);
+  CHECK (!terminate);
+
+  // Turn on rule: Tuesday, 07:00, on the new time zone
+  CHECK (rtcwake_args.found && !rtcwake_args.run_shutdown);
+  CHECK (rtcwake_args.year == 2030 && rtcwake_args.month == 1 && rtcwake_args.day == 8);
+  CHECK (rtcwake_args.hour == 7 && rtcwake_args.minutes == 0);
+  CHECK (rtcwake_args.mode == MODE_MEM);
+
+  virtual_clock_uninstall ();
+
+  return check_result ();
+}
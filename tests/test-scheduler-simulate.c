@@ -0,0 +1,241 @@
+/* test-scheduler-simulate.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * The simulation of a year (2030, on CET/CEST) with 1k random rules, most of
+ * them inactive: turn off rules in the evening (20:00 to 23:59) and turn on
+ * rules in the morning (06:00 to 09:59), each on random days, plus one of
+ * each every day, and a turn on rule on Sundays at 02:30. So each day has a
+ * single cycle: a turn off at the first active rule of its week day, and a
+ * wake up at the first active turn on rule of the next day. Every line
+ * printed by the simulation is checked against it, and the time it took is
+ * reported.
+ * On the days the clocks change, 02:30 is skipped (31 March: the wake up is
+ * at 03:00, the first minute after the gap) or repeated (27 October).
+ *
+ * Argument: the schema of the database (src/database.sql)
+ */
+
+#define ALLOW_MANAGING_RULES
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <glib.h>
+
+#include "test-utils.h"
+#include "test-database.h"
+#include "../src/database-connection/database-connection.h"
+#include "../src/gawaked/scheduler.h"
+#include "../src/gawaked/week-index.h"
+
+#define RULES 500                 // on each table
+#define DAYS 365
+#define OUTPUT DB_DIR "simulation.txt"
+#define NOTIFICATION_TIME 5       // config of the schema, in minutes
+#define DST_START 89              // day of 2030: 31 March
+#define DST_END 299               // 27 October
+
+static Rule rules[2 * RULES];
+
+// First rule of each week day, as a minute of the day
+static int first_off[7], first_on[7];
+
+// Minutes of the day of the events printed, per day of 2030 (the last wake
+// up is on 2031); -1 if there was none
+static int notifications[DAYS + 1], turn_offs[DAYS + 1], wake_ups[DAYS + 1];
+static int other_events = 0;
+
+static void make_rules (void)
+{
+  srand (1);
+
+  for (int d = 0; d < 7; d++)
+    first_off[d] = first_on[d] = MINUTES_PER_DAY;
+
+  for (int i = 0; i < 2 * RULES; i++)
+    {
+      Rule *rule = &rules[i];
+      bool off = i < RULES, every_day = (i % RULES) == 0;
+      int mask = every_day ? 127 : 1 + rand () % 127;
+
+      snprintf (rule->name, RULE_NAME_LENGTH, "Rule %d", i + 1);
+      rule->hour = every_day ? (off ? 23 : 9) : (off ? 20 : 6) + rand () % 4;
+      rule->minutes = every_day ? 59 : rand () % 60;
+      rule->active = every_day || rand () % 8 == 0;
+      rule->mode = rand () % MODE_LAST;
+      rule->table = off ? TABLE_OFF : TABLE_ON;
+
+      if (i == RULES + 1)
+        {
+          // Sundays, 02:30
+          mask = 1;
+          rule->hour = 2;
+          rule->minutes = 30;
+          rule->active = true;
+        }
+
+      for (int d = 0; d < 7; d++)
+        {
+          int *first = off ? &first_off[d] : &first_on[d];
+
+          rule->days[d] = mask & (1 << d);
+          if (rule->days[d] && rule->active && rule->hour * 60 + rule->minutes < *first)
+            *first = rule->hour * 60 + rule->minutes;
+        }
+    }
+}
+
+// Read the lines printed by the simulation; returns the turn offs of its
+// summary, or -1
+static long read_output (void)
+{
+  FILE *file = fopen (OUTPUT, "r");
+  char line[256];
+  long summary = -1;
+
+  if (file == NULL)
+    return -1;
+
+  for (int i = 0; i <= DAYS; i++)
+    notifications[i] = turn_offs[i] = wake_ups[i] = -1;
+
+  while (fgets (line, sizeof (line), file) != NULL)
+    {
+      struct tm date = { 0 };
+      int hour, minutes, day;
+      unsigned long deadlines, turn_off_count;
+
+      if (sscanf (line, "Simulated %lu deadlines (%lu turn offs)", &deadlines, &turn_off_count) == 2)
+        {
+          summary = (long) turn_off_count;
+          continue;
+        }
+
+      // "YYYY-MM-DD HH:MM  event  ..."
+      if (sscanf (line, "%d-%d-%d %d:%d", &date.tm_year, &date.tm_mon, &date.tm_mday, &hour, &minutes) != 5
+          || strlen (line) < 18)
+        {
+          other_events++;
+          continue;
+        }
+
+      date.tm_year -= 1900;
+      date.tm_mon--;
+      day = (int) ((timegm (&date) - timegm (&(struct tm) { .tm_year = 130, .tm_mday = 1 })) / 86400);
+      if (day < 0 || day > DAYS)
+        {
+          other_events++;
+          continue;
+        }
+
+      if (strncmp (line + 18, "notification ", 13) == 0 && notifications[day] == -1)
+        notifications[day] = hour * 60 + minutes;
+      else if (strncmp (line + 18, "turn off ", 9) == 0 && turn_offs[day] == -1)
+        turn_offs[day] = hour * 60 + minutes;
+      else if (strncmp (line + 18, "wake up ", 8) == 0 && wake_ups[day] == -1)
+        wake_ups[day] = hour * 60 + minutes;
+      else
+        other_events++;
+    }
+
+  fclose (file);
+  return summary;
+}
+
+// The notification and turn off of a day of 2030, and the wake up on the next
+// day
+static bool check_day (int day)
+{
+  // 1 January 2030 is a Tuesday
+  int week_day = (2 + day) % 7;
+  int wake_up = (day + 1 == DST_START) ? 3 * 60 : first_on[(week_day + 1) % 7];
+  bool ok = turn_offs[day] == first_off[week_day]
+    && notifications[day] == first_off[week_day] - NOTIFICATION_TIME
+    && wake_ups[day + 1] == wake_up;
+
+  if (!ok)
+    fprintf (stderr, "Day %d: notification %d, turn off %d (expected %d), wake up %d (expected %d)\n",
+             day, notifications[day], turn_offs[day], first_off[week_day],
+             wake_ups[day + 1], wake_up);
+
+  return ok;
+}
+
+int main (int argc, char *argv[])
+{
+  GawakeDb *db;
+  struct tm from = { .tm_year = 130, .tm_mday = 1, .tm_isdst = -1 };
+  struct tm to = { .tm_year = 131, .tm_mday = 1, .tm_isdst = -1 };
+  struct timespec start;
+  double simulation_ms;
+  int saved, output, ret, days_ok = 0;
+
+  setenv ("TZ", "CET-1CEST,M3.5.0,M10.5.0/3", 1);
+  tzset ();
+
+  if (argc < 2 || test_database_create (argv[1]))
+    return EXIT_FAILURE;
+
+  db = gawake_db_open (false);
+  if (db == NULL)
+    return EXIT_FAILURE;
+
+  make_rules ();
+  ret = rule_add_many (db, rules, 2 * RULES);
+  gawake_db_close (db);
+  if (!CHECK (ret == EXIT_SUCCESS))
+    return check_result ();
+
+  // The simulation prints to stdout
+  saved = dup (STDOUT_FILENO);
+  output = open (OUTPUT, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+  if (saved == -1 || output == -1)
+    return EXIT_FAILURE;
+
+  fflush (stdout);
+  dup2 (output, STDOUT_FILENO);
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  ret = scheduler_simulate (mktime (&from), mktime (&to));
+  simulation_ms = elapsed_ms (&start);
+  fflush (stdout);
+  dup2 (saved, STDOUT_FILENO);
+  close (output);
+  close (saved);
+
+  CHECK (ret == EXIT_SUCCESS);
+  CHECK (read_output () == DAYS);
+  CHECK (other_events == 0);
+
+  for (int day = 0; day < DAYS; day++)
+    days_ok += check_day (day);
+  CHECK (days_ok == DAYS);
+
+  // Days the clocks change: their wake ups come from the day before
+  CHECK (first_on[0] == 2 * 60 + 30);
+  CHECK (check_day (DST_START - 1) && wake_ups[DST_START] == 3 * 60);
+  CHECK (check_day (DST_END - 1) && wake_ups[DST_END] == 2 * 60 + 30);
+
+  printf ("Simulated %d days with %d rules in %.3f ms\n", DAYS, 2 * RULES, simulation_ms);
+
+  return check_result ();
+}
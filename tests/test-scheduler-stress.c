@@ -0,0 +1,289 @@
+/* test-scheduler-stress.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * The scheduler deciding while another process (as gawake-cli does, through
+ * the library) keeps writing to the database: batches, single edits, a
+ * transaction held for a while, and the configuration.
+ *
+ * The scheduler runs on a virtual clock, with a turn off rule at 22:00 and a
+ * turn on rule at 07:00, every day; the rules the writer changes are at 23:xx
+ * and 08:xx, so they never come first. Each cycle, the scheduler loads the
+ * turn off rules, expires at the notification (loading the turn on rules)
+ * and then at the turn off rule, and returns the wake up; the clock then
+ * moves to it, as if the system was suspended until 07:00. A failed decision
+ * (a query that gave up) skips the rule, or doesn't find it: the cycle
+ * doesn't end at 22:00 with the wake up at 07:00 of the next day.
+ *
+ * Argument: the schema of the database (src/database.sql)
+ */
+
+#define ALLOW_MANAGING_RULES
+#define ALLOW_MANAGING_CONFIGURATION
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <glib.h>
+
+#include "test-utils.h"
+#include "test-database.h"
+#include "virtual-clock.h"
+#include "../src/database-connection/database-connection.h"
+#include "../src/gawaked/scheduler.h"
+
+#define CYCLES 200
+#define CHURN_RULES 50            // changed by the writer, on each table
+#define MAX_EXPIRATIONS 8         // in a cycle; 2 if nothing failed
+#define TRANSACTION_HOLD_US 2000
+
+static Rule churn[TABLE_LAST][CHURN_RULES];
+static volatile sig_atomic_t stop = 0;
+
+static int expirations = 0;
+static int handled_arms = 0;
+
+static void on_stop (int signal_number)
+{
+  stop = 1;
+}
+
+/*
+ * WRITER
+ * A separate process, with its own connection; it fails if any of its
+ * writes failed
+ */
+static int write_rules (void)
+{
+  GawakeDb *db;
+  int64_t ids[CHURN_RULES];
+  unsigned long writes = 0, failed = 0;
+  bool active = false;
+  int ret;
+
+  signal (SIGTERM, on_stop);
+
+  db = gawake_db_open (false);
+  if (db == NULL)
+    return EXIT_FAILURE;
+
+  for (int i = 0; i < CHURN_RULES; i++)
+    ids[i] = churn[TABLE_OFF][i].id;
+
+  for (unsigned long operation = 0; !stop; operation++)
+    {
+      Table table = (operation / 4) % 2 ? TABLE_ON : TABLE_OFF;
+      Rule *rule = &churn[table][rand () % CHURN_RULES];
+
+      switch (operation % 4)
+        {
+        case 0:
+          // The ids are the same on both tables
+          ret = rule_set_active_many (db, ids, CHURN_RULES, table, active);
+          active = !active;
+          break;
+
+        case 1:
+          rule->minutes = rand () % 60;
+          rule->active = !rule->active;
+          ret = rule_edit (db, rule);
+          break;
+
+        case 2:
+          // Hold the write lock while the scheduler reads
+          ret = gawake_db_transaction_begin (db);
+          for (int i = 0; i < 5 && ret == EXIT_SUCCESS; i++)
+            ret = rule_enable_disable (db, ids[rand () % CHURN_RULES], table, rand () % 2);
+          usleep (TRANSACTION_HOLD_US);
+          ret = gawake_db_transaction_end (db, ret);
+          break;
+
+        case 3:
+        default:
+          ret = configuration_set_shutdown_fail (db, false);
+          break;
+        }
+
+      writes++;
+      if (ret != EXIT_SUCCESS)
+        failed++;
+    }
+
+  printf ("Writer: %lu writes, %lu failed\n", writes, failed);
+  gawake_db_close (db);
+
+  return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int add_rules (void)
+{
+  GawakeDb *db;
+  Rule rules[2] = {
+    {
+      .name = "Night",
+      .hour = 22,
+      .days = { true, true, true, true, true, true, true },
+      .active = true,
+      .mode = MODE_MEM,
+      .table = TABLE_OFF,
+    },
+    {
+      .name = "Morning",
+      .hour = 7,
+      .days = { true, true, true, true, true, true, true },
+      .active = true,
+      .mode = MODE_MEM,
+      .table = TABLE_ON,
+    },
+  };
+  int ret;
+
+  // On new tables, "Night" and "Morning" get the id 1, and the others the
+  // ids 2 to CHURN_RULES + 1
+  for (int table = TABLE_ON; table < TABLE_LAST; table++)
+    {
+      for (int i = 0; i < CHURN_RULES; i++)
+        {
+          Rule *rule = &churn[table][i];
+
+          snprintf (rule->name, RULE_NAME_LENGTH, "Churn %d", i + 1);
+          rule->id = i + 2;
+          rule->hour = (table == TABLE_OFF) ? 23 : 8;
+          rule->minutes = rand () % 60;
+          for (int d = 0; d < 7; d++)
+            rule->days[d] = true;
+          rule->active = true;
+          rule->mode = MODE_MEM;
+          rule->table = (Table) table;
+        }
+    }
+
+  db = gawake_db_open (false);
+  if (db == NULL)
+    return EXIT_FAILURE;
+
+  ret = rule_add_many (db, rules, 2)
+        || rule_add_many (db, churn[TABLE_ON], CHURN_RULES)
+        || rule_add_many (db, churn[TABLE_OFF], CHURN_RULES);
+  gawake_db_close (db);
+
+  return ret ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/*
+ * Run on the main loop of the scheduler: expire the timer each time it's
+ * armed again
+ */
+static gboolean drive (gpointer user_data)
+{
+  if (virtual_timer_arms () == handled_arms)
+    return G_SOURCE_CONTINUE;
+
+  if (++expirations > MAX_EXPIRATIONS)
+    {
+      fprintf (stderr, "ERROR: The scheduler didn't decide after %d deadlines\n",
+               MAX_EXPIRATIONS);
+      CHECK (false);
+      exit (check_result ());
+    }
+
+  handled_arms = virtual_timer_arms ();
+  virtual_timer_expire ();
+
+  return G_SOURCE_CONTINUE;
+}
+
+int main (int argc, char *argv[])
+{
+  RtcwakeArgs rtcwake_args;
+  struct timespec started;
+  bool terminate;
+  int failed = 0, status;
+  pid_t writer;
+  struct tm start = {
+    .tm_year = 2030 - 1900,
+    .tm_mon = 0,
+    .tm_mday = 7,     // Monday
+    .tm_hour = 10,
+  };
+
+  setenv ("TZ", "UTC0", 1);
+  tzset ();
+  srand (1);
+
+  if (argc < 2 || test_database_create (argv[1]) || add_rules ())
+    return EXIT_FAILURE;
+
+  writer = fork ();
+  if (writer == -1)
+    {
+      perror ("ERROR: Couldn't start the writer");
+      return EXIT_FAILURE;
+    }
+  if (writer == 0)
+    exit (write_rules ());
+
+  virtual_clock_install (timegm (&start));
+
+  if (scheduler_init (&rtcwake_args))
+    {
+      kill (writer, SIGKILL);
+      return EXIT_FAILURE;
+    }
+
+  g_timeout_add (1, drive, NULL);
+  clock_gettime (CLOCK_MONOTONIC, &started);
+
+  for (int cycle = 0; cycle < CYCLES; cycle++)
+    {
+      time_t off_rule = virtual_clock_local_time (0, 22, 0);
+      time_t on_rule = virtual_clock_local_time (1, 7, 0);
+      struct tm wake_up;
+
+      expirations = 0;
+      handled_arms = virtual_timer_arms ();
+
+      CHECK (scheduler_run (&terminate) == EXIT_SUCCESS);
+      localtime_r (&on_rule, &wake_up);
+
+      // Decided at 22:00, for 07:00 of the next day
+      if (!CHECK (virtual_clock_now () == off_rule
+                  && rtcwake_args.found && !rtcwake_args.run_shutdown
+                  && rtcwake_args.day == wake_up.tm_mday
+                  && rtcwake_args.hour == 7 && rtcwake_args.minutes == 0))
+        failed++;
+
+      // Suspended until the wake up
+      virtual_clock_move (on_rule);
+    }
+
+  printf ("%d decisions in %.3f ms, %d failed\n", CYCLES, elapsed_ms (&started), failed);
+
+  scheduler_end ();
+  virtual_clock_uninstall ();
+
+  kill (writer, SIGTERM);
+  CHECK (waitpid (writer, &status, 0) == writer
+         && WIFEXITED (status) && WEXITSTATUS (status) == EXIT_SUCCESS);
+
+  return check_result ();
+}
@@ -0,0 +1,113 @@
+/* test-transaction-changes.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Changes made inside a transaction are notified once, after the commit;
+ * the ones rolled back (the whole transaction, or a nested one) aren't
+ *
+ * Argument: the schema of the database (src/database.sql)
+ */
+
+#define ALLOW_MANAGING_RULES
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "test-utils.h"
+#include "test-database.h"
+#include "../src/database-connection/database-connection.h"
+
+static int notifications = 0;
+static size_t notified_length = 0;
+static int64_t notified_ids[8];
+
+static void on_changes (const DatabaseChange *changes, size_t length)
+{
+  notifications++;
+  notified_length = length;
+  for (size_t i = 0; i < length && i < 8; i++)
+    notified_ids[i] = changes[i].rule.id;
+}
+
+static void reset (void)
+{
+  notifications = 0;
+  notified_length = 0;
+}
+
+int main (int argc, char *argv[])
+{
+  GawakeDb *db;
+  Rule rule = {
+    .name = "Rule",
+    .hour = 22,
+    .days = { true, true, true, true, true, true, true },
+    .active = true,
+    .mode = MODE_OFF,
+    .table = TABLE_OFF,
+  };
+  Rule found;
+
+  if (argc < 2 || test_database_create (argv[1]))
+    return EXIT_FAILURE;
+
+  db = gawake_db_open (false);
+  if (db == NULL)
+    return EXIT_FAILURE;
+  gawake_db_set_change_callback (db, on_changes);
+
+  // Outside a transaction: right away
+  CHECK (rule_add (db, &rule) == EXIT_SUCCESS);
+  CHECK (notifications == 1 && notified_length == 1);
+
+  // Committed: once, after the commit
+  reset ();
+  CHECK (gawake_db_transaction_begin (db) == EXIT_SUCCESS);
+  CHECK (rule_add (db, &rule) == EXIT_SUCCESS);
+  CHECK (rule_enable_disable (db, 1, TABLE_OFF, false) == EXIT_SUCCESS);
+  CHECK (notifications == 0);
+  CHECK (gawake_db_transaction_end (db, EXIT_SUCCESS) == EXIT_SUCCESS);
+  CHECK (notifications == 1 && notified_length == 2);
+  CHECK (notified_ids[0] == 2 && notified_ids[1] == 1);
+
+  // Rolled back: never
+  reset ();
+  CHECK (gawake_db_transaction_begin (db) == EXIT_SUCCESS);
+  CHECK (rule_add (db, &rule) == EXIT_SUCCESS);
+  CHECK (gawake_db_transaction_end (db, EXIT_FAILURE) == EXIT_FAILURE);
+  CHECK (notifications == 0);
+  CHECK (rule_get_single (db, 3, TABLE_OFF, &found) != EXIT_SUCCESS);
+
+  // A nested transaction rolled back: only the changes of the outer one
+  reset ();
+  CHECK (gawake_db_transaction_begin (db) == EXIT_SUCCESS);
+  CHECK (rule_enable_disable (db, 1, TABLE_OFF, true) == EXIT_SUCCESS);
+  CHECK (gawake_db_transaction_begin (db) == EXIT_SUCCESS);
+  CHECK (rule_enable_disable (db, 2, TABLE_OFF, false) == EXIT_SUCCESS);
+  CHECK (gawake_db_transaction_end (db, EXIT_FAILURE) == EXIT_FAILURE);
+  CHECK (notifications == 0);
+  CHECK (gawake_db_transaction_end (db, EXIT_SUCCESS) == EXIT_SUCCESS);
+  CHECK (notifications == 1 && notified_length == 1 && notified_ids[0] == 1);
+  CHECK (rule_get_single (db, 2, TABLE_OFF, &found) == EXIT_SUCCESS && found.active);
+
+  gawake_db_close (db);
+
+  return check_result ();
+}
@@ -0,0 +1,63 @@
+/* test-utils.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Helpers shared by the tests and the benchmarks: the checks don't stop the
+ * test, so every failure is reported, and the result is the exit status
+ * (EXIT_FAILURE if any check failed)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "test-utils.h"
+
+static unsigned int checks = 0, failures = 0;
+
+bool check_condition (bool condition, const char *expression,
+                      const char *file, int line)
+{
+  checks++;
+
+  if (!condition)
+    {
+      failures++;
+      fprintf (stderr, "FAIL: %s:%d: %s\n", file, line, expression);
+    }
+
+  return condition;
+}
+
+int check_result (void)
+{
+  printf ("%u checks, %u failed\n", checks, failures);
+
+  return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Milliseconds since "start", on the monotonic clock
+double elapsed_ms (const struct timespec *start)
+{
+  struct timespec now;
+
+  clock_gettime (CLOCK_MONOTONIC, &now);
+
+  return (now.tv_sec - start->tv_sec) * 1e3 + (now.tv_nsec - start->tv_nsec) / 1e6;
+}
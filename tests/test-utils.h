@@ -0,0 +1,15 @@
+#ifndef TEST_UTILS_H_
+#define TEST_UTILS_H_
+
+#include <stdbool.h>
+#include <time.h>
+
+// Check a condition, reporting it if it fails; the test goes on
+#define CHECK(condition) check_condition ((condition), #condition, __FILE__, __LINE__)
+
+bool check_condition (bool condition, const char *expression,
+                      const char *file, int line);
+int check_result (void);
+double elapsed_ms (const struct timespec *start);
+
+#endif /* TEST_UTILS_H_ */
@@ -0,0 +1,156 @@
+/* test-week-index.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Edge cases of the lookup on the week index: the wrap from the last minute
+ * of the week (Saturday 23:59, 10079) to the first one (Sunday 00:00, 0), the
+ * upper bound (an entry on the given minute itself isn't upcoming) and rules
+ * on the same minute
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "test-utils.h"
+#include "../src/gawaked/week-index.h"
+
+static const bool SUNDAY[7] = { true, false, false, false, false, false, false };
+static const bool SATURDAY[7] = { false, false, false, false, false, false, true };
+static const bool MONDAY_FRIDAY[7] = { false, true, false, false, false, true, false };
+
+static void test_empty (void)
+{
+  WeekIndex index;
+  int ahead = -1;
+
+  week_index_init (&index);
+  CHECK (week_index_next (&index, 0, &ahead) == NULL);
+  week_index_free (&index);
+}
+
+static void test_wrap_around (void)
+{
+  WeekIndex index;
+  const WeekIndexEntry *entry;
+  int ahead;
+
+  week_index_init (&index);
+  CHECK (week_index_add (&index, 1, 0, 0, SUNDAY, MODE_OFF) == EXIT_SUCCESS);
+  CHECK (week_index_add (&index, 2, 23, 59, SATURDAY, MODE_OFF) == EXIT_SUCCESS);
+  week_index_sort (&index);
+
+  CHECK (index.length == 2);
+  CHECK (index.entries[1].minute == MINUTES_PER_WEEK - 1);
+
+  // From the last minute of the week to the first one of the next
+  entry = week_index_next (&index, MINUTES_PER_WEEK - 1, &ahead);
+  CHECK (entry != NULL && entry->id == 1 && entry->minute == 0);
+  CHECK (ahead == 1);
+
+  entry = week_index_next (&index, MINUTES_PER_WEEK - 2, &ahead);
+  CHECK (entry != NULL && entry->id == 2);
+  CHECK (ahead == 1);
+
+  entry = week_index_next (&index, 0, &ahead);
+  CHECK (entry != NULL && entry->id == 2);
+  CHECK (ahead == MINUTES_PER_WEEK - 1);
+
+  week_index_free (&index);
+}
+
+static void test_upper_bound (void)
+{
+  WeekIndex index;
+  const WeekIndexEntry *entry;
+  int ahead, minute;
+
+  week_index_init (&index);
+  // Monday and Friday, 08:30
+  CHECK (week_index_add (&index, 7, 8, 30, MONDAY_FRIDAY, MODE_MEM) == EXIT_SUCCESS);
+  week_index_sort (&index);
+  CHECK (index.length == 2);
+
+  // The rule on the given minute isn't upcoming: the next day of it is
+  minute = WEEK_MINUTE (1, 8, 30);
+  entry = week_index_next (&index, minute, &ahead);
+  CHECK (entry != NULL && entry->minute == WEEK_MINUTE (5, 8, 30));
+  CHECK (ahead == 4 * MINUTES_PER_DAY);
+
+  // One minute before it, it is
+  entry = week_index_next (&index, minute - 1, &ahead);
+  CHECK (entry != NULL && entry->minute == minute);
+  CHECK (ahead == 1);
+
+  // After the last entry of the week, the first one of the next week
+  entry = week_index_next (&index, WEEK_MINUTE (5, 8, 30), &ahead);
+  CHECK (entry != NULL && entry->minute == minute);
+  CHECK (ahead == MINUTES_PER_WEEK - 4 * MINUTES_PER_DAY);
+
+  // A single entry is found again a whole week later
+  week_index_remove (&index, 7);
+  CHECK (week_index_add (&index, 7, 8, 30, SUNDAY, MODE_MEM) == EXIT_SUCCESS);
+  week_index_sort (&index);
+  entry = week_index_next (&index, WEEK_MINUTE (0, 8, 30), &ahead);
+  CHECK (entry != NULL && entry->id == 7);
+  CHECK (ahead == MINUTES_PER_WEEK);
+
+  week_index_free (&index);
+}
+
+static void test_same_minute (void)
+{
+  WeekIndex index;
+  const WeekIndexEntry *entry;
+  int ahead;
+
+  week_index_init (&index);
+  // Added out of order: the lowest id comes first, whatever the order
+  CHECK (week_index_add (&index, 30, 22, 0, SUNDAY, MODE_OFF) == EXIT_SUCCESS);
+  CHECK (week_index_add (&index, 10, 22, 0, SUNDAY, MODE_MEM) == EXIT_SUCCESS);
+  CHECK (week_index_add (&index, 20, 22, 0, SUNDAY, MODE_DISK) == EXIT_SUCCESS);
+  week_index_sort (&index);
+
+  entry = week_index_next (&index, WEEK_MINUTE (0, 21, 59), &ahead);
+  CHECK (entry != NULL && entry->id == 10 && entry->mode == MODE_MEM);
+  CHECK (ahead == 1);
+
+  // None of them is upcoming on their own minute
+  entry = week_index_next (&index, WEEK_MINUTE (0, 22, 0), &ahead);
+  CHECK (entry != NULL && entry->id == 10);
+  CHECK (ahead == MINUTES_PER_WEEK);
+
+  // Removing one keeps the others, in order
+  week_index_remove (&index, 10);
+  CHECK (index.length == 2);
+  entry = week_index_next (&index, WEEK_MINUTE (0, 21, 59), &ahead);
+  CHECK (entry != NULL && entry->id == 20 && entry->mode == MODE_DISK);
+
+  week_index_free (&index);
+}
+
+int main (void)
+{
+  test_empty ();
+  test_wrap_around ();
+  test_upper_bound ();
+  test_same_minute ();
+
+  return check_result ();
+}
@@ -0,0 +1,182 @@
+/* virtual-clock.c
+ *
+ * Copyright 2021-2024 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Virtual clock for the scheduler: the time source, and a deadline timer on
+ * an eventfd, readable when the test moves the clock to the armed deadline,
+ * or sets the clock (then reading it fails with ECANCELED, like timerfd with
+ * TFD_TIMER_CANCEL_ON_SET)
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include "virtual-clock.h"
+#include "../src/gawaked/deadline-timer.h"
+#include "../src/utils/get-time.h"
+
+static int virtual_timer_create (void);
+static int virtual_timer_set_time (int fd, time_t deadline);
+static ssize_t virtual_timer_read (int fd, uint64_t *expirations);
+
+static const DeadlineTimerBackend virtual_timer = {
+  .create = virtual_timer_create,
+  .set_time = virtual_timer_set_time,
+  .read = virtual_timer_read,
+};
+
+static time_t now;
+static time_t armed;          // last deadline armed by the scheduler
+static int arms = 0;          // times the timer was armed
+static struct timespec armed_at;  // CLOCK_MONOTONIC, when it was last armed
+static bool clock_set = false;
+
+static time_t get_virtual_time (void)
+{
+  return now;
+}
+
+static void wake_timer (int fd)
+{
+  uint64_t one = 1;
+
+  if (write (fd, &one, sizeof (one)) != sizeof (one))
+    perror ("ERROR: Couldn't wake the virtual timer");
+}
+
+static void drain_timer (int fd)
+{
+  uint64_t count;
+
+  while (read (fd, &count, sizeof (count)) == sizeof (count));
+}
+
+static int virtual_timer_create (void)
+{
+  return eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+}
+
+static int virtual_timer_set_time (int fd, time_t deadline)
+{
+  // Like timerfd, arming it again drops a pending expiration
+  drain_timer (fd);
+  armed = deadline;
+  arms++;
+  clock_gettime (CLOCK_MONOTONIC, &armed_at);
+
+  if (deadline <= now)
+    wake_timer (fd);
+
+  return 0;
+}
+
+static ssize_t virtual_timer_read (int fd, uint64_t *expirations)
+{
+  ssize_t size;
+
+  if (clock_set)
+    {
+      clock_set = false;
+      drain_timer (fd);
+      errno = ECANCELED;
+      return -1;
+    }
+
+  size = read (fd, expirations, sizeof (*expirations));
+  if (size == sizeof (*expirations))
+    *expirations = 1;
+
+  return size;
+}
+
+// Run the scheduler on the virtual clock, from "start"; before scheduler_init ()
+void virtual_clock_install (time_t start)
+{
+  now = start;
+  set_time_source (get_virtual_time);
+  deadline_timer_set_backend (&virtual_timer);
+}
+
+void virtual_clock_uninstall (void)
+{
+  set_time_source (NULL);
+  deadline_timer_set_backend (NULL);
+}
+
+time_t virtual_clock_now (void)
+{
+  return now;
+}
+
+// Local time on the day of the virtual clock (plus "days")
+time_t virtual_clock_local_time (int days, int hour, int minutes)
+{
+  struct tm local;
+
+  localtime_r (&now, &local);
+  local.tm_mday += days;
+  local.tm_hour = hour;
+  local.tm_min = minutes;
+  local.tm_sec = 0;
+  local.tm_isdst = -1;
+
+  return mktime (&local);
+}
+
+// Set the clock, as an NTP step or the admin would
+void virtual_clock_set (time_t to)
+{
+  now = to;
+  clock_set = true;
+  wake_timer (deadline_timer_get_fd ());
+}
+
+// Move the clock without setting it, e.g. while the system was suspended
+void virtual_clock_move (time_t to)
+{
+  now = to;
+}
+
+time_t virtual_timer_armed (void)
+{
+  return armed;
+}
+
+int virtual_timer_arms (void)
+{
+  return arms;
+}
+
+// Milliseconds from "since" (CLOCK_MONOTONIC) to the last time it was armed
+double virtual_timer_armed_after (const struct timespec *since)
+{
+  return (armed_at.tv_sec - since->tv_sec) * 1e3
+         + (armed_at.tv_nsec - since->tv_nsec) / 1e6;
+}
+
+// Move the clock to the armed deadline
+void virtual_timer_expire (void)
+{
+  now = armed;
+  wake_timer (deadline_timer_get_fd ());
+}
@@ -0,0 +1,17 @@
+#ifndef VIRTUAL_CLOCK_H_
+#define VIRTUAL_CLOCK_H_
+
+#include <time.h>
+
+void virtual_clock_install (time_t start);
+void virtual_clock_uninstall (void);
+time_t virtual_clock_now (void);
+time_t virtual_clock_local_time (int days, int hour, int minutes);
+void virtual_clock_set (time_t to);
+void virtual_clock_move (time_t to);
+time_t virtual_timer_armed (void);
+int virtual_timer_arms (void);
+double virtual_timer_armed_after (const struct timespec *since);
+void virtual_timer_expire (void);
+
+#endif /* VIRTUAL_CLOCK_H_ */